@@ -0,0 +1,122 @@
+#include <algorithm>
+#include "BlockedClients.h"
+#include "ClusterSlots.h"
+
+BlockedClients::BlockedClients(Executor executor) : executor(std::move(executor)) {
+}
+
+/// @brief 登记等待者
+/// @param tokens 已经通过参数检查、非阻塞执行结果为nil的阻塞命令
+std::shared_ptr<BlockedClients::Waiter> BlockedClients::block(const std::vector<std::string> &tokens){
+    if(rpc_scheduler::current() == nullptr){
+        return nullptr;
+    }
+    std::shared_ptr<Waiter> waiter = std::make_shared<Waiter>();
+    waiter->tokens = tokens;
+    if(tokens[0] == "blmove"){
+        waiter->keys.push_back(tokens[1]);
+    }
+    else{
+        waiter->keys.assign(tokens.begin()+1, tokens.end()-1);
+    }
+    double seconds = std::stod(tokens.back());
+    for(const std::string &key : waiter->keys){
+        waiters[key].push_back(waiter);
+    }
+    blocked++;
+    //不足1毫秒的超时按1毫秒计算，0表示一直等待
+    waiter->timeout = seconds > 0 ? std::max<uint32_t>(1, static_cast<uint32_t>(seconds * 1000)) : 0;
+    return waiter;
+}
+
+/// @brief 等待serveKey或者expire给出回复
+rpc_task<std::string> BlockedClients::wait(std::shared_ptr<Waiter> waiter){
+    if(waiter->timeout > 0){
+        rpc_spawn(expire(waiter, waiter->timeout));
+    }
+    while(!waiter->done){
+        co_await waiter->served.wait();
+    }
+    co_return std::move(waiter->reply);
+}
+
+/// @brief 超时后等待者还没有被服务时回复nil
+rpc_task<void> BlockedClients::expire(std::weak_ptr<Waiter> weak, uint32_t ms){
+    co_await rpc_sleep(ms);
+    std::shared_ptr<Waiter> waiter = weak.lock();
+    if(waiter == nullptr || waiter->done){
+        co_return;
+    }
+    unblock(waiter);
+    waiter->done = true;
+    waiter->reply = NIL_MESSAGE;
+    waiter->served.notify_one();
+}
+
+/// @brief 检查写命令涉及的键，BLMOVE唤醒后压入的目标列表也会继续检查
+void BlockedClients::signal(const std::vector<std::string> &tokens){
+    if(waiters.empty()){
+        return;
+    }
+    std::vector<std::string> keys = commandKeys(tokens);
+    std::deque<std::string> ready(keys.begin(), keys.end());
+    while(!ready.empty()){
+        std::string key = std::move(ready.front());
+        ready.pop_front();
+        serveKey(key, ready);
+    }
+}
+
+/// @brief 依次服务键上的等待者，直到列表为空或者没有等待者
+void BlockedClients::serveKey(const std::string &key, std::deque<std::string> &ready){
+    auto it = waiters.find(key);
+    if(it == waiters.end()){
+        return;
+    }
+    std::deque<std::shared_ptr<Waiter>> &queue = it->second;
+    while(!queue.empty()){
+        std::shared_ptr<Waiter> waiter = queue.front();
+        std::vector<std::string> command;
+        if(waiter->tokens[0] == "blmove"){
+            command = {"lmove", key, waiter->tokens[2], waiter->tokens[3], waiter->tokens[4]};
+        }
+        else{
+            command = {waiter->tokens[0] == "blpop" ? "lpop" : "rpop", key};
+        }
+        std::string result = executor(command);
+        if(result.empty() || result[0] != '"'){
+            break;  //列表为空，或者键已经不是列表，继续等待
+        }
+        unblock(waiter);
+        waiter->done = true;
+        if(waiter->tokens[0] == "blmove"){
+            ready.push_back(waiter->tokens[2]);
+            waiter->reply = std::move(result);
+        }
+        else{
+            waiter->reply = "1) \"" + key + "\"\n2) " + result;
+        }
+        waiter->served.notify_one();
+        //unblock可能已经删除了这个键的队列
+        it = waiters.find(key);
+        if(it == waiters.end()){
+            return;
+        }
+    }
+}
+
+/// @brief 把等待者从所有键的队列中移除
+void BlockedClients::unblock(const std::shared_ptr<Waiter> &waiter){
+    blocked--;
+    for(const std::string &key : waiter->keys){
+        auto it = waiters.find(key);
+        if(it == waiters.end()){
+            continue;
+        }
+        std::deque<std::shared_ptr<Waiter>> &queue = it->second;
+        queue.erase(std::remove(queue.begin(), queue.end(), waiter), queue.end());
+        if(queue.empty()){
+            waiters.erase(it);
+        }
+    }
+}
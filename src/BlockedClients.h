@@ -0,0 +1,57 @@
+#ifndef BLOCKED_CLIENTS_H
+#define BLOCKED_CLIENTS_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <unordered_map>
+#include "RPC/coroutine.hpp"
+
+/*
+    BLPOP/BRPOP/BLMOVE的阻塞部分
+    命令先按非阻塞的方式执行，列表都为空时调用block：把客户端放入每个键的等待队列，
+    处理请求的协程释放dataMutex后用wait挂起，run线程可以继续处理其他客户端
+    写命令执行之后调用signal，它的键上有等待者时按先来先服务的顺序执行等价的非阻塞命令
+    （LPOP/RPOP/LMOVE），把执行结果交给等待者并唤醒它；等价命令会像普通写命令一样传播给从节点
+    超时由另一个协程用rpc_sleep等待，到期时等待者还没有被服务就回复nil
+    所有方法只在调度器线程调用，block和signal的调用者需要持有dataMutex，wait的调用者不能持有
+*/
+class BlockedClients{
+public:
+    //执行一条命令并传播，用于唤醒等待者
+    typedef std::function<std::string(std::vector<std::string>&)> Executor;
+
+    struct Waiter{
+        std::vector<std::string> tokens;
+        std::vector<std::string> keys;
+        uint32_t timeout = 0;   //毫秒，0表示一直等待
+        bool done = false;      //已经被服务或者已经超时
+        std::string reply;
+        rpc_condition served;   //done变为true时通知
+    };
+
+    explicit BlockedClients(Executor executor);
+
+    //登记等待者，不在调度器线程中（无法挂起）时返回nullptr
+    std::shared_ptr<Waiter> block(const std::vector<std::string> &tokens);
+    //挂起直到等待者被服务或者超时，返回给客户端的回复
+    rpc_task<std::string> wait(std::shared_ptr<Waiter> waiter);
+    //写命令执行之后调用，服务等待该命令的键的客户端
+    void signal(const std::vector<std::string> &tokens);
+    size_t count() const { return blocked; }   //正在等待的客户端个数
+
+private:
+    void serveKey(const std::string &key, std::deque<std::string> &ready);
+    void unblock(const std::shared_ptr<Waiter> &waiter);
+    //只持有weak_ptr，等待者被服务后不会因为定时器还没到期而留在内存中
+    rpc_task<void> expire(std::weak_ptr<Waiter> waiter, uint32_t ms);
+
+private:
+    Executor executor;
+    std::unordered_map<std::string, std::deque<std::shared_ptr<Waiter>>> waiters;    //键 -> 按阻塞顺序排列的等待者
+    size_t blocked = 0;
+};
+
+#endif
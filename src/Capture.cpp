@@ -0,0 +1,183 @@
+#include "Capture.h"
+#include "RPC/buttonrpc.hpp"
+
+Capture& Capture::getInstance(){
+    static Capture capture;
+    return capture;
+}
+
+Capture::~Capture(){
+    stop();
+}
+
+void Capture::writeVarint(std::string &out, uint64_t value){
+    while(value >= 0x80){
+        out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+std::string Capture::command(const std::vector<std::string> &tokens){
+    if(tokens.size() == 3 && tokens[1] == "start"){
+        if(active.load(std::memory_order_relaxed)){
+            return "(error) ERR capture already in progress to " + path;
+        }
+        if(!isBareFileName(tokens[2])){
+            return "(error) ERR invalid file name " + tokens[2] + ", only a file name inside the output directory is allowed";
+        }
+        std::string filePath = directory + "/" + tokens[2];
+        file.open(filePath, std::ios::binary | std::ios::trunc);
+        if(!file.is_open()){
+            return "(error) ERR can't open " + filePath;
+        }
+        std::string header(CAPTURE_MAGIC);
+        header.push_back(static_cast<char>(CAPTURE_VERSION));
+        uint64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        for(int i=0; i<8; i++){
+            header.push_back(static_cast<char>(now >> (8 * i)));
+        }
+        file.write(header.data(), header.size());
+        path = filePath;
+        last = std::chrono::steady_clock::now();
+        connections.clear();
+        records = 0;
+        stopping = false;
+        writer = std::thread(&Capture::run, this);
+        active.store(true, std::memory_order_relaxed);
+        return "OK";
+    }
+    if(tokens.size() == 2 && tokens[1] == "stop"){
+        if(!active.load(std::memory_order_relaxed)){
+            return "(error) ERR no capture in progress";
+        }
+        stop();
+        return "(integer) " + std::to_string(records);
+    }
+    if(tokens.size() == 2 && tokens[1] == "status"){
+        if(!active.load(std::memory_order_relaxed)){
+            return "\"off\"";
+        }
+        return "\"" + path + " " + std::to_string(records) + " commands\"";
+    }
+    return "(error) ERR unknown subcommand or wrong number of arguments for CAPTURE";
+}
+
+void Capture::append(const std::string &commandLine){
+    //录制命令本身不回放
+    if(commandLine.compare(0, 7, "capture") == 0){
+        return;
+    }
+    auto now = std::chrono::steady_clock::now();
+    uint32_t connection = 0;
+    buttonrpc *rpc = buttonrpc::serving();
+    if(rpc != nullptr){
+        auto it = connections.emplace(rpc->current_identity(), connections.size() + 1).first;
+        connection = it->second;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    writeVarint(buffer, std::chrono::duration_cast<std::chrono::nanoseconds>(now - last).count());
+    writeVarint(buffer, connection);
+    writeVarint(buffer, commandLine.size());
+    buffer += commandLine;
+    last = now;
+    records++;
+    if(buffer.size() >= CAPTURE_FLUSH_BYTES){
+        condition.notify_one();
+    }
+}
+
+/// @brief 停止录制，等写线程把剩下的记录写完
+void Capture::stop(){
+    if(!writer.joinable()){
+        return;
+    }
+    active.store(false, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    condition.notify_one();
+    writer.join();
+    file.close();
+}
+
+/// @brief 写线程：缓冲区满了或者每隔一秒把记录写入文件
+void Capture::run(){
+    std::string pending;
+    while(true){
+        bool done = false;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait_for(lock, std::chrono::seconds(1), [this](){ return stopping || buffer.size() >= CAPTURE_FLUSH_BYTES; });
+            pending.swap(buffer);
+            done = stopping;
+        }
+        file.write(pending.data(), pending.size());
+        pending.clear();
+        if(done){
+            file.flush();
+            return;
+        }
+    }
+}
+
+bool CaptureReader::open(const std::string &path){
+    file.open(path, std::ios::binary);
+    if(!file.is_open()){
+        message = "can't open " + path;
+        return false;
+    }
+    char header[13];
+    if(!file.read(header, sizeof(header)) || std::string(header, 4) != CAPTURE_MAGIC){
+        message = path + " is not a capture file";
+        return false;
+    }
+    if(header[4] != CAPTURE_VERSION){
+        message = "unsupported capture version " + std::to_string(header[4]);
+        return false;
+    }
+    start = 0;
+    for(int i=0; i<8; i++){
+        start |= static_cast<uint64_t>(static_cast<uint8_t>(header[5 + i])) << (8 * i);
+    }
+    offset = 0;
+    return true;
+}
+
+bool CaptureReader::readVarint(uint64_t &value){
+    value = 0;
+    for(int shift=0; shift<64; shift+=7){
+        int byte = file.get();
+        if(byte == EOF){
+            return false;
+        }
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if((byte & 0x80) == 0){
+            return true;
+        }
+    }
+    return false;
+}
+
+bool CaptureReader::next(CaptureRecord &record){
+    uint64_t delta = 0;
+    uint64_t connection = 0;
+    uint64_t length = 0;
+    if(!readVarint(delta)){
+        return false;   //正常结束
+    }
+    if(!readVarint(connection) || !readVarint(length)){
+        message = "truncated record";
+        return false;
+    }
+    record.command.resize(length);
+    if(!file.read(&record.command[0], length)){
+        message = "truncated record";
+        return false;
+    }
+    offset += delta;
+    record.offset = offset;
+    record.connection = connection;
+    return true;
+}
@@ -0,0 +1,92 @@
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <unordered_map>
+#include <condition_variable>
+#include "global.h"
+
+#define CAPTURE_MAGIC "RCAP"
+#define CAPTURE_VERSION 1
+#define CAPTURE_FLUSH_BYTES (64 * 1024)     //缓冲区超过该大小时唤醒写线程
+
+/*
+    流量录制
+    CAPTURE START filename 之后handleClient收到的每条命令都追加到内存缓冲区，由后台线程写入文件，
+    请求线程不做文件IO；没有录制时每条命令只多一次原子读
+    文件格式：头部是 "RCAP"、版本（1字节）、开始录制的unix时间（8字节小端，纳秒）
+    之后每条记录是 [varint 距上一条的纳秒数][varint 连接编号][varint 长度][命令]
+    连接编号按连接第一次出现的顺序从1开始分配，不是通过RPC收到的命令（例如直接调用）编号为0
+*/
+class Capture{
+public:
+    static Capture& getInstance();
+    ~Capture();
+
+    //CAPTURE START filename / CAPTURE STOP / CAPTURE STATUS，文件写在setDirectory指定的目录下
+    std::string command(const std::vector<std::string> &tokens);
+    //只在启动时设置
+    void setDirectory(const std::string &dir) { directory = dir; }
+    //记录一条收到的命令，调用者需要持有dataMutex，保证记录的顺序就是执行的顺序
+    void record(const std::string &commandLine){
+        if(active.load(std::memory_order_relaxed)){
+            append(commandLine);
+        }
+    }
+
+    static void writeVarint(std::string &out, uint64_t value);
+
+private:
+    Capture() = default;
+    void append(const std::string &commandLine);
+    void stop();
+    void run();
+
+private:
+    std::atomic<bool> active{false};
+    std::mutex mutex;                   //保护buffer和stopping
+    std::condition_variable condition;
+    std::string buffer;                 //还没写入文件的记录
+    bool stopping = false;
+    std::thread writer;
+    std::ofstream file;                 //只在写线程中使用
+    std::string path;
+    std::string directory = DEFAULT_OUTPUT_DIR;
+    std::chrono::steady_clock::time_point last;     //上一条记录的时间
+    std::unordered_map<std::string, uint32_t> connections;  //ROUTER身份 -> 连接编号
+    uint64_t records = 0;
+};
+
+//录制文件中的一条命令
+struct CaptureRecord{
+    uint64_t offset;        //距开始录制的纳秒数
+    uint32_t connection;
+    std::string command;
+};
+
+//顺序读取录制文件
+class CaptureReader{
+public:
+    bool open(const std::string &path);     //失败时error()给出原因
+    bool next(CaptureRecord &record);       //读到末尾或者文件损坏时返回false
+    uint64_t startTime() const { return start; }
+    const std::string& error() const { return message; }
+
+private:
+    bool readVarint(uint64_t &value);
+
+private:
+    std::ifstream file;
+    uint64_t start = 0;
+    uint64_t offset = 0;
+    std::string message;
+};
+
+#endif
@@ -0,0 +1,338 @@
+#include <sstream>
+#include <chrono>
+#include "Cluster.h"
+
+Cluster::Cluster(int port, std::mutex &dataMutex)
+: port(port), dataMutex(dataMutex), myself(std::string(CLUSTER_DEFAULT_HOST) + ":" + std::to_string(port)), slots(CLUSTER_SLOTS) {
+}
+
+void Cluster::start(){
+    std::thread(&Cluster::serveBus, this).detach();
+}
+
+bool Cluster::parseSlot(const std::string &str, int &slot){
+    try{
+        size_t pos = 0;
+        slot = std::stoi(str, &pos);
+        return pos == str.size() && slot >= 0 && slot < CLUSTER_SLOTS;
+    }
+    catch(const std::exception &e){
+        return false;
+    }
+}
+
+/// @brief 节点地址 host:port 对应的集群总线地址
+std::string Cluster::busEndpoint(const std::string &address){
+    size_t colon = address.rfind(':');
+    int port = std::stoi(address.substr(colon+1));
+    return "tcp://" + address.substr(0, colon) + ":" + std::to_string(port + CLUSTER_BUS_PORT_OFFSET);
+}
+
+/// @brief 检查命令的键是否由本节点负责
+/// @param asking 客户端是否在上一条命令发送了ASKING
+/// @return 需要重定向时返回MOVED/ASK等错误，可以在本节点执行时返回空字符串
+std::string Cluster::redirect(const std::vector<std::string> &tokens, bool asking){
+    if(!clusterEnabled){
+        return "";
+    }
+    std::vector<std::string> keys = commandKeys(tokens);
+    if(keys.empty()){
+        return "";
+    }
+    int slot = keyHashSlot(keys[0]);
+    for(size_t i=1; i<keys.size(); i++){
+        if(keyHashSlot(keys[i]) != slot){
+            return "(error) CROSSSLOT Keys in request don't hash to the same slot";
+        }
+    }
+    const Slot &state = slots[slot];
+    if(state.owner == myself){
+        if(state.migratingTo.empty()){
+            return "";
+        }
+        //正在迁出：键都还在本地时在本地执行，都已经迁走时让客户端去目标节点
+        size_t missing = 0;
+        for(const std::string &key : keys){
+            if(CommandParser::getRedisHelper()->getType(key) == TYPE_NONE){
+                missing++;
+            }
+        }
+        if(missing == 0){
+            for(const std::string &key : keys){
+                if(inFlightKeys.count(key) != 0){
+                    return "(error) TRYAGAIN Key is being migrated";
+                }
+            }
+            return "";
+        }
+        if(missing < keys.size()){
+            return "(error) TRYAGAIN Multiple keys request during rehashing of slot";
+        }
+        return "(error) ASK " + std::to_string(slot) + " " + state.migratingTo;
+    }
+    if(asking && !state.importingFrom.empty()){
+        return "";
+    }
+    if(state.owner.empty()){
+        return "(error) CLUSTERDOWN Hash slot not served";
+    }
+    return "(error) MOVED " + std::to_string(slot) + " " + state.owner;
+}
+
+/// @brief CLUSTER子命令
+/// CLUSTER KEYSLOT key
+/// CLUSTER ADDSLOTSRANGE start end [host:port]：把区间内的槽分配给指定节点，默认为本节点，同时开启集群模式
+/// CLUSTER SETSLOT slot NODE|MIGRATING|IMPORTING host:port / CLUSTER SETSLOT slot STABLE
+/// CLUSTER SLOTS：槽的分布，每行为 start end host:port
+/// CLUSTER MYSELF [host:port]：查看或设置本节点对外的地址
+/// CLUSTER MIGRATE slot：把处于MIGRATING状态的槽迁移到目标节点
+std::string Cluster::command(const std::vector<std::string> &tokens){
+    if(tokens.size() < 2){
+        return "wrong number of arguments for CLUSTER.";
+    }
+    const std::string &sub = tokens[1];
+    if(sub == "keyslot" && tokens.size() == 3){
+        return "(integer) " + std::to_string(keyHashSlot(tokens[2]));
+    }
+    if(sub == "addslotsrange" && (tokens.size() == 4 || tokens.size() == 5)){
+        int start = 0;
+        int end = 0;
+        if(!parseSlot(tokens[2], start) || !parseSlot(tokens[3], end) || start > end){
+            return "(error) ERR Invalid or out of range slot";
+        }
+        for(int slot=start; slot<=end; slot++){
+            slots[slot].owner = tokens.size() == 5 ? tokens[4] : myself;
+        }
+        clusterEnabled = true;
+        CommandParser::getRedisHelper()->enableSlotIndex();
+        return "OK";
+    }
+    if(sub == "setslot"){
+        return setSlot(tokens);
+    }
+    if(sub == "slots" && tokens.size() == 2){
+        return slotsReply();
+    }
+    if(sub == "myself" && tokens.size() <= 3){
+        if(tokens.size() == 3){
+            myself = tokens[2];
+            return "OK";
+        }
+        return "\"" + myself + "\"";
+    }
+    if(sub == "migrate" && tokens.size() == 3){
+        int slot = 0;
+        if(!parseSlot(tokens[2], slot)){
+            return "(error) ERR Invalid or out of range slot";
+        }
+        if(slots[slot].owner != myself || slots[slot].migratingTo.empty()){
+            return "(error) ERR Slot " + tokens[2] + " is not migrating";
+        }
+        std::thread(&Cluster::migrate, this, slot, slots[slot].migratingTo).detach();
+        return "OK";
+    }
+    return "(error) ERR unknown subcommand or wrong number of arguments for CLUSTER " + sub;
+}
+
+std::string Cluster::setSlot(const std::vector<std::string> &tokens){
+    if(tokens.size() != 4 && tokens.size() != 5){
+        return "wrong number of arguments for CLUSTER SETSLOT.";
+    }
+    int slot = 0;
+    if(!parseSlot(tokens[2], slot)){
+        return "(error) ERR Invalid or out of range slot";
+    }
+    Slot &state = slots[slot];
+    const std::string &action = tokens[3];
+    if(action == "stable" && tokens.size() == 4){
+        state.migratingTo.clear();
+        state.importingFrom.clear();
+        return "OK";
+    }
+    if(tokens.size() != 5){
+        return "wrong number of arguments for CLUSTER SETSLOT.";
+    }
+    const std::string &node = tokens[4];
+    if(action == "node"){
+        state.owner = node;
+        state.migratingTo.clear();
+        state.importingFrom.clear();
+        clusterEnabled = true;
+        CommandParser::getRedisHelper()->enableSlotIndex();
+        return "OK";
+    }
+    if(action == "migrating"){
+        if(state.owner != myself || node == myself){
+            return "(error) ERR I'm not the owner of hash slot " + tokens[2];
+        }
+        state.migratingTo = node;
+        return "OK";
+    }
+    if(action == "importing"){
+        if(state.owner == myself || node == myself){
+            return "(error) ERR I'm already the owner of hash slot " + tokens[2];
+        }
+        state.importingFrom = node;
+        return "OK";
+    }
+    return "(error) ERR Invalid CLUSTER SETSLOT action";
+}
+
+/// @brief 把连续的、由同一节点负责的槽合并成一行
+std::string Cluster::slotsReply() const{
+    std::string res;
+    int index = 0;
+    for(int start=0; start<CLUSTER_SLOTS; ){
+        int end = start;
+        while(end+1 < CLUSTER_SLOTS && slots[end+1].owner == slots[start].owner){
+            end++;
+        }
+        if(!slots[start].owner.empty()){
+            if(index != 0){
+                res += "\n";
+            }
+            res += std::to_string(++index) + ") \"" + std::to_string(start) + " " + std::to_string(end) + " " + slots[start].owner + "\"";
+        }
+        start = end + 1;
+    }
+    return index == 0 ? EMPTY_LIST_MESSAGE : res;
+}
+
+void Cluster::serveBus(){
+    zmq::socket_t socket(context, ZMQ_REP);
+    socket.bind("tcp://*:" + std::to_string(port + CLUSTER_BUS_PORT_OFFSET));
+    while(true){
+        zmq::message_t request;
+        if(!socket.recv(request)){
+            continue;
+        }
+        std::string reply = handleBus(std::string(static_cast<char*>(request.data()), request.size()));
+        zmq::message_t response(reply.data(), reply.size());
+        socket.send(response);
+    }
+}
+
+/// @brief 处理集群总线上的请求
+/// import slot\n命令\n命令...：迁入一批键，先删除同名的键再执行命令
+/// cluster ...：执行CLUSTER子命令，迁移完成后源节点用它通知目标节点接管槽
+std::string Cluster::handleBus(const std::string &request){
+    size_t headerEnd = request.find('\n');
+    std::istringstream header(request.substr(0, headerEnd));
+    std::vector<std::string> tokens;
+    std::string token;
+    while(header >> token){
+        tokens.push_back(token);
+    }
+    std::lock_guard<std::mutex> lock(dataMutex);
+    if(!tokens.empty() && tokens[0] == "cluster"){
+        return command(tokens);
+    }
+    int slot = 0;
+    if(tokens.size() != 2 || tokens[0] != "import" || !parseSlot(tokens[1], slot)){
+        return "(error) ERR unknown cluster bus request";
+    }
+    if(slots[slot].importingFrom.empty()){
+        return "(error) ERR Slot " + tokens[1] + " is not importing";
+    }
+    size_t pos = headerEnd == std::string::npos ? request.size() : headerEnd + 1;
+    while(pos < request.size()){
+        size_t end = request.find('\n', pos);
+        if(end == std::string::npos){
+            end = request.size();
+        }
+        std::string commandLine = request.substr(pos, end - pos);
+        std::istringstream iss(commandLine);
+        std::string name;
+        std::string key;
+        if(iss >> name >> key){
+            CommandParser::getRedisHelper()->del({key});
+            apply(commandLine);
+        }
+        pos = end + 1;
+    }
+    return "OK";
+}
+
+/// @brief 执行一条迁入的命令，结果直接丢弃
+void Cluster::apply(const std::string &commandLine){
+    std::istringstream iss(commandLine);
+    std::string token;
+    std::vector<std::string> tokens;
+    while(iss >> token){
+        tokens.push_back(token);
+    }
+    std::shared_ptr<CommandParser> commandParser = factory.getParser(tokens[0]);
+    if(commandParser == nullptr){
+        return;
+    }
+    try{
+        commandParser->parse(tokens);
+    }
+    catch(const std::exception &e){
+    }
+}
+
+/// @brief 向其他节点的集群总线发送请求，超时返回空字符串
+std::string Cluster::busCall(const std::string &address, const std::string &request){
+    zmq::socket_t socket(context, ZMQ_REQ);
+    socket.setsockopt(ZMQ_RCVTIMEO, CLUSTER_TIMEOUT_MS);
+    socket.setsockopt(ZMQ_LINGER, 0);
+    socket.connect(busEndpoint(address));
+    zmq::message_t message(request.data(), request.size());
+    socket.send(message);
+    zmq::message_t reply;
+    if(!socket.recv(reply)){
+        return "";
+    }
+    return std::string(static_cast<char*>(reply.data()), reply.size());
+}
+
+/// @brief 迁移线程，每批在数据锁内从槽索引取出键并生成重建命令，释放锁后发给目标节点，确认后重新加锁删除
+/// 发送期间这批键在inFlightKeys中，访问它们的命令回复TRYAGAIN，所以确认时键的内容和发送的相同
+/// 迁移期间该槽的新键会被ASK到目标节点，不会出现在本地，索引取空时迁移完成
+void Cluster::migrate(int slot, std::string target){
+    std::shared_ptr<RedisHelper> helper = CommandParser::getRedisHelper();
+    while(true){
+        std::unique_lock<std::mutex> lock(dataMutex);
+        if(slots[slot].migratingTo != target){
+            return; //迁移被取消
+        }
+        std::vector<std::string> batch = helper->slotKeys(slot, CLUSTER_MIGRATE_BATCH);
+        bool ok = true;
+        if(!batch.empty()){
+            std::string request = "import " + std::to_string(slot);
+            for(const std::string &line : helper->dump(batch)){
+                request += "\n" + line;
+            }
+            inFlightKeys.insert(batch.begin(), batch.end());
+            lock.unlock();
+            ok = busCall(target, request) == "OK";
+            lock.lock();
+            for(const std::string &key : batch){
+                inFlightKeys.erase(key);
+            }
+            //等待确认期间迁移可能被取消，取消后键仍然由本节点负责，不能删除
+            if(ok && slots[slot].migratingTo == target){
+                helper->del(batch);
+            }
+        }
+        else{
+            //全部迁移完成，先让目标节点接管，再修改本地的槽分布
+            lock.unlock();
+            ok = busCall(target, "cluster setslot " + std::to_string(slot) + " node " + target) == "OK";
+            lock.lock();
+            if(ok && slots[slot].migratingTo == target){
+                slots[slot].owner = target;
+                slots[slot].migratingTo.clear();
+                return;
+            }
+        }
+        lock.unlock();
+        if(!ok){
+            std::this_thread::sleep_for(std::chrono::milliseconds(CLUSTER_TIMEOUT_MS));
+        }
+        else{
+            std::this_thread::yield();
+        }
+    }
+}
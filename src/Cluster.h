@@ -0,0 +1,72 @@
+#ifndef CLUSTER_H
+#define CLUSTER_H
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <thread>
+#include <set>
+#include <zmq.hpp>
+#include "ClusterSlots.h"
+#include "ParserFlyweightFactory.h"
+
+#define CLUSTER_BUS_PORT_OFFSET 10000   //集群总线端口 = 服务端口 + 10000，节点之间迁移数据用
+#define CLUSTER_MIGRATE_BATCH 100       //迁移时每批最多发送的键个数
+#define CLUSTER_TIMEOUT_MS 5000         //集群总线请求的超时时间
+#define CLUSTER_DEFAULT_HOST "127.0.0.1"
+
+/*
+    哈希槽集群
+    键按CRC16映射到16384个槽，每个槽由一个节点（host:port）负责，没有节点间的自动发现，
+    每个节点都用 CLUSTER ADDSLOTSRANGE 配置完整的槽分布
+    命令的键不属于本节点时回复 MOVED slot host:port，客户端据此更新槽表并重发
+    迁移槽S从A到B：
+        B: CLUSTER SETSLOT S IMPORTING A
+        A: CLUSTER SETSLOT S MIGRATING B
+        A: CLUSTER MIGRATE S
+    迁移期间A上已经不存在的键回复 ASK S B，客户端先向B发送ASKING再重发，B只对同一个连接ASKING之后的一条命令放行
+    迁移在后台线程中分批进行，开启集群模式后按槽维护键索引，每批在数据锁内从索引取出该槽的一批键并生成重建命令，
+    然后释放锁再通过集群总线发给B，发送期间访问这批键的命令回复TRYAGAIN，
+    B确认后重新加锁，迁移没有被取消时A删除这些键，网络往返期间不阻塞A上的其他命令
+    全部发送完后A和B都把槽的负责节点改为B
+*/
+class Cluster{
+public:
+    Cluster(int port, std::mutex &dataMutex);
+
+    void start();   //绑定集群总线端口
+    bool enabled() const { return clusterEnabled; }
+    //检查命令能否在本节点执行，需要重定向时返回错误回复，否则返回空字符串，调用者需要持有dataMutex
+    std::string redirect(const std::vector<std::string> &tokens, bool asking);
+    //CLUSTER子命令，调用者需要持有dataMutex
+    std::string command(const std::vector<std::string> &tokens);
+
+private:
+    struct Slot{
+        std::string owner;          //负责该槽的节点，空表示未分配
+        std::string migratingTo;    //正在迁出到的节点
+        std::string importingFrom;  //正在从该节点迁入
+    };
+
+    std::string setSlot(const std::vector<std::string> &tokens);
+    std::string slotsReply() const;
+    void serveBus();    //集群总线的服务线程
+    std::string handleBus(const std::string &request);
+    void migrate(int slot, std::string target);  //迁移线程
+    std::string busCall(const std::string &address, const std::string &request);
+    void apply(const std::string &commandLine);
+    static bool parseSlot(const std::string &str, int &slot);
+    static std::string busEndpoint(const std::string &address);
+
+private:
+    int port;
+    std::mutex &dataMutex;
+    std::string myself;     //本节点的地址 host:port
+    bool clusterEnabled = false;
+    std::vector<Slot> slots;
+    std::set<std::string> inFlightKeys;     //已经发给目标节点、还没有收到确认的键
+    zmq::context_t context{1};
+    ParserFlyweightFactory factory;     //执行迁入的命令
+};
+
+#endif
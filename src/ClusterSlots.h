@@ -0,0 +1,86 @@
+#ifndef CLUSTER_SLOTS_H
+#define CLUSTER_SLOTS_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstdlib>
+#include "global.h"
+
+#define CLUSTER_SLOTS 16384     //哈希槽个数
+
+
+/// @brief CRC16（XMODEM），与Redis集群使用的算法相同
+inline uint16_t clusterCrc16(const char *data, size_t len){
+    uint16_t crc = 0;
+    for(size_t i=0; i<len; i++){
+        crc ^= static_cast<uint16_t>(static_cast<unsigned char>(data[i])) << 8;
+        for(int j=0; j<8; j++){
+            crc = (crc & 0x8000) ? static_cast<uint16_t>((crc << 1) ^ 0x1021) : static_cast<uint16_t>(crc << 1);
+        }
+    }
+    return crc;
+}
+
+/// @brief 计算键所在的哈希槽
+/// 键中包含非空的 {tag} 时只对第一个tag计算，{user1}:name 和 {user1}:age 一定在同一个槽
+inline int keyHashSlot(const std::string &key){
+    size_t begin = key.find('{');
+    if(begin != std::string::npos){
+        size_t end = key.find('}', begin+1);
+        if(end != std::string::npos && end != begin+1){
+            return clusterCrc16(key.data() + begin + 1, end - begin - 1) & (CLUSTER_SLOTS - 1);
+        }
+    }
+    return clusterCrc16(key.data(), key.size()) & (CLUSTER_SLOTS - 1);
+}
+
+/// @brief 取出命令中的键，集群据此决定命令由哪个节点执行
+/// 不带键的命令（包括按区间、前缀操作的命令）返回空，由收到命令的节点在本地执行
+inline std::vector<std::string> commandKeys(const std::vector<std::string> &tokens){
+    std::vector<std::string> keys;
+    auto it = commandMaps.find(tokens.empty() ? "" : tokens[0]);
+    if(it == commandMaps.end() || tokens.size() < 2){
+        return keys;
+    }
+    switch(it->second){
+        case SELECT: case DBSIZE: case KEYS: case SCAN:
+        case KEYRANGE: case KEYCOUNT: case DELRANGE: case DELPREFIX:
+        case FLUSHDB: case FLUSHALL:
+            break;
+        case EXISTS: case DEL: case MGET: case UNLINK: case PFCOUNT: case PFMERGE:
+            keys.assign(tokens.begin()+1, tokens.end());
+            break;
+        case MSET:
+            for(size_t i=1; i<tokens.size(); i+=2){
+                keys.push_back(tokens[i]);
+            }
+            break;
+        case RENAME: case LMOVE: case BLMOVE:
+            keys.assign(tokens.begin()+1, tokens.begin() + std::min<size_t>(tokens.size(), 3));
+            break;
+        case BITOP:
+            //BITOP op destkey key [key ...]
+            keys.assign(tokens.begin()+2, tokens.end());
+            break;
+        case BLPOP: case BRPOP:
+            //最后一个参数是超时时间
+            keys.assign(tokens.begin()+1, tokens.end()-1);
+            break;
+        case FCALL: case FCALL_RO:{
+            //FCALL name numkeys key [key ...] arg [arg ...]，numkeys不合法时没有键，由解析器报错
+            char *end = nullptr;
+            long numKeys = tokens.size() < 3 ? -1 : std::strtol(tokens[2].c_str(), &end, 10);
+            if(numKeys >= 0 && *end == '\0' && !tokens[2].empty() && numKeys <= static_cast<long>(tokens.size()) - 3){
+                keys.assign(tokens.begin()+3, tokens.begin()+3+numKeys);
+            }
+            break;
+        }
+        default:
+            keys.push_back(tokens[1]);
+            break;
+    }
+    return keys;
+}
+
+#endif
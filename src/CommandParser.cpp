@@ -1,5 +1,6 @@
 #include <stdexcept>
 #include "CommandParser.h"
+#include "Procedures.h"
 
 
 std::shared_ptr<RedisHelper> CommandParser::redisHelper = std::make_shared<RedisHelper>();
@@ -15,4 +16,886 @@ std::string SelectParser::parse(std::vector<std::string> &tokens){
         return tokens[1] + " is not a numeric type"; //返回错误信息
     }
     return redisHelper->select(index); //调用RedisHelper的select方法
-}
\ No newline at end of file
+}
+
+std::string LPushParser::parse(std::vector<std::string> &tokens){
+    if(tokens.size() < 3){
+        return "wrong number of arguments for LPUSH.";
+    }
+    std::string res;
+    for(size_t i=2; i<tokens.size(); i++){
+        res = redisHelper->lpush(tokens[1], tokens[i]);
+    }
+    return res;
+}
+
+std::string RPushParser::parse(std::vector<std::string> &tokens){
+    if(tokens.size() < 3){
+        return "wrong number of arguments for RPUSH.";
+    }
+    std::string res;
+    for(size_t i=2; i<tokens.size(); i++){
+        res = redisHelper->rpush(tokens[1], tokens[i]);
+    }
+    return res;
+}
+
+std::string LPopParser::parse(std::vector<std::string> &tokens){
+    if(tokens.size() != 2){
+        return "wrong number of arguments for LPOP.";
+    }
+    return redisHelper->lpop(tokens[1]);
+}
+
+std::string RPopParser::parse(std::vector<std::string> &tokens){
+    if(tokens.size() != 2){
+        return "wrong number of arguments for RPOP.";
+    }
+    return redisHelper->rpop(tokens[1]);
+}
+
+std::string LRangeParser::parse(std::vector<std::string> &tokens){
+    if(tokens.size() != 4){
+        return "wrong number of arguments for LRANGE.";
+    }
+    return redisHelper->lrange(tokens[1], tokens[2], tokens[3]);
+}
+
+std::string HSetParser::parse(std::vector<std::string> &tokens){
+    if(tokens.size() < 4 || tokens.size() % 2 != 0){
+        return "wrong number of arguments for HSET.";
+    }
+    std::vector<std::string> fields(tokens.begin()+2, tokens.end());
+    return redisHelper->hset(tokens[1], fields);
+}
+
+std::string HGetParser::parse(std::vector<std::string> &tokens){
+    if(tokens.size() != 3){
+        return "wrong number of arguments for HGET.";
+    }
+    return redisHelper->hget(tokens[1], tokens[2]);
+}
+
+std::string HDelParser::parse(std::vector<std::string> &tokens){
+    if(tokens.size() < 3){
+        return "wrong number of arguments for HDEL.";
+    }
+    std::vector<std::string> fields(tokens.begin()+2, tokens.end());
+    return redisHelper->hdel(tokens[1], fields);
+}
+
+std::string HKeysParser::parse(std::vector<std::string> &tokens){
+    if(tokens.size() != 2){
+        return "wrong number of arguments for HKEYS.";
+    }
+    return redisHelper->hkeys(tokens[1]);
+}
+
+std::string HValsParser::parse(std::vector<std::string> &tokens){
+    if(tokens.size() != 2){
+        return "wrong number of arguments for HVALS.";
+    }
+    return redisHelper->hvals(tokens[1]);
+}
+
+std::string HGetAllParser::parse(std::vector<std::string> &tokens){
+    if(tokens.size() != 2){
+        return "wrong number of arguments for HGETALL.";
+    }
+    return redisHelper->hgetall(tokens[1]);
+}
+
+std::string HMGetParser::parse(std::vector<std::string> &tokens){
+    if(tokens.size() < 3){
+        return "wrong number of arguments for HMGET.";
+    }
+    std::vector<std::string> fields(tokens.begin()+2, tokens.end());
+    return redisHelper->hmget(tokens[1], fields);
+}
+
+std::string HIncrbyParser::parse(std::vector<std::string> &tokens){
+    if(tokens.size() != 4){
+        return "wrong number of arguments for HINCRBY.";
+    }
+    long long increment = 0;
+    try {
+        increment = std::stoll(tokens[3]);
+    } catch (std::exception const& e) {
+        return tokens[3] + " is not a numeric type";
+    }
+    return redisHelper->hincrby(tokens[1], tokens[2], increment);
+}
+
+std::string HLenParser::parse(std::vector<std::string> &tokens){
+    if(tokens.size() != 2){
+        return "wrong number of arguments for HLEN.";
+    }
+    return redisHelper->hlen(tokens[1]);
+}
+
+std::string ZAddParser::parse(std::vector<std::string> &tokens){
+    if(tokens.size() < 4 || tokens.size() % 2 != 0){
+        return "wrong number of arguments for ZADD.";
+    }
+    std::vector<std::string> items(tokens.begin()+2, tokens.end());
+    return redisHelper->zadd(tokens[1], items);
+}
+
+std::string ZRemParser::parse(std::vector<std::string> &tokens){
+    if(tokens.size() < 3){
+        return "wrong number of arguments for ZREM.";
+    }
+    std::vector<std::string> members(tokens.begin()+2, tokens.end());
+    return redisHelper->zrem(tokens[1], members);
+}
+
+std::string ZScoreParser::parse(std::vector<std::string> &tokens){
+    if(tokens.size() != 3){
+        return "wrong number of arguments for ZSCORE.";
+    }
+    return redisHelper->zscore(tokens[1], tokens[2]);
+}
+
+std::string ZIncrbyParser::parse(std::vector<std::string> &tokens){
+    if(tokens.size() != 4){
+        return "wrong number of arguments for ZINCRBY.";
+    }
+    double increment = 0;
+    try {
+        increment = std::stod(tokens[2]);
+    } catch (std::exception const& e) {
+        return tokens[2] + " is not a numeric type";
+    }
+    return redisHelper->zincrby(tokens[1], increment, tokens[3]);
+}
+
+std::string ZCardParser::parse(std::vector<std::string> &tokens){
+    if(tokens.size() != 2){
+        return "wrong number of arguments for ZCARD.";
+    }
+    return redisHelper->zcard(tokens[1]);
+}
+
+std::string ZRankParser::parse(std::vector<std::string> &tokens){
+    if(tokens.size() != 3){
+        return "wrong number of arguments for ZRANK.";
+    }
+    return redisHelper->zrank(tokens[1], tokens[2]);
+}
+
+std::string ZRevRankParser::parse(std::vector<std::string> &tokens){
+    if(tokens.size() != 3){
+        return "wrong number of arguments for ZREVRANK.";
+    }
+    return redisHelper->zrevrank(tokens[1], tokens[2]);
+}
+
+std::string ZRangeParser::parse(std::vector<std::string> &tokens){
+    if(tokens.size() != 4 && !(tokens.size() == 5 && tokens[4] == "withscores")){
+        return "wrong number of arguments for ZRANGE.";
+    }
+    long start = 0;
+    long end = 0;
+    try {
+        start = std::stol(tokens[2]);
+        end = std::stol(tokens[3]);
+    } catch (std::exception const& e) {
+        return "start or stop is not a numeric type";
+    }
+    return redisHelper->zrange(tokens[1], start, end, tokens.size() == 5);
+}
+
+std::string ZRevRangeParser::parse(std::vector<std::string> &tokens){
+    if(tokens.size() != 4 && !(tokens.size() == 5 && tokens[4] == "withscores")){
+        return "wrong number of arguments for ZREVRANGE.";
+    }
+    long start = 0;
+    long end = 0;
+    try {
+        start = std::stol(tokens[2]);
+        end = std::stol(tokens[3]);
+    } catch (std::exception const& e) {
+        return "start or stop is not a numeric type";
+    }
+    return redisHelper->zrevrange(tokens[1], start, end, tokens.size() == 5);
+}
+
+std::string ZRangeByScoreParser::parse(std::vector<std::string> &tokens){
+    if(tokens.size() < 4){
+        return "wrong number of arguments for ZRANGEBYSCORE.";
+    }
+    bool withScores = false;
+    long offset = 0;
+    long count = -1;
+    for(size_t i=4; i<tokens.size(); i++){
+        if(tokens[i] == "withscores"){
+            withScores = true;
+        }
+        else if(tokens[i] == "limit" && i+2 < tokens.size()){
+            try {
+                offset = std::stol(tokens[i+1]);
+                count = std::stol(tokens[i+2]);
+            } catch (std::exception const& e) {
+                return "offset or count is not a numeric type";
+            }
+            i += 2;
+        }
+        else{
+            return "syntax error in ZRANGEBYSCORE.";
+        }
+    }
+    return redisHelper->zrangebyscore(tokens[1], tokens[2], tokens[3], withScores, offset, count);
+}
+
+/// @brief 解析SCAN类命令的可选参数 [MATCH pattern] [COUNT count]
+/// @return 参数是否合法
+static bool parseScanOptions(std::vector<std::string> &tokens, size_t begin, std::string &pattern, int &count){
+    for(size_t i=begin; i<tokens.size(); i+=2){
+        if(i+1 >= tokens.size()){
+            return false;
+        }
+        if(tokens[i] == "match"){
+            pattern = tokens[i+1];
+        }
+        else if(tokens[i] == "count"){
+            try {
+                count = std::stoi(tokens[i+1]);
+            } catch (std::exception const& e) {
+                return false;
+            }
+        }
+        else{
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string ScanParser::parse(std::vector<std::string> &tokens){
+    if(tokens.size() < 2){
+        return "wrong number of arguments for SCAN.";
+    }
+    std::string pattern = "*";
+    int count = SCAN_DEFAULT_COUNT;
+    if(!parseScanOptions(tokens, 2, pattern, count)){
+        return "syntax error in SCAN.";
+    }
+    return redisHelper->scan(tokens[1], pattern, count);
+}
+
+std::string HScanParser::parse(std::vector<std::string> &tokens){
+    if(tokens.size() < 3){
+        return "wrong number of arguments for HSCAN.";
+    }
+    std::string pattern = "*";
+    int count = SCAN_DEFAULT_COUNT;
+    if(!parseScanOptions(tokens, 3, pattern, count)){
+        return "syntax error in HSCAN.";
+    }
+    return redisHelper->hscan(tokens[1], tokens[2], pattern, count);
+}
+
+std::string KeysParser::parse(std::vector<std::string> &tokens){
+    if(tokens.size() > 2){
+        return "wrong number of arguments for KEYS.";
+    }
+    if(tokens.size() == 1){
+        return redisHelper->keys();
+    }
+    return redisHelper->keys(tokens[1]);
+}
+
+std::string KeyRangeParser::parse(std::vector<std::string> &tokens){
+    if(tokens.size() != 3 && !(tokens.size() == 5 && tokens[3] == "limit")){
+        return "wrong number of arguments for KEYRANGE.";
+    }
+    long limit = -1;
+    if(tokens.size() == 5){
+        try {
+            limit = std::stol(tokens[4]);
+        } catch (std::exception const& e) {
+            return tokens[4] + " is not a numeric type";
+        }
+    }
+    return redisHelper->keyrange(tokens[1], tokens[2], limit);
+}
+
+std::string KeyCountParser::parse(std::vector<std::string> &tokens){
+    if(tokens.size() != 3){
+        return "wrong number of arguments for KEYCOUNT.";
+    }
+    return redisHelper->keycount(tokens[1], tokens[2]);
+}
+
+std::string DelRangeParser::parse(std::vector<std::string> &tokens){
+    if(tokens.size() != 3){
+        return "wrong number of arguments for DELRANGE.";
+    }
+    return redisHelper->delrange(tokens[1], tokens[2]);
+}
+
+std::string DelPrefixParser::parse(std::vector<std::string> &tokens){
+    if(tokens.size() != 2){
+        return "wrong number of arguments for DELPREFIX.";
+    }
+    return redisHelper->delprefix(tokens[1]);
+}
+
+std::string ExistsParser::parse(std::vector<std::string> &tokens){
+    if(tokens.size() < 2){
+        return "wrong number of arguments for EXISTS.";
+    }
+    std::vector<std::string> keys(tokens.begin()+1, tokens.end());
+    return redisHelper->exists(keys);
+}
+
+std::string DelParser::parse(std::vector<std::string> &tokens){
+    if(tokens.size() < 2){
+        return "wrong number of arguments for DEL.";
+    }
+    std::vector<std::string> keys(tokens.begin()+1, tokens.end());
+    return redisHelper->del(keys);
+}
+
+std::string MSetParser::parse(std::vector<std::string> &tokens){
+    if(tokens.size() < 3 || tokens.size() % 2 == 0){
+        return "wrong number of arguments for MSET.";
+    }
+    std::vector<std::string> items(tokens.begin()+1, tokens.end());
+    return redisHelper->mset(items);
+}
+
+std::string MGetParser::parse(std::vector<std::string> &tokens){
+    if(tokens.size() < 2){
+        return "wrong number of arguments for MGET.";
+    }
+    std::vector<std::string> keys(tokens.begin()+1, tokens.end());
+    return redisHelper->mget(keys);
+}
+
+std::string UnlinkParser::parse(std::vector<std::string> &tokens){
+    if(tokens.size() < 2){
+        return "wrong number of arguments for UNLINK.";
+    }
+    std::vector<std::string> keys(tokens.begin()+1, tokens.end());
+    return redisHelper->unlink(keys);
+}
+
+/// @brief 解析FLUSHDB/FLUSHALL的 [ASYNC|SYNC] 选项
+static bool parseFlushMode(std::vector<std::string> &tokens, bool &async){
+    async = false;
+    if(tokens.size() == 1){
+        return true;
+    }
+    if(tokens.size() == 2 && (tokens[1] == "async" || tokens[1] == "sync")){
+        async = tokens[1] == "async";
+        return true;
+    }
+    return false;
+}
+
+std::string FlushDBParser::parse(std::vector<std::string> &tokens){
+    bool async;
+    if(!parseFlushMode(tokens, async)){
+        return "wrong number of arguments for FLUSHDB.";
+    }
+    return redisHelper->flushdb(async);
+}
+
+std::string FlushAllParser::parse(std::vector<std::string> &tokens){
+    bool async;
+    if(!parseFlushMode(tokens, async)){
+        return "wrong number of arguments for FLUSHALL.";
+    }
+    return redisHelper->flushall(async);
+}
+
+static bool isListEnd(const std::string &where){
+    return where == "left" || where == "right";
+}
+
+/// @brief 检查阻塞命令的超时参数，单位为秒，可以是小数，0表示一直等待
+static std::string checkBlockTimeout(const std::string &timeout){
+    double seconds = 0;
+    try{
+        size_t pos = 0;
+        seconds = std::stod(timeout, &pos);
+        if(pos != timeout.size()){
+            return "(error) ERR timeout is not a float or out of range";
+        }
+    }
+    catch(const std::exception &e){
+        return "(error) ERR timeout is not a float or out of range";
+    }
+    if(seconds < 0){
+        return "(error) ERR timeout is negative";
+    }
+    return "";
+}
+
+std::string LMoveParser::parse(std::vector<std::string> &tokens){
+    if(tokens.size() != 5){
+        return "wrong number of arguments for LMOVE.";
+    }
+    if(!isListEnd(tokens[3]) || !isListEnd(tokens[4])){
+        return "(error) ERR syntax error";
+    }
+    return redisHelper->lmove(tokens[1], tokens[2], tokens[3], tokens[4]);
+}
+
+std::string BLPopParser::parse(std::vector<std::string> &tokens){
+    if(tokens.size() < 3){
+        return "wrong number of arguments for BLPOP.";
+    }
+    std::string error = checkBlockTimeout(tokens.back());
+    if(!error.empty()){
+        return error;
+    }
+    return redisHelper->bpop(std::vector<std::string>(tokens.begin()+1, tokens.end()-1), true);
+}
+
+std::string BRPopParser::parse(std::vector<std::string> &tokens){
+    if(tokens.size() < 3){
+        return "wrong number of arguments for BRPOP.";
+    }
+    std::string error = checkBlockTimeout(tokens.back());
+    if(!error.empty()){
+        return error;
+    }
+    return redisHelper->bpop(std::vector<std::string>(tokens.begin()+1, tokens.end()-1), false);
+}
+
+std::string BLMoveParser::parse(std::vector<std::string> &tokens){
+    if(tokens.size() != 6){
+        return "wrong number of arguments for BLMOVE.";
+    }
+    if(!isListEnd(tokens[3]) || !isListEnd(tokens[4])){
+        return "(error) ERR syntax error";
+    }
+    std::string error = checkBlockTimeout(tokens[5]);
+    if(!error.empty()){
+        return error;
+    }
+    return redisHelper->lmove(tokens[1], tokens[2], tokens[3], tokens[4]);
+}
+
+/// @brief 解析位的偏移量，范围与位图的最大长度相同
+static bool parseBitOffset(const std::string &token, uint64_t &offset){
+    try {
+        long long value = std::stoll(token);
+        if(value < 0 || static_cast<uint64_t>(value) >= BITMAP_MAX_BITS){
+            return false;
+        }
+        offset = value;
+    } catch (std::exception const& e) {
+        return false;
+    }
+    return true;
+}
+
+/// @brief 解析位的值，只能是0或1
+static bool parseBit(const std::string &token, int &bit){
+    if(token != "0" && token != "1"){
+        return false;
+    }
+    bit = token[0] - '0';
+    return true;
+}
+
+/// @brief 解析区间单位BYTE|BIT，默认按字节
+static bool parseBitUnit(const std::string &token, bool &bitUnit){
+    if(token != "byte" && token != "bit"){
+        return false;
+    }
+    bitUnit = token == "bit";
+    return true;
+}
+
+std::string SetBitParser::parse(std::vector<std::string> &tokens){
+    if(tokens.size() != 4){
+        return "wrong number of arguments for SETBIT.";
+    }
+    uint64_t offset = 0;
+    if(!parseBitOffset(tokens[2], offset)){
+        return "(error) ERR bit offset is not an integer or out of range";
+    }
+    int bit = 0;
+    if(!parseBit(tokens[3], bit)){
+        return "(error) ERR bit is not an integer or out of range";
+    }
+    return redisHelper->setbit(tokens[1], offset, bit);
+}
+
+std::string GetBitParser::parse(std::vector<std::string> &tokens){
+    if(tokens.size() != 3){
+        return "wrong number of arguments for GETBIT.";
+    }
+    uint64_t offset = 0;
+    if(!parseBitOffset(tokens[2], offset)){
+        return "(error) ERR bit offset is not an integer or out of range";
+    }
+    return redisHelper->getbit(tokens[1], offset);
+}
+
+std::string BitCountParser::parse(std::vector<std::string> &tokens){
+    if(tokens.size() != 2 && tokens.size() != 4 && tokens.size() != 5){
+        return "wrong number of arguments for BITCOUNT.";
+    }
+    if(tokens.size() == 2){
+        return redisHelper->bitcount(tokens[1]);
+    }
+    long start = 0, end = 0;
+    try {
+        start = std::stol(tokens[2]);
+        end = std::stol(tokens[3]);
+    } catch (std::exception const& e) {
+        return "start or end is not a numeric type";
+    }
+    bool bitUnit = false;
+    if(tokens.size() == 5 && !parseBitUnit(tokens[4], bitUnit)){
+        return "(error) ERR syntax error";
+    }
+    return redisHelper->bitcount(tokens[1], start, end, bitUnit);
+}
+
+std::string BitPosParser::parse(std::vector<std::string> &tokens){
+    if(tokens.size() < 3 || tokens.size() > 6){
+        return "wrong number of arguments for BITPOS.";
+    }
+    int bit = 0;
+    if(!parseBit(tokens[2], bit)){
+        return "(error) ERR The bit argument must be 1 or 0.";
+    }
+    long start = 0, end = -1;
+    try {
+        if(tokens.size() >= 4){
+            start = std::stol(tokens[3]);
+        }
+        if(tokens.size() >= 5){
+            end = std::stol(tokens[4]);
+        }
+    } catch (std::exception const& e) {
+        return "start or end is not a numeric type";
+    }
+    bool bitUnit = false;
+    if(tokens.size() == 6 && !parseBitUnit(tokens[5], bitUnit)){
+        return "(error) ERR syntax error";
+    }
+    return redisHelper->bitpos(tokens[1], bit, start, end, tokens.size() >= 5, bitUnit);
+}
+
+std::string BitOpParser::parse(std::vector<std::string> &tokens){
+    if(tokens.size() < 4){
+        return "wrong number of arguments for BITOP.";
+    }
+    static const std::unordered_map<std::string, BitmapOp> ops = {
+        {"and", BITMAP_AND}, {"or", BITMAP_OR}, {"xor", BITMAP_XOR}, {"not", BITMAP_NOT}
+    };
+    auto it = ops.find(tokens[1]);
+    if(it == ops.end()){
+        return "(error) ERR syntax error";
+    }
+    if(it->second == BITMAP_NOT && tokens.size() != 4){
+        return "(error) ERR BITOP NOT must be called with a single source key.";
+    }
+    return redisHelper->bitop(it->second, tokens[2], std::vector<std::string>(tokens.begin()+3, tokens.end()));
+}
+
+std::string PfAddParser::parse(std::vector<std::string> &tokens){
+    if(tokens.size() < 2){
+        return "wrong number of arguments for PFADD.";
+    }
+    return redisHelper->pfadd(tokens[1], std::vector<std::string>(tokens.begin()+2, tokens.end()));
+}
+
+std::string PfCountParser::parse(std::vector<std::string> &tokens){
+    if(tokens.size() < 2){
+        return "wrong number of arguments for PFCOUNT.";
+    }
+    return redisHelper->pfcount(std::vector<std::string>(tokens.begin()+1, tokens.end()));
+}
+
+std::string PfMergeParser::parse(std::vector<std::string> &tokens){
+    if(tokens.size() < 2){
+        return "wrong number of arguments for PFMERGE.";
+    }
+    return redisHelper->pfmerge(tokens[1], std::vector<std::string>(tokens.begin()+2, tokens.end()));
+}
+
+std::string RestoreParser::parse(std::vector<std::string> &tokens){
+    if(tokens.size() != 4){
+        return "wrong number of arguments for RESTORE.";
+    }
+    return redisHelper->restore(tokens[1], tokens[2], tokens[3]);
+}
+
+/// @brief 解析过滤器的容量，必须是正整数
+static bool parseCapacity(const std::string &token, uint64_t &capacity){
+    try {
+        long long value = std::stoll(token);
+        if(value <= 0){
+            return false;
+        }
+        capacity = value;
+    } catch (std::exception const& e) {
+        return false;
+    }
+    return true;
+}
+
+std::string BfReserveParser::parse(std::vector<std::string> &tokens){
+    if(tokens.size() != 4){
+        return "wrong number of arguments for BF.RESERVE.";
+    }
+    double errorRate = 0;
+    try {
+        errorRate = std::stod(tokens[2]);
+    } catch (std::exception const& e) {
+        return "(error) ERR bad error rate";
+    }
+    if(!(errorRate > 0 && errorRate < 1)){
+        return "(error) ERR (0 < error rate range < 1)";
+    }
+    uint64_t capacity = 0;
+    if(!parseCapacity(tokens[3], capacity)){
+        return "(error) ERR (capacity should be larger than 0)";
+    }
+    return redisHelper->bfreserve(tokens[1], errorRate, capacity);
+}
+
+std::string BfAddParser::parse(std::vector<std::string> &tokens){
+    if(tokens.size() != 3){
+        return "wrong number of arguments for BF.ADD.";
+    }
+    return redisHelper->bfadd(tokens[1], tokens[2]);
+}
+
+std::string BfMAddParser::parse(std::vector<std::string> &tokens){
+    if(tokens.size() < 3){
+        return "wrong number of arguments for BF.MADD.";
+    }
+    return redisHelper->bfmadd(tokens[1], std::vector<std::string>(tokens.begin()+2, tokens.end()));
+}
+
+std::string BfExistsParser::parse(std::vector<std::string> &tokens){
+    if(tokens.size() != 3){
+        return "wrong number of arguments for BF.EXISTS.";
+    }
+    return redisHelper->bfexists(tokens[1], tokens[2]);
+}
+
+std::string BfMExistsParser::parse(std::vector<std::string> &tokens){
+    if(tokens.size() < 3){
+        return "wrong number of arguments for BF.MEXISTS.";
+    }
+    return redisHelper->bfmexists(tokens[1], std::vector<std::string>(tokens.begin()+2, tokens.end()));
+}
+
+std::string CfReserveParser::parse(std::vector<std::string> &tokens){
+    if(tokens.size() != 3){
+        return "wrong number of arguments for CF.RESERVE.";
+    }
+    uint64_t capacity = 0;
+    if(!parseCapacity(tokens[2], capacity)){
+        return "(error) ERR (capacity should be larger than 0)";
+    }
+    return redisHelper->cfreserve(tokens[1], capacity);
+}
+
+std::string CfAddParser::parse(std::vector<std::string> &tokens){
+    if(tokens.size() != 3){
+        return "wrong number of arguments for CF.ADD.";
+    }
+    return redisHelper->cfadd(tokens[1], tokens[2]);
+}
+
+std::string CfAddNxParser::parse(std::vector<std::string> &tokens){
+    if(tokens.size() != 3){
+        return "wrong number of arguments for CF.ADDNX.";
+    }
+    return redisHelper->cfaddnx(tokens[1], tokens[2]);
+}
+
+std::string CfExistsParser::parse(std::vector<std::string> &tokens){
+    if(tokens.size() != 3){
+        return "wrong number of arguments for CF.EXISTS.";
+    }
+    return redisHelper->cfexists(tokens[1], tokens[2]);
+}
+
+std::string CfDelParser::parse(std::vector<std::string> &tokens){
+    if(tokens.size() != 3){
+        return "wrong number of arguments for CF.DEL.";
+    }
+    return redisHelper->cfdel(tokens[1], tokens[2]);
+}
+
+std::string SetParser::parse(std::vector<std::string> &tokens){
+    if(tokens.size() != 3 && tokens.size() != 4){
+        return "wrong number of arguments for SET.";
+    }
+    SET_MODEL model = NONE;
+    if(tokens.size() == 4){
+        if(tokens[3] == "nx"){
+            model = NX;
+        }
+        else if(tokens[3] == "xx"){
+            model = XX;
+        }
+        else{
+            return "(error) ERR syntax error";
+        }
+    }
+    return redisHelper->set(tokens[1], RedisValue(tokens[2]), model);
+}
+
+std::string GetParser::parse(std::vector<std::string> &tokens){
+    if(tokens.size() != 2){
+        return "wrong number of arguments for GET.";
+    }
+    return redisHelper->get(tokens[1]);
+}
+
+std::string StrlenParser::parse(std::vector<std::string> &tokens){
+    if(tokens.size() != 2){
+        return "wrong number of arguments for STRLEN.";
+    }
+    return redisHelper->strlen(tokens[1]);
+}
+
+std::string AppendParser::parse(std::vector<std::string> &tokens){
+    if(tokens.size() != 3){
+        return "wrong number of arguments for APPEND.";
+    }
+    return redisHelper->append(tokens[1], tokens[2]);
+}
+
+std::string SetnxParser::parse(std::vector<std::string> &tokens){
+    if(tokens.size() != 3){
+        return "wrong number of arguments for SETNX.";
+    }
+    return redisHelper->setnx(tokens[1], RedisValue(tokens[2]));
+}
+
+//键不会过期，不能假装设置成功
+std::string SetexParser::parse(std::vector<std::string> &tokens){
+    if(tokens.size() != 4){
+        return "wrong number of arguments for SETEX.";
+    }
+    return "(error) ERR SETEX is not supported, keys never expire";
+}
+
+std::string DBSizeParser::parse(std::vector<std::string> &tokens){
+    if(tokens.size() != 1){
+        return "wrong number of arguments for DBSIZE.";
+    }
+    return redisHelper->dbsize();
+}
+
+std::string RenameParser::parse(std::vector<std::string> &tokens){
+    if(tokens.size() != 3){
+        return "wrong number of arguments for RENAME.";
+    }
+    return redisHelper->rename(tokens[1], tokens[2]);
+}
+
+/// @brief 解析整数增量，整个参数都必须是数字
+static bool parseIncrement(const std::string &str, long long &increment){
+    try {
+        size_t pos = 0;
+        increment = std::stoll(str, &pos);
+        return pos == str.size();
+    } catch (std::exception const& e) {
+        return false;
+    }
+}
+
+std::string IncrParser::parse(std::vector<std::string> &tokens){
+    if(tokens.size() != 2){
+        return "wrong number of arguments for INCR.";
+    }
+    return redisHelper->incr(tokens[1]);
+}
+
+std::string IncrbyParser::parse(std::vector<std::string> &tokens){
+    if(tokens.size() != 3){
+        return "wrong number of arguments for INCRBY.";
+    }
+    long long increment = 0;
+    if(!parseIncrement(tokens[2], increment)){
+        return "(error) ERR value is not an integer or out of range";
+    }
+    return redisHelper->incrby(tokens[1], increment);
+}
+
+std::string IncrbyfloatParser::parse(std::vector<std::string> &tokens){
+    if(tokens.size() != 3){
+        return "wrong number of arguments for INCRBYFLOAT.";
+    }
+    double increment = 0;
+    try {
+        size_t pos = 0;
+        increment = std::stod(tokens[2], &pos);
+        if(pos != tokens[2].size()){
+            return "(error) ERR value is not a valid float";
+        }
+    } catch (std::exception const& e) {
+        return "(error) ERR value is not a valid float";
+    }
+    return redisHelper->incrbyfloat(tokens[1], increment);
+}
+
+std::string DecrParser::parse(std::vector<std::string> &tokens){
+    if(tokens.size() != 2){
+        return "wrong number of arguments for DECR.";
+    }
+    return redisHelper->decr(tokens[1]);
+}
+
+std::string DecrbyParser::parse(std::vector<std::string> &tokens){
+    if(tokens.size() != 3){
+        return "wrong number of arguments for DECRBY.";
+    }
+    long long increment = 0;
+    if(!parseIncrement(tokens[2], increment)){
+        return "(error) ERR value is not an integer or out of range";
+    }
+    return redisHelper->decrby(tokens[1], increment);
+}
+
+/// @brief 解析FCALL/FCALL_RO的参数：name numkeys key [key ...] arg [arg ...]
+static std::string parseFCall(std::vector<std::string> &tokens, bool readOnly){
+    long long numKeys = 0;
+    try {
+        size_t pos = 0;
+        numKeys = std::stoll(tokens[2], &pos);
+        if(pos != tokens[2].size()){
+            return "(error) ERR value is not an integer or out of range";
+        }
+    } catch (std::exception const& e) {
+        return "(error) ERR value is not an integer or out of range";
+    }
+    if(numKeys < 0){
+        return "(error) ERR Number of keys can't be negative";
+    }
+    if(numKeys > static_cast<long long>(tokens.size()) - 3){
+        return "(error) ERR Number of keys can't be greater than number of args";
+    }
+    std::vector<std::string> keys(tokens.begin()+3, tokens.begin()+3+numKeys);
+    std::vector<std::string> args(tokens.begin()+3+numKeys, tokens.end());
+    return Procedures::getInstance().call(tokens[1], keys, args, readOnly);
+}
+
+std::string FCallParser::parse(std::vector<std::string> &tokens){
+    if(tokens.size() < 3){
+        return "wrong number of arguments for FCALL.";
+    }
+    return parseFCall(tokens, false);
+}
+
+std::string FCallRoParser::parse(std::vector<std::string> &tokens){
+    if(tokens.size() < 3){
+        return "wrong number of arguments for FCALL_RO.";
+    }
+    return parseFCall(tokens, true);
+}
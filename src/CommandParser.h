@@ -191,6 +191,294 @@ public:
     std::string parse(std::vector<std::string>& tokens) override;
 };
 
+// HGetAllParser
+class HGetAllParser : public CommandParser {
+public:
+    std::string parse(std::vector<std::string>& tokens) override;
+};
+
+// HMGetParser
+class HMGetParser : public CommandParser {
+public:
+    std::string parse(std::vector<std::string>& tokens) override;
+};
+
+// HIncrbyParser
+class HIncrbyParser : public CommandParser {
+public:
+    std::string parse(std::vector<std::string>& tokens) override;
+};
+
+// HLenParser
+class HLenParser : public CommandParser {
+public:
+    std::string parse(std::vector<std::string>& tokens) override;
+};
+
+// ScanParser
+class ScanParser : public CommandParser {
+public:
+    std::string parse(std::vector<std::string>& tokens) override;
+};
+
+// HScanParser
+class HScanParser : public CommandParser {
+public:
+    std::string parse(std::vector<std::string>& tokens) override;
+};
+
+// KeyRangeParser
+class KeyRangeParser : public CommandParser {
+public:
+    std::string parse(std::vector<std::string>& tokens) override;
+};
+
+// KeyCountParser
+class KeyCountParser : public CommandParser {
+public:
+    std::string parse(std::vector<std::string>& tokens) override;
+};
+
+// DelRangeParser
+class DelRangeParser : public CommandParser {
+public:
+    std::string parse(std::vector<std::string>& tokens) override;
+};
+
+// DelPrefixParser
+class DelPrefixParser : public CommandParser {
+public:
+    std::string parse(std::vector<std::string>& tokens) override;
+};
+
+// ZAddParser
+class ZAddParser : public CommandParser {
+public:
+    std::string parse(std::vector<std::string>& tokens) override;
+};
+
+// ZRemParser
+class ZRemParser : public CommandParser {
+public:
+    std::string parse(std::vector<std::string>& tokens) override;
+};
+
+// ZScoreParser
+class ZScoreParser : public CommandParser {
+public:
+    std::string parse(std::vector<std::string>& tokens) override;
+};
+
+// ZIncrbyParser
+class ZIncrbyParser : public CommandParser {
+public:
+    std::string parse(std::vector<std::string>& tokens) override;
+};
+
+// ZCardParser
+class ZCardParser : public CommandParser {
+public:
+    std::string parse(std::vector<std::string>& tokens) override;
+};
+
+// ZRankParser
+class ZRankParser : public CommandParser {
+public:
+    std::string parse(std::vector<std::string>& tokens) override;
+};
+
+// ZRevRankParser
+class ZRevRankParser : public CommandParser {
+public:
+    std::string parse(std::vector<std::string>& tokens) override;
+};
+
+// ZRangeParser
+class ZRangeParser : public CommandParser {
+public:
+    std::string parse(std::vector<std::string>& tokens) override;
+};
+
+// ZRevRangeParser
+class ZRevRangeParser : public CommandParser {
+public:
+    std::string parse(std::vector<std::string>& tokens) override;
+};
+
+// ZRangeByScoreParser
+class ZRangeByScoreParser : public CommandParser {
+public:
+    std::string parse(std::vector<std::string>& tokens) override;
+};
+
+// UnlinkParser
+class UnlinkParser : public CommandParser {
+public:
+    std::string parse(std::vector<std::string>& tokens) override;
+};
+
+// FlushDBParser
+class FlushDBParser : public CommandParser {
+public:
+    std::string parse(std::vector<std::string>& tokens) override;
+};
+
+// FlushAllParser
+class FlushAllParser : public CommandParser {
+public:
+    std::string parse(std::vector<std::string>& tokens) override;
+};
+
+// LMoveParser
+class LMoveParser : public CommandParser {
+public:
+    std::string parse(std::vector<std::string>& tokens) override;
+};
+
+// BLPopParser，只做非阻塞的部分，列表都为空时由RedisServer挂起客户端
+class BLPopParser : public CommandParser {
+public:
+    std::string parse(std::vector<std::string>& tokens) override;
+};
+
+// BRPopParser
+class BRPopParser : public CommandParser {
+public:
+    std::string parse(std::vector<std::string>& tokens) override;
+};
+
+// BLMoveParser
+class BLMoveParser : public CommandParser {
+public:
+    std::string parse(std::vector<std::string>& tokens) override;
+};
+
+// SetBitParser
+class SetBitParser : public CommandParser {
+public:
+    std::string parse(std::vector<std::string>& tokens) override;
+};
+
+// GetBitParser
+class GetBitParser : public CommandParser {
+public:
+    std::string parse(std::vector<std::string>& tokens) override;
+};
+
+// BitCountParser
+class BitCountParser : public CommandParser {
+public:
+    std::string parse(std::vector<std::string>& tokens) override;
+};
+
+// BitPosParser
+class BitPosParser : public CommandParser {
+public:
+    std::string parse(std::vector<std::string>& tokens) override;
+};
+
+// BitOpParser
+class BitOpParser : public CommandParser {
+public:
+    std::string parse(std::vector<std::string>& tokens) override;
+};
+
+// PfAddParser
+class PfAddParser : public CommandParser {
+public:
+    std::string parse(std::vector<std::string>& tokens) override;
+};
+
+// PfCountParser
+class PfCountParser : public CommandParser {
+public:
+    std::string parse(std::vector<std::string>& tokens) override;
+};
+
+// PfMergeParser
+class PfMergeParser : public CommandParser {
+public:
+    std::string parse(std::vector<std::string>& tokens) override;
+};
+
+// RestoreParser，重建snapshot/dump生成的值
+class RestoreParser : public CommandParser {
+public:
+    std::string parse(std::vector<std::string>& tokens) override;
+};
+
+// BfReserveParser
+class BfReserveParser : public CommandParser {
+public:
+    std::string parse(std::vector<std::string>& tokens) override;
+};
+
+// BfAddParser
+class BfAddParser : public CommandParser {
+public:
+    std::string parse(std::vector<std::string>& tokens) override;
+};
+
+// BfMAddParser
+class BfMAddParser : public CommandParser {
+public:
+    std::string parse(std::vector<std::string>& tokens) override;
+};
+
+// BfExistsParser
+class BfExistsParser : public CommandParser {
+public:
+    std::string parse(std::vector<std::string>& tokens) override;
+};
+
+// BfMExistsParser
+class BfMExistsParser : public CommandParser {
+public:
+    std::string parse(std::vector<std::string>& tokens) override;
+};
+
+// CfReserveParser
+class CfReserveParser : public CommandParser {
+public:
+    std::string parse(std::vector<std::string>& tokens) override;
+};
+
+// CfAddParser
+class CfAddParser : public CommandParser {
+public:
+    std::string parse(std::vector<std::string>& tokens) override;
+};
+
+// CfAddNxParser
+class CfAddNxParser : public CommandParser {
+public:
+    std::string parse(std::vector<std::string>& tokens) override;
+};
+
+// CfExistsParser
+class CfExistsParser : public CommandParser {
+public:
+    std::string parse(std::vector<std::string>& tokens) override;
+};
+
+// CfDelParser
+class CfDelParser : public CommandParser {
+public:
+    std::string parse(std::vector<std::string>& tokens) override;
+};
+
+// FCallParser
+class FCallParser : public CommandParser {
+public:
+    std::string parse(std::vector<std::string>& tokens) override;
+};
+
+// FCallRoParser
+class FCallRoParser : public CommandParser {
+public:
+    std::string parse(std::vector<std::string>& tokens) override;
+};
+
 
 
 #endif
\ No newline at end of file
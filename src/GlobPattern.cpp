@@ -0,0 +1,191 @@
+#include <cstring>
+#include <algorithm>
+#include "GlobPattern.h"
+
+GlobPattern::GlobPattern(const std::string &pattern){
+    compile(pattern);
+}
+
+/// @brief 把模式编译成段序列，并提取字面量前缀
+/// @param pattern glob模式
+void GlobPattern::compile(const std::string &pattern){
+    size_t i = 0;
+    while(i < pattern.size()){
+        char c = pattern[i];
+        if(c == '*'){
+            //连续的*等价于一个
+            if(tokens.empty() || tokens.back().type != Token::ANY_SEQ){
+                tokens.push_back(Token{Token::ANY_SEQ, "", {}});
+            }
+            i++;
+        }
+        else if(c == '?'){
+            tokens.push_back(Token{Token::ANY_CHAR, "", {}});
+            i++;
+        }
+        else if(c == '[' && pattern.find(']', i+1) != std::string::npos){
+            Token token{Token::CHAR_CLASS, "", {}};
+            i++;
+            bool negate = i < pattern.size() && pattern[i] == '^';
+            if(negate){
+                i++;
+            }
+            while(i < pattern.size() && pattern[i] != ']'){
+                if(pattern[i] == '\\' && i+1 < pattern.size()){
+                    token.charset.set(static_cast<unsigned char>(pattern[i+1]));
+                    i += 2;
+                }
+                else if(i+2 < pattern.size() && pattern[i+1] == '-' && pattern[i+2] != ']'){
+                    unsigned char low = std::min(pattern[i], pattern[i+2]);
+                    unsigned char high = std::max(pattern[i], pattern[i+2]);
+                    for(int ch=low; ch<=high; ch++){
+                        token.charset.set(ch);
+                    }
+                    i += 3;
+                }
+                else{
+                    token.charset.set(static_cast<unsigned char>(pattern[i]));
+                    i++;
+                }
+            }
+            i++; //跳过 ]
+            if(negate){
+                token.charset.flip();
+            }
+            tokens.push_back(token);
+        }
+        else{
+            if(c == '\\' && i+1 < pattern.size()){
+                i++;
+                c = pattern[i];
+            }
+            //合并相邻的普通字符
+            if(tokens.empty() || tokens.back().type != Token::LITERAL){
+                tokens.push_back(Token{Token::LITERAL, "", {}});
+            }
+            tokens.back().text.push_back(c);
+            i++;
+        }
+    }
+    if(!tokens.empty() && tokens.front().type == Token::LITERAL){
+        literalPrefix = tokens.front().text;
+        firstToken = 1;
+    }
+    literal = tokens.size() == firstToken;
+    anyRest = tokens.size() == firstToken + 1 && tokens.back().type == Token::ANY_SEQ;
+}
+
+bool GlobPattern::match(const std::string &str) const{
+    if(str.size() < literalPrefix.size() || memcmp(str.data(), literalPrefix.data(), literalPrefix.size()) != 0){
+        return false;
+    }
+    return matchSuffix(str);
+}
+
+bool GlobPattern::matchSuffix(const std::string &str) const{
+    if(anyRest){
+        return true;
+    }
+    return matchFrom(firstToken, str.data() + literalPrefix.size(), str.data() + str.size());
+}
+
+/// @brief 在[begin,end)中查找字面量，先用memchr定位首字符再比较剩余部分
+const char* GlobPattern::findLiteral(const char *begin, const char *end, const std::string &literal){
+    size_t len = literal.size();
+    while(begin + len <= end){
+        const char *p = static_cast<const char*>(memchr(begin, literal[0], end - begin - len + 1));
+        if(p == nullptr){
+            return nullptr;
+        }
+        if(memcmp(p + 1, literal.data() + 1, len - 1) == 0){
+            return p;
+        }
+        begin = p + 1;
+    }
+    return nullptr;
+}
+
+bool GlobPattern::matchToken(const Token &token, const char *&str, const char *end) const{
+    switch(token.type){
+        case Token::LITERAL:{
+            size_t len = token.text.size();
+            if(static_cast<size_t>(end - str) < len || memcmp(str, token.text.data(), len) != 0){
+                return false;
+            }
+            str += len;
+            return true;
+        }
+        case Token::ANY_CHAR:{
+            if(str == end){
+                return false;
+            }
+            str++;
+            return true;
+        }
+        case Token::CHAR_CLASS:{
+            if(str == end || !token.charset.test(static_cast<unsigned char>(*str))){
+                return false;
+            }
+            str++;
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+bool GlobPattern::advanceStar(size_t &tokenIndex, const char *&str, const char *&starPos, const char *end) const{
+    const Token &next = tokens[tokenIndex + 1];
+    if(next.type == Token::LITERAL){
+        const char *p = findLiteral(starPos, end, next.text);
+        if(p == nullptr){
+            return false;
+        }
+        starPos = p;
+        str = p + next.text.size();
+        tokenIndex += 2;
+        return true;
+    }
+    str = starPos;
+    tokenIndex += 1;
+    return true;
+}
+
+/// @brief 从第first个段开始匹配，遇到失败时只回溯到最近的一个*
+/// 最近的*可以吸收任意内容，所以不需要回溯更早的*
+bool GlobPattern::matchFrom(size_t first, const char *str, const char *end) const{
+    size_t t = first;
+    size_t starToken = tokens.size();
+    const char *starPos = nullptr;
+    while(true){
+        if(t < tokens.size() && tokens[t].type == Token::ANY_SEQ){
+            if(t + 1 == tokens.size()){
+                return true;
+            }
+            starToken = t;
+            starPos = str;
+            if(!advanceStar(t, str, starPos, end)){
+                return false;
+            }
+            continue;
+        }
+        if(t == tokens.size()){
+            if(str == end){
+                return true;
+            }
+        }
+        else if(matchToken(tokens[t], str, end)){
+            t++;
+            continue;
+        }
+        //匹配失败，让最近的*多吸收一个字符后重试
+        if(starToken == tokens.size() || starPos >= end){
+            return false;
+        }
+        starPos++;
+        t = starToken;
+        if(!advanceStar(t, str, starPos, end)){
+            return false;
+        }
+    }
+}
@@ -0,0 +1,53 @@
+#ifndef GLOB_PATTERN_H
+#define GLOB_PATTERN_H
+
+#include <string>
+#include <vector>
+#include <bitset>
+
+/*
+    预编译的glob模式，支持 * ? [abc] [^a-z] 和 \ 转义
+    编译时把模式拆成若干段：连续的普通字符合并为一个字面量段，字符集合编译为256位的位图
+    模式开头的字面量单独提取为前缀，键存放在有序跳表中，可以直接定位到前缀所在的区间，
+    区间外的键完全不需要比较
+    匹配时 * 后面紧跟的字面量段用memchr快速定位，不用逐个位置回溯
+*/
+class GlobPattern{
+public:
+    explicit GlobPattern(const std::string &pattern);
+
+    bool match(const std::string &str) const;       //完整匹配
+    bool matchSuffix(const std::string &str) const; //调用者已保证str以前缀开头，只匹配剩余部分
+    const std::string& prefix() const { return literalPrefix; }
+    bool matchAll() const { return anyRest; }       //前缀之后可以匹配任意内容，如 "user:*"
+    bool isLiteral() const { return literal; }      //模式中没有通配符
+
+private:
+    struct Token{
+        enum Type{
+            LITERAL,    //字面量
+            ANY_CHAR,   // ?
+            ANY_SEQ,    // *
+            CHAR_CLASS  // [...]
+        };
+        Type type;
+        std::string text;
+        std::bitset<256> charset;
+    };
+
+    void compile(const std::string &pattern);
+    bool matchFrom(size_t first, const char *str, const char *end) const;
+    bool matchToken(const Token &token, const char *&str, const char *end) const;
+    //处理 * ，如果后面是字面量，直接查找该字面量下一次出现的位置
+    bool advanceStar(size_t &tokenIndex, const char *&str, const char *&starPos, const char *end) const;
+    static const char* findLiteral(const char *begin, const char *end, const std::string &literal);
+
+private:
+    std::vector<Token> tokens;
+    std::string literalPrefix;
+    size_t firstToken = 0;  //前缀之后的第一个段
+    bool anyRest = false;
+    bool literal = false;
+};
+
+#endif
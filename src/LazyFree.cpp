@@ -0,0 +1,29 @@
+#include "LazyFree.h"
+
+/// @brief 释放对象，object应该是该对象的最后一个引用
+/// @param object 需要释放的对象
+/// @param effort 释放代价，小于LAZYFREE_THRESHOLD时直接在当前线程释放
+void LazyFree::release(std::shared_ptr<void> object, size_t effort){
+    if(object == nullptr || effort < LAZYFREE_THRESHOLD){
+        return;
+    }
+    (*pendingObjects)++;
+    if(rpc_scheduler::current() != nullptr){
+        rpc_spawn(releaseLater(std::move(object), pendingObjects));
+        return;
+    }
+    std::shared_ptr<std::atomic<size_t>> pending = pendingObjects;
+    rpc_worker_pool::instance().submit([object = std::move(object), pending]() mutable {
+        object.reset();
+        (*pending)--;
+    });
+}
+
+/// @brief 析构在后台线程进行，完成后回到run线程更新计数
+rpc_task<void> LazyFree::releaseLater(std::shared_ptr<void> object, std::shared_ptr<std::atomic<size_t>> pending){
+    rpc_offload destroy([object = std::move(object)]() mutable {
+        object.reset();
+    });
+    co_await destroy;
+    (*pending)--;
+}
@@ -0,0 +1,35 @@
+#ifndef LAZY_FREE_H
+#define LAZY_FREE_H
+
+#include <memory>
+#include <atomic>
+#include "RPC/coroutine.hpp"
+
+#define LAZYFREE_THRESHOLD 64   //释放代价（大致为需要释放的内存块个数）不小于该值时交给后台线程
+
+/*
+    后台释放
+    删除大列表、大哈希或者整个数据库时，析构需要逐个释放大量内存块，在请求线程上会阻塞所有客户端
+    调用者在锁内把值从跳表中摘下来，然后把最后一个引用交给这里，由rpc_offload的后台线程析构
+    在run线程上用rpc_offload挂起一个协程等待释放完成；复制线程、迁移线程没有调度器，直接提交给后台线程
+    代价小于阈值的对象直接在调用线程释放，入队和唤醒线程的开销比释放本身还大
+*/
+class LazyFree{
+public:
+    LazyFree() = default;
+    LazyFree(const LazyFree&) = delete;
+    LazyFree& operator=(const LazyFree&) = delete;
+
+    //释放对象，effort为释放代价的估计值
+    void release(std::shared_ptr<void> object, size_t effort);
+    size_t pending() const { return *pendingObjects; }  //等待后台释放的对象个数
+
+private:
+    static rpc_task<void> releaseLater(std::shared_ptr<void> object, std::shared_ptr<std::atomic<size_t>> pending);
+
+private:
+    //后台线程可能在LazyFree析构之后才释放完，计数和任务共享
+    std::shared_ptr<std::atomic<size_t>> pendingObjects = std::make_shared<std::atomic<size_t>>(0);
+};
+
+#endif
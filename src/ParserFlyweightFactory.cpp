@@ -134,6 +134,198 @@ std::shared_ptr<CommandParser> ParserFlyweightFactory::createCommandParser(std::
             parserMaps[command]=std::make_shared<HValsParser>();
             break;
         }
+        case HGETALL:{
+            parserMaps[command]=std::make_shared<HGetAllParser>();
+            break;
+        }
+        case HMGET:{
+            parserMaps[command]=std::make_shared<HMGetParser>();
+            break;
+        }
+        case HINCRBY:{
+            parserMaps[command]=std::make_shared<HIncrbyParser>();
+            break;
+        }
+        case HLEN:{
+            parserMaps[command]=std::make_shared<HLenParser>();
+            break;
+        }
+        case SCAN:{
+            parserMaps[command]=std::make_shared<ScanParser>();
+            break;
+        }
+        case HSCAN:{
+            parserMaps[command]=std::make_shared<HScanParser>();
+            break;
+        }
+        case KEYRANGE:{
+            parserMaps[command]=std::make_shared<KeyRangeParser>();
+            break;
+        }
+        case KEYCOUNT:{
+            parserMaps[command]=std::make_shared<KeyCountParser>();
+            break;
+        }
+        case DELRANGE:{
+            parserMaps[command]=std::make_shared<DelRangeParser>();
+            break;
+        }
+        case DELPREFIX:{
+            parserMaps[command]=std::make_shared<DelPrefixParser>();
+            break;
+        }
+        case UNLINK:{
+            parserMaps[command]=std::make_shared<UnlinkParser>();
+            break;
+        }
+        case FLUSHDB:{
+            parserMaps[command]=std::make_shared<FlushDBParser>();
+            break;
+        }
+        case FLUSHALL:{
+            parserMaps[command]=std::make_shared<FlushAllParser>();
+            break;
+        }
+        case LMOVE:{
+            parserMaps[command]=std::make_shared<LMoveParser>();
+            break;
+        }
+        case BLPOP:{
+            parserMaps[command]=std::make_shared<BLPopParser>();
+            break;
+        }
+        case BRPOP:{
+            parserMaps[command]=std::make_shared<BRPopParser>();
+            break;
+        }
+        case BLMOVE:{
+            parserMaps[command]=std::make_shared<BLMoveParser>();
+            break;
+        }
+        case ZADD:{
+            parserMaps[command]=std::make_shared<ZAddParser>();
+            break;
+        }
+        case ZREM:{
+            parserMaps[command]=std::make_shared<ZRemParser>();
+            break;
+        }
+        case ZSCORE:{
+            parserMaps[command]=std::make_shared<ZScoreParser>();
+            break;
+        }
+        case ZINCRBY:{
+            parserMaps[command]=std::make_shared<ZIncrbyParser>();
+            break;
+        }
+        case ZCARD:{
+            parserMaps[command]=std::make_shared<ZCardParser>();
+            break;
+        }
+        case ZRANK:{
+            parserMaps[command]=std::make_shared<ZRankParser>();
+            break;
+        }
+        case ZREVRANK:{
+            parserMaps[command]=std::make_shared<ZRevRankParser>();
+            break;
+        }
+        case ZRANGE:{
+            parserMaps[command]=std::make_shared<ZRangeParser>();
+            break;
+        }
+        case ZREVRANGE:{
+            parserMaps[command]=std::make_shared<ZRevRangeParser>();
+            break;
+        }
+        case ZRANGEBYSCORE:{
+            parserMaps[command]=std::make_shared<ZRangeByScoreParser>();
+            break;
+        }
+        case SETBIT:{
+            parserMaps[command]=std::make_shared<SetBitParser>();
+            break;
+        }
+        case GETBIT:{
+            parserMaps[command]=std::make_shared<GetBitParser>();
+            break;
+        }
+        case BITCOUNT:{
+            parserMaps[command]=std::make_shared<BitCountParser>();
+            break;
+        }
+        case BITPOS:{
+            parserMaps[command]=std::make_shared<BitPosParser>();
+            break;
+        }
+        case BITOP:{
+            parserMaps[command]=std::make_shared<BitOpParser>();
+            break;
+        }
+        case PFADD:{
+            parserMaps[command]=std::make_shared<PfAddParser>();
+            break;
+        }
+        case PFCOUNT:{
+            parserMaps[command]=std::make_shared<PfCountParser>();
+            break;
+        }
+        case PFMERGE:{
+            parserMaps[command]=std::make_shared<PfMergeParser>();
+            break;
+        }
+        case RESTORE:{
+            parserMaps[command]=std::make_shared<RestoreParser>();
+            break;
+        }
+        case BF_RESERVE:{
+            parserMaps[command]=std::make_shared<BfReserveParser>();
+            break;
+        }
+        case BF_ADD:{
+            parserMaps[command]=std::make_shared<BfAddParser>();
+            break;
+        }
+        case BF_MADD:{
+            parserMaps[command]=std::make_shared<BfMAddParser>();
+            break;
+        }
+        case BF_EXISTS:{
+            parserMaps[command]=std::make_shared<BfExistsParser>();
+            break;
+        }
+        case BF_MEXISTS:{
+            parserMaps[command]=std::make_shared<BfMExistsParser>();
+            break;
+        }
+        case CF_RESERVE:{
+            parserMaps[command]=std::make_shared<CfReserveParser>();
+            break;
+        }
+        case CF_ADD:{
+            parserMaps[command]=std::make_shared<CfAddParser>();
+            break;
+        }
+        case CF_ADDNX:{
+            parserMaps[command]=std::make_shared<CfAddNxParser>();
+            break;
+        }
+        case CF_EXISTS:{
+            parserMaps[command]=std::make_shared<CfExistsParser>();
+            break;
+        }
+        case CF_DEL:{
+            parserMaps[command]=std::make_shared<CfDelParser>();
+            break;
+        }
+        case FCALL:{
+            parserMaps[command]=std::make_shared<FCallParser>();
+            break;
+        }
+        case FCALL_RO:{
+            parserMaps[command]=std::make_shared<FCallRoParser>();
+            break;
+        }
         default:{
             return nullptr;
         }
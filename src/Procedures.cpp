@@ -0,0 +1,165 @@
+#include <stdexcept>
+#include <algorithm>
+#include "Procedures.h"
+#include "ClusterSlots.h"
+
+static bool parseInteger(const std::string &str, long long &value){
+    try{
+        size_t pos = 0;
+        value = std::stoll(str, &pos);
+        return pos == str.size();
+    }
+    catch(const std::exception &e){
+        return false;
+    }
+}
+
+ProcedureContext::ProcedureContext(ParserFlyweightFactory &factory, const std::vector<std::string> &keys, bool readOnly)
+: factory(factory), keys(keys), readOnly(readOnly) {}
+
+/// @brief 执行一条命令，只允许访问声明过的键
+/// 不带键的命令（KEYS、FLUSHDB、DELRANGE等）会访问未声明的键，也不允许
+std::string ProcedureContext::call(std::vector<std::string> tokens){
+    if(tokens.empty()){
+        throw std::runtime_error("empty command");
+    }
+    const std::string &command = tokens[0];
+    auto it = commandMaps.find(command);
+    if(it == commandMaps.end()){
+        throw std::runtime_error("unknown command '" + command + "'");
+    }
+    if(it->second == FCALL || it->second == FCALL_RO){
+        throw std::runtime_error("procedures can't call '" + command + "'");
+    }
+    if(readOnly && writeCommands.count(it->second) > 0){
+        throw std::runtime_error("write command '" + command + "' called from a read-only procedure");
+    }
+    std::vector<std::string> accessed = commandKeys(tokens);
+    if(accessed.empty()){
+        throw std::runtime_error("command '" + command + "' doesn't name its keys");
+    }
+    for(const std::string &key : accessed){
+        if(std::find(keys.begin(), keys.end(), key) == keys.end()){
+            throw std::runtime_error("procedure accessed undeclared key '" + key + "'");
+        }
+    }
+    std::shared_ptr<CommandParser> parser = factory.getParser(command);
+    if(parser == nullptr){
+        throw std::runtime_error("unknown command '" + command + "'");
+    }
+    return parser->parse(tokens);
+}
+
+bool ProcedureContext::bulkValue(const std::string &reply, std::string &value){
+    if(reply.size() < 2 || reply.front() != '"' || reply.back() != '"'){
+        return false;
+    }
+    value = reply.substr(1, reply.size() - 2);
+    return true;
+}
+
+bool ProcedureContext::integerValue(const std::string &reply, long long &value){
+    static const std::string prefix = "(integer) ";
+    if(reply.compare(0, prefix.size(), prefix) != 0){
+        return false;
+    }
+    try{
+        size_t pos = 0;
+        value = std::stoll(reply.substr(prefix.size()), &pos);
+        return pos == reply.size() - prefix.size();
+    }
+    catch(const std::exception &e){
+        return false;
+    }
+}
+
+Procedures& Procedures::getInstance(){
+    static Procedures procedures;
+    return procedures;
+}
+
+Procedures::Procedures(){
+    addBuiltins();
+}
+
+void Procedures::add(const std::string &name, Procedure procedure, bool readOnly){
+    Entry &entry = procedures[name];
+    entry.procedure = std::move(procedure);
+    entry.readOnly = readOnly;
+}
+
+/// @brief 执行过程，过程中违反限制时回复错误，已经执行的命令保留
+std::string Procedures::call(const std::string &name, const std::vector<std::string> &keys, const std::vector<std::string> &args, bool readOnly){
+    auto it = procedures.find(name);
+    if(it == procedures.end()){
+        return "(error) ERR Function not found";
+    }
+    if(readOnly && !it->second.readOnly){
+        return "(error) ERR Can not execute a function with write flag using fcall_ro.";
+    }
+    //只读的过程用FCALL调用时仍然只能执行读命令
+    ProcedureContext context(factory, keys, it->second.readOnly);
+    try{
+        return it->second.procedure(context, keys, args);
+    }
+    catch(const std::exception &e){
+        return "(error) ERR " + name + ": " + e.what();
+    }
+}
+
+/// @brief 内置的过程，也是写过程的示例
+void Procedures::addBuiltins(){
+    // CAS：FCALL cas 1 key expected value，字符串的值等于expected时改成value，回复是否修改
+    add("cas", [](ProcedureContext &context, const std::vector<std::string> &keys, const std::vector<std::string> &args){
+        if(keys.size() != 1 || args.size() != 2){
+            return std::string("(error) ERR wrong number of arguments for 'cas'");
+        }
+        std::string reply = context.call({"get", keys[0]});
+        std::string current;
+        if(!ProcedureContext::bulkValue(reply, current)){
+            return reply == NIL_MESSAGE ? std::string("(integer) 0") : reply;
+        }
+        if(current != args[0]){
+            return std::string("(integer) 0");
+        }
+        context.call({"set", keys[0], args[1]});
+        return std::string("(integer) 1");
+    });
+
+    // HTRANSFER：FCALL htransfer 2 src dst field amount，src的字段不小于amount时从src转移amount到dst的同名字段
+    add("htransfer", [](ProcedureContext &context, const std::vector<std::string> &keys, const std::vector<std::string> &args){
+        if(keys.size() != 2 || args.size() != 2){
+            return std::string("(error) ERR wrong number of arguments for 'htransfer'");
+        }
+        long long amount = 0;
+        if(!parseInteger(args[1], amount)){
+            return std::string("(error) ERR value is not an integer or out of range");
+        }
+        if(amount <= 0){
+            return std::string("(error) ERR amount must be a positive integer");
+        }
+        //先检查两个键的类型和余额，都满足才开始写，不会只改了一半
+        long long balance = 0;
+        for(int i=1; i>=0; i--){
+            std::string reply = context.call({"hget", keys[i], args[0]});
+            std::string value;
+            if(ProcedureContext::bulkValue(reply, value)){
+                if(!parseInteger(value, balance)){
+                    return std::string("(error) ERR hash value is not an integer");
+                }
+            }
+            else if(reply != NIL_MESSAGE){
+                return reply;
+            }
+            else{
+                balance = 0;
+            }
+        }
+        if(balance < amount){
+            return std::string("(integer) 0");
+        }
+        context.call({"hincrby", keys[0], args[0], std::to_string(-amount)});
+        context.call({"hincrby", keys[1], args[0], std::to_string(amount)});
+        return std::string("(integer) 1");
+    });
+}
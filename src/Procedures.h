@@ -0,0 +1,64 @@
+#ifndef PROCEDURES_H
+#define PROCEDURES_H
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <unordered_map>
+#include "ParserFlyweightFactory.h"
+
+class ProcedureContext;
+
+//过程的参数依次是执行上下文、声明的键、其余参数，返回值直接作为回复
+typedef std::function<std::string(ProcedureContext&, const std::vector<std::string>&, const std::vector<std::string>&)> Procedure;
+
+/*
+    服务端存储过程：编译进服务端的C++函数，一次请求完成跨多个键的读-改-写，代替客户端的先读后写重试循环
+    FCALL name numkeys key [key ...] arg [arg ...]：执行过程，和普通命令一样在dataMutex内执行，期间不会插入其他命令
+    FCALL_RO：只能调用注册为只读的过程，不是写命令，可以在从节点上执行
+    过程通过ProcedureContext::call执行命令，用到的键必须在numkeys中声明，集群重定向和阻塞客户端的唤醒都按声明的键处理
+    复制时传播的是FCALL命令本身，从节点重新执行同一个过程，所以过程的结果只能由数据和参数决定
+    和事务一样，过程中途出错时已经执行的写命令不会回滚
+    过程在服务开始处理请求之前注册，之后只读，执行时不需要额外加锁
+*/
+class ProcedureContext{
+public:
+    ProcedureContext(ParserFlyweightFactory &factory, const std::vector<std::string> &keys, bool readOnly);
+
+    //执行一条命令并返回回复，命令的键没有声明或者只读过程执行写命令时抛出异常，终止整个过程
+    std::string call(std::vector<std::string> tokens);
+
+    //从GET/HGET等的回复中取出值，回复是(nil)或者错误时返回false
+    static bool bulkValue(const std::string &reply, std::string &value);
+    //从"(integer) n"的回复中取出整数
+    static bool integerValue(const std::string &reply, long long &value);
+
+private:
+    ParserFlyweightFactory &factory;
+    const std::vector<std::string> &keys;
+    bool readOnly;
+};
+
+class Procedures{
+public:
+    static Procedures& getInstance();
+
+    //注册过程，同名的过程被替换；readOnly的过程才能用FCALL_RO调用
+    void add(const std::string &name, Procedure procedure, bool readOnly=false);
+    //执行过程，调用者需要持有dataMutex，readOnly表示通过FCALL_RO调用
+    std::string call(const std::string &name, const std::vector<std::string> &keys, const std::vector<std::string> &args, bool readOnly);
+
+private:
+    Procedures();
+    void addBuiltins();
+
+private:
+    struct Entry{
+        Procedure procedure;
+        bool readOnly = false;
+    };
+    std::unordered_map<std::string, Entry> procedures;
+    ParserFlyweightFactory factory;     //过程中的命令直接交给解析器执行
+};
+
+#endif
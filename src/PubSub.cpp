@@ -0,0 +1,333 @@
+#include <sstream>
+#include "PubSub.h"
+#include "GlobPattern.h"
+#include "global.h"
+
+#define PUBSUB_WAKE_ENDPOINT "inproc://pubsub-wake"
+
+PubSub::PubSub(int port) : port(port) {
+}
+
+/// @brief 在调用线程中绑定所有套接字再启动服务线程，inproc要求先bind后connect
+void PubSub::start(){
+    router.reset(new zmq::socket_t(context, ZMQ_ROUTER));
+    //发给不存在的订阅者时抛出异常，而不是静默丢弃，用来发现已经断开的订阅者
+    router->setsockopt(ZMQ_ROUTER_MANDATORY, 1);
+    router->bind("tcp://*:" + std::to_string(port + PUBSUB_PORT_OFFSET));
+    wakeReceiver.reset(new zmq::socket_t(context, ZMQ_PULL));
+    wakeReceiver->bind(PUBSUB_WAKE_ENDPOINT);
+    waker.reset(new zmq::socket_t(context, ZMQ_PUSH));
+    waker->connect(PUBSUB_WAKE_ENDPOINT);
+    std::thread(&PubSub::serve, this).detach();
+}
+
+static std::string quote(const std::string &str){
+    return "\"" + str + "\"";
+}
+
+/// @brief 把已经格式化的元素拼成多行回复
+std::string PubSub::formatMessage(const std::vector<std::string> &items){
+    std::string res;
+    for(size_t i=0; i<items.size(); i++){
+        if(i != 0){
+            res += "\n";
+        }
+        res += std::to_string(i+1) + ") " + items[i];
+    }
+    return res;
+}
+
+size_t PubSub::subscriptionCount(const Subscriber &subscriber){
+    return subscriber.channels.size() + subscriber.patterns.size();
+}
+
+/// @brief 零拷贝消息释放时调用，释放对缓冲区的引用
+void PubSub::releaseBuffer(void *, void *hint){
+    delete static_cast<Buffer*>(hint);
+}
+
+std::string PubSub::publish(const std::vector<std::string> &tokens){
+    if(tokens.size() != 3){
+        return "wrong number of arguments for PUBLISH.";
+    }
+    const std::string &channel = tokens[1];
+    const std::string &message = tokens[2];
+    size_t receivers = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        //enqueue可能断开订阅者并修改订阅关系，先取出所有接收者
+        std::vector<std::string> channelReceivers;
+        auto it = channels.find(channel);
+        if(it != channels.end()){
+            channelReceivers.assign(it->second.begin(), it->second.end());
+        }
+        std::vector<std::pair<std::string, std::string>> patternReceivers;
+        patterns.match(channel, [&](const std::string &pattern, const std::string &identity){
+            patternReceivers.emplace_back(pattern, identity);
+        });
+        if(!channelReceivers.empty()){
+            Buffer buffer = std::make_shared<const std::string>(formatMessage({quote("message"), quote(channel), quote(message)}));
+            for(const std::string &identity : channelReceivers){
+                enqueue(identity, buffer);
+            }
+        }
+        //同一个模式的订阅者是连续给出的，共用一个缓冲区
+        Buffer buffer;
+        const std::string *lastPattern = nullptr;
+        for(const auto &receiver : patternReceivers){
+            if(lastPattern == nullptr || *lastPattern != receiver.first){
+                buffer = std::make_shared<const std::string>(formatMessage({quote("pmessage"), quote(receiver.first), quote(channel), quote(message)}));
+                lastPattern = &receiver.first;
+            }
+            enqueue(receiver.second, buffer);
+        }
+        receivers = channelReceivers.size() + patternReceivers.size();
+    }
+    if(receivers > 0){
+        wakeUp();
+    }
+    return "(integer) " + std::to_string(receivers);
+}
+
+std::string PubSub::command(const std::vector<std::string> &tokens){
+    if(tokens.size() < 2){
+        return "wrong number of arguments for PUBSUB.";
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    if(tokens[1] == "channels" && tokens.size() <= 3){
+        GlobPattern matcher(tokens.size() == 3 ? tokens[2] : "*");
+        std::vector<std::string> items;
+        for(const auto &channel : channels){
+            if(matcher.match(channel.first)){
+                items.push_back(quote(channel.first));
+            }
+        }
+        return items.empty() ? EMPTY_LIST_MESSAGE : formatMessage(items);
+    }
+    if(tokens[1] == "numsub"){
+        std::vector<std::string> items;
+        for(size_t i=2; i<tokens.size(); i++){
+            auto it = channels.find(tokens[i]);
+            items.push_back(quote(tokens[i]));
+            items.push_back("(integer) " + std::to_string(it == channels.end() ? 0 : it->second.size()));
+        }
+        return items.empty() ? EMPTY_LIST_MESSAGE : formatMessage(items);
+    }
+    if(tokens[1] == "numpat" && tokens.size() == 2){
+        return "(integer) " + std::to_string(patterns.size());
+    }
+    return "(error) ERR unknown subcommand or wrong number of arguments for PUBSUB " + tokens[1];
+}
+
+std::string PubSub::info(){
+    std::lock_guard<std::mutex> lock(mutex);
+    return "pubsub_clients:" + std::to_string(subscribers.size()) + "\npubsub_channels:" + std::to_string(channels.size()) +
+        "\npubsub_patterns:" + std::to_string(patterns.size()) + "\n";
+}
+
+/// @brief 把消息放入订阅者的发送队列，调用者需要持有mutex
+/// 积压超过上限时取消所有订阅，队列换成一条通知，订阅者留在表中直到通知发出，
+/// 同一次发布中后面的消息看到dropped后直接跳过，不会重新建立订阅者
+void PubSub::enqueue(const std::string &identity, const Buffer &buffer){
+    Subscriber &subscriber = subscribers[identity];
+    if(subscriber.dropped){
+        return;
+    }
+    subscriber.pending.push_back(buffer);
+    subscriber.pendingBytes += buffer->size();
+    if(subscriber.pendingBytes > PUBSUB_OUTPUT_LIMIT){
+        static const Buffer notice = std::make_shared<const std::string>(PUBSUB_DROPPED_MESSAGE);
+        cancelSubscriptions(identity, subscriber);
+        subscriber.pending.clear();
+        subscriber.pending.push_back(notice);
+        subscriber.pendingBytes = notice->size();
+        subscriber.dropped = true;
+    }
+}
+
+/// @brief 取消订阅者的所有订阅，调用者需要持有mutex
+void PubSub::cancelSubscriptions(const std::string &identity, Subscriber &subscriber){
+    for(const std::string &channel : subscriber.channels){
+        auto channelIt = channels.find(channel);
+        channelIt->second.erase(identity);
+        if(channelIt->second.empty()){
+            channels.erase(channelIt);
+        }
+    }
+    for(const std::string &pattern : subscriber.patterns){
+        patterns.erase(pattern, identity);
+    }
+    subscriber.channels.clear();
+    subscriber.patterns.clear();
+}
+
+/// @brief 删除订阅者的所有订阅和积压的消息，调用者需要持有mutex
+void PubSub::dropSubscriber(const std::string &identity){
+    auto it = subscribers.find(identity);
+    if(it == subscribers.end()){
+        return;
+    }
+    cancelSubscriptions(identity, it->second);
+    subscribers.erase(it);
+}
+
+void PubSub::wakeUp(){
+    zmq::message_t message(0);
+    waker->send(message, ZMQ_DONTWAIT);
+}
+
+/// @brief 订阅端口的服务线程：处理订阅请求，把发送队列中的消息发出去
+/// 还有积压时定时重试，没有积压时一直等到有请求或者新消息
+void PubSub::serve(){
+    bool backlog = false;
+    while(true){
+        zmq::pollitem_t items[] = {
+            {static_cast<void*>(*router), 0, ZMQ_POLLIN, 0},
+            {static_cast<void*>(*wakeReceiver), 0, ZMQ_POLLIN, 0}
+        };
+        zmq::poll(items, 2, backlog ? PUBSUB_FLUSH_MS : -1);
+        if(items[1].revents & ZMQ_POLLIN){
+            zmq::message_t message;
+            while(wakeReceiver->recv(&message, ZMQ_DONTWAIT)){
+            }
+        }
+        if(items[0].revents & ZMQ_POLLIN){
+            //ROUTER收到的消息第一帧是订阅者的身份，第二帧是请求
+            zmq::message_t identity;
+            while(router->recv(&identity, ZMQ_DONTWAIT)){
+                std::string request;
+                zmq::message_t frame;
+                while(identity.more() && router->recv(frame)){
+                    request.assign(static_cast<char*>(frame.data()), frame.size());
+                    if(!frame.more()){
+                        break;
+                    }
+                }
+                handleRequest(std::string(static_cast<char*>(identity.data()), identity.size()), request);
+            }
+        }
+        backlog = flush(*router);
+    }
+}
+
+void PubSub::handleRequest(const std::string &identity, const std::string &request){
+    std::istringstream iss(request);
+    std::vector<std::string> tokens;
+    std::string token;
+    while(iss >> token){
+        tokens.push_back(token);
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    if(tokens.empty()){
+        return;
+    }
+    //被丢弃的订阅者发来新的请求，说明它还在，之后的回复排在通知后面
+    auto it = subscribers.find(identity);
+    if(it != subscribers.end()){
+        it->second.dropped = false;
+    }
+    const std::string &command = tokens[0];
+    if((command == "subscribe" || command == "psubscribe") && tokens.size() >= 2){
+        subscribe(identity, tokens);
+    }
+    else if(command == "unsubscribe" || command == "punsubscribe"){
+        unsubscribe(identity, tokens);
+    }
+    else if(command == "ping"){
+        enqueue(identity, std::make_shared<const std::string>("PONG"));
+    }
+    else{
+        enqueue(identity, std::make_shared<const std::string>(
+            "(error) ERR only (P)SUBSCRIBE / (P)UNSUBSCRIBE / PING are allowed in this context"));
+    }
+}
+
+/// @brief 每个频道或模式回复一条：类型、频道或模式、当前的订阅总数
+void PubSub::subscribe(const std::string &identity, const std::vector<std::string> &tokens){
+    bool pattern = tokens[0] == "psubscribe";
+    Subscriber &subscriber = subscribers[identity];
+    for(size_t i=1; i<tokens.size(); i++){
+        if(pattern){
+            if(subscriber.patterns.insert(tokens[i]).second){
+                patterns.insert(tokens[i], identity);
+            }
+        }
+        else if(subscriber.channels.insert(tokens[i]).second){
+            channels[tokens[i]].insert(identity);
+        }
+        enqueue(identity, std::make_shared<const std::string>(formatMessage({quote(tokens[0]), quote(tokens[i]),
+            "(integer) " + std::to_string(subscriptionCount(subscriber))})));
+    }
+}
+
+/// @brief 不带参数时退订所有频道（或所有模式）
+void PubSub::unsubscribe(const std::string &identity, const std::vector<std::string> &tokens){
+    bool pattern = tokens[0] == "punsubscribe";
+    Subscriber &subscriber = subscribers[identity];
+    std::set<std::string> &subscribed = pattern ? subscriber.patterns : subscriber.channels;
+    std::vector<std::string> targets(tokens.begin()+1, tokens.end());
+    if(targets.empty()){
+        targets.assign(subscribed.begin(), subscribed.end());
+    }
+    if(targets.empty()){
+        enqueue(identity, std::make_shared<const std::string>(formatMessage({quote(tokens[0]), NIL_MESSAGE, "(integer) 0"})));
+        return;
+    }
+    for(const std::string &target : targets){
+        if(subscribed.erase(target) > 0){
+            if(pattern){
+                patterns.erase(target, identity);
+            }
+            else{
+                auto it = channels.find(target);
+                it->second.erase(identity);
+                if(it->second.empty()){
+                    channels.erase(it);
+                }
+            }
+        }
+        enqueue(identity, std::make_shared<const std::string>(formatMessage({quote(tokens[0]), quote(target),
+            "(integer) " + std::to_string(subscriptionCount(subscriber))})));
+    }
+}
+
+/// @brief 尽量发送所有订阅者的积压消息，不阻塞
+/// @return 是否还有发不出去的消息
+bool PubSub::flush(zmq::socket_t &socket){
+    std::lock_guard<std::mutex> lock(mutex);
+    bool remaining = false;
+    std::vector<std::string> finished;
+    for(auto &entry : subscribers){
+        const std::string &identity = entry.first;
+        Subscriber &subscriber = entry.second;
+        bool gone = false;
+        while(!subscriber.pending.empty()){
+            const Buffer &buffer = subscriber.pending.front();
+            try{
+                zmq::message_t address(identity.data(), identity.size());
+                if(!socket.send(address, ZMQ_SNDMORE | ZMQ_DONTWAIT)){
+                    //对方的接收队列已满，下次再发
+                    remaining = true;
+                    break;
+                }
+                //同一条消息的所有帧一起入队，身份帧发出后正文帧不会失败
+                zmq::message_t payload(const_cast<char*>(buffer->data()), buffer->size(), releaseBuffer, new Buffer(buffer));
+                socket.send(payload, ZMQ_DONTWAIT);
+            }
+            catch(const zmq::error_t &e){
+                //订阅者已经断开
+                gone = true;
+                break;
+            }
+            subscriber.pendingBytes -= buffer->size();
+            subscriber.pending.pop_front();
+        }
+        if(gone || (subscriber.pending.empty() && subscriptionCount(subscriber) == 0)){
+            finished.push_back(identity);
+        }
+    }
+    for(const std::string &identity : finished){
+        dropSubscriber(identity);
+    }
+    return remaining;
+}
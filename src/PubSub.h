@@ -0,0 +1,81 @@
+#ifndef PUB_SUB_H
+#define PUB_SUB_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+#include <mutex>
+#include <thread>
+#include <memory>
+#include <zmq.hpp>
+#include "dataStructure/PatternTrie.h"
+
+#define PUBSUB_PORT_OFFSET 3                        //订阅端口（ROUTER）= 服务端口 + 3
+#define PUBSUB_OUTPUT_LIMIT (32 * 1024 * 1024)      //每个订阅者最多积压的消息字节数
+#define PUBSUB_FLUSH_MS 100                         //有积压时重试发送的间隔
+
+const std::string PUBSUB_DROPPED_MESSAGE = "(error) ERR output buffer limit reached, all subscriptions were cancelled";
+
+/*
+    发布订阅
+    请求端口是一问一答的，订阅者需要连接单独的订阅端口（DEALER），在上面发送
+    SUBSCRIBE/UNSUBSCRIBE/PSUBSCRIBE/PUNSUBSCRIBE/PING，之后持续接收推送的消息
+    PUBLISH 在请求端口上执行，回复收到消息的订阅者个数
+    一条消息只序列化一次：频道的订阅者共用一个缓冲区，每个模式的订阅者共用一个缓冲区，
+    发送时用零拷贝的zmq消息引用同一块内存，最后一个引用释放时缓冲区才释放
+    模式订阅存放在前缀树中，发布的代价与模式总数无关
+    每个订阅者有自己的发送队列，套接字发不出去（对方太慢）时消息留在队列中，
+    队列超过 PUBSUB_OUTPUT_LIMIT 时取消该订阅者的所有订阅并丢弃积压，不会让一个慢订阅者占满内存，
+    队列中只留下一条 PUBSUB_DROPPED_MESSAGE 通知订阅者，ROUTER不能主动断开连接，订阅者收到后可以重新订阅
+*/
+class PubSub{
+public:
+    explicit PubSub(int port);
+
+    void start();   //绑定订阅端口
+    //PUBLISH channel message，只在执行命令的线程调用
+    std::string publish(const std::vector<std::string> &tokens);
+    //PUBSUB CHANNELS [pattern] / PUBSUB NUMSUB [channel ...] / PUBSUB NUMPAT
+    std::string command(const std::vector<std::string> &tokens);
+    std::string info(); //INFO中的发布订阅统计
+
+private:
+    typedef std::shared_ptr<const std::string> Buffer;
+
+    struct Subscriber{
+        std::set<std::string> channels;
+        std::set<std::string> patterns;
+        std::deque<Buffer> pending;     //还没有发出去的消息
+        size_t pendingBytes = 0;
+        bool dropped = false;           //积压超过上限，只剩下通知，之后的消息不再入队，直到订阅者发来新的请求
+    };
+
+    void serve();   //订阅端口的服务线程
+    void handleRequest(const std::string &identity, const std::string &request);
+    void subscribe(const std::string &identity, const std::vector<std::string> &tokens);
+    void unsubscribe(const std::string &identity, const std::vector<std::string> &tokens);
+    void enqueue(const std::string &identity, const Buffer &buffer);
+    void cancelSubscriptions(const std::string &identity, Subscriber &subscriber);
+    void dropSubscriber(const std::string &identity);
+    bool flush(zmq::socket_t &socket);
+    void wakeUp();
+    static std::string formatMessage(const std::vector<std::string> &items);
+    static size_t subscriptionCount(const Subscriber &subscriber);
+    static void releaseBuffer(void *data, void *hint);
+
+private:
+    int port;
+    std::mutex mutex;   //保护订阅关系和发送队列，请求线程和订阅端口线程都会访问
+    std::unordered_map<std::string, std::unordered_set<std::string>> channels;  //频道 -> 订阅者
+    PatternTrie<std::string> patterns;                                          //模式 -> 订阅者
+    std::unordered_map<std::string, Subscriber> subscribers;                    //ROUTER分配的身份 -> 订阅者
+    zmq::context_t context{1};
+    std::unique_ptr<zmq::socket_t> router;          //订阅端口，只在服务线程使用
+    std::unique_ptr<zmq::socket_t> wakeReceiver;    //只在服务线程使用
+    std::unique_ptr<zmq::socket_t> waker;           //通知服务线程有新消息，只在执行命令的线程使用
+};
+
+#endif
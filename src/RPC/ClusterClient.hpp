@@ -0,0 +1,218 @@
+#ifndef CLUSTER_CLIENT_HPP
+#define CLUSTER_CLIENT_HPP
+
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <thread>
+#include <chrono>
+#include "buttonrpc.hpp"
+#include "../ClusterSlots.h"
+
+#define CLUSTER_CLIENT_MAX_REDIRECTS 5      //一条命令最多跟随的重定向次数
+#define CLUSTER_CLIENT_RETRY_MS 10          //TRYAGAIN之后等待的时间
+
+const std::string REDIS_COMMAND_RPC = "redis_command";    //服务端绑定的处理命令的函数名
+
+/*
+    集群客户端
+    缓存槽到节点的映射，按键所在的槽把命令直接发给负责的节点，每个节点只建立一个连接
+    收到 MOVED 时更新映射并重发；收到 ASK 时只对这一条命令先发送ASKING再发给目标节点，不修改映射
+    MGET/MSET/DEL/EXISTS/UNLINK 的键分布在多个槽时按槽拆分成多条命令，再合并结果
+*/
+class ClusterClient{
+public:
+    /// @param host 任意一个节点的地址，用于获取槽的分布
+    ClusterClient(const std::string &host, int port)
+    : seed(host + ":" + std::to_string(port)), slotOwners(CLUSTER_SLOTS) {
+        refreshSlots();
+    }
+
+    /// @brief 执行一条命令，返回服务端的回复
+    std::string execute(const std::string &commandLine){
+        std::vector<std::string> tokens = split(commandLine);
+        if(tokens.empty()){
+            return "";
+        }
+        std::vector<std::string> keys = commandKeys(tokens);
+        if(keys.empty()){
+            return route(-1, commandLine);
+        }
+        int slot = keyHashSlot(keys[0]);
+        bool splittable = tokens[0] == "mget" || tokens[0] == "mset" || tokens[0] == "del" || tokens[0] == "exists" || tokens[0] == "unlink";
+        for(const std::string &key : keys){
+            if(splittable && keyHashSlot(key) != slot){
+                return splitBySlot(tokens);
+            }
+        }
+        return route(slot, commandLine);
+    }
+
+    /// @brief 从种子节点重新获取槽的分布，每行为 序号) "start end host:port"
+    void refreshSlots(){
+        std::string reply = send(seed, "cluster slots");
+        std::istringstream lines(reply);
+        std::string line;
+        while(std::getline(lines, line)){
+            size_t begin = line.find('"');
+            size_t end = line.rfind('"');
+            if(begin == std::string::npos || end <= begin){
+                continue;
+            }
+            std::istringstream iss(line.substr(begin+1, end-begin-1));
+            int start = 0;
+            int last = 0;
+            std::string address;
+            if(iss >> start >> last >> address && start >= 0 && last < CLUSTER_SLOTS){
+                for(int slot=start; slot<=last; slot++){
+                    slotOwners[slot] = address;
+                }
+            }
+        }
+    }
+
+private:
+    static std::vector<std::string> split(const std::string &commandLine){
+        std::istringstream iss(commandLine);
+        std::vector<std::string> tokens;
+        std::string token;
+        while(iss >> token){
+            tokens.push_back(token);
+        }
+        return tokens;
+    }
+
+    static std::string join(const std::vector<std::string> &tokens){
+        std::string commandLine;
+        for(size_t i=0; i<tokens.size(); i++){
+            if(i != 0){
+                commandLine += " ";
+            }
+            commandLine += tokens[i];
+        }
+        return commandLine;
+    }
+
+    /// @brief 解析 "(error) MOVED slot host:port" 或 "(error) ASK slot host:port"
+    static bool parseRedirect(const std::string &reply, const std::string &type, int &slot, std::string &address){
+        const std::string prefix = "(error) " + type + " ";
+        if(reply.compare(0, prefix.size(), prefix) != 0){
+            return false;
+        }
+        std::istringstream iss(reply.substr(prefix.size()));
+        return static_cast<bool>(iss >> slot >> address) && slot >= 0 && slot < CLUSTER_SLOTS;
+    }
+
+    buttonrpc& connection(const std::string &address){
+        std::unique_ptr<buttonrpc> &client = connections[address];
+        if(client == nullptr){
+            size_t colon = address.rfind(':');
+            client.reset(new buttonrpc());
+            client->as_client(address.substr(0, colon), std::stoi(address.substr(colon+1)));
+        }
+        return *client;
+    }
+
+    std::string send(const std::string &address, const std::string &commandLine){
+        return connection(address).call<std::string>(REDIS_COMMAND_RPC, commandLine).val();
+    }
+
+    /// @brief 把命令发给负责该槽的节点，并跟随重定向
+    /// @param slot 命令的键所在的槽，不带键的命令为-1，发给种子节点
+    std::string route(int slot, const std::string &commandLine){
+        std::string address = (slot >= 0 && !slotOwners[slot].empty()) ? slotOwners[slot] : seed;
+        bool asking = false;
+        std::string reply;
+        for(int i=0; i<=CLUSTER_CLIENT_MAX_REDIRECTS; i++){
+            if(asking){
+                send(address, "asking");
+            }
+            reply = send(address, commandLine);
+            int redirectSlot = 0;
+            std::string target;
+            if(parseRedirect(reply, "MOVED", redirectSlot, target)){
+                slotOwners[redirectSlot] = target;
+                address = target;
+                asking = false;
+            }
+            else if(parseRedirect(reply, "ASK", redirectSlot, target)){
+                address = target;
+                asking = true;
+            }
+            else if(reply.compare(0, 16, "(error) TRYAGAIN") == 0){
+                std::this_thread::sleep_for(std::chrono::milliseconds(CLUSTER_CLIENT_RETRY_MS));
+            }
+            else{
+                break;
+            }
+        }
+        return reply;
+    }
+
+    /// @brief 多键命令按槽拆分
+    /// MGET按原来的顺序合并每个键的结果，MSET全部成功时回复OK，DEL/EXISTS/UNLINK把整数结果相加
+    std::string splitBySlot(const std::vector<std::string> &tokens){
+        const std::string &command = tokens[0];
+        size_t step = command == "mset" ? 2 : 1;
+        std::map<int, std::vector<std::string>> groups;         //槽 -> 命令参数
+        std::map<int, std::vector<size_t>> positions;           //槽 -> 键在原命令中的序号，MGET合并结果用
+        for(size_t i=1; i+step-1<tokens.size(); i+=step){
+            int slot = keyHashSlot(tokens[i]);
+            groups[slot].insert(groups[slot].end(), tokens.begin()+i, tokens.begin()+i+step);
+            positions[slot].push_back((i-1) / step);
+        }
+        std::vector<std::string> values((tokens.size()-1) / step);
+        long long total = 0;
+        for(auto &group : groups){
+            std::vector<std::string> subTokens{command};
+            subTokens.insert(subTokens.end(), group.second.begin(), group.second.end());
+            std::string reply = route(group.first, join(subTokens));
+            if(command == "mget"){
+                //每行为 序号) 值，去掉序号后放回原来的位置
+                std::istringstream lines(reply);
+                std::string line;
+                for(size_t index : positions[group.first]){
+                    if(!std::getline(lines, line)){
+                        return reply;
+                    }
+                    size_t pos = line.find(") ");
+                    values[index] = pos == std::string::npos ? line : line.substr(pos+2);
+                }
+            }
+            else if(command == "mset"){
+                if(reply != "OK"){
+                    return reply;
+                }
+            }
+            else{
+                if(reply.compare(0, 10, "(integer) ") != 0){
+                    return reply;
+                }
+                total += std::stoll(reply.substr(10));
+            }
+        }
+        if(command == "mset"){
+            return "OK";
+        }
+        if(command != "mget"){
+            return "(integer) " + std::to_string(total);
+        }
+        std::string res;
+        for(size_t i=0; i<values.size(); i++){
+            res += std::to_string(i+1) + ") " + values[i];
+            if(i != values.size()-1){
+                res += "\n";
+            }
+        }
+        return res;
+    }
+
+private:
+    std::string seed;                                               //种子节点 host:port
+    std::vector<std::string> slotOwners;                            //槽 -> 节点 host:port
+    std::map<std::string, std::unique_ptr<buttonrpc>> connections;  //每个节点一个连接
+};
+
+#endif
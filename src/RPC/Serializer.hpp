@@ -6,6 +6,10 @@
 #include <iostream>
 #include <algorithm>
 #include <cstring>
+#include <cstdint>
+#include <type_traits>
+
+#define SERIALIZER_LONG_STRING 0xFFFF  //字符串长度的2字节前缀为该值时，真实长度在后面的4个字节中
 
 using std::vector;
 
@@ -45,7 +49,7 @@ public:
     bool is_eof(){ return m_curpos >= size(); }
 
     //往末尾添加数据
-    bool input(const char* in, size_t len){ insert(end(), in, in+len); }
+    bool input(const char* in, size_t len){ insert(end(), in, in+len); return true; }
 
     //在缓冲区中查找特定的字节
     int findc(char c){
@@ -129,6 +133,17 @@ public:
         reset();
     }
 
+    /**
+     * @brief 移出字节流，不复制，之后序列化器为空
+     * @return 序列化好的数据
+    */
+    std::vector<char> take_data(){
+        std::vector<char> out;
+        out.swap(m_iodevice);
+        reset();
+        return out;
+    }
+
     /**
 	 * @brief 输出指定类型的数据
 	 * @tparam T 要输出的数据类型
@@ -143,7 +158,7 @@ public:
 	 * @param t 要输入的数据
 	 */
     template<typename T>
-    void input_type(T t);
+    void input_type(const T &t);
 
     /**
 	 * @brief 重载运算符>>，用于从序列化器中读取数据。
@@ -165,7 +180,7 @@ public:
 	 */
     template<typename T>
 	Serializer &operator << (const T &i){
-		input_type(i);
+		input_type<typename std::decay<const T>::type>(i);   //字符串字面量按const char*处理
 		return *this;
 	}
 
@@ -177,12 +192,12 @@ private:
 template<typename T>
 inline void Serializer::output_type(T &t){
     int len = sizeof(T);
-    char *d = new char[len];
+    char d[sizeof(T)];
     if(!m_iodevice.is_eof()){
-        memcpy(d,m_iodevice.current,len);
+        memcpy(d,m_iodevice.current(),len);
         m_iodevice.offset(len);
         byte_orser(d,len);
-        t = *reinterpret_cast<T*>(&d[0]);
+        memcpy(&t, d, len);
     }
 }
 
@@ -190,16 +205,18 @@ inline void Serializer::output_type(T &t){
 template<>
 inline void Serializer::output_type(std::string &in){
     //针对string类型，先取出长度，后根据长度存入到string中
-    int marklen = sizeof(uint16_t); //unsigned short类型
-    char *d = new char[marklen];
-    memcpy(d, m_iodevice.current(),marklen);
-    byte_orser(d,marklen);
-    m_iodevice.offset(marklen); //将字节流的位置向后移动两个字节
-    int len = *reinterpret_cast<uint16_t*>(&d[0]);  //取出字符串长度
-    delete[] d;
+    uint16_t shortLen = 0;
+    output_type(shortLen);  //unsigned short类型
+    size_t len = shortLen;
+    if(shortLen == SERIALIZER_LONG_STRING){
+        //长字符串的真实长度在后面的4个字节中
+        uint32_t longLen = 0;
+        output_type(longLen);
+        len = longLen;
+    }
     if(len==0) return;
 
-    in.insert(in.begin(), m_iodevice.current(), m_iodevice.current()+len);
+    in.insert(in.end(), m_iodevice.current(), m_iodevice.current()+len);
     m_iodevice.offset(len);
 }
 
@@ -208,34 +225,32 @@ inline void Serializer::output_type(std::string &in){
  * @brief 针对所有类型的数据，通用版本，进行输入
 */
 template<typename T>
-inline void Serializer::input_type(T t){
+inline void Serializer::input_type(const T &t){
     int len = sizeof(T);
-    char *d = new char[len];
-    const char *p = reinterpret_cast<const char*>(&t);
-    memcpy(d,p,len);
+    char d[sizeof(T)];
+    memcpy(d,&t,len);
     byte_orser(d,len);
     m_iodevice.input(d,len);
-    delete[] d;
 }
 
 /**
  * @brief 将string输入到字节流中。
+ * 长度小于SERIALIZER_LONG_STRING时用2个字节表示长度，否则2个字节写SERIALIZER_LONG_STRING，后面4个字节是真实长度，
+ * 短字符串的编码与原来相同
  * @param in 要输入的字符串。
  */
 template<>
-inline void Serializer::input_type(std::string in){
+inline void Serializer::input_type(const std::string &in){
     //先将字符串的长度输入到字节流中
-    uint16_t len = in.size();
-    char *p = reinterpret_cast<char*>(&len);
-    byte_orser(p,sizeof(uint16_t));
-    m_iodevice.input(p,sizeof(uint16_t));
-    if(len==0) return;
-
-    //再将字符串的数据输入到字节流中
-    char *d = new char[len];
-    memcpy(d,in.c_str(),len);
-    m_iodevice.input(d,len);
-    delete[] d;
+    if(in.size() < SERIALIZER_LONG_STRING){
+        input_type(static_cast<uint16_t>(in.size()));
+    }
+    else{
+        input_type(static_cast<uint16_t>(SERIALIZER_LONG_STRING));
+        input_type(static_cast<uint32_t>(in.size()));
+    }
+    //再将字符串的数据直接追加到字节流中
+    m_iodevice.input(in.data(), in.size());
 }
 
 
@@ -244,9 +259,9 @@ inline void Serializer::input_type(std::string in){
  * @param in The null-terminated string to input.
  */
 template<>
-inline void Serializer::input_type(const char* in)
+inline void Serializer::input_type(const char* const &in)
 {
-	input_type<std::string>(std::string(in)); //调用input_type<std::string>函数
+	input_type(std::string(in)); //调用input_type<std::string>函数
 }
 
 
@@ -5,8 +5,21 @@
 #include <map>
 #include <sstream>
 #include <functional>
+#include <vector>
+#include <chrono>
+#include <atomic>
+#include <mutex>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <unistd.h>
 #include <zmq.hpp>
 #include "Serializer.hpp"
+#include "coroutine.hpp"
+
+#define RPC_SERVE_BATCH 64  //连续处理这么多个请求后让出一次，让定时器、连接监控和其他协程有机会运行
 
 template <typename T>
 struct type_xx{
@@ -20,7 +33,8 @@ struct type_xx<void>{
 };
 
 
-class buttonrpc{
+//服务端本身是一个调度器，接收请求和监控连接都是它上面的协程
+class buttonrpc : public rpc_scheduler{
 public:
     //定义rpc类型，是服务端还是客户端
     enum rpc_role{
@@ -31,7 +45,8 @@ public:
     enum rpc_err_code{
         RPC_ERR_SUCCESS = 0,    //成功
         RPC_ERR_FUNCTION_NOT_BIND = 1,  //函数未绑定
-        RPC_ERR_RECV_TIMEOUT    //接受超时
+        RPC_ERR_RECV_TIMEOUT,   //接受超时
+        RPC_ERR_HANDLER_EXCEPTION   //挂起的请求在处理过程中抛出异常
     };
 
     template<typename T>
@@ -52,6 +67,7 @@ public:
         type val() { return val_; } //返回值
 
         void set_val(const type &val) { val_= val; }
+        void set_val(type &&val) { val_ = std::move(val); }   //大的返回值直接移动进来
         void set_code(code_type code) { code_ = code; }
         void set_msg(const msg_type &msg) { msg_ = msg; }
 
@@ -87,6 +103,35 @@ public:
     void set_timeout(uint32_t ms);
     void run();
 
+public:
+    //挂起的请求：ROUTER收到的路由帧，回复时原样带上
+    typedef std::vector<std::string> pending_t;
+
+    static buttonrpc* serving();    //当前线程正在run的服务端，不在run中时为nullptr
+    //在处理函数中调用，本次请求先不回复，之后用reply回复，run线程可以继续处理其他请求
+    pending_t defer();
+    //回复挂起的请求，只能在run线程调用
+    template<typename R>
+    void reply(const pending_t &request, const R &value);
+    //以错误码RPC_ERR_HANDLER_EXCEPTION回复挂起的请求，客户端从error_msg得到msg
+    void reply_error(const pending_t &request, const std::string &msg);
+    //正在处理的请求来自哪个连接（ROUTER分配的身份），只能在处理函数中调用
+    const std::string& current_identity() const;
+    //服务端当前的连接数和累计接受的连接数，只能在run线程读取
+    size_t connected_clients() const { return m_connected_clients; }
+    size_t total_connections() const { return m_total_connections; }
+
+    //服务端处理一个请求的各个阶段，设置了钩子时run线程在每个阶段结束时调用
+    enum rpc_stage{
+        RPC_STAGE_BEGIN,    //收到请求的第一帧，开始接收请求
+        RPC_STAGE_RECEIVED, //请求已经接收完
+        RPC_STAGE_CALLED,   //处理函数已经返回，返回值已经序列化
+        RPC_STAGE_SENT      //回复已经发出，挂起的请求没有这个阶段
+    };
+    typedef void (*stage_hook_t)(rpc_stage stage);
+    //所有服务端共用一个钩子，传nullptr关闭，关闭时每个请求只多一次原子读
+    static void set_stage_hook(stage_hook_t hook);
+
 public:
     //绑定普通函数
     template<typename F>
@@ -96,6 +141,9 @@ public:
     template<typename F, typename S>
     void bind(std::string name, F func, S *s);
 
+    //绑定直接处理请求字节流的函数，由它把value_t写进pr；调用了defer的函数可以不写
+    void bind_handler(std::string name, std::function<void(Serializer*, const char*, int)> handler);
+
     //client
     //客户端单参数调用
     template<typename R>
@@ -116,6 +164,16 @@ public:
     template<typename R, typename P1, typename P2, typename P3, typename P4, typename P5>
     value_t<R> call(std::string name, P1, P2, P3, P4, P5);
 
+    //流水线客户端：用DEALER连接，可以连续发出多个请求，再按发送的顺序接收回复
+    //服务端按收到的顺序处理同一个连接的请求，挂起的请求（阻塞命令）除外
+    void as_pipelined_client(std::string ip, int port);
+    //发出一个请求，不等待回复
+    template<typename P1>
+    void post(std::string name, P1 p1);
+    //接收最早发出的、还没有收到回复的请求的结果
+    template<typename R>
+    value_t<R> fetch();
+
 private:
     //服务端的函数调用，根据函数名字和对应的参数调用对应的函数
     Serializer* call_(std::string name, const char* data, int len);
@@ -132,6 +190,15 @@ private:
     template<typename F, typename S>
     void callproxy(F fun, S *s, Serializer *pr, const char* data, int len);
 
+    static buttonrpc*& serving_();
+    static std::atomic<stage_hook_t>& stage_hook_();
+    rpc_task<void> serve_requests();    //依次接收请求并调用处理函数，没有请求时挂起
+    rpc_task<void> serve_monitor();     //接收连接事件
+    void handle_request(zmq::message_t &data);
+    void handle_monitor_event(const zmq::message_t &event);
+    void send_reply(const pending_t &envelope, Serializer *r);
+    static void release_buffer(void *data, void *hint);
+
     //接受普通函数的统一接口函数的辅助函数，即接受普通函数的callproxy里调用callproxy_
     template<typename R>
     void callproxy_(R(*func)(), Serializer *pr, const char *data, int len){
@@ -167,12 +234,12 @@ private:
     //function不能包装类成员变量或函数，需要配合Bind,传入函数地址和类对象地址
     template<typename R, typename C, typename S>
     void callproxy_(R(C::*func)(), S *s, Serializer *pr, const char* data, int len){
-        callproxy_(std::functional<R()>(std::bind(func,s)), pr, data, len);
+        callproxy_(std::function<R()>(std::bind(func,s)), pr, data, len);
     }
 
     template<typename R, typename C, typename S, typename P1>
-    void callproxy_(R(C::*func(P1)), S *s, Serializer *pr, const char *data, int len){
-        callproxy_(std::function<R(P1)>(std::bind(func,s,std::placeholders::1)), pr, data, len);
+    void callproxy_(R(C::*func)(P1), S *s, Serializer *pr, const char *data, int len){
+        callproxy_(std::function<R(P1)>(std::bind(func,s,std::placeholders::_1)), pr, data, len);
     }
 
     template<typename R, typename C, typename S, typename P1, typename P2>
@@ -223,19 +290,28 @@ private:
     zmq::socket_t *m_socket; //套接字
     rpc_err_code m_error_code; //错误码
     int m_role;
+    pending_t m_envelope;   //正在处理的请求的路由帧
+    bool m_deferred = false;
+    zmq::socket_t *m_monitor = nullptr;    //接收服务端套接字的连接事件
+    size_t m_connected_clients = 0;
+    size_t m_total_connections = 0;
 };
 
-buttonrpc::buttonrpc() : m_context(1){
+inline buttonrpc::buttonrpc() : m_context(1){
     m_error_code = RPC_ERR_SUCCESS;
 }
 
-buttonrpc::~buttonrpc(){
+inline buttonrpc::~buttonrpc(){
+    if(m_monitor != nullptr){
+        m_monitor->close();
+        delete m_monitor;
+    }
     m_socket->close();
     delete m_socket;
     m_context.close();
 }
 
-void buttonrpc::as_client(std::string ip, int port){
+inline void buttonrpc::as_client(std::string ip, int port){
     m_role = RPC_CLIENT;
     m_socket = new zmq::socket_t(m_context, ZMQ_REQ);
     std::ostringstream os;
@@ -243,23 +319,38 @@ void buttonrpc::as_client(std::string ip, int port){
     m_socket->connect(os.str());
 }
 
-void buttonrpc::as_server(int port){
+//DEALER发送时要自己加上REQ的空分隔帧，服务端当作普通的REQ客户端处理
+inline void buttonrpc::as_pipelined_client(std::string ip, int port){
+    m_role = RPC_CLIENT;
+    m_socket = new zmq::socket_t(m_context, ZMQ_DEALER);
+    std::ostringstream os;
+    os<<"tcp://"<<ip<<":"<<port;
+    m_socket->connect(os.str());
+}
+
+//服务端使用ROUTER，可以先挂起一个请求去处理其他请求，客户端仍然是REQ
+inline void buttonrpc::as_server(int port){
     m_role = RPC_SERVER;
-    m_socket = new zmq::socket_t(m_context, ZMQ_REP);
+    m_socket = new zmq::socket_t(m_context, ZMQ_ROUTER);
     std::ostringstream os;
-    os<<"tcp://*"<<port;
+    os<<"tcp://*:"<<port;
     m_socket->bind(os.str());
+    //监控连接的建立和断开，ROUTER本身不会通知
+    std::string monitor_endpoint = "inproc://buttonrpc-monitor-" + std::to_string(port);
+    zmq_socket_monitor(static_cast<void*>(*m_socket), monitor_endpoint.c_str(), ZMQ_EVENT_ACCEPTED | ZMQ_EVENT_DISCONNECTED);
+    m_monitor = new zmq::socket_t(m_context, ZMQ_PAIR);
+    m_monitor->connect(monitor_endpoint);
 }
 
-void buttonrpc::send(zmq::message_t &data){
+inline void buttonrpc::send(zmq::message_t &data){
     m_socket->send(data);
 }
 
-void buttonrpc::recv(zmq::message_t &data){
+inline void buttonrpc::recv(zmq::message_t &data){
     m_socket->recv(data);
 }
 
-inline void buttonrpc::set_timeout(uint32_t ms)
+inline void buttonrpc::set_timeout([[maybe_unused]] uint32_t ms)
 {
 	// // only client can set
 	// if (m_role == RPC_CLIENT) {
@@ -267,29 +358,175 @@ inline void buttonrpc::set_timeout(uint32_t ms)
 	// }
 }
 
-void buttonrpc::run(){
-    if(m_role != RPC_CLIENT)
+//接收请求和监控连接的协程在调度器开始运行后启动，之后由调度器在套接字可读时恢复
+inline void buttonrpc::run(){
+    if(m_role != RPC_SERVER)
         return;
-    while(1){
-        zmq::message_t data;
-        recv(data);
-        StreamBuffer iodev(static_cast<char*>(data.data()), data.size());
-        Serializer ds(iodev);
-
-        std::string funname;
-        ds>>funname;    //读取函数名
-        //可以优化，使用智能指针
-        Serializer *r = call_(funname, ds.current(), ds.size()-funname.size());
-
-        zmq::message_t retmsg(r->size());
-        std::memcpy(retmsg.data(), r->data(), r->size());
+    serving_() = this;
+    schedule([this](){
+        rpc_spawn(serve_requests());
+        rpc_spawn(serve_monitor());
+    });
+    run_loop();
+}
+
+inline buttonrpc*& buttonrpc::serving_(){
+    static thread_local buttonrpc *server = nullptr;
+    return server;
+}
+
+inline buttonrpc* buttonrpc::serving(){
+    return serving_();
+}
+
+inline std::atomic<buttonrpc::stage_hook_t>& buttonrpc::stage_hook_(){
+    static std::atomic<stage_hook_t> hook{nullptr};
+    return hook;
+}
+
+inline void buttonrpc::set_stage_hook(stage_hook_t hook){
+    stage_hook_().store(hook, std::memory_order_relaxed);
+}
+
+//ROUTER收到的消息：客户端身份帧、REQ的空分隔帧、请求
+//同一个消息的各帧一起到达，只有第一帧可能需要等待
+inline rpc_task<void> buttonrpc::serve_requests(){
+    uint32_t served = 0;
+    while(true){
+        zmq::message_t frame;
+        co_await rpc_recv(*m_socket, frame);
+        stage_hook_t hook = stage_hook_().load(std::memory_order_relaxed);
+        if(hook){
+            hook(RPC_STAGE_BEGIN);
+        }
+        m_envelope.clear();
+        bool complete = true;
+        while(true){
+            if(!frame.more()){
+                complete = false;   //没有请求体，丢弃
+                break;
+            }
+            m_envelope.emplace_back(static_cast<char*>(frame.data()), frame.size());
+            if(frame.size() == 0){
+                break;
+            }
+            co_await rpc_recv(*m_socket, frame);
+        }
+        if(complete){
+            zmq::message_t data;
+            co_await rpc_recv(*m_socket, data);
+            handle_request(data);
+        }
+        if(++served % RPC_SERVE_BATCH == 0){
+            co_await rpc_sleep(0);
+        }
+    }
+}
+
+inline void buttonrpc::handle_request(zmq::message_t &data){
+    stage_hook_t hook = stage_hook_().load(std::memory_order_relaxed);
+    if(hook){
+        hook(RPC_STAGE_RECEIVED);
+    }
+    StreamBuffer iodev(static_cast<char*>(data.data()), data.size());
+    Serializer ds(iodev);
+
+    std::string funname;
+    ds>>funname;    //读取函数名
+    m_deferred = false;
+    //参数从函数名之后开始，长度要扣掉函数名的长度前缀，否则会读到缓冲区外
+    //可以优化，使用智能指针
+    Serializer *r = call_(funname, ds.current(), ds.size() - static_cast<int>(ds.current() - ds.data()));
+    if(hook){
+        hook(RPC_STAGE_CALLED);
+    }
+    if(!m_deferred){
+        send_reply(m_envelope, r);
+        if(hook){
+            hook(RPC_STAGE_SENT);
+        }
+    }
+    delete r;
+}
+
+//监控消息的第一帧是6字节：事件类型（2字节）和事件值，第二帧是对端地址
+inline rpc_task<void> buttonrpc::serve_monitor(){
+    while(true){
+        zmq::message_t event;
+        co_await rpc_recv(*m_monitor, event);
+        if(event.more()){
+            zmq::message_t address;
+            co_await rpc_recv(*m_monitor, address);
+        }
+        handle_monitor_event(event);
+    }
+}
+
+inline void buttonrpc::handle_monitor_event(const zmq::message_t &event){
+    if(event.size() < sizeof(uint16_t)){
+        return;
+    }
+    uint16_t type;
+    std::memcpy(&type, event.data(), sizeof(type));
+    if(type == ZMQ_EVENT_ACCEPTED){
+        m_connected_clients++;
+        m_total_connections++;
+    }
+    else if(type == ZMQ_EVENT_DISCONNECTED && m_connected_clients > 0){
+        m_connected_clients--;
+    }
+}
+
+//序列化好的回复直接交给zmq，发送完成后由zmq释放，不再复制一次
+inline void buttonrpc::send_reply(const pending_t &envelope, Serializer *r){
+    for(const std::string &part : envelope){
+        zmq::message_t frame(part.data(), part.size());
+        m_socket->send(frame, ZMQ_SNDMORE);
+    }
+    std::vector<char> *buffer = new std::vector<char>(r->take_data());
+    if(buffer->empty()){
+        delete buffer;
+        zmq::message_t retmsg(0);
         send(retmsg);
-        delete r;
+        return;
     }
+    zmq::message_t retmsg(buffer->data(), buffer->size(), release_buffer, buffer);
+    send(retmsg);
+}
+
+inline void buttonrpc::release_buffer(void *, void *hint){
+    delete static_cast<std::vector<char>*>(hint);
+}
+
+inline const std::string& buttonrpc::current_identity() const{
+    static const std::string none;
+    return m_envelope.empty() ? none : m_envelope.front();
+}
+
+inline buttonrpc::pending_t buttonrpc::defer(){
+    m_deferred = true;
+    return m_envelope;
+}
+
+template<typename R>
+inline void buttonrpc::reply(const pending_t &request, const R &value){
+    Serializer ds;
+    value_t<R> val;
+    val.set_code(RPC_ERR_SUCCESS);
+    val.set_val(value);
+    ds<<val;
+    send_reply(request, &ds);
+}
+
+inline void buttonrpc::reply_error(const pending_t &request, const std::string &msg){
+    Serializer ds;
+    ds<<value_t<int>::code_type(RPC_ERR_HANDLER_EXCEPTION);
+    ds<<value_t<int>::msg_type(msg);
+    send_reply(request, &ds);
 }
 
 //实现函数调用
-Serializer* buttonrpc::call_(std::string name, const char* data, int len){
+inline Serializer* buttonrpc::call_(std::string name, const char* data, int len){
     Serializer *ds = new Serializer();
     if(m_handlers.find(name) == m_handlers.end()){
         (*ds)<<value_t<int>::code_type(RPC_ERR_FUNCTION_NOT_BIND);
@@ -314,6 +551,10 @@ inline void buttonrpc::bind(std::string name, F func, S* s)
 	m_handlers[name] = std::bind(&buttonrpc::callproxy<F, S>, this, func, s, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3);
 }
 
+inline void buttonrpc::bind_handler(std::string name, std::function<void(Serializer*, const char*, int)> handler){
+    m_handlers[name] = std::move(handler);
+}
+
 template<typename F>
 inline void buttonrpc::callproxy(F fun, Serializer *pr, const char* data, int len){
     callproxy_(fun,pr,data,len);
@@ -324,7 +565,7 @@ inline void buttonrpc::callproxy(F fun, S *s, Serializer *pr, const char *data,
     callproxy_(fun, s, pr, data, len);
 }
 
-#pragma region 区分返回值
+//区分返回值
 template<typename R, typename F>
 typename std::enable_if<std::is_same<R,void>::value, typename type_xx<R>::type>::type call_helper(F f){
     f();
@@ -335,7 +576,6 @@ template<typename R, typename F>
 typename std::enable_if<!std::is_same<R,void>::value, typename type_xx<R>::type>::type call_helper(F f){
     return f();
 }
-#pragma endregion
 
 /**
  * @brief 重载callproxy_，具体绑定的函数调用的实现
@@ -351,13 +591,13 @@ void buttonrpc::callproxy_(std::function<R()>func, Serializer *pr, const char* d
 
     value_t<R> val;
     val.set_code(RPC_ERR_SUCCESS);
-    val.set_val(r);
+    val.set_val(std::move(r));
     (*pr)<<val;
 }
 
 template<typename R, typename P1>
 void buttonrpc::callproxy_(std::function<R(P1)> func, Serializer *pr, const char *data, int len){
-    Serializer* ds(StreamBuffer(data,len));
+    Serializer ds(StreamBuffer(data,len));
     P1 p1;
     ds>>p1;
     
@@ -365,13 +605,13 @@ void buttonrpc::callproxy_(std::function<R(P1)> func, Serializer *pr, const char
 
     value_t<R> val;
     val.set_code(RPC_ERR_SUCCESS);
-    val.set_val(r);
+    val.set_val(std::move(r));
     (*pr)<<val;
 }
 
 template<typename R, typename P1, typename P2>
-void buttonrpc::callproxy_(std::function<R(P1,P2)> fuc, Serializer *pr, const char *data, int len){
-    Serializer *ds(StreamBuffer(data,len));
+void buttonrpc::callproxy_(std::function<R(P1,P2)> func, Serializer *pr, const char *data, int len){
+    Serializer ds(StreamBuffer(data,len));
     P1 p1;
     P2 p2;
     ds>>p1>>p2;
@@ -379,7 +619,7 @@ void buttonrpc::callproxy_(std::function<R(P1,P2)> fuc, Serializer *pr, const ch
 
     value_t<R> val;
     val.set_code(RPC_ERR_SUCCESS);
-    val.set_val(r);
+    val.set_val(std::move(r));
     (*pr)<<val;
 }
 
@@ -394,7 +634,7 @@ void buttonrpc::callproxy_(std::function<R(P1,P2,P3)> func, Serializer *pr, cons
 
     value_t<R> val;
     val.set_code(RPC_ERR_SUCCESS);
-    val.set_val(r);
+    val.set_val(std::move(r));
     (*pr)<<val;
 }
 
@@ -407,7 +647,7 @@ void buttonrpc::callproxy_(std::function<R(P1, P2, P3, P4)> func, Serializer* pr
 	typename type_xx<R>::type r = call_helper<R>(std::bind(func, p1, p2, p3, p4));
 	value_t<R> val;
 	val.set_code(RPC_ERR_SUCCESS);
-	val.set_val(r);
+	val.set_val(std::move(r));
 	(*pr) << val;
 }
 
@@ -420,7 +660,7 @@ void buttonrpc::callproxy_(std::function<R(P1, P2, P3, P4, P5)> func, Serializer
 	typename type_xx<R>::type r = call_helper<R>(std::bind(func, p1, p2, p3, p4, p5));
 	value_t<R> val;
 	val.set_code(RPC_ERR_SUCCESS);
-	val.set_val(r);
+	val.set_val(std::move(r));
 	(*pr) << val;
 }
 
@@ -442,7 +682,7 @@ inline buttonrpc::value_t<R> buttonrpc::net_call(Serializer &ds){
     }
     m_error_code = RPC_ERR_SUCCESS;
     ds.clear();
-    ds.write_raw_data((char*)reple.data(), reply.size());
+    ds.write_raw_data((char*)reply.data(), reply.size());
     ds.reset();
 
     ds>>val;
@@ -496,5 +736,101 @@ inline buttonrpc::value_t<R> buttonrpc::call(std::string name, P1 p1, P2 p2, P3
 	return net_call<R>(ds);
 }
 
+template<typename P1>
+inline void buttonrpc::post(std::string name, P1 p1){
+    Serializer ds;
+    ds << name << p1;
+    zmq::message_t delimiter(0);
+    m_socket->send(delimiter, ZMQ_SNDMORE);
+    zmq::message_t request(ds.size());
+    memcpy(request.data(), ds.data(), ds.size());
+    send(request);
+}
+
+template<typename R>
+inline buttonrpc::value_t<R> buttonrpc::fetch(){
+    //回复的第一帧是空分隔帧
+    zmq::message_t reply;
+    do{
+        recv(reply);
+    }while(reply.size() == 0 && reply.more());
+    value_t<R> val;
+    if(reply.size() == 0){
+        val.set_code(RPC_ERR_RECV_TIMEOUT);
+        val.set_msg("recv timeout");
+        return val;
+    }
+    Serializer ds;
+    ds.write_raw_data((char*)reply.data(), reply.size());
+    ds.reset();
+    ds>>val;
+    return val;
+}
+
+//rpc_bind_async的一次调用：协程在处理函数返回前结束时直接写进回复，否则挂起请求，结束时再回复
+template<typename R>
+struct rpc_async_call{
+    bool done = false;
+    bool deferred = false;
+    buttonrpc::pending_t request;
+    std::optional<typename type_xx<R>::type> value;
+    std::string error;  //value为空时是协程抛出的异常
+};
+
+template<typename R>
+inline rpc_detached rpc_reply_when_done(buttonrpc &rpc, std::shared_ptr<rpc_async_call<R>> call, rpc_task<R> task){
+    try{
+        if constexpr(std::is_void_v<R>){
+            co_await task;
+            call->value.emplace(0);
+        }
+        else{
+            call->value.emplace(co_await task);
+        }
+    }
+    catch(const std::exception &e){
+        call->error = e.what();
+    }
+    catch(...){
+        call->error = "unknown exception";
+    }
+    call->done = true;
+    if(!call->deferred){
+        co_return;
+    }
+    if(call->value){
+        rpc.reply<typename type_xx<R>::type>(call->request, *call->value);
+    }
+    else{
+        rpc.reply_error(call->request, call->error);
+    }
+}
+
+//绑定返回rpc_task的函数，客户端和调用普通函数一样用call<R>调用
+//协程挂起时请求也挂起，run线程继续处理其他请求；没有挂起的请求和普通函数一样直接回复
+template<typename R, typename... P>
+void rpc_bind_async(buttonrpc &rpc, std::string name, std::function<rpc_task<R>(P...)> func){
+    rpc.bind_handler(name, [&rpc, func](Serializer *pr, const char *data, int len){
+        Serializer ds(StreamBuffer(data, len));
+        std::tuple<std::decay_t<P>...> args;
+        std::apply([&ds](auto&... arg){ ((ds >> arg), ...); }, args);
+        std::shared_ptr<rpc_async_call<R>> call = std::make_shared<rpc_async_call<R>>();
+        rpc_reply_when_done<R>(rpc, call, std::apply(func, std::move(args)));
+        if(!call->done){
+            call->request = rpc.defer();
+            call->deferred = true;
+        }
+        else if(call->value){
+            buttonrpc::value_t<R> val;
+            val.set_code(buttonrpc::RPC_ERR_SUCCESS);
+            val.set_val(std::move(*call->value));
+            (*pr)<<val;
+        }
+        else{
+            (*pr)<<buttonrpc::value_t<int>::code_type(buttonrpc::RPC_ERR_HANDLER_EXCEPTION);
+            (*pr)<<buttonrpc::value_t<int>::msg_type(call->error);
+        }
+    });
+}
 
 #endif
\ No newline at end of file
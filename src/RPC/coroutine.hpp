@@ -0,0 +1,687 @@
+#ifndef BUTTONRPC_COROUTINE_HPP
+#define BUTTONRPC_COROUTINE_HPP
+
+#include <coroutine>
+#include <exception>
+#include <stdexcept>
+#include <optional>
+#include <utility>
+#include <memory>
+#include <list>
+#include <map>
+#include <deque>
+#include <vector>
+#include <chrono>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <type_traits>
+#include <iostream>
+#include <cstdint>
+#include <cerrno>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <zmq.hpp>
+
+#define RPC_OFFLOAD_THREADS 4       //rpc_offload的后台线程数
+
+/*
+    基于C++20协程的请求执行层
+    rpc_scheduler：单线程的调度器，run_loop中poll所有挂起的协程登记的fd/zmq套接字，到期的定时器和其他线程提交的任务也在这里执行
+    buttonrpc的服务端就是一个调度器：接收请求、监控连接都是run_loop上的协程，处理函数也可以是协程
+    协程只在调度器线程上运行，挂起时登记一个定时器、一个fd/套接字的就绪监听或者一个等待队列，
+    调度器继续处理其他请求，条件满足时由run_loop恢复协程，一个线程可以同时挂起任意多个请求
+    rpc_task<T>：惰性启动的协程，被co_await时才开始执行，结束时直接切回等待它的协程，异常传给等待者
+    rpc_spawn：在当前线程启动一个rpc_task<void>，不等待它结束
+    rpc_bind_async（buttonrpc.hpp）：绑定返回rpc_task的函数，协程挂起时请求也挂起，协程结束时回复，协程抛出异常时回复错误
+    rpc_sleep/rpc_readable/rpc_writable/rpc_read/rpc_write/rpc_recv/rpc_send：定时器和非阻塞IO
+    rpc_mutex/rpc_condition：协程之间的锁和等待，不阻塞调度器线程；不能用来和其他线程同步
+    rpc_offload：把会阻塞的调用（读写磁盘、等其他线程持有的锁等）交给后台线程执行，完成后回到调度器线程继续
+    除rpc_offload传入的函数和rpc_scheduler::schedule外，所有操作都只能在调度器线程中调用
+*/
+
+template<typename T>
+class rpc_task;
+
+class rpc_scheduler{
+public:
+    rpc_scheduler();
+    ~rpc_scheduler();
+    rpc_scheduler(const rpc_scheduler&) = delete;
+    rpc_scheduler& operator=(const rpc_scheduler&) = delete;
+
+    static rpc_scheduler* current();    //当前线程正在运行的调度器，不在run_loop中时为nullptr
+    //ms毫秒后在调度器线程调用callback，返回的id可以用来取消
+    uint64_t add_timer(uint32_t ms, std::function<void()> callback);
+    void cancel_timer(uint64_t id);
+    //把callback交给调度器线程执行，可以在任意线程调用，按提交顺序执行
+    void schedule(std::function<void()> callback);
+    //fd或zmq套接字就绪（events是ZMQ_POLLIN/ZMQ_POLLOUT）时在调度器线程调用一次callback
+    uint64_t watch(int fd, short events, std::function<void()> callback);
+    uint64_t watch(zmq::socket_t &socket, short events, std::function<void()> callback);
+    void cancel_watch(uint64_t id);
+
+protected:
+    void run_loop();    //在当前线程运行调度器，不会返回
+
+private:
+    static rpc_scheduler*& current_();
+    long next_timeout();    //到最近一个定时器的毫秒数，没有定时器时为-1
+    void run_timers();
+    void run_watches(const std::vector<zmq::pollitem_t> &items, const std::vector<uint64_t> &ids);
+    void run_scheduled();
+    rpc_task<void> serve_scheduled();   //等待其他线程提交的任务并执行
+
+private:
+    //定时器按到期时间排序，id用来区分同一时间的多个定时器
+    std::map<std::pair<std::chrono::steady_clock::time_point, uint64_t>, std::function<void()>> m_timers;
+    std::map<uint64_t, std::chrono::steady_clock::time_point> m_timer_deadlines;
+    uint64_t m_next_timer = 0;
+    //一次性的就绪监听，每轮循环一起poll
+    struct watch_t{
+        void *socket;
+        int fd;
+        short events;
+        std::function<void()> callback;
+    };
+    std::map<uint64_t, watch_t> m_watches;
+    uint64_t m_next_watch = 0;
+    //其他线程提交的任务，写m_wakeup_fd唤醒poll
+    std::mutex m_scheduled_mutex;
+    std::deque<std::function<void()>> m_scheduled;
+    int m_wakeup_fd = -1;
+};
+
+//正在运行的调度器，不在调度器线程中时抛出异常
+inline rpc_scheduler& rpc_current(){
+    rpc_scheduler *scheduler = rpc_scheduler::current();
+    if(scheduler == nullptr){
+        throw std::logic_error("coroutine awaited outside rpc_scheduler::run_loop");
+    }
+    return *scheduler;
+}
+
+struct rpc_promise_base{
+    //结束时切回等待者，没有等待者时回到恢复它的地方
+    struct final_awaiter{
+        bool await_ready() noexcept { return false; }
+        template<typename P>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<P> handle) noexcept{
+            std::coroutine_handle<> next = handle.promise().continuation;
+            return next ? next : std::noop_coroutine();
+        }
+        void await_resume() noexcept {}
+    };
+
+    std::suspend_always initial_suspend() noexcept { return {}; }
+    final_awaiter final_suspend() noexcept { return {}; }
+    void unhandled_exception() { exception = std::current_exception(); }
+
+    std::coroutine_handle<> continuation;
+    std::exception_ptr exception;
+};
+
+template<typename T>
+struct rpc_promise : rpc_promise_base{
+    rpc_task<T> get_return_object();
+    void return_value(T v) { value.emplace(std::move(v)); }
+    T result(){
+        if(exception){
+            std::rethrow_exception(exception);
+        }
+        return std::move(*value);
+    }
+
+    std::optional<T> value;
+};
+
+template<>
+struct rpc_promise<void> : rpc_promise_base{
+    rpc_task<void> get_return_object();
+    void return_void() {}
+    void result(){
+        if(exception){
+            std::rethrow_exception(exception);
+        }
+    }
+};
+
+template<typename T>
+class rpc_task{
+public:
+    typedef rpc_promise<T> promise_type;
+
+    explicit rpc_task(std::coroutine_handle<promise_type> handle) : m_handle(handle) {}
+    rpc_task(rpc_task &&other) noexcept : m_handle(std::exchange(other.m_handle, nullptr)) {}
+    rpc_task& operator=(rpc_task &&other) noexcept{
+        if(this != &other){
+            if(m_handle){
+                m_handle.destroy();
+            }
+            m_handle = std::exchange(other.m_handle, nullptr);
+        }
+        return *this;
+    }
+    rpc_task(const rpc_task&) = delete;
+    rpc_task& operator=(const rpc_task&) = delete;
+    ~rpc_task(){
+        if(m_handle){
+            m_handle.destroy();
+        }
+    }
+
+    //co_await时记下等待者，然后直接切到这个协程开始执行
+    bool await_ready() const noexcept { return false; }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> caller) noexcept{
+        m_handle.promise().continuation = caller;
+        return m_handle;
+    }
+    T await_resume() { return m_handle.promise().result(); }
+
+private:
+    std::coroutine_handle<promise_type> m_handle;
+};
+
+template<typename T>
+inline rpc_task<T> rpc_promise<T>::get_return_object(){
+    return rpc_task<T>(std::coroutine_handle<rpc_promise<T>>::from_promise(*this));
+}
+
+inline rpc_task<void> rpc_promise<void>::get_return_object(){
+    return rpc_task<void>(std::coroutine_handle<rpc_promise<void>>::from_promise(*this));
+}
+
+//立即开始执行、结束时自己销毁的协程，只用来启动rpc_task
+struct rpc_detached{
+    struct promise_type{
+        rpc_detached get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+};
+
+//启动task，运行到第一次挂起时返回；task抛出的异常只打印，不会传给调用者
+inline rpc_detached rpc_spawn(rpc_task<void> task){
+    try{
+        co_await task;
+    }
+    catch(const std::exception &e){
+        std::cerr << "rpc_spawn: uncaught exception: " << e.what() << std::endl;
+    }
+    catch(...){
+        std::cerr << "rpc_spawn: uncaught exception" << std::endl;
+    }
+}
+
+//ms毫秒后恢复
+class rpc_sleep{
+public:
+    explicit rpc_sleep(uint32_t ms) : m_rpc(rpc_current()), m_ms(ms) {}
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> handle){
+        m_rpc.add_timer(m_ms, [handle](){ handle.resume(); });
+    }
+    void await_resume() const noexcept {}
+
+private:
+    rpc_scheduler &m_rpc;
+    uint32_t m_ms;
+};
+
+//fd或zmq套接字可读/可写时恢复；zmq套接字必须属于调度器线程
+class rpc_ready{
+public:
+    rpc_ready(int fd, short events) : m_rpc(rpc_current()), m_fd(fd), m_socket(nullptr), m_events(events) {}
+    rpc_ready(zmq::socket_t &socket, short events) : m_rpc(rpc_current()), m_fd(-1), m_socket(&socket), m_events(events) {}
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> handle){
+        if(m_socket != nullptr){
+            m_rpc.watch(*m_socket, m_events, [handle](){ handle.resume(); });
+        }
+        else{
+            m_rpc.watch(m_fd, m_events, [handle](){ handle.resume(); });
+        }
+    }
+    void await_resume() const noexcept {}
+
+private:
+    rpc_scheduler &m_rpc;
+    int m_fd;
+    zmq::socket_t *m_socket;
+    short m_events;
+};
+
+inline rpc_ready rpc_readable(int fd) { return rpc_ready(fd, ZMQ_POLLIN); }
+inline rpc_ready rpc_readable(zmq::socket_t &socket) { return rpc_ready(socket, ZMQ_POLLIN); }
+inline rpc_ready rpc_writable(int fd) { return rpc_ready(fd, ZMQ_POLLOUT); }
+inline rpc_ready rpc_writable(zmq::socket_t &socket) { return rpc_ready(socket, ZMQ_POLLOUT); }
+
+//非阻塞fd上的读写，返回值和read/write相同，没有数据或者缓冲区满时挂起
+inline rpc_task<ssize_t> rpc_read(int fd, void *buffer, size_t len){
+    while(true){
+        ssize_t n = ::read(fd, buffer, len);
+        if(n >= 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)){
+            co_return n;
+        }
+        if(errno != EINTR){
+            co_await rpc_readable(fd);
+        }
+    }
+}
+
+inline rpc_task<ssize_t> rpc_write(int fd, const void *buffer, size_t len){
+    while(true){
+        ssize_t n = ::write(fd, buffer, len);
+        if(n >= 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)){
+            co_return n;
+        }
+        if(errno != EINTR){
+            co_await rpc_writable(fd);
+        }
+    }
+}
+
+//zmq套接字上收发一帧
+inline rpc_task<void> rpc_recv(zmq::socket_t &socket, zmq::message_t &message){
+    while(!socket.recv(&message, ZMQ_DONTWAIT)){
+        co_await rpc_readable(socket);
+    }
+}
+
+inline rpc_task<void> rpc_send(zmq::socket_t &socket, zmq::message_t &message, int flags = 0){
+    while(!socket.send(message, flags | ZMQ_DONTWAIT)){
+        co_await rpc_writable(socket);
+    }
+}
+
+//协程之间的互斥锁，按等待的顺序交给下一个等待者
+class rpc_mutex{
+public:
+    //scoped_lock的结果，析构时解锁
+    class [[nodiscard]] guard{
+    public:
+        explicit guard(rpc_mutex *mutex) : m_mutex(mutex) {}
+        guard(guard &&other) noexcept : m_mutex(std::exchange(other.m_mutex, nullptr)) {}
+        guard(const guard&) = delete;
+        guard& operator=(const guard&) = delete;
+        ~guard(){
+            if(m_mutex != nullptr){
+                m_mutex->unlock();
+            }
+        }
+
+    private:
+        rpc_mutex *m_mutex;
+    };
+
+    class lock_awaiter{
+    public:
+        explicit lock_awaiter(rpc_mutex &mutex) : m_mutex(mutex) {}
+        bool await_ready() noexcept { return m_mutex.try_lock(); }
+        void await_suspend(std::coroutine_handle<> handle) { m_mutex.m_waiters.push_back(handle); }
+        void await_resume() const noexcept {}
+
+    protected:
+        rpc_mutex &m_mutex;
+    };
+
+    class scoped_lock_awaiter : public lock_awaiter{
+    public:
+        using lock_awaiter::lock_awaiter;
+        guard await_resume() noexcept { return guard(&m_mutex); }
+    };
+
+    rpc_mutex() = default;
+    rpc_mutex(const rpc_mutex&) = delete;
+    rpc_mutex& operator=(const rpc_mutex&) = delete;
+
+    //co_await lock()之后需要自己unlock
+    lock_awaiter lock() { return lock_awaiter(*this); }
+    scoped_lock_awaiter scoped_lock() { return scoped_lock_awaiter(*this); }
+
+    bool try_lock(){
+        if(m_locked){
+            return false;
+        }
+        m_locked = true;
+        return true;
+    }
+
+    //有等待者时锁直接转给它，等待者在调度器的下一轮恢复，不在unlock的调用栈里执行
+    void unlock(){
+        if(m_waiters.empty()){
+            m_locked = false;
+            return;
+        }
+        std::coroutine_handle<> next = m_waiters.front();
+        m_waiters.pop_front();
+        rpc_current().schedule([next](){ next.resume(); });
+    }
+
+    bool locked() const { return m_locked; }
+
+private:
+    bool m_locked = false;
+    std::deque<std::coroutine_handle<>> m_waiters;
+};
+
+//协程之间的条件等待，没有状态：notify时没有等待者就什么都不做
+//等待者挂起期间rpc_condition不能销毁
+class rpc_condition{
+private:
+    struct waiter_t{
+        std::coroutine_handle<> handle;
+        uint64_t timer = 0;
+        bool notified = false;
+    };
+
+public:
+    class wait_awaiter{
+    public:
+        wait_awaiter(rpc_condition &condition, uint32_t timeout_ms)
+        : m_condition(condition), m_timeout(timeout_ms), m_waiter(std::make_shared<waiter_t>()) {}
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle){
+            m_waiter->handle = handle;
+            m_condition.m_waiters.push_back(m_waiter);
+            if(m_timeout > 0){
+                rpc_condition *condition = &m_condition;
+                std::shared_ptr<waiter_t> waiter = m_waiter;
+                m_waiter->timer = rpc_current().add_timer(m_timeout, [condition, waiter](){
+                    condition->m_waiters.remove(waiter);
+                    waiter->handle.resume();
+                });
+            }
+        }
+        bool await_resume() const noexcept { return m_waiter->notified; }
+
+    private:
+        rpc_condition &m_condition;
+        uint32_t m_timeout;
+        std::shared_ptr<waiter_t> m_waiter;
+    };
+
+    rpc_condition() = default;
+    rpc_condition(const rpc_condition&) = delete;
+    rpc_condition& operator=(const rpc_condition&) = delete;
+
+    //等待notify，timeout_ms为0时不超时；被notify唤醒时返回true，超时返回false
+    wait_awaiter wait(uint32_t timeout_ms = 0) { return wait_awaiter(*this, timeout_ms); }
+
+    //唤醒最早的等待者，它在调度器的下一轮恢复
+    void notify_one(){
+        if(m_waiters.empty()){
+            return;
+        }
+        std::shared_ptr<waiter_t> waiter = std::move(m_waiters.front());
+        m_waiters.pop_front();
+        wake(waiter);
+    }
+
+    void notify_all(){
+        std::list<std::shared_ptr<waiter_t>> waiters;
+        waiters.swap(m_waiters);
+        for(const std::shared_ptr<waiter_t> &waiter : waiters){
+            wake(waiter);
+        }
+    }
+
+    size_t waiting() const { return m_waiters.size(); }
+
+private:
+    static void wake(const std::shared_ptr<waiter_t> &waiter){
+        rpc_scheduler &rpc = rpc_current();
+        waiter->notified = true;
+        if(waiter->timer != 0){
+            rpc.cancel_timer(waiter->timer);
+        }
+        std::coroutine_handle<> handle = waiter->handle;
+        rpc.schedule([handle](){ handle.resume(); });
+    }
+
+private:
+    std::list<std::shared_ptr<waiter_t>> m_waiters;
+};
+
+//rpc_offload使用的后台线程，进程退出时处理完已提交的任务再结束
+class rpc_worker_pool{
+public:
+    static rpc_worker_pool& instance(){
+        static rpc_worker_pool pool(RPC_OFFLOAD_THREADS);
+        return pool;
+    }
+
+    void submit(std::function<void()> job){
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_jobs.push_back(std::move(job));
+        }
+        m_cv.notify_one();
+    }
+
+private:
+    explicit rpc_worker_pool(size_t threads){
+        for(size_t i=0; i<threads; i++){
+            m_threads.emplace_back([this](){ work(); });
+        }
+    }
+
+    ~rpc_worker_pool(){
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_cv.notify_all();
+        for(std::thread &thread : m_threads){
+            thread.join();
+        }
+    }
+
+    void work(){
+        while(true){
+            std::function<void()> job;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_cv.wait(lock, [this](){ return m_stop || !m_jobs.empty(); });
+                if(m_jobs.empty()){
+                    return;
+                }
+                job = std::move(m_jobs.front());
+                m_jobs.pop_front();
+            }
+            job();
+        }
+    }
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::deque<std::function<void()>> m_jobs;
+    std::vector<std::thread> m_threads;
+    bool m_stop = false;
+};
+
+//在后台线程执行func，协程挂起，完成后在调度器线程恢复并得到func的返回值或异常
+//func不能访问只属于调度器线程的状态，需要的数据按值捕获
+//先定义成局部变量再co_await，GCC 12析构co_await表达式里带捕获的临时对象时会重复释放
+template<typename F>
+class rpc_offload{
+public:
+    typedef std::invoke_result_t<F> result_type;
+
+    explicit rpc_offload(F func) : m_rpc(rpc_current()), m_func(std::move(func)) {}
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> handle){
+        rpc_worker_pool::instance().submit([this, handle](){
+            try{
+                if constexpr(std::is_void_v<result_type>){
+                    m_func();
+                    m_result.emplace(0);
+                }
+                else{
+                    m_result.emplace(m_func());
+                }
+            }
+            catch(...){
+                m_exception = std::current_exception();
+            }
+            m_rpc.schedule([handle](){ handle.resume(); });
+        });
+    }
+    result_type await_resume(){
+        if(m_exception){
+            std::rethrow_exception(m_exception);
+        }
+        if constexpr(!std::is_void_v<result_type>){
+            return std::move(*m_result);
+        }
+    }
+
+private:
+    rpc_scheduler &m_rpc;
+    F m_func;
+    std::optional<std::conditional_t<std::is_void_v<result_type>, int8_t, result_type>> m_result;
+    std::exception_ptr m_exception;
+};
+
+inline rpc_scheduler::rpc_scheduler(){
+    m_wakeup_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+}
+
+inline rpc_scheduler::~rpc_scheduler(){
+    if(m_wakeup_fd >= 0){
+        ::close(m_wakeup_fd);
+    }
+}
+
+inline rpc_scheduler*& rpc_scheduler::current_(){
+    static thread_local rpc_scheduler *scheduler = nullptr;
+    return scheduler;
+}
+
+inline rpc_scheduler* rpc_scheduler::current(){
+    return current_();
+}
+
+//每轮poll所有登记的监听，然后执行就绪的监听和到期的定时器；其他线程提交的任务由serve_scheduled执行
+inline void rpc_scheduler::run_loop(){
+    current_() = this;
+    rpc_spawn(serve_scheduled());
+    std::vector<zmq::pollitem_t> items;
+    std::vector<uint64_t> ids;
+    while(1){
+        items.clear();
+        ids.clear();
+        for(const auto &watch : m_watches){
+            items.push_back({watch.second.socket, watch.second.fd, watch.second.events, 0});
+            ids.push_back(watch.first);
+        }
+        zmq::poll(items.data(), items.size(), next_timeout());
+        run_watches(items, ids);
+        run_timers();
+    }
+}
+
+inline rpc_task<void> rpc_scheduler::serve_scheduled(){
+    uint64_t count;
+    while(true){
+        co_await rpc_read(m_wakeup_fd, &count, sizeof(count));
+        run_scheduled();
+    }
+}
+
+inline uint64_t rpc_scheduler::add_timer(uint32_t ms, std::function<void()> callback){
+    uint64_t id = ++m_next_timer;
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(ms);
+    m_timers[std::make_pair(deadline, id)] = std::move(callback);
+    m_timer_deadlines[id] = deadline;
+    return id;
+}
+
+inline void rpc_scheduler::cancel_timer(uint64_t id){
+    auto it = m_timer_deadlines.find(id);
+    if(it == m_timer_deadlines.end()){
+        return;
+    }
+    m_timers.erase(std::make_pair(it->second, id));
+    m_timer_deadlines.erase(it);
+}
+
+inline long rpc_scheduler::next_timeout(){
+    if(m_timers.empty()){
+        return -1;
+    }
+    auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(m_timers.begin()->first.first - std::chrono::steady_clock::now());
+    //向上取整，避免提前醒来后空转
+    return wait.count() < 0 ? 0 : wait.count() + 1;
+}
+
+inline void rpc_scheduler::run_timers(){
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    while(!m_timers.empty() && m_timers.begin()->first.first <= now){
+        auto it = m_timers.begin();
+        std::function<void()> callback = std::move(it->second);
+        m_timer_deadlines.erase(it->first.second);
+        m_timers.erase(it);
+        callback();
+    }
+}
+
+inline void rpc_scheduler::schedule(std::function<void()> callback){
+    {
+        std::lock_guard<std::mutex> lock(m_scheduled_mutex);
+        m_scheduled.push_back(std::move(callback));
+    }
+    uint64_t one = 1;
+    ssize_t n = ::write(m_wakeup_fd, &one, sizeof(one));
+    (void)n;
+}
+
+//只执行这一轮之前提交的任务，任务中再提交的留到下一轮，不会让poll一直等不到机会
+inline void rpc_scheduler::run_scheduled(){
+    std::deque<std::function<void()>> callbacks;
+    {
+        std::lock_guard<std::mutex> lock(m_scheduled_mutex);
+        callbacks.swap(m_scheduled);
+    }
+    for(std::function<void()> &callback : callbacks){
+        callback();
+    }
+}
+
+inline uint64_t rpc_scheduler::watch(int fd, short events, std::function<void()> callback){
+    uint64_t id = ++m_next_watch;
+    m_watches[id] = watch_t{nullptr, fd, events, std::move(callback)};
+    return id;
+}
+
+inline uint64_t rpc_scheduler::watch(zmq::socket_t &socket, short events, std::function<void()> callback){
+    uint64_t id = ++m_next_watch;
+    m_watches[id] = watch_t{static_cast<void*>(socket), 0, events, std::move(callback)};
+    return id;
+}
+
+inline void rpc_scheduler::cancel_watch(uint64_t id){
+    m_watches.erase(id);
+}
+
+//前面的回调可能已经取消了后面的监听，按id重新查找
+inline void rpc_scheduler::run_watches(const std::vector<zmq::pollitem_t> &items, const std::vector<uint64_t> &ids){
+    for(size_t i=0; i<ids.size(); i++){
+        if(items[i].revents == 0){
+            continue;
+        }
+        auto it = m_watches.find(ids[i]);
+        if(it == m_watches.end()){
+            continue;
+        }
+        std::function<void()> callback = std::move(it->second.callback);
+        m_watches.erase(it);
+        callback();
+    }
+}
+
+#endif
@@ -0,0 +1,1983 @@
+#include "RedisHelper.h"
+#include "GlobPattern.h"
+#include "ReplyBuilder.h"
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <climits>
+#include <fstream>
+#include <algorithm>
+#include <iterator>
+
+/// @brief 把多个元素组织成带序号的多行回复
+/// @param items 元素列表
+/// @return 回复字符串，列表为空时返回(empty list or set)
+static std::string formatList(const std::vector<std::string> &items){
+    size_t bytes = 0;
+    for(const std::string &item : items){
+        bytes += ReplyBuilder::bulkSize(item.size());
+    }
+    ReplyBuilder reply(bytes);
+    for(const std::string &item : items){
+        reply.addBulk(item);
+    }
+    return reply.take();
+}
+
+/// @brief 把分数转换为字符串，整数不带小数点
+static std::string formatScore(double score){
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.17g", score);
+    return buf;
+}
+
+/// @brief 解析分数，支持inf/-inf
+/// @return 是否解析成功
+static bool parseScore(const std::string &str, double &score){
+    try{
+        size_t pos = 0;
+        score = std::stod(str, &pos);
+        return pos == str.size() && !std::isnan(score);
+    }
+    catch(const std::exception &e){
+        return false;
+    }
+}
+
+/// @brief 解析整数，整个字符串都必须是数字
+/// @return 是否解析成功
+static bool parseInteger(const std::string &str, long long &value){
+    try{
+        size_t pos = 0;
+        value = std::stoll(str, &pos);
+        return pos == str.size();
+    }
+    catch(const std::exception &e){
+        return false;
+    }
+}
+
+/// @brief 解析分数区间的边界，以'('开头表示开区间
+/// @return 是否解析成功
+static bool parseScoreBound(const std::string &str, double &score, bool &exclusive){
+    exclusive = !str.empty() && str[0] == '(';
+    return parseScore(exclusive ? str.substr(1) : str, score);
+}
+
+/// @brief 把有序集合的成员组织成回复，withScores为true时成员和分数交替输出
+static std::string formatZSetItems(const SortedSet::Items &items, bool withScores){
+    size_t bytes = 0;
+    for(const auto &item : items){
+        bytes += ReplyBuilder::bulkSize(item.first.size()) + (withScores ? ReplyBuilder::bulkSize(24) : 0);
+    }
+    ReplyBuilder reply(bytes);
+    for(const auto &item : items){
+        reply.addBulk(item.first);
+        if(withScores){
+            reply.addBulk(formatScore(item.second));
+        }
+    }
+    return reply.take();
+}
+
+/// @brief 键的字典序区间
+struct LexRange{
+    std::string min;
+    std::string max;
+    bool minInclusive = true;
+    bool maxInclusive = true;
+    bool maxInfinite = false;
+    bool empty = false;     //区间为空，如min为+
+    bool contains(const std::string &key) const {
+        return maxInfinite || key < max || (maxInclusive && key == max);
+    }
+};
+
+/// @brief 解析字典序区间，[a 闭区间，(a 开区间，- 最小，+ 最大
+/// @return 是否解析成功
+static bool parseLexRange(const std::string &min, const std::string &max, LexRange &range){
+    if(min.empty() || max.empty()){
+        return false;
+    }
+    if(min == "-"){
+        range.min = "";
+    }
+    else if(min == "+"){
+        range.empty = true;
+    }
+    else if(min[0] == '[' || min[0] == '('){
+        range.min = min.substr(1);
+        range.minInclusive = min[0] == '[';
+    }
+    else{
+        return false;
+    }
+    if(max == "+"){
+        range.maxInfinite = true;
+    }
+    else if(max == "-"){
+        range.empty = true;
+    }
+    else if(max[0] == '[' || max[0] == '('){
+        range.max = max.substr(1);
+        range.maxInclusive = max[0] == '[';
+    }
+    else{
+        return false;
+    }
+    return true;
+}
+
+/// @brief 把键编码为游标，用十六进制表示，避免键中的空白字符被拆分
+static std::string encodeCursor(const std::string &key){
+    static const char digits[] = "0123456789abcdef";
+    std::string cursor;
+    cursor.reserve(key.size() * 2);
+    for(unsigned char c : key){
+        cursor.push_back(digits[c >> 4]);
+        cursor.push_back(digits[c & 0xf]);
+    }
+    return cursor;
+}
+
+/// @brief 把游标解码为键
+/// @return 游标是否合法
+static bool decodeCursor(const std::string &cursor, std::string &key){
+    if(cursor.size() % 2 != 0){
+        return false;
+    }
+    auto nibble = [](char c){
+        return c >= '0' && c <= '9' ? c - '0' : c >= 'a' && c <= 'f' ? c - 'a' + 10 : c >= 'A' && c <= 'F' ? c - 'A' + 10 : -1;
+    };
+    key.clear();
+    key.reserve(cursor.size() / 2);
+    for(size_t i=0; i<cursor.size(); i+=2){
+        int high = nibble(cursor[i]);
+        int low = nibble(cursor[i+1]);
+        if(high < 0 || low < 0){
+            return false;
+        }
+        key.push_back(static_cast<char>((high << 4) | low));
+    }
+    return true;
+}
+
+/// @brief 组织SCAN类命令的回复：第一项是下一次的游标，第二项是本次返回的元素
+static std::string formatScanReply(const std::string &cursor, const std::vector<std::string> &items){
+    size_t bytes = 0;
+    for(const std::string &item : items){
+        bytes += ReplyBuilder::bulkSize(item.size()) + 3;
+    }
+    ReplyBuilder elements(bytes, 3);
+    for(const std::string &item : items){
+        elements.addBulk(item);
+    }
+    ReplyBuilder reply(ReplyBuilder::bulkSize(cursor.size()) + bytes + 8);
+    reply.addBulk(cursor);
+    reply.addFormatted(elements.take());
+    return reply.take();
+}
+
+/// @brief 估计释放一个值需要释放的内存块个数
+static size_t freeEffort(const RedisValue &){
+    return 1;
+}
+
+static size_t freeEffort(const std::shared_ptr<CompressedString> &value){
+    return value->frameCount();
+}
+
+static size_t freeEffort(const std::shared_ptr<QuickList> &list){
+    return list->nodeSize();
+}
+
+static size_t freeEffort(const std::shared_ptr<CompactHash> &hash){
+    return hash->encoding() == CompactHash::PACKED ? 1 : hash->size();
+}
+
+static size_t freeEffort(const std::shared_ptr<SortedSet> &zset){
+    return zset->size();
+}
+
+static size_t freeEffort(const std::shared_ptr<HyperLogLog> &){
+    return 1;
+}
+
+static size_t freeEffort(const std::shared_ptr<BloomFilter> &bloom){
+    return bloom->layerCount();
+}
+
+static size_t freeEffort(const std::shared_ptr<CuckooFilter> &cuckoo){
+    return cuckoo->tableCount();
+}
+
+static size_t freeEffort(const std::shared_ptr<std::string> &){
+    return 1;
+}
+
+static size_t freeEffort(const RedisObject &object){
+    return std::visit([](const auto &value){ return freeEffort(value); }, object);
+}
+
+/// @brief 值的类型，下标与RedisObject的备选类型一一对应
+static VALUE_TYPE typeOf(const RedisObject &object){
+    static const VALUE_TYPE types[] = {TYPE_STRING, TYPE_STRING, TYPE_LIST, TYPE_HASH, TYPE_ZSET, TYPE_HLL, TYPE_BLOOM, TYPE_CUCKOO, TYPE_STRING};
+    static_assert(sizeof(types) / sizeof(types[0]) == std::variant_size_v<RedisObject>, "every alternative needs a type");
+    return types[object.index()];
+}
+
+/// @brief 释放摘下来的节点，较大的值交给后台线程
+static void releaseNodes(LazyFree &lazyFree, std::vector<std::shared_ptr<SkipListNode<std::string, RedisObject>>> &nodes){
+    for(auto &node : nodes){
+        size_t effort = freeEffort(node->value);
+        lazyFree.release(std::move(node), effort);
+    }
+}
+
+/// @brief 获取键对应的值类型
+/// @param key 键
+/// @return 值类型，键不存在时返回TYPE_NONE
+VALUE_TYPE RedisHelper::getType(const std::string &key){
+    auto node = dataBase->searchItem(key);
+    return node == nullptr ? TYPE_NONE : typeOf(node->value);
+}
+
+/// @brief 加入一个原来不存在的键
+void RedisHelper::addObject(const std::string &key, RedisObject object){
+    typeCounts[typeOf(object)]++;
+    if(!slotIndex.empty()){
+        slotIndex[keyHashSlot(key)].insert(key);
+    }
+    dataBase->addItem(key, object);
+}
+
+/// @brief 替换已有节点的值，新值可以是其他类型
+void RedisHelper::replaceObject(const std::shared_ptr<SkipListNode<std::string, RedisObject>> &node, RedisObject object){
+    typeCounts[typeOf(node->value)]--;
+    typeCounts[typeOf(object)]++;
+    node->value = std::move(object);
+}
+
+/// @brief 写入一个值，覆盖任意类型的同名键
+void RedisHelper::setObject(const std::string &key, RedisObject object){
+    auto node = dataBase->searchItem(key);
+    if(node != nullptr){
+        replaceObject(node, std::move(object));
+    }
+    else{
+        addObject(key, std::move(object));
+    }
+}
+
+/// @brief 删除一个键
+/// @return 键是否存在
+bool RedisHelper::removeKey(const std::string &key){
+    std::vector<std::shared_ptr<SkipListNode<std::string, RedisObject>>> detached;
+    dataBase->deleteItems({key}, &detached);
+    forgetNodes(detached);
+    return !detached.empty();
+}
+
+/// @brief 从键空间摘下节点之后更新统计
+void RedisHelper::forgetNodes(const std::vector<std::shared_ptr<SkipListNode<std::string, RedisObject>>> &nodes){
+    for(const auto &node : nodes){
+        typeCounts[typeOf(node->value)]--;
+        if(!slotIndex.empty()){
+            slotIndex[keyHashSlot(node->key)].erase(node->key);
+        }
+    }
+}
+
+/// @brief 获取T类型的值，只查找一次
+/// @param wrongType 键存在但不是T类型时置为true
+/// @param create 键不存在时是否用args创建
+/// @return 值对象，不存在且不创建、或者类型不对时返回nullptr
+template <typename T, typename... Args>
+std::shared_ptr<T> RedisHelper::getObject(const std::string &key, bool &wrongType, bool create, Args&&... args){
+    wrongType = false;
+    auto node = dataBase->searchItem(key);
+    if(node != nullptr){
+        const std::shared_ptr<T> *object = std::get_if<std::shared_ptr<T>>(&node->value);
+        wrongType = object == nullptr;
+        return wrongType ? nullptr : *object;
+    }
+    if(!create){
+        return nullptr;
+    }
+    std::shared_ptr<T> object = std::make_shared<T>(std::forward<Args>(args)...);
+    addObject(key, object);
+    return object;
+}
+
+std::shared_ptr<CompactHash> RedisHelper::getHash(const std::string &key, bool &wrongType, bool create){
+    return getObject<CompactHash>(key, wrongType, create, hashMaxPackedEntries, hashMaxPackedValue);
+}
+
+void RedisHelper::setHashPacking(size_t maxEntries, size_t maxValue){
+    hashMaxPackedEntries = maxEntries;
+    hashMaxPackedValue = maxValue;
+}
+
+std::shared_ptr<SortedSet> RedisHelper::getZSet(const std::string &key, bool &wrongType, bool create){
+    return getObject<SortedSet>(key, wrongType, create);
+}
+
+std::shared_ptr<HyperLogLog> RedisHelper::getHyperLogLog(const std::string &key, bool &wrongType, bool create){
+    return getObject<HyperLogLog>(key, wrongType, create);
+}
+
+std::shared_ptr<BloomFilter> RedisHelper::getBloom(const std::string &key, bool &wrongType, bool create){
+    return getObject<BloomFilter>(key, wrongType, create);
+}
+
+std::shared_ptr<CuckooFilter> RedisHelper::getCuckoo(const std::string &key, bool &wrongType, bool create){
+    return getObject<CuckooFilter>(key, wrongType, create);
+}
+
+std::shared_ptr<QuickList> RedisHelper::getList(const std::string &key, bool &wrongType, bool create){
+    return getObject<QuickList>(key, wrongType, create, QUICKLIST_CHUNK_SIZE, LIST_COMPRESS_DEPTH);
+}
+
+/// @brief 从列表头部插入元素
+/// @param key 列表的键
+/// @param value 插入的元素
+/// @return 插入后列表的长度
+std::string RedisHelper::lpush(const std::string &key, const std::string &value){
+    bool wrongType = false;
+    std::shared_ptr<QuickList> list = getList(key, wrongType, true);
+    if(wrongType){
+        return WRONG_TYPE_MESSAGE;
+    }
+    list->pushFront(value);
+    return "(integer) " + std::to_string(list->size());
+}
+
+/// @brief 从列表尾部插入元素
+/// @param key 列表的键
+/// @param value 插入的元素
+/// @return 插入后列表的长度
+std::string RedisHelper::rpush(const std::string &key, const std::string &value){
+    bool wrongType = false;
+    std::shared_ptr<QuickList> list = getList(key, wrongType, true);
+    if(wrongType){
+        return WRONG_TYPE_MESSAGE;
+    }
+    list->pushBack(value);
+    return "(integer) " + std::to_string(list->size());
+}
+
+/// @brief 从列表头部弹出元素，列表为空时删除该键
+/// @param key 列表的键
+/// @return 弹出的元素
+std::string RedisHelper::lpop(const std::string &key){
+    bool wrongType = false;
+    std::shared_ptr<QuickList> list = getList(key, wrongType);
+    if(wrongType){
+        return WRONG_TYPE_MESSAGE;
+    }
+    std::string value;
+    if(list == nullptr || !list->popFront(value)){
+        return NIL_MESSAGE;
+    }
+    if(list->size() == 0){
+        removeKey(key);
+    }
+    return "\"" + value + "\"";
+}
+
+/// @brief 从列表尾部弹出元素，列表为空时删除该键
+/// @param key 列表的键
+/// @return 弹出的元素
+std::string RedisHelper::rpop(const std::string &key){
+    bool wrongType = false;
+    std::shared_ptr<QuickList> list = getList(key, wrongType);
+    if(wrongType){
+        return WRONG_TYPE_MESSAGE;
+    }
+    std::string value;
+    if(list == nullptr || !list->popBack(value)){
+        return NIL_MESSAGE;
+    }
+    if(list->size() == 0){
+        removeKey(key);
+    }
+    return "\"" + value + "\"";
+}
+
+/// @brief 原子地把元素从一个列表移动到另一个列表，source和destination相同时为旋转
+/// @return 移动的元素，source为空时为nil
+std::string RedisHelper::lmove(const std::string &source, const std::string &destination, const std::string &wherefrom, const std::string &whereto){
+    bool sourceWrongType = false;
+    bool destinationWrongType = false;
+    std::shared_ptr<QuickList> sourceList = getList(source, sourceWrongType);
+    std::shared_ptr<QuickList> destinationList = getList(destination, destinationWrongType);
+    if(sourceWrongType || destinationWrongType){
+        return WRONG_TYPE_MESSAGE;
+    }
+    std::string value;
+    if(sourceList == nullptr || !(wherefrom == "left" ? sourceList->popFront(value) : sourceList->popBack(value))){
+        return NIL_MESSAGE;
+    }
+    if(destinationList == nullptr){
+        destinationList = getList(destination, destinationWrongType, true);
+    }
+    if(whereto == "left"){
+        destinationList->pushFront(value);
+    }
+    else{
+        destinationList->pushBack(value);
+    }
+    //压入之后再检查，source和destination相同时列表不会被删除
+    if(sourceList->size() == 0){
+        removeKey(source);
+    }
+    return "\"" + value + "\"";
+}
+
+/// @brief BLPOP/BRPOP的非阻塞部分
+/// @param keys 按顺序检查的键
+/// @param left 从头部还是尾部弹出
+/// @return 1) 键 2) 元素，所有列表都为空时为nil
+std::string RedisHelper::bpop(const std::vector<std::string> &keys, bool left){
+    for(const std::string &key : keys){
+        bool wrongType = false;
+        std::shared_ptr<QuickList> list = getList(key, wrongType);
+        if(wrongType){
+            return WRONG_TYPE_MESSAGE;
+        }
+        std::string value;
+        if(list == nullptr || !(left ? list->popFront(value) : list->popBack(value))){
+            continue;
+        }
+        if(list->size() == 0){
+            removeKey(key);
+        }
+        return "1) \"" + key + "\"\n2) \"" + value + "\"";
+    }
+    return NIL_MESSAGE;
+}
+
+/// @brief 获取列表指定区间内的元素
+/// @param key 列表的键
+/// @param start 开始下标，支持负数
+/// @param end 结束下标，支持负数
+/// @return 区间内的元素，每行一个
+std::string RedisHelper::lrange(const std::string &key, const std::string &start, const std::string &end){
+    bool wrongType = false;
+    std::shared_ptr<QuickList> list = getList(key, wrongType);
+    if(wrongType){
+        return WRONG_TYPE_MESSAGE;
+    }
+    long startIndex = 0;
+    long endIndex = 0;
+    try{
+        startIndex = std::stol(start);
+        endIndex = std::stol(end);
+    }
+    catch(const std::exception &e){
+        return "(error) ERR value is not an integer or out of range";
+    }
+    if(list == nullptr){
+        return EMPTY_LIST_MESSAGE;
+    }
+    //元素直接从列表的节点追加到回复中
+    ReplyBuilder reply;
+    list->forEachInRange(startIndex, endIndex, [&reply](const char *data, size_t size){
+        reply.addBulk(data, size);
+    });
+    return reply.take();
+}
+
+/// @brief 向哈希表中设置字段
+/// @param key 哈希的键
+/// @param filed 字段和值交替排列 field value [field value ...]
+/// @return 新增字段的个数
+std::string RedisHelper::hset(const std::string &key, const std::vector<std::string> &filed){
+    if(filed.empty() || filed.size() % 2 != 0){
+        return "(error) ERR wrong number of arguments for 'hset' command";
+    }
+    bool wrongType = false;
+    std::shared_ptr<CompactHash> hash = getHash(key, wrongType, true);
+    if(wrongType){
+        return WRONG_TYPE_MESSAGE;
+    }
+    int added = 0;
+    for(size_t i=0; i+1<filed.size(); i+=2){
+        if(hash->set(filed[i], filed[i+1])){
+            added++;
+        }
+    }
+    return "(integer) " + std::to_string(added);
+}
+
+/// @brief 获取哈希表中字段的值
+/// @param key 哈希的键
+/// @param filed 字段
+/// @return 字段的值，不存在返回(nil)
+std::string RedisHelper::hget(const std::string &key, const std::string &filed){
+    bool wrongType = false;
+    std::shared_ptr<CompactHash> hash = getHash(key, wrongType);
+    if(wrongType){
+        return WRONG_TYPE_MESSAGE;
+    }
+    std::string value;
+    if(hash == nullptr || !hash->get(filed, value)){
+        return NIL_MESSAGE;
+    }
+    return "\"" + value + "\"";
+}
+
+/// @brief 删除哈希表中的字段，删空后删除该键
+/// @param key 哈希的键
+/// @param filed 要删除的字段
+/// @return 删除的字段个数
+std::string RedisHelper::hdel(const std::string &key, const std::vector<std::string> &filed){
+    bool wrongType = false;
+    std::shared_ptr<CompactHash> hash = getHash(key, wrongType);
+    if(wrongType){
+        return WRONG_TYPE_MESSAGE;
+    }
+    if(hash == nullptr){
+        return "(integer) 0";
+    }
+    int removed = 0;
+    for(const std::string &f : filed){
+        if(hash->remove(f)){
+            removed++;
+        }
+    }
+    if(hash->size() == 0){
+        removeKey(key);
+    }
+    return "(integer) " + std::to_string(removed);
+}
+
+/// @brief 获取哈希表中的所有字段名
+std::string RedisHelper::hkeys(const std::string &key){
+    bool wrongType = false;
+    std::shared_ptr<CompactHash> hash = getHash(key, wrongType);
+    if(wrongType){
+        return WRONG_TYPE_MESSAGE;
+    }
+    ReplyBuilder reply;
+    if(hash != nullptr){
+        hash->forEach([&reply](const std::string &f, const std::string &){
+            reply.addBulk(f);
+            return true;
+        });
+    }
+    return reply.take();
+}
+
+/// @brief 获取哈希表中的所有值
+std::string RedisHelper::hvals(const std::string &key){
+    bool wrongType = false;
+    std::shared_ptr<CompactHash> hash = getHash(key, wrongType);
+    if(wrongType){
+        return WRONG_TYPE_MESSAGE;
+    }
+    ReplyBuilder reply;
+    if(hash != nullptr){
+        hash->forEach([&reply](const std::string &, const std::string &v){
+            reply.addBulk(v);
+            return true;
+        });
+    }
+    return reply.take();
+}
+
+/// @brief 获取哈希表中的所有字段和值，字段和值交替输出
+std::string RedisHelper::hgetall(const std::string &key){
+    bool wrongType = false;
+    std::shared_ptr<CompactHash> hash = getHash(key, wrongType);
+    if(wrongType){
+        return WRONG_TYPE_MESSAGE;
+    }
+    ReplyBuilder reply;
+    if(hash != nullptr){
+        hash->forEach([&reply](const std::string &f, const std::string &v){
+            reply.addBulk(f);
+            reply.addBulk(v);
+            return true;
+        });
+    }
+    return reply.take();
+}
+
+/// @brief 获取多个字段的值，不存在的字段输出(nil)
+std::string RedisHelper::hmget(const std::string &key, const std::vector<std::string> &filed){
+    bool wrongType = false;
+    std::shared_ptr<CompactHash> hash = getHash(key, wrongType);
+    if(wrongType){
+        return WRONG_TYPE_MESSAGE;
+    }
+    ReplyBuilder reply;
+    std::string value;
+    for(const std::string &f : filed){
+        if(hash != nullptr && hash->get(f, value)){
+            reply.addBulk(value);
+        }
+        else{
+            reply.addNil();
+        }
+    }
+    return reply.take();
+}
+
+/// @brief 字段的整数值加上增量，字段不存在时视为0
+/// @return 增加后的值
+std::string RedisHelper::hincrby(const std::string &key, const std::string &filed, long long increment){
+    bool wrongType = false;
+    std::shared_ptr<CompactHash> hash = getHash(key, wrongType, true);
+    if(wrongType){
+        return WRONG_TYPE_MESSAGE;
+    }
+    std::string value;
+    long long number = 0;
+    if(hash->get(filed, value)){
+        size_t pos = 0;
+        try{
+            number = std::stoll(value, &pos);
+        }
+        catch(const std::exception &e){
+            pos = std::string::npos;
+        }
+        if(pos != value.size()){
+            return "(error) ERR hash value is not an integer";
+        }
+    }
+    number += increment;
+    hash->set(filed, std::to_string(number));
+    return "(integer) " + std::to_string(number);
+}
+
+/// @brief 获取哈希表中字段的数量
+std::string RedisHelper::hlen(const std::string &key){
+    bool wrongType = false;
+    std::shared_ptr<CompactHash> hash = getHash(key, wrongType);
+    if(wrongType){
+        return WRONG_TYPE_MESSAGE;
+    }
+    return "(integer) " + std::to_string(hash == nullptr ? 0 : hash->size());
+}
+
+/// @brief 添加成员或更新成员的分数
+/// @param key 有序集合的键
+/// @param items 分数和成员交替排列 score member [score member ...]
+/// @return 新增成员的个数
+std::string RedisHelper::zadd(const std::string &key, const std::vector<std::string> &items){
+    if(items.empty() || items.size() % 2 != 0){
+        return "(error) ERR syntax error";
+    }
+    //先检查所有分数，保证要么全部添加要么都不添加
+    std::vector<double> scores(items.size() / 2);
+    for(size_t i=0; i<items.size(); i+=2){
+        if(!parseScore(items[i], scores[i/2])){
+            return "(error) ERR value is not a valid float";
+        }
+    }
+    bool wrongType = false;
+    std::shared_ptr<SortedSet> zset = getZSet(key, wrongType, true);
+    if(wrongType){
+        return WRONG_TYPE_MESSAGE;
+    }
+    int added = 0;
+    for(size_t i=0; i<items.size(); i+=2){
+        if(zset->add(items[i+1], scores[i/2])){
+            added++;
+        }
+    }
+    return "(integer) " + std::to_string(added);
+}
+
+/// @brief 删除成员，删空后删除该键
+/// @return 删除的成员个数
+std::string RedisHelper::zrem(const std::string &key, const std::vector<std::string> &members){
+    bool wrongType = false;
+    std::shared_ptr<SortedSet> zset = getZSet(key, wrongType);
+    if(wrongType){
+        return WRONG_TYPE_MESSAGE;
+    }
+    if(zset == nullptr){
+        return "(integer) 0";
+    }
+    int removed = 0;
+    for(const std::string &member : members){
+        if(zset->remove(member)){
+            removed++;
+        }
+    }
+    if(zset->size() == 0){
+        removeKey(key);
+    }
+    return "(integer) " + std::to_string(removed);
+}
+
+/// @brief 获取成员的分数
+std::string RedisHelper::zscore(const std::string &key, const std::string &member){
+    bool wrongType = false;
+    std::shared_ptr<SortedSet> zset = getZSet(key, wrongType);
+    if(wrongType){
+        return WRONG_TYPE_MESSAGE;
+    }
+    double score = 0;
+    if(zset == nullptr || !zset->score(member, score)){
+        return NIL_MESSAGE;
+    }
+    return "\"" + formatScore(score) + "\"";
+}
+
+/// @brief 成员的分数加上增量，成员不存在时视为0
+/// @return 增加后的分数
+std::string RedisHelper::zincrby(const std::string &key, double increment, const std::string &member){
+    bool wrongType = false;
+    std::shared_ptr<SortedSet> zset = getZSet(key, wrongType, true);
+    if(wrongType){
+        return WRONG_TYPE_MESSAGE;
+    }
+    double score = 0;
+    if(!zset->incrBy(member, increment, score)){
+        if(zset->size() == 0){
+            removeKey(key);
+        }
+        return "(error) ERR resulting score is not a number (NaN)";
+    }
+    return "\"" + formatScore(score) + "\"";
+}
+
+/// @brief 获取成员个数
+std::string RedisHelper::zcard(const std::string &key){
+    bool wrongType = false;
+    std::shared_ptr<SortedSet> zset = getZSet(key, wrongType);
+    if(wrongType){
+        return WRONG_TYPE_MESSAGE;
+    }
+    return "(integer) " + std::to_string(zset == nullptr ? 0 : zset->size());
+}
+
+/// @brief 获取成员按分数升序的排名，从0开始
+std::string RedisHelper::zrank(const std::string &key, const std::string &member){
+    bool wrongType = false;
+    std::shared_ptr<SortedSet> zset = getZSet(key, wrongType);
+    if(wrongType){
+        return WRONG_TYPE_MESSAGE;
+    }
+    long rank = zset == nullptr ? -1 : zset->rank(member);
+    if(rank < 0){
+        return NIL_MESSAGE;
+    }
+    return "(integer) " + std::to_string(rank);
+}
+
+/// @brief 获取成员按分数降序的排名，从0开始
+std::string RedisHelper::zrevrank(const std::string &key, const std::string &member){
+    bool wrongType = false;
+    std::shared_ptr<SortedSet> zset = getZSet(key, wrongType);
+    if(wrongType){
+        return WRONG_TYPE_MESSAGE;
+    }
+    long rank = zset == nullptr ? -1 : zset->rank(member, true);
+    if(rank < 0){
+        return NIL_MESSAGE;
+    }
+    return "(integer) " + std::to_string(rank);
+}
+
+/// @brief 按分数升序获取排名区间内的成员
+std::string RedisHelper::zrange(const std::string &key, long start, long end, bool withScores){
+    bool wrongType = false;
+    std::shared_ptr<SortedSet> zset = getZSet(key, wrongType);
+    if(wrongType){
+        return WRONG_TYPE_MESSAGE;
+    }
+    if(zset == nullptr){
+        return EMPTY_LIST_MESSAGE;
+    }
+    return formatZSetItems(zset->rangeByIndex(start, end), withScores);
+}
+
+/// @brief 按分数降序获取排名区间内的成员
+std::string RedisHelper::zrevrange(const std::string &key, long start, long end, bool withScores){
+    bool wrongType = false;
+    std::shared_ptr<SortedSet> zset = getZSet(key, wrongType);
+    if(wrongType){
+        return WRONG_TYPE_MESSAGE;
+    }
+    if(zset == nullptr){
+        return EMPTY_LIST_MESSAGE;
+    }
+    return formatZSetItems(zset->rangeByIndex(start, end, true), withScores);
+}
+
+/// @brief 获取分数区间内的成员
+/// @param min 最小分数，'('开头表示开区间，支持-inf
+/// @param max 最大分数，'('开头表示开区间，支持+inf
+/// @param offset 跳过的成员个数
+/// @param count 最多返回的成员个数，负数表示不限制
+std::string RedisHelper::zrangebyscore(const std::string &key, const std::string &min, const std::string &max,
+    bool withScores, long offset, long count){
+    bool wrongType = false;
+    std::shared_ptr<SortedSet> zset = getZSet(key, wrongType);
+    if(wrongType){
+        return WRONG_TYPE_MESSAGE;
+    }
+    ZRangeSpec range;
+    if(!parseScoreBound(min, range.min, range.minExclusive) || !parseScoreBound(max, range.max, range.maxExclusive)){
+        return "(error) ERR min or max is not a float";
+    }
+    if(zset == nullptr || offset < 0){
+        return EMPTY_LIST_MESSAGE;
+    }
+    return formatZSetItems(zset->rangeByScore(range, offset, count), withScores);
+}
+
+/// @brief 添加元素，键不存在时创建
+/// @return 有寄存器改变或者新建了键时为1，否则为0
+std::string RedisHelper::pfadd(const std::string &key, const std::vector<std::string> &elements){
+    bool wrongType = false;
+    std::shared_ptr<HyperLogLog> hll = getHyperLogLog(key, wrongType);
+    if(wrongType){
+        return WRONG_TYPE_MESSAGE;
+    }
+    bool updated = hll == nullptr;
+    if(updated){
+        hll = getHyperLogLog(key, wrongType, true);
+    }
+    for(const std::string &element : elements){
+        updated |= hll->add(element);
+    }
+    return updated ? "(integer) 1" : "(integer) 0";
+}
+
+/// @brief 把多个HyperLogLog的寄存器合并到展开的数组中，不存在的键跳过
+bool RedisHelper::mergeRegisters(const std::vector<std::string> &keys, uint8_t *registers){
+    std::vector<std::shared_ptr<HyperLogLog>> sources;
+    for(const std::string &key : keys){
+        bool wrongType = false;
+        std::shared_ptr<HyperLogLog> hll = getHyperLogLog(key, wrongType);
+        if(wrongType){
+            return false;
+        }
+        if(hll != nullptr){
+            sources.push_back(hll);
+        }
+    }
+    for(const auto &hll : sources){
+        hll->mergeInto(registers);
+    }
+    return true;
+}
+
+/// @brief 估计基数，一个键时使用缓存的估计值，多个键时合并到临时的寄存器上估计
+std::string RedisHelper::pfcount(const std::vector<std::string> &keys){
+    if(keys.size() == 1){
+        bool wrongType = false;
+        std::shared_ptr<HyperLogLog> hll = getHyperLogLog(keys[0], wrongType);
+        if(wrongType){
+            return WRONG_TYPE_MESSAGE;
+        }
+        return "(integer) " + std::to_string(hll == nullptr ? 0 : hll->count());
+    }
+    std::vector<uint8_t> registers(HLL_REGISTERS, 0);
+    if(!mergeRegisters(keys, registers.data())){
+        return WRONG_TYPE_MESSAGE;
+    }
+    return "(integer) " + std::to_string(HyperLogLog::estimate(registers.data()));
+}
+
+/// @brief 合并到destKey，destKey原来的值也参与合并，结果使用密集编码
+std::string RedisHelper::pfmerge(const std::string &destKey, const std::vector<std::string> &keys){
+    std::vector<std::string> all = keys;
+    all.push_back(destKey);
+    std::vector<uint8_t> registers(HLL_REGISTERS, 0);
+    if(!mergeRegisters(all, registers.data())){
+        return WRONG_TYPE_MESSAGE;
+    }
+    bool wrongType = false;
+    getHyperLogLog(destKey, wrongType, true)->setRegisters(registers.data());
+    return "OK";
+}
+
+/// @brief 创建指定误判率和初始容量的布隆过滤器
+std::string RedisHelper::bfreserve(const std::string &key, double errorRate, uint64_t capacity){
+    if(dataBase->searchItem(key) != nullptr){
+        return "(error) ERR item exists";
+    }
+    addObject(key, std::make_shared<BloomFilter>(errorRate, capacity));
+    return "OK";
+}
+
+/// @brief 添加元素，键不存在时按默认参数创建
+/// @return 元素原来不存在时为1，可能已经存在时为0
+std::string RedisHelper::bfadd(const std::string &key, const std::string &item){
+    bool wrongType = false;
+    std::shared_ptr<BloomFilter> bloom = getBloom(key, wrongType, true);
+    if(wrongType){
+        return WRONG_TYPE_MESSAGE;
+    }
+    return bloom->add(item) ? "(integer) 1" : "(integer) 0";
+}
+
+/// @brief 添加多个元素，每个元素回复一项，含义与BF.ADD相同
+std::string RedisHelper::bfmadd(const std::string &key, const std::vector<std::string> &items){
+    bool wrongType = false;
+    std::shared_ptr<BloomFilter> bloom = getBloom(key, wrongType, true);
+    if(wrongType){
+        return WRONG_TYPE_MESSAGE;
+    }
+    ReplyBuilder reply;
+    for(const std::string &item : items){
+        reply.addFormatted(bloom->add(item) ? "(integer) 1" : "(integer) 0");
+    }
+    return reply.take();
+}
+
+std::string RedisHelper::bfexists(const std::string &key, const std::string &item){
+    bool wrongType = false;
+    std::shared_ptr<BloomFilter> bloom = getBloom(key, wrongType);
+    if(wrongType){
+        return WRONG_TYPE_MESSAGE;
+    }
+    return bloom != nullptr && bloom->contains(item) ? "(integer) 1" : "(integer) 0";
+}
+
+std::string RedisHelper::bfmexists(const std::string &key, const std::vector<std::string> &items){
+    bool wrongType = false;
+    std::shared_ptr<BloomFilter> bloom = getBloom(key, wrongType);
+    if(wrongType){
+        return WRONG_TYPE_MESSAGE;
+    }
+    ReplyBuilder reply;
+    for(const std::string &item : items){
+        reply.addFormatted(bloom != nullptr && bloom->contains(item) ? "(integer) 1" : "(integer) 0");
+    }
+    return reply.take();
+}
+
+/// @brief 创建指定初始容量的布谷鸟过滤器
+std::string RedisHelper::cfreserve(const std::string &key, uint64_t capacity){
+    if(dataBase->searchItem(key) != nullptr){
+        return "(error) ERR item exists";
+    }
+    addObject(key, std::make_shared<CuckooFilter>(capacity));
+    return "OK";
+}
+
+/// @brief 添加元素，同一个元素可以添加多次，键不存在时按默认容量创建
+std::string RedisHelper::cfadd(const std::string &key, const std::string &item){
+    bool wrongType = false;
+    std::shared_ptr<CuckooFilter> cuckoo = getCuckoo(key, wrongType, true);
+    if(wrongType){
+        return WRONG_TYPE_MESSAGE;
+    }
+    cuckoo->add(item);
+    return "(integer) 1";
+}
+
+/// @brief 元素不存在时才添加
+/// @return 是否添加
+std::string RedisHelper::cfaddnx(const std::string &key, const std::string &item){
+    bool wrongType = false;
+    std::shared_ptr<CuckooFilter> cuckoo = getCuckoo(key, wrongType, true);
+    if(wrongType){
+        return WRONG_TYPE_MESSAGE;
+    }
+    if(cuckoo->contains(item)){
+        return "(integer) 0";
+    }
+    cuckoo->add(item);
+    return "(integer) 1";
+}
+
+std::string RedisHelper::cfexists(const std::string &key, const std::string &item){
+    bool wrongType = false;
+    std::shared_ptr<CuckooFilter> cuckoo = getCuckoo(key, wrongType);
+    if(wrongType){
+        return WRONG_TYPE_MESSAGE;
+    }
+    return cuckoo != nullptr && cuckoo->contains(item) ? "(integer) 1" : "(integer) 0";
+}
+
+/// @brief 删除一次添加的元素，删空后保留过滤器，容量不变
+/// @return 是否找到并删除
+std::string RedisHelper::cfdel(const std::string &key, const std::string &item){
+    bool wrongType = false;
+    std::shared_ptr<CuckooFilter> cuckoo = getCuckoo(key, wrongType);
+    if(wrongType){
+        return WRONG_TYPE_MESSAGE;
+    }
+    return cuckoo != nullptr && cuckoo->remove(item) ? "(integer) 1" : "(integer) 0";
+}
+
+/// @brief 查找匹配模式的所有键
+/// 模式先编译，其中的字面量前缀用于在有序的键空间中直接定位到前缀区间，
+/// 遇到第一个不带前缀的键就停止，工作量与前缀区间的大小成正比，而不是数据库的大小
+/// @param pattern glob模式
+/// @return 按顺序排列的匹配键
+std::string RedisHelper::keys(const std::string pattern){
+    GlobPattern matcher(pattern);
+    const std::string &prefix = matcher.prefix();
+    std::vector<std::string> result;
+    if(matcher.isLiteral()){
+        //没有通配符，直接查找
+        if(dataBase->searchItem(prefix) != nullptr){
+            result.push_back(prefix);
+        }
+        return formatList(result);
+    }
+    dataBase->seekKeys(prefix, [&](const std::string &key){
+        if(key.compare(0, prefix.size(), prefix) != 0){
+            return false;
+        }
+        if(matcher.matchSuffix(key)){
+            result.push_back(key);
+        }
+        return true;
+    });
+    return formatList(result);
+}
+
+/// @brief 增量遍历当前数据库的键
+/// 游标是上一次返回的最后一个键，键空间是有序跳表，从游标之后顺序取count个键返回。
+/// 游标只会单调增大，所以整个遍历期间一直存在的键一定会被返回，且不会重复
+/// @param cursor 游标，"0"表示从头开始
+/// @param pattern 键需要匹配的模式，在访问之后过滤，所以一次可能返回少于count个键
+/// @param count 本次最多访问的键个数
+/// @return 下一次的游标和匹配的键，游标为"0"表示遍历结束
+std::string RedisHelper::scan(const std::string &cursor, const std::string &pattern, int count){
+    std::string lastKey;
+    bool fromStart = cursor == "0";
+    if(!fromStart && !decodeCursor(cursor, lastKey)){
+        return "(error) ERR invalid cursor";
+    }
+    if(count <= 0){
+        return "(error) ERR syntax error";
+    }
+    bool hasMore = false;
+    std::vector<std::string> candidates = scanKeys(lastKey, fromStart, count, hasMore);
+    GlobPattern matcher(pattern);
+    std::vector<std::string> matched;
+    for(const std::string &key : candidates){
+        if(matcher.match(key)){
+            matched.push_back(key);
+        }
+    }
+    std::string nextCursor = hasMore ? encodeCursor(candidates.back()) : "0";
+    return formatScanReply(nextCursor, matched);
+}
+
+/// @brief 从lastKey之后顺序取最多count个键
+std::vector<std::string> RedisHelper::scanKeys(const std::string &lastKey, bool fromStart, int count, bool &hasMore){
+    std::vector<std::string> keys = dataBase->scanKeys(lastKey, count, fromStart);
+    //取满了count个，说明后面可能还有键
+    hasMore = keys.size() == static_cast<size_t>(count);
+    return keys;
+}
+
+/// @brief 开启槽索引，已经开启时什么也不做
+void RedisHelper::enableSlotIndex(){
+    if(!slotIndex.empty()){
+        return;
+    }
+    slotIndex.resize(CLUSTER_SLOTS);
+    for(auto it=dataBase->begin(); it!=dataBase->end(); ++it){
+        slotIndex[keyHashSlot(it.key())].insert(it.key());
+    }
+}
+
+/// @brief 按字典序返回槽中的前count个键
+std::vector<std::string> RedisHelper::slotKeys(int slot, size_t count) const{
+    std::vector<std::string> keys;
+    if(slotIndex.empty()){
+        return keys;
+    }
+    for(auto it=slotIndex[slot].begin(); it!=slotIndex[slot].end() && keys.size() < count; ++it){
+        keys.push_back(*it);
+    }
+    return keys;
+}
+
+/// @brief 增量遍历哈希表的字段
+/// @param cursor 游标，"0"表示从头开始
+/// @param pattern 字段需要匹配的模式
+/// @param count 本次最多访问的桶个数
+/// @return 下一次的游标和匹配的字段、值
+std::string RedisHelper::hscan(const std::string &key, const std::string &cursor, const std::string &pattern, int count){
+    bool wrongType = false;
+    std::shared_ptr<CompactHash> hash = getHash(key, wrongType);
+    if(wrongType){
+        return WRONG_TYPE_MESSAGE;
+    }
+    size_t position = 0;
+    try{
+        size_t pos = 0;
+        position = std::stoull(cursor, &pos);
+        if(pos != cursor.size()){
+            return "(error) ERR invalid cursor";
+        }
+    }
+    catch(const std::exception &e){
+        return "(error) ERR invalid cursor";
+    }
+    if(count <= 0){
+        return "(error) ERR syntax error";
+    }
+    GlobPattern matcher(pattern);
+    std::vector<std::string> items;
+    size_t nextCursor = 0;
+    if(hash != nullptr){
+        nextCursor = hash->scan(position, count, [&](const std::string &field, const std::string &value){
+            if(matcher.match(field)){
+                items.push_back(field);
+                items.push_back(value);
+            }
+        });
+    }
+    return formatScanReply(std::to_string(nextCursor), items);
+}
+
+/// @brief 按字典序获取区间内的键
+/// 用lowerBound/upperBound定位起点，再用迭代器顺序读取
+/// @param limit 最多返回的键个数，负数表示不限制
+std::string RedisHelper::keyrange(const std::string &min, const std::string &max, long limit){
+    LexRange range;
+    if(!parseLexRange(min, max, range)){
+        return "(error) ERR min or max not valid string range item";
+    }
+    std::vector<std::string> result;
+    if(range.empty || limit == 0){
+        return formatList(result);
+    }
+    auto it = range.minInclusive ? dataBase->lowerBound(range.min) : dataBase->upperBound(range.min);
+    for(; it.valid() && range.contains(it.key()) && (limit < 0 || static_cast<long>(result.size()) < limit); ++it){
+        result.push_back(it.key());
+    }
+    return formatList(result);
+}
+
+/// @brief 统计字典序区间内的键个数
+std::string RedisHelper::keycount(const std::string &min, const std::string &max){
+    LexRange range;
+    if(!parseLexRange(min, max, range)){
+        return "(error) ERR min or max not valid string range item";
+    }
+    if(range.empty){
+        return "(integer) 0";
+    }
+    int count = dataBase->countRange(range.min, range.minInclusive, [&range](const std::string &key){ return range.contains(key); });
+    return "(integer) " + std::to_string(count);
+}
+
+/// @brief 删除字典序区间内的所有键，整段一次摘除
+/// @return 删除的键个数
+std::string RedisHelper::delrange(const std::string &min, const std::string &max){
+    LexRange range;
+    if(!parseLexRange(min, max, range)){
+        return "(error) ERR min or max not valid string range item";
+    }
+    if(range.empty){
+        return "(integer) 0";
+    }
+    std::vector<std::shared_ptr<SkipListNode<std::string, RedisObject>>> detached;
+    int count = dataBase->deleteRange(range.min, range.minInclusive, [&range](const std::string &key){ return range.contains(key); }, &detached);
+    forgetNodes(detached);
+    return "(integer) " + std::to_string(count);
+}
+
+/// @brief 删除以prefix开头的所有键
+/// @return 删除的键个数
+std::string RedisHelper::delprefix(const std::string &prefix){
+    std::vector<std::shared_ptr<SkipListNode<std::string, RedisObject>>> detached;
+    int count = dataBase->deleteRange(prefix, true, [&prefix](const std::string &key){ return key.compare(0, prefix.size(), prefix) == 0; }, &detached);
+    forgetNodes(detached);
+    return "(integer) " + std::to_string(count);
+}
+
+std::string RedisHelper::dbsize() const{
+    return "(integer) " + std::to_string(dataBase->size());
+}
+
+/// @brief 更改键名称，值原样移到新键上，新键已经存在时被覆盖
+std::string RedisHelper::rename(const std::string &oldName, const std::string &newName){
+    if(oldName == newName){
+        return dataBase->searchItem(oldName) == nullptr ? "(error) ERR no such key" : "OK";
+    }
+    std::vector<std::shared_ptr<SkipListNode<std::string, RedisObject>>> detached;
+    dataBase->deleteItems({oldName}, &detached);
+    if(detached.empty()){
+        return "(error) ERR no such key";
+    }
+    forgetNodes(detached);
+    setObject(newName, std::move(detached.front()->value));
+    return "OK";
+}
+
+/// @brief 统计存在的键个数，重复的键重复计数
+/// 用一次批量查找，按顺序共用一次遍历
+std::string RedisHelper::exists(const std::vector<std::string> &keys){
+    auto nodes = dataBase->searchItems(keys);
+    long count = std::count_if(nodes.begin(), nodes.end(), [](const auto &node){ return node != nullptr; });
+    return "(integer) " + std::to_string(count);
+}
+
+/// @brief 删除键，用一次批量删除
+/// @return 删除的键个数
+std::string RedisHelper::del(const std::vector<std::string> &keys){
+    std::vector<std::shared_ptr<SkipListNode<std::string, RedisObject>>> detached;
+    int count = dataBase->deleteItems(keys, &detached);
+    forgetNodes(detached);
+    return "(integer) " + std::to_string(count);
+}
+
+/// @brief 和DEL相同，但是值的析构不在请求线程上进行
+/// 在跳表锁内只把节点摘下来，大列表、大哈希、大有序集合交给后台线程释放
+/// @return 删除的键个数
+std::string RedisHelper::unlink(const std::vector<std::string> &keys){
+    std::vector<std::shared_ptr<SkipListNode<std::string, RedisObject>>> detached;
+    int count = dataBase->deleteItems(keys, &detached);
+    forgetNodes(detached);
+    releaseNodes(lazyFree, detached);
+    return "(integer) " + std::to_string(count);
+}
+
+/// @brief 清空数据库，换上空的跳表，旧的跳表按节点个数估计释放代价
+/// @param async 为false时在当前线程释放
+std::string RedisHelper::flushdb(bool async){
+    auto old = std::move(dataBase);
+    dataBase = std::make_shared<SkipList<std::string, RedisObject>>();
+    std::fill(std::begin(typeCounts), std::end(typeCounts), 0);
+    for(std::set<std::string> &keys : slotIndex){
+        keys.clear();
+    }
+    if(async){
+        //每个节点至少一次释放，值本身的代价不再逐个统计
+        //必须把唯一的引用交出去，否则后台线程先释放完时，析构会发生在这里
+        size_t effort = old->size();
+        lazyFree.release(std::move(old), effort);
+    }
+    return "OK";
+}
+
+std::string RedisHelper::flushall(bool async){
+    return flushdb(async);
+}
+
+std::string RedisHelper::keyspaceInfo(){
+    size_t keys = dataBase->size();
+    if(keys == 0){
+        return "";
+    }
+    return "db" + dataBaseIndex + ":keys=" + std::to_string(keys) + ",strings=" + std::to_string(typeCounts[TYPE_STRING]) +
+        ",lists=" + std::to_string(typeCounts[TYPE_LIST]) + ",hashes=" + std::to_string(typeCounts[TYPE_HASH]) +
+        ",zsets=" + std::to_string(typeCounts[TYPE_ZSET]) + ",hlls=" + std::to_string(typeCounts[TYPE_HLL]) +
+        ",blooms=" + std::to_string(typeCounts[TYPE_BLOOM]) + ",cuckoos=" + std::to_string(typeCounts[TYPE_CUCKOO]) + "\n";
+}
+
+/// @brief 字符串值的字节，数字等非字符串的值先转换成字符串放在buffer中
+static const std::string& stringBytes(const RedisValue &value, std::string &buffer){
+    if(value.is_string()){
+        return value.string_value();
+    }
+    buffer = value.dump();
+    return buffer;
+}
+
+/// @brief 值为字符串时返回它的字节，压缩保存的字符串解压到buffer中
+/// @return 不是字符串时返回nullptr
+static const std::string* stringBytes(const RedisObject &object, std::string &buffer){
+    const RedisValue *value = std::get_if<RedisValue>(&object);
+    if(value != nullptr){
+        return &stringBytes(*value, buffer);
+    }
+    const auto *raw = std::get_if<std::shared_ptr<std::string>>(&object);
+    if(raw != nullptr){
+        return raw->get();
+    }
+    const auto *compressed = std::get_if<std::shared_ptr<CompressedString>>(&object);
+    if(compressed == nullptr){
+        return nullptr;
+    }
+    buffer = (*compressed)->str();
+    return &buffer;
+}
+
+/// @brief 字符串的长度，压缩保存的字符串不需要解压
+/// @return 不是字符串时返回false
+static bool stringSize(const RedisObject &object, size_t &size){
+    const auto *compressed = std::get_if<std::shared_ptr<CompressedString>>(&object);
+    if(compressed != nullptr){
+        size = (*compressed)->size();
+        return true;
+    }
+    std::string buffer;
+    const std::string *bytes = stringBytes(object, buffer);
+    size = bytes == nullptr ? 0 : bytes->size();
+    return bytes != nullptr;
+}
+
+/// @brief 字符串中从first开始的count个字节，压缩保存的字符串只解压这些字节所在的帧，放在buffer中
+static const uint8_t* stringSlice(const RedisObject &object, size_t first, size_t count, std::string &buffer){
+    const auto *compressed = std::get_if<std::shared_ptr<CompressedString>>(&object);
+    if(compressed != nullptr){
+        buffer = (*compressed)->substr(first, count);
+        return reinterpret_cast<const uint8_t*>(buffer.data());
+    }
+    return reinterpret_cast<const uint8_t*>(stringBytes(object, buffer)->data()) + first;
+}
+
+/// @brief 按长度选择字符串的保存方式，达到STRING_COMPRESS_MIN_BYTES时压缩保存
+static RedisObject makeString(std::string value){
+    if(STRING_COMPRESS_MIN_BYTES > 0 && value.size() >= STRING_COMPRESS_MIN_BYTES){
+        return std::make_shared<CompressedString>(value);
+    }
+    return RedisValue(std::move(value));
+}
+
+/// @brief 批量存放键值，覆盖其他类型的同名键
+/// 按键排序后写入，插入位置都在上一个键之后，可以沿用上一次的搜索路径
+/// @param items 键和值交替排列 key value [key value ...]
+std::string RedisHelper::mset(std::vector<std::string> &items){
+    if(items.empty() || items.size() % 2 != 0){
+        return "(error) ERR wrong number of arguments for 'mset' command";
+    }
+    //同一个键出现多次时以最后一次为准
+    std::vector<std::pair<std::string, std::string>> pairs;
+    for(size_t i=0; i+1<items.size(); i+=2){
+        pairs.emplace_back(items[i], items[i+1]);
+    }
+    std::stable_sort(pairs.begin(), pairs.end(), [](const auto &a, const auto &b){ return a.first < b.first; });
+    std::vector<std::string> keys;
+    for(size_t i=0; i<pairs.size(); i++){
+        if(i+1 < pairs.size() && pairs[i].first == pairs[i+1].first){
+            continue;
+        }
+        if(keys.size() != i){
+            pairs[keys.size()] = std::move(pairs[i]);
+        }
+        keys.push_back(pairs[keys.size()].first);
+    }
+    pairs.resize(keys.size());
+    auto nodes = dataBase->searchItems(keys);
+    for(size_t i=0; i<pairs.size(); i++){
+        RedisObject value = makeString(std::move(pairs[i].second));
+        if(nodes[i] != nullptr){
+            replaceObject(nodes[i], std::move(value));
+        }
+        else{
+            addObject(pairs[i].first, std::move(value));
+        }
+    }
+    return "OK";
+}
+
+/// @brief 批量获取键值，不存在或者不是字符串的键返回(nil)
+/// 压缩保存的值只有在这里才解压
+std::string RedisHelper::mget(std::vector<std::string> &keys){
+    auto nodes = dataBase->searchItems(keys);
+    //先算出回复的大小，值从跳表节点直接追加到回复中，只分配一次
+    size_t bytes = 0;
+    for(const auto &node : nodes){
+        size_t len = NIL_MESSAGE.size();
+        if(node != nullptr){
+            const RedisValue *value = std::get_if<RedisValue>(&node->value);
+            const auto *compressed = std::get_if<std::shared_ptr<CompressedString>>(&node->value);
+            const auto *raw = std::get_if<std::shared_ptr<std::string>>(&node->value);
+            if(value != nullptr && value->is_string()){
+                len = value->string_value().size();
+            }
+            else if(compressed != nullptr){
+                len = (*compressed)->size();
+            }
+            else if(raw != nullptr){
+                len = (*raw)->size();
+            }
+        }
+        bytes += ReplyBuilder::bulkSize(len);
+    }
+    ReplyBuilder reply(bytes);
+    std::string buffer;
+    for(const auto &node : nodes){
+        const std::string *value = node == nullptr ? nullptr : stringBytes(node->value, buffer);
+        if(value != nullptr){
+            reply.addBulk(*value);
+        }
+        else{
+            reply.addNil();
+        }
+    }
+    return reply.take();
+}
+
+/// @brief 把可以是负数的区间下标转换成[start, end]，与GETRANGE相同
+/// @return 区间是否非空
+static bool normalizeRange(long &start, long &end, long len){
+    if(start < 0){
+        start += len;
+    }
+    if(end < 0){
+        end += len;
+    }
+    start = std::max(start, 0L);
+    end = std::min(std::max(end, 0L), len - 1);
+    return len > 0 && start <= end;
+}
+
+/// @brief 获取字符串的字节，普通字符串直接返回节点中的值，压缩保存的字符串解压到buffer中
+/// @return 键不存在时返回nullptr
+const std::string* RedisHelper::findString(const std::string &key, std::string &buffer, bool &wrongType){
+    wrongType = false;
+    auto node = dataBase->searchItem(key);
+    if(node == nullptr){
+        return nullptr;
+    }
+    const std::string *bytes = stringBytes(node->value, buffer);
+    wrongType = bytes == nullptr;
+    return bytes;
+}
+
+/// @brief 写入字符串，达到STRING_COMPRESS_MIN_BYTES时压缩保存，并删除另一种表示的同名键
+void RedisHelper::storeString(const std::string &key, std::string value){
+    setObject(key, makeString(std::move(value)));
+}
+
+/// @brief 位图命令使用的字符串，之后的SETBIT直接修改其中的字节，不再整体拷贝或者重新压缩
+std::shared_ptr<std::string> RedisHelper::getMutableString(const std::string &key){
+    auto node = dataBase->searchItem(key);
+    if(node == nullptr){
+        std::shared_ptr<std::string> value = std::make_shared<std::string>();
+        addObject(key, value);
+        return value;
+    }
+    const auto *raw = std::get_if<std::shared_ptr<std::string>>(&node->value);
+    if(raw != nullptr){
+        return *raw;
+    }
+    std::string buffer;
+    const std::string *bytes = stringBytes(node->value, buffer);
+    if(bytes == nullptr){
+        return nullptr;
+    }
+    std::shared_ptr<std::string> value = std::make_shared<std::string>(*bytes);
+    replaceObject(node, value);
+    return value;
+}
+
+/// @brief 设置字符串，覆盖任意类型的同名键
+/// @param model NX只在键不存在时设置，XX只在键存在时设置，不满足条件时回复(nil)
+std::string RedisHelper::set(const std::string& key, const RedisValue& value, const SET_MODEL model){
+    if(model != NONE){
+        bool exists = dataBase->searchItem(key) != nullptr;
+        if((model == NX && exists) || (model == XX && !exists)){
+            return NIL_MESSAGE;
+        }
+    }
+    std::string buffer;
+    storeString(key, stringBytes(value, buffer));
+    return "OK";
+}
+
+std::string RedisHelper::get(const std::string &key){
+    bool wrongType = false;
+    std::string buffer;
+    const std::string *value = findString(key, buffer, wrongType);
+    if(wrongType){
+        return WRONG_TYPE_MESSAGE;
+    }
+    if(value == nullptr){
+        return NIL_MESSAGE;
+    }
+    return "\"" + *value + "\"";
+}
+
+/// @brief 键不存在时才设置
+/// @return 设置了回复1，键已经存在回复0
+std::string RedisHelper::setnx(const std::string& key, const RedisValue& value){
+    if(dataBase->searchItem(key) != nullptr){
+        return "(integer) 0";
+    }
+    std::string buffer;
+    storeString(key, stringBytes(value, buffer));
+    return "(integer) 1";
+}
+
+/// @brief 字符串的整数值加上增量，键不存在时视为0，结果仍然保存为字符串
+/// @return 增加后的值
+std::string RedisHelper::incrby(const std::string &key, long long increment){
+    bool wrongType = false;
+    std::string buffer;
+    const std::string *value = findString(key, buffer, wrongType);
+    if(wrongType){
+        return WRONG_TYPE_MESSAGE;
+    }
+    long long number = 0;
+    if(value != nullptr && !parseInteger(*value, number)){
+        return "(error) ERR value is not an integer or out of range";
+    }
+    if((increment > 0 && number > LLONG_MAX - increment) || (increment < 0 && number < LLONG_MIN - increment)){
+        return "(error) ERR increment or decrement would overflow";
+    }
+    number += increment;
+    storeString(key, std::to_string(number));
+    return "(integer) " + std::to_string(number);
+}
+
+std::string RedisHelper::incr(const std::string &key){
+    return incrby(key, 1);
+}
+
+std::string RedisHelper::decr(const std::string &key){
+    return incrby(key, -1);
+}
+
+std::string RedisHelper::decrby(const std::string &key, long long increment){
+    if(increment == LLONG_MIN){
+        return "(error) ERR decrement would overflow";
+    }
+    return incrby(key, -increment);
+}
+
+/// @brief 字符串的浮点数值加上增量，键不存在时视为0
+/// @return 增加后的值，整数不带小数点
+std::string RedisHelper::incrbyfloat(const std::string &key, double increment){
+    bool wrongType = false;
+    std::string buffer;
+    const std::string *value = findString(key, buffer, wrongType);
+    if(wrongType){
+        return WRONG_TYPE_MESSAGE;
+    }
+    double number = 0;
+    if(value != nullptr && (!parseScore(*value, number) || std::isinf(number))){
+        return "(error) ERR value is not a valid float";
+    }
+    number += increment;
+    if(std::isnan(number) || std::isinf(number)){
+        return "(error) ERR increment would produce NaN or Infinity";
+    }
+    std::string result = formatScore(number);
+    storeString(key, result);
+    return "\"" + result + "\"";
+}
+
+/// @brief 字符串的长度，压缩保存的字符串直接返回记录的长度
+std::string RedisHelper::strlen(const std::string& key){
+    auto node = dataBase->searchItem(key);
+    if(node == nullptr){
+        return "(integer) 0";
+    }
+    const auto *compressed = std::get_if<std::shared_ptr<CompressedString>>(&node->value);
+    if(compressed != nullptr){
+        return "(integer) " + std::to_string((*compressed)->size());
+    }
+    std::string buffer;
+    const std::string *bytes = stringBytes(node->value, buffer);
+    if(bytes == nullptr){
+        return WRONG_TYPE_MESSAGE;
+    }
+    return "(integer) " + std::to_string(bytes->size());
+}
+
+/// @brief 追加内容，键不存在时相当于SET
+/// 压缩保存的字符串原地追加，只解压最后一帧；位图命令写入的字符串原地追加；普通字符串追加后达到阈值时转为压缩保存
+/// @return 追加后的长度
+std::string RedisHelper::append(const std::string &key, const std::string &value){
+    auto node = dataBase->searchItem(key);
+    if(node == nullptr){
+        addObject(key, makeString(value));
+        return "(integer) " + std::to_string(value.size());
+    }
+    const auto *compressed = std::get_if<std::shared_ptr<CompressedString>>(&node->value);
+    if(compressed != nullptr){
+        (*compressed)->append(value);
+        return "(integer) " + std::to_string((*compressed)->size());
+    }
+    const auto *raw = std::get_if<std::shared_ptr<std::string>>(&node->value);
+    if(raw != nullptr){
+        (*raw)->append(value);
+        return "(integer) " + std::to_string((*raw)->size());
+    }
+    std::string buffer;
+    const std::string *bytes = stringBytes(node->value, buffer);
+    if(bytes == nullptr){
+        return WRONG_TYPE_MESSAGE;
+    }
+    std::string result = *bytes + value;
+    size_t len = result.size();
+    replaceObject(node, makeString(std::move(result)));
+    return "(integer) " + std::to_string(len);
+}
+
+/// @brief 设置一位，字符串第一次被SETBIT修改时转换成可以原地修改的表示，之后只修改一个字节
+/// @return 这一位原来的值
+std::string RedisHelper::setbit(const std::string &key, uint64_t offset, int bit){
+    std::shared_ptr<std::string> value = getMutableString(key);
+    if(value == nullptr){
+        return WRONG_TYPE_MESSAGE;
+    }
+    size_t index = offset / 8;
+    uint8_t mask = 0x80 >> (offset % 8);
+    if(value->size() <= index){
+        value->resize(index + 1, '\0');
+    }
+    char &byte = (*value)[index];
+    int old = (static_cast<uint8_t>(byte) & mask) != 0;
+    byte = bit ? (byte | mask) : (byte & ~mask);
+    return "(integer) " + std::to_string(old);
+}
+
+std::string RedisHelper::getbit(const std::string &key, uint64_t offset){
+    auto node = dataBase->searchItem(key);
+    if(node == nullptr){
+        return "(integer) 0";
+    }
+    size_t size = 0;
+    if(!stringSize(node->value, size)){
+        return WRONG_TYPE_MESSAGE;
+    }
+    size_t index = offset / 8;
+    std::string buffer;
+    int bit = index < size && (*stringSlice(node->value, index, 1, buffer) & (0x80 >> (offset % 8))) != 0;
+    return "(integer) " + std::to_string(bit);
+}
+
+/// @brief 统计区间内1的个数，普通字符串直接在节点保存的字节上计算，压缩保存的字符串只解压区间涉及的帧
+/// @param bitUnit 区间的单位是位还是字节
+std::string RedisHelper::bitcount(const std::string &key, long start, long end, bool bitUnit){
+    auto node = dataBase->searchItem(key);
+    if(node == nullptr){
+        return "(integer) 0";
+    }
+    size_t size = 0;
+    if(!stringSize(node->value, size)){
+        return WRONG_TYPE_MESSAGE;
+    }
+    long len = bitUnit ? size * 8 : size;
+    if(!normalizeRange(start, end, len)){
+        return "(integer) 0";
+    }
+    size_t firstByte = bitUnit ? start / 8 : start;
+    size_t lastByte = bitUnit ? end / 8 : end;
+    std::string buffer;
+    const uint8_t *data = stringSlice(node->value, firstByte, lastByte - firstByte + 1, buffer);
+    uint64_t count = bitUnit ? bitmapCountBits(data, start - firstByte * 8, end - firstByte * 8) : bitmapCount(data, lastByte - firstByte + 1);
+    return "(integer) " + std::to_string(count);
+}
+
+/// @brief 查找区间内第一个值为bit的位，压缩保存的字符串只解压区间涉及的帧
+/// 找0时没有指定end且区间内全是1，回复区间之后的第一位，即把字符串看作右边无限补0
+std::string RedisHelper::bitpos(const std::string &key, int bit, long start, long end, bool endGiven, bool bitUnit){
+    auto node = dataBase->searchItem(key);
+    if(node == nullptr){
+        return bit ? "(integer) -1" : "(integer) 0";
+    }
+    size_t size = 0;
+    if(!stringSize(node->value, size)){
+        return WRONG_TYPE_MESSAGE;
+    }
+    long len = bitUnit ? size * 8 : size;
+    if(!normalizeRange(start, end, len)){
+        return "(integer) -1";
+    }
+    uint64_t first = bitUnit ? start : start * 8;
+    uint64_t last = bitUnit ? end : end * 8 + 7;
+    size_t firstByte = first / 8;
+    std::string buffer;
+    const uint8_t *data = stringSlice(node->value, firstByte, last / 8 - firstByte + 1, buffer);
+    int64_t pos = bitmapFindBit(data, first - firstByte * 8, last - firstByte * 8, bit);
+    if(pos >= 0){
+        pos += firstByte * 8;
+    }
+    else if(bit == 0 && !endGiven){
+        pos = last + 1;
+    }
+    return "(integer) " + std::to_string(pos);
+}
+
+/// @brief 按位运算，较短的字符串看作右边补0，结果为空时删除destKey
+/// 源字符串直接从节点读取（压缩保存的先解压），结果需要一块新的缓冲区
+/// @return 结果字符串的长度
+std::string RedisHelper::bitop(BitmapOp op, const std::string &destKey, const std::vector<std::string> &keys){
+    std::vector<std::string> buffers(keys.size());
+    std::vector<const std::string*> sources;
+    size_t maxLen = 0;
+    for(size_t i=0; i<keys.size(); i++){
+        bool wrongType = false;
+        const std::string *found = findString(keys[i], buffers[i], wrongType);
+        if(wrongType){
+            return WRONG_TYPE_MESSAGE;
+        }
+        sources.push_back(found == nullptr ? &buffers[i] : found);
+        maxLen = std::max(maxLen, sources.back()->size());
+    }
+    std::string result(maxLen, '\0');
+    uint8_t *dst = reinterpret_cast<uint8_t*>(&result[0]);
+    if(op == BITMAP_NOT){
+        bitmapOp(op, dst, reinterpret_cast<const uint8_t*>(sources[0]->data()), maxLen);
+    }
+    else{
+        std::memcpy(dst, sources[0]->data(), sources[0]->size());
+        for(size_t i=1; i<sources.size(); i++){
+            size_t len = sources[i]->size();
+            bitmapOp(op, dst, reinterpret_cast<const uint8_t*>(sources[i]->data()), len);
+            if(op == BITMAP_AND && len < maxLen){
+                std::memset(dst + len, 0, maxLen - len);
+            }
+        }
+    }
+    //结果覆盖任意类型的destKey，保存为位图命令使用的表示
+    if(maxLen == 0){
+        removeKey(destKey);
+    }
+    else{
+        setObject(destKey, std::make_shared<std::string>(std::move(result)));
+    }
+    return "(integer) " + std::to_string(maxLen);
+}
+
+//二进制的编码转换成十六进制，命令按空白分隔参数
+static std::string hexEncode(const std::string &data){
+    static const char digits[] = "0123456789abcdef";
+    std::string hex;
+    hex.reserve(data.size() * 2);
+    for(unsigned char c : data){
+        hex += digits[c >> 4];
+        hex += digits[c & 0xf];
+    }
+    return hex;
+}
+
+static bool hexDecode(const std::string &hex, std::string &data){
+    if(hex.size() % 2 != 0){
+        return false;
+    }
+    auto value = [](char c){
+        return c >= '0' && c <= '9' ? c - '0' : c >= 'a' && c <= 'f' ? c - 'a' + 10 : -1;
+    };
+    data.clear();
+    data.reserve(hex.size() / 2);
+    for(size_t i=0; i<hex.size(); i+=2){
+        int high = value(hex[i]), low = value(hex[i+1]);
+        if(high < 0 || low < 0){
+            return false;
+        }
+        data += static_cast<char>(high << 4 | low);
+    }
+    return true;
+}
+
+//复制和迁移按空白分隔参数、按换行分隔命令，包含这些字节的字符串不能直接写在SET中
+static bool isPlainText(const std::string &value){
+    if(value.empty()){
+        return false;
+    }
+    for(unsigned char c : value){
+        if(c <= ' ' || c == 0x7f){
+            return false;
+        }
+    }
+    return true;
+}
+
+/// @brief 生成重建一个值的命令：字符串用SET，列表用RPUSH，哈希用HSET，有序集合用ZADD，HyperLogLog和过滤器用RESTORE
+/// 包含空白或者控制字符的字符串（SETBIT、BITOP的结果）用RESTORE raw按十六进制传输
+static std::string dumpString(const std::string &key, const std::string &bytes){
+    if(!isPlainText(bytes)){
+        return "restore " + key + " raw " + hexEncode(bytes);
+    }
+    return "set " + key + " " + bytes;
+}
+
+static std::string dumpValue(const std::string &key, const RedisValue &value){
+    std::string buffer;
+    return dumpString(key, stringBytes(value, buffer));
+}
+
+static std::string dumpValue(const std::string &key, const std::shared_ptr<std::string> &value){
+    return dumpString(key, *value);
+}
+
+static std::string dumpValue(const std::string &key, const std::shared_ptr<QuickList> &list){
+    std::string command = "rpush " + key;
+    for(const std::string &item : list->range(0, -1)){
+        command += " " + item;
+    }
+    return command;
+}
+
+static std::string dumpValue(const std::string &key, const std::shared_ptr<CompactHash> &hash){
+    std::string command = "hset " + key;
+    hash->forEach([&command](const std::string &field, const std::string &value){
+        command += " " + field + " " + value;
+        return true;
+    });
+    return command;
+}
+
+static std::string dumpValue(const std::string &key, const std::shared_ptr<SortedSet> &zset){
+    std::string command = "zadd " + key;
+    for(const auto &item : zset->rangeByIndex(0, -1)){
+        command += " " + formatScore(item.second) + " " + item.first;
+    }
+    return command;
+}
+
+//压缩保存的字符串直接输出压缩后的帧，快照中同样是压缩的
+static std::string dumpValue(const std::string &key, const std::shared_ptr<CompressedString> &value){
+    return "restore " + key + " string " + hexEncode(value->serialize());
+}
+
+static std::string dumpValue(const std::string &key, const std::shared_ptr<HyperLogLog> &hll){
+    return "restore " + key + " hll " + hexEncode(hll->serialize());
+}
+
+static std::string dumpValue(const std::string &key, const std::shared_ptr<BloomFilter> &bloom){
+    return "restore " + key + " bloom " + hexEncode(bloom->serialize());
+}
+
+static std::string dumpValue(const std::string &key, const std::shared_ptr<CuckooFilter> &cuckoo){
+    return "restore " + key + " cuckoo " + hexEncode(cuckoo->serialize());
+}
+
+static std::string dumpObject(const std::string &key, const RedisObject &object){
+    return std::visit([&key](const auto &value){ return dumpValue(key, value); }, object);
+}
+
+std::vector<std::string> RedisHelper::dump(const std::vector<std::string> &keys){
+    std::vector<std::string> commands;
+    for(const auto &node : dataBase->searchItems(keys)){
+        if(node != nullptr){
+            commands.push_back(dumpObject(node->key, node->value));
+        }
+    }
+    return commands;
+}
+
+std::string RedisHelper::restore(const std::string &key, const std::string &type, const std::string &payload){
+    std::string data;
+    if(!hexDecode(payload, data)){
+        return "(error) ERR Bad data format";
+    }
+    RedisObject object;
+    if(type == "hll"){
+        std::shared_ptr<HyperLogLog> hll = std::make_shared<HyperLogLog>();
+        if(!hll->deserialize(data)){
+            return "(error) ERR Bad data format";
+        }
+        object = hll;
+    }
+    else if(type == "string"){
+        std::shared_ptr<CompressedString> value = std::make_shared<CompressedString>();
+        if(!value->deserialize(data)){
+            return "(error) ERR Bad data format";
+        }
+        object = value;
+    }
+    else if(type == "raw"){
+        object = makeString(std::move(data));
+    }
+    else if(type == "bloom"){
+        std::shared_ptr<BloomFilter> bloom = std::make_shared<BloomFilter>();
+        if(!bloom->deserialize(data)){
+            return "(error) ERR Bad data format";
+        }
+        object = bloom;
+    }
+    else if(type == "cuckoo"){
+        std::shared_ptr<CuckooFilter> cuckoo = std::make_shared<CuckooFilter>();
+        if(!cuckoo->deserialize(data)){
+            return "(error) ERR Bad data format";
+        }
+        object = cuckoo;
+    }
+    else{
+        return "(error) ERR Bad data format";
+    }
+    setObject(key, std::move(object));
+    return "OK";
+}
+
+RedisHelper::RedisHelper(){
+    loadData(getFilePath());
+}
+
+RedisHelper::~RedisHelper(){
+}
+
+/// @brief 当前数据库的文件，每个数据库一个
+std::string RedisHelper::getFilePath(){
+    return std::string(SAVE_PATH) + "_" + dataBaseIndex;
+}
+
+/// @brief 把当前数据库写入文件，每行一条重建键的命令（与dump相同）
+/// 先写临时文件再改名，写到一半退出时原来的文件不受影响
+void RedisHelper::flush(){
+    std::string path = getFilePath();
+    std::string tempPath = path + ".tmp";
+    std::ofstream ofs(tempPath, std::ios::trunc);
+    if(!ofs.is_open()){
+        std::cout<<"cannot open "<<tempPath<<std::endl;
+        return;
+    }
+    for(auto it=dataBase->begin(); it!=dataBase->end(); ++it){
+        ofs<<dumpObject(it.key(), it.value())<<"\n";
+    }
+    ofs.close();
+    if(!ofs || std::rename(tempPath.c_str(), path.c_str()) != 0){
+        std::cout<<"cannot write "<<path<<std::endl;
+    }
+}
+
+/// @brief 从文件加载数据库，文件不存在时数据库为空
+void RedisHelper::loadData(std::string loadPath){
+    std::ifstream ifs(loadPath);
+    std::string line;
+    while(std::getline(ifs, line)){
+        std::istringstream iss(line);
+        std::vector<std::string> tokens;
+        std::string token;
+        while(iss >> token){
+            tokens.push_back(token);
+        }
+        if(tokens.size() >= 3){
+            replay(tokens);
+        }
+    }
+}
+
+/// @brief 执行flush写出的命令，只有dump会生成的几种
+void RedisHelper::replay(const std::vector<std::string> &tokens){
+    const std::string &command = tokens[0];
+    const std::string &key = tokens[1];
+    if(command == "set" && tokens.size() == 3){
+        storeString(key, tokens[2]);
+    }
+    else if(command == "rpush"){
+        for(size_t i=2; i<tokens.size(); i++){
+            rpush(key, tokens[i]);
+        }
+    }
+    else if(command == "hset"){
+        hset(key, std::vector<std::string>(tokens.begin()+2, tokens.end()));
+    }
+    else if(command == "zadd"){
+        zadd(key, std::vector<std::string>(tokens.begin()+2, tokens.end()));
+    }
+    else if(command == "restore" && tokens.size() == 4){
+        restore(key, tokens[2], tokens[3]);
+    }
+}
+
+/// @brief 切换数据库：当前数据库写入文件后清空，再加载新数据库的文件
+std::string RedisHelper::select(int index){
+    if(index < 0 || index >= DATABASE_COUNT){
+        return "(error) ERR DB index is out of range";
+    }
+    std::string newIndex = std::to_string(index);
+    if(newIndex == dataBaseIndex){
+        return "OK";
+    }
+    flush();
+    flushdb(true);
+    dataBaseIndex = newIndex;
+    loadData(getFilePath());
+    return "OK";
+}
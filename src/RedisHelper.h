@@ -2,9 +2,28 @@
 #define REDISHELPER_H
 
 #include <memory>
+#include <variant>
+#include <set>
 
 #include "global.h"
+#include "LazyFree.h"
+#include "ClusterSlots.h"
 #include "dataStructure/SkipList.h" 
+#include "dataStructure/QuickList.h"
+#include "dataStructure/CompactHash.h"
+#include "dataStructure/SortedSet.h"
+#include "dataStructure/Bitmap.h"
+#include "dataStructure/HyperLogLog.h"
+#include "dataStructure/BloomFilter.h"
+#include "dataStructure/CuckooFilter.h"
+#include "dataStructure/CompressedString.h"
+
+//键空间中的值，一个键只在一个跳表中出现一次，类型由备选类型决定
+//字符串有三种表示：RedisValue，达到STRING_COMPRESS_MIN_BYTES后压缩保存的CompressedString，
+//以及位图命令写入的std::string，可以原地修改，不压缩
+typedef std::variant<RedisValue, std::shared_ptr<CompressedString>, std::shared_ptr<QuickList>, std::shared_ptr<CompactHash>,
+    std::shared_ptr<SortedSet>, std::shared_ptr<HyperLogLog>, std::shared_ptr<BloomFilter>, std::shared_ptr<CuckooFilter>,
+    std::shared_ptr<std::string>> RedisObject;
 
 class RedisHelper{
 public:
@@ -13,14 +32,40 @@ public:
 
 public:
     void flush(); //写入文件 
-    //选择数据库
+    //选择数据库，先把当前数据库写入文件，再从文件加载新的数据库
     std::string select(int index);
 
     // key操作命令
     std::string keys(const std::string pattern="*");
 
+    // 增量遍历键，游标为上一次返回的最后一个键，每次最多访问count个键
+    std::string scan(const std::string &cursor, const std::string &pattern="*", int count=SCAN_DEFAULT_COUNT);
+    // 按顺序返回lastKey之后（fromStart为true时从头开始）的最多count个键，hasMore返回后面是否可能还有键
+    std::vector<std::string> scanKeys(const std::string &lastKey, bool fromStart, int count, bool &hasMore);
+    // 开启按哈希槽的键索引，集群模式下使用，开启时为已有的键建立索引，之后随键空间的修改一起维护
+    void enableSlotIndex();
+    // 返回槽中的最多count个键，需要先开启槽索引
+    std::vector<std::string> slotKeys(int slot, size_t count) const;
+
+    // 按字典序区间操作键，区间边界格式与ZRANGEBYLEX相同：[a 闭区间，(a 开区间，- 最小，+ 最大
+    // KEYRANGE min max [LIMIT count]：按顺序获取区间内的键。
+    // KEYCOUNT min max：统计区间内的键个数。
+    // DELRANGE min max：删除区间内的所有键。
+    // DELPREFIX prefix：删除以prefix开头的所有键。
+    std::string keyrange(const std::string &min, const std::string &max, long limit=-1);
+    std::string keycount(const std::string &min, const std::string &max);
+    std::string delrange(const std::string &min, const std::string &max);
+    std::string delprefix(const std::string &prefix);
+
     // 获取键总数
     std::string dbsize()const;
+    // INFO keyspace：db0:keys=,strings=,lists=,hashes=,zsets=,hlls=,blooms=,cuckoos=，没有键时为空
+    std::string keyspaceInfo();
+    // 设置之后新建的哈希使用的紧凑编码阈值，字段个数超过maxEntries或者字段、值的长度超过maxValue时转为哈希表
+    // 已有的哈希不受影响
+    void setHashPacking(size_t maxEntries, size_t maxValue);
+    // 等待后台线程释放的对象个数
+    size_t lazyfreePending() const { return lazyFree.pending(); }
 
     // 查询键是否存在
     std::string exists(const std::vector<std::string>&keys);
@@ -28,6 +73,24 @@ public:
     // 删除键
     std::string del(const std::vector<std::string>&keys);
 
+    // 删除键，只在请求线程上摘除，较大的值交给后台线程释放
+    std::string unlink(const std::vector<std::string>&keys);
+
+    // 清空数据库，async为true时整个数据库交给后台线程释放
+    // 内存中只保存当前数据库，FLUSHALL和FLUSHDB效果相同
+    std::string flushdb(bool async=false);
+    std::string flushall(bool async=false);
+
+    // 生成能重建指定键的命令，每个键一条，不存在的键跳过，用于迁移哈希槽和分批生成全量同步的快照
+    std::vector<std::string> dump(const std::vector<std::string> &keys);
+    // RESTORE key type payload：用dump生成的编码重建一个值，覆盖已有的键
+    // 用于没有对应写命令可以重建的类型，type为hll、bloom、cuckoo、string（压缩保存的字符串）
+    // 或raw（包含空白、控制字符的字符串，原样的字节），payload是值编码的十六进制
+    std::string restore(const std::string &key, const std::string &type, const std::string &payload);
+
+    //获取键对应的值类型
+    VALUE_TYPE getType(const std::string &key);
+
     // 更改键名称
     std::string rename(const std::string&oldName,const std::string&newName);
 
@@ -36,21 +99,19 @@ public:
 
     std::string setnx(const std::string& key, const RedisValue& value);
 
-    std::string setex(const std::string& key, const RedisValue& value);
-
     // 获取键值
     std::string get(const std::string &key);
     // 值递增/递减
     std::string incr(const std::string &key);
 
-    std::string incrby(const std::string &key,int increment);
+    std::string incrby(const std::string &key,long long increment);
 
     std::string incrbyfloat(const std::string &key,double increment);
 
     // 同样，递减使用decr、decrby命令。
     std::string decr(const std::string &key);
 
-    std::string decrby(const std::string &key,int increment);
+    std::string decrby(const std::string &key,long long increment);
 
     // 批量存放键值
     std::string mset(std::vector<std::string> &items);  
@@ -58,17 +119,33 @@ public:
     // 获取获取键值
     std::string mget(std::vector<std::string> &keys);
 
-    // 获取值长度
+    // 获取值长度，压缩保存的字符串不需要解压
     std::string strlen(const std::string& key);
 
-    // 追加内容
+    // 追加内容，压缩保存的字符串只解压最后一帧
     std::string append(const std::string &key,const std::string &value);
+
+    //位图操作，位图就是字符串，第0位是第一个字节的最高位
+    // SETBIT key offset value：设置一位，字符串不够长时用0补齐，回复原来的值。
+    // GETBIT key offset：获取一位，超出字符串长度的位为0。
+    // BITCOUNT key [start end [BYTE|BIT]]：统计区间内1的个数，区间可以是负数下标，默认按字节。
+    // BITPOS key bit [start [end [BYTE|BIT]]]：查找区间内第一个0或1。
+    // BITOP AND|OR|XOR|NOT destkey key [key ...]：按位运算，结果存入destkey，回复结果的长度。
+    std::string setbit(const std::string &key, uint64_t offset, int bit);
+    std::string getbit(const std::string &key, uint64_t offset);
+    std::string bitcount(const std::string &key, long start=0, long end=-1, bool bitUnit=false);
+    std::string bitpos(const std::string &key, int bit, long start=0, long end=-1, bool endGiven=false, bool bitUnit=false);
+    std::string bitop(BitmapOp op, const std::string &destKey, const std::vector<std::string> &keys);
     
     //列表操作
     std::string lpush(const std::string &key,const std::string &value);
     std::string rpush(const std::string &key,const std::string &value);
     std::string lpop(const std::string &key);
     std::string rpop(const std::string &key);
+    //从source的一端弹出元素并压入destination的一端，wherefrom/whereto为left或right
+    std::string lmove(const std::string &source, const std::string &destination, const std::string &wherefrom, const std::string &whereto);
+    //按顺序从第一个非空列表弹出元素，回复键和元素，都为空时回复nil，阻塞由RedisServer处理
+    std::string bpop(const std::vector<std::string> &keys, bool left);
     std::string lrange(const std::string &key, const std::string &start, const std::string &end);
 
     //哈希表操作
@@ -77,20 +154,111 @@ public:
     // HDEL key field：删除哈希表 key 中的一个或多个指定字段。
     // HKEYS key：获取哈希表中的所有字段名。
     // HVALS key：获取哈希表中的所有值。
+    // HGETALL key：获取哈希表中的所有字段和值。
+    // HMGET key field [field ...]：获取多个字段的值。
+    // HINCRBY key field increment：字段的整数值加上增量。
+    // HLEN key：获取哈希表中字段的数量。
     std::string hset(const std::string &key, const std::vector<std::string> &filed);
     std::string hget(const std::string &key, const std::string &filed);
     std::string hdel(const std::string &key, const std::vector<std::string> &filed);
     std::string hkeys(const std::string &key);
     std::string hvals(const std::string &key);
+    std::string hgetall(const std::string &key);
+    std::string hmget(const std::string &key, const std::vector<std::string> &filed);
+    std::string hincrby(const std::string &key, const std::string &filed, long long increment);
+    std::string hlen(const std::string &key);
+    // HSCAN key cursor [MATCH pattern] [COUNT count]：增量遍历哈希表。
+    std::string hscan(const std::string &key, const std::string &cursor, const std::string &pattern="*", int count=SCAN_DEFAULT_COUNT);
+
+    //有序集合操作
+    // ZADD key score member [score member ...]：添加成员或更新分数。
+    // ZREM key member [member ...]：删除成员。
+    // ZSCORE key member：获取成员的分数。
+    // ZINCRBY key increment member：成员的分数加上增量。
+    // ZCARD key：获取成员个数。
+    // ZRANK/ZREVRANK key member：获取成员按分数升序/降序的排名。
+    // ZRANGE/ZREVRANGE key start stop [WITHSCORES]：按排名升序/降序获取区间内的成员。
+    // ZRANGEBYSCORE key min max [WITHSCORES] [LIMIT offset count]：获取分数区间内的成员。
+    std::string zadd(const std::string &key, const std::vector<std::string> &items);
+    std::string zrem(const std::string &key, const std::vector<std::string> &members);
+    std::string zscore(const std::string &key, const std::string &member);
+    std::string zincrby(const std::string &key, double increment, const std::string &member);
+    std::string zcard(const std::string &key);
+    std::string zrank(const std::string &key, const std::string &member);
+    std::string zrevrank(const std::string &key, const std::string &member);
+    std::string zrange(const std::string &key, long start, long end, bool withScores=false);
+    std::string zrevrange(const std::string &key, long start, long end, bool withScores=false);
+    std::string zrangebyscore(const std::string &key, const std::string &min, const std::string &max,
+        bool withScores=false, long offset=0, long count=-1);
+
+    //HyperLogLog操作
+    // PFADD key [element ...]：添加元素，有寄存器改变或者新建了键时回复1。
+    // PFCOUNT key [key ...]：估计基数，多个键时估计并集的基数。
+    // PFMERGE destkey [sourcekey ...]：把所有源合并到destkey，destkey原来的值也参与合并。
+    std::string pfadd(const std::string &key, const std::vector<std::string> &elements);
+    std::string pfcount(const std::vector<std::string> &keys);
+    std::string pfmerge(const std::string &destKey, const std::vector<std::string> &keys);
+
+    //布隆过滤器操作，可能误判存在，不会误判不存在
+    // BF.RESERVE key error_rate capacity：创建过滤器，写满后自动扩容。
+    // BF.ADD key item / BF.MADD key item [item ...]：添加元素，原来不存在时回复1。
+    // BF.EXISTS key item / BF.MEXISTS key item [item ...]：元素是否可能存在。
+    std::string bfreserve(const std::string &key, double errorRate, uint64_t capacity);
+    std::string bfadd(const std::string &key, const std::string &item);
+    std::string bfmadd(const std::string &key, const std::vector<std::string> &items);
+    std::string bfexists(const std::string &key, const std::string &item);
+    std::string bfmexists(const std::string &key, const std::vector<std::string> &items);
+
+    //布谷鸟过滤器操作，和布隆过滤器相比支持删除
+    // CF.RESERVE key capacity：创建过滤器，写满后自动扩容。
+    // CF.ADD key item：添加元素，可以重复添加。
+    // CF.ADDNX key item：元素不存在时才添加。
+    // CF.EXISTS key item：元素是否可能存在。
+    // CF.DEL key item：删除一次添加的元素。
+    std::string cfreserve(const std::string &key, uint64_t capacity);
+    std::string cfadd(const std::string &key, const std::string &item);
+    std::string cfaddnx(const std::string &key, const std::string &item);
+    std::string cfexists(const std::string &key, const std::string &item);
+    std::string cfdel(const std::string &key, const std::string &item);
 
 private:
     //从文件中加载数据  持久性保存数据
     void loadData(std::string loadPath);  
     std::string getFilePath();
+    //执行一条flush写出的命令，用于从文件加载
+    void replay(const std::vector<std::string> &tokens);
+    //获取T类型的值，只查找一次；键存在但类型不对时wrongType为true，不存在且create为true时用args创建
+    template <typename T, typename... Args>
+    std::shared_ptr<T> getObject(const std::string &key, bool &wrongType, bool create, Args&&... args);
+    std::shared_ptr<QuickList> getList(const std::string &key, bool &wrongType, bool create=false);
+    std::shared_ptr<CompactHash> getHash(const std::string &key, bool &wrongType, bool create=false);
+    std::shared_ptr<SortedSet> getZSet(const std::string &key, bool &wrongType, bool create=false);
+    std::shared_ptr<HyperLogLog> getHyperLogLog(const std::string &key, bool &wrongType, bool create=false);
+    std::shared_ptr<BloomFilter> getBloom(const std::string &key, bool &wrongType, bool create=false);
+    std::shared_ptr<CuckooFilter> getCuckoo(const std::string &key, bool &wrongType, bool create=false);
+    //获取字符串的字节，压缩保存的字符串解压到buffer中，键不存在或者不是字符串时返回nullptr，不是字符串时wrongType为true
+    const std::string* findString(const std::string &key, std::string &buffer, bool &wrongType);
+    //写入字符串，按长度选择是否压缩保存，覆盖任意类型的同名键
+    void storeString(const std::string &key, std::string value);
+    //获取可以原地修改的字符串，其他表示的字符串转换一次，键不存在时创建空字符串，不是字符串时返回nullptr
+    std::shared_ptr<std::string> getMutableString(const std::string &key);
+    //键空间的修改都经过这几个函数，同时维护各类型的键个数
+    void addObject(const std::string &key, RedisObject object);
+    void replaceObject(const std::shared_ptr<SkipListNode<std::string, RedisObject>> &node, RedisObject object);
+    void setObject(const std::string &key, RedisObject object);
+    bool removeKey(const std::string &key);
+    void forgetNodes(const std::vector<std::shared_ptr<SkipListNode<std::string, RedisObject>>> &nodes);
+    //把多个HyperLogLog的寄存器合并到展开的数组中，有键不是HyperLogLog时返回false
+    bool mergeRegisters(const std::vector<std::string> &keys, uint8_t *registers);
 
 private:
+    LazyFree lazyFree; //把大对象交给后台线程释放
     std::string dataBaseIndex = "0"; //当前的数据库索引
-    std::shared_ptr<SkipList<std::string, RedisValue>> redisDataBase =  std::make_shared<SkipList<std::string, RedisValue>>();
+    std::shared_ptr<SkipList<std::string, RedisObject>> dataBase = std::make_shared<SkipList<std::string, RedisObject>>();
+    size_t typeCounts[TYPE_CUCKOO + 1] = {};    //各类型的键个数，用于INFO keyspace
+    std::vector<std::set<std::string>> slotIndex;   //每个槽中的键，没有开启时为空
+    size_t hashMaxPackedEntries = HASH_MAX_PACKED_ENTRIES;   //新建哈希的紧凑编码阈值
+    size_t hashMaxPackedValue = HASH_MAX_PACKED_VALUE;
 };
 
 
@@ -1,9 +1,23 @@
 #include"RedisServer.h"
+#include "RPC/ClusterClient.hpp"
+
+/// @brief 是否是会修改数据的命令
+static bool isWriteCommand(const std::string &command){
+    auto it = commandMaps.find(command);
+    return it != commandMaps.end() && writeCommands.count(it->second) > 0;
+}
+
+/// @brief 列表都为空时可以挂起客户端的命令，事务中按非阻塞执行
+static bool isBlockingCommand(const std::string &command){
+    return command == "blpop" || command == "brpop" || command == "blmove";
+}
 
 /// @brief 懒汉单例模式
+/// @param port 客户端请求的端口，复制、订阅和集群总线使用它之后的固定偏移
+/// @param logFilePath logo文件路径
 /// @return 返回唯一的RedisServer对象
-RedisServer* RedisServer::getInstance(){
-    static RedisServer redis;
+RedisServer* RedisServer::getInstance(int port, const std::string& logFilePath){
+    static RedisServer redis(port, logFilePath);
     return &redis;
 }
 
@@ -11,8 +25,26 @@ RedisServer* RedisServer::getInstance(){
 /// @param port redis服务器的端口
 /// @param logFilePath  logo文件路径，作为首次登陆弹出的界面信息 
 RedisServer::RedisServer(int port, const std::string& logFilePath) 
-: port(port), logFilePath(logFilePath), flyweightFactory(new ParserFlyweightFactory()){
+: flyweightFactory(new ParserFlyweightFactory()), port(port), logFilePath(logFilePath){
     pid = getpid();
+    startTime = std::chrono::steady_clock::now();
+    replication.reset(new Replication(port, dataMutex));
+    cluster.reset(new Cluster(port, dataMutex));
+    pubsub.reset(new PubSub(port));
+    //唤醒阻塞的客户端时执行等价的非阻塞命令，弹出了元素才需要传播
+    blockedClients.reset(new BlockedClients([this](std::vector<std::string> &tokens){
+        std::string result = flyweightFactory->getParser(tokens[0])->parse(tokens);
+        if(!result.empty() && result[0] == '"'){
+            replication->propagate(tokens);
+        }
+        return result;
+    }));
+}
+
+/// @brief 正在处理的请求来自哪个连接，不在buttonrpc的处理函数中（例如基准测试直接调用execute）时为空字符串
+std::string RedisServer::clientIdentity(){
+    buttonrpc *rpc = buttonrpc::serving();
+    return rpc == nullptr ? "" : rpc->current_identity();
 }
 
 /// @brief 替代字符串中的指定字符
@@ -66,19 +98,33 @@ void RedisServer::printStartMessage(){
     replaceText(initMessage, "DATE", getDate());
 }
 
-/// @brief 开始步骤，打印基本信息，设置对终止信号的处理，即写入文件
+/// @brief 开始步骤，打印基本信息，设置对终止信号的处理，即写入文件，之后一直处理客户端请求
 void RedisServer::start(){
     //如果产生终止信号（ctrl+ca），就把当前文件内容写入文件中
     signal(SIGINT, signalHandler);
     printLogo();
     printStartMessage();
+    replication->start();
+    cluster->start();
+    pubsub->start();
+    buttonrpc server;
+    server.as_server(port);
+    rpc_bind_async(server, REDIS_COMMAND_RPC, std::function<rpc_task<std::string>(std::string)>([this](std::string receiveData){
+        return handleClient(std::move(receiveData));
+    }));
+    //同步端口的请求也在run线程上处理，生成快照交给后台线程
+    server.schedule([this](){
+        rpc_spawn(replication->serveSync());
+    });
+    server.run();
 }
 
 /// @brief 处理事务内容
 /// @param commandsQueue 事务中存在的redis语句
 /// @return 返回执行事务内的多条语句组成的结果
 std::string RedisServer::executeTransaction(std::queue<std::string> &commandsQueue){
-    std::vector<std::string> responseMessagesList;
+    //每条命令的结果直接追加到回复中
+    ReplyBuilder reply;
     while(!commandsQueue.empty()){
         std::string commandLine = std::move(commandsQueue.front());
         commandsQueue.pop();
@@ -93,32 +139,45 @@ std::string RedisServer::executeTransaction(std::queue<std::string> &commandsQue
         if(!tokens.empty()){
             command = tokens.front();
             std::shared_ptr<CommandParser> commandParser = flyweightFactory->getParser(command); //获取解析器
+            Stats::Timer timer(command);
             try {
                 responseMessage = commandParser->parse(tokens);
+                if(isWriteCommand(command)){
+                    replication->propagate(tokens);
+                    blockedClients->signal(tokens);
+                }
             } 
             catch (const std::exception& e) {
                 //语句执行错误，意思是说，hset a 2,本来该条语句应该是这个格式HSET key field value，所以该条语句内容错误
                 responseMessage = "Error processing command '" + command + "': " + e.what();
             }   
-            responseMessagesList.emplace_back(responseMessage);
+            reply.addFormatted(responseMessage);
         }
     }
-    std::string res = "";
-    for(int i=0; i<responseMessagesList.size(); i++){
-        std::string responseMessage = std::to_string(i+1) + ")" + responseMessage[i];
-        res += responseMessage;
-        if(i!=responseMessagesList.size()-1){
-            res+="\n";
-        } 
-    }
-    return res;
+    return reply.take();
 }
 
 /// @brief 处理客户端发过来的信息最原始信息，即字符串形式
+/// 在execute中执行，需要挂起时释放dataMutex之后等待，期间run线程继续处理其他客户端
 /// @param receiveData 客户端发送过来的字符串
 /// @return 返回客户端的redis语句处理结果
-std::string RedisServer::handleClient(std::string receiveData){
+rpc_task<std::string> RedisServer::handleClient(std::string receiveData){
+    std::shared_ptr<BlockedClients::Waiter> blocked;
+    std::string responseMessage = execute(std::move(receiveData), &blocked);
+    if(blocked != nullptr){
+        responseMessage = co_await blockedClients->wait(std::move(blocked));
+    }
+    co_return responseMessage;
+}
+
+/// @brief 执行客户端的一条请求
+/// @param receiveData 客户端发送过来的字符串
+/// @param blocked 为nullptr时阻塞命令按非阻塞执行
+/// @return 返回客户端的redis语句处理结果，请求挂起时为空字符串
+std::string RedisServer::execute(std::string receiveData, std::shared_ptr<BlockedClients::Waiter> *blocked){
     size_t bytesRead = receiveData.size();
+    std::lock_guard<std::mutex> lock(dataMutex);
+    Capture::getInstance().record(receiveData);
     if(bytesRead > 0){
         std::istringstream iss(receiveData);
         std::string command;
@@ -126,6 +185,7 @@ std::string RedisServer::handleClient(std::string receiveData){
         while(iss>>command){
             tokens.push_back(command);
         }
+        SlowLog::mark(TRACE_TOKENIZE);
         while(!tokens.empty()){
             command = tokens.front();
             std::string responseMessage;
@@ -162,6 +222,44 @@ std::string RedisServer::handleClient(std::string receiveData){
                     return responseMessage;
                 }
             }
+            else if(command == "replicaof" || command == "slaveof"){
+                return replication->replicaOf(tokens);
+            }
+            else if(command == "role"){
+                return replication->role();
+            }
+            else if(command == "cluster"){
+                return cluster->command(tokens);
+            }
+            else if(command == "publish"){
+                return pubsub->publish(tokens);
+            }
+            else if(command == "pubsub"){
+                return pubsub->command(tokens);
+            }
+            else if(command == "subscribe" || command == "psubscribe" || command == "unsubscribe" || command == "punsubscribe"){
+                return "(error) ERR " + command + " is only allowed on the subscriber port " + std::to_string(port + PUBSUB_PORT_OFFSET);
+            }
+            else if(command == "info"){
+                return info(tokens);
+            }
+            else if(command == "slowlog"){
+                return SlowLog::getInstance().command(tokens);
+            }
+            else if(command == "capture"){
+                return Capture::getInstance().command(tokens);
+            }
+            else if(command == "asking"){
+                //只对同一个连接的下一条命令有效
+                askingClients.insert(clientIdentity());
+                return "OK";
+            }
+            else if(replication->isReplica() && isWriteCommand(command)){
+                if(startMulti){
+                    fallback = true;
+                }
+                return READONLY_MESSAGE;
+            }
             else if (command == "discard"){
                 startMulti = false;
                 fallback = false;
@@ -169,18 +267,41 @@ std::string RedisServer::handleClient(std::string receiveData){
                 return responseMessage;
             }
             else{
+                //集群模式下键不属于本节点时回复MOVED/ASK
+                bool asking = !askingClients.empty() && askingClients.erase(clientIdentity()) > 0;
+                std::string redirectMessage = cluster->redirect(tokens, asking);
+                if(!redirectMessage.empty()){
+                    if(startMulti){
+                        fallback = true;
+                    }
+                    return redirectMessage;
+                }
                 if(!startMulti){
                     std::shared_ptr<CommandParser> commandParser = flyweightFactory->getParser(command);
+                    SlowLog::mark(TRACE_DISPATCH);
                     if (commandParser==nullptr){
                         responseMessage = "Error: Command '" + command + "' not recognized.";
                     }
                     else{
+                        Stats::Timer timer(command);
                         try{
                             responseMessage = commandParser->parse(tokens);
+                            SlowLog::mark(TRACE_EXECUTE);
+                            if(blocked != nullptr && isBlockingCommand(command) && responseMessage == NIL_MESSAGE){
+                                *blocked = blockedClients->block(tokens);
+                                if(*blocked != nullptr){
+                                    return ""; //列表都为空，由handleClient在锁外等待
+                                }
+                            }
+                            if(isWriteCommand(command)){
+                                replication->propagate(tokens);
+                                blockedClients->signal(tokens);
+                            }
                         }
                         catch(const std::exception &e){
                             responseMessage = "Error processing command '" + command + "': " + e.what();
                         }
+                        SlowLog::getInstance().record(tokens, timer.elapsed());
                     }
                     return responseMessage;
                 }
@@ -206,6 +327,82 @@ std::string RedisServer::handleClient(std::string receiveData){
     return "error";
 }
 
+/// @brief INFO [section ...]，不带参数时返回除commandstats和latencystats以外的所有部分
+/// @param tokens all/everything返回所有部分，否则只返回指定的部分
+/// @return 每部分以"# 名称"开头，部分之间空一行
+std::string RedisServer::info(const std::vector<std::string> &tokens){
+    static const std::vector<std::string> sections = {
+        "server", "clients", "memory", "stats", "replication", "commandstats", "latencystats", "keyspace"
+    };
+    std::set<std::string> selected;
+    if(tokens.size() == 1){
+        selected.insert(sections.begin(), sections.end());
+        selected.erase("commandstats");
+        selected.erase("latencystats");
+    }
+    for(size_t i=1; i<tokens.size(); i++){
+        if(tokens[i] == "all" || tokens[i] == "everything"){
+            selected.insert(sections.begin(), sections.end());
+        }
+        else{
+            selected.insert(tokens[i]);
+        }
+    }
+    std::string res;
+    for(const std::string &section : sections){
+        if(selected.count(section) == 0){
+            continue;
+        }
+        std::string content;
+        if(section == "server"){
+            long long uptime = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - startTime).count();
+            content = std::string("redis_mode:") + (cluster->enabled() ? "cluster" : "standalone") +
+                "\nprocess_id:" + std::to_string(pid) + "\ntcp_port:" + std::to_string(port) +
+                "\nuptime_in_seconds:" + std::to_string(uptime) + "\nuptime_in_days:" + std::to_string(uptime / 86400) + "\n";
+        }
+        else if(section == "clients"){
+            //请求端口上的连接数来自buttonrpc的套接字监视器
+            buttonrpc *rpc = buttonrpc::serving();
+            content = "connected_clients:" + std::to_string(rpc == nullptr ? 0 : rpc->connected_clients()) +
+                "\ntotal_connections_received:" + std::to_string(rpc == nullptr ? 0 : rpc->total_connections()) +
+                "\nblocked_clients:" + std::to_string(blockedClients->count()) + "\n" + pubsub->info();
+        }
+        else if(section == "memory"){
+            size_t rss = Stats::residentMemory();
+            size_t peak = Stats::peakMemory();
+            content = "used_memory_rss:" + std::to_string(rss) + "\nused_memory_rss_human:" + Stats::humanBytes(rss) +
+                "\nused_memory_peak:" + std::to_string(peak) + "\nused_memory_peak_human:" + Stats::humanBytes(peak) +
+                "\nlazyfree_pending_objects:" + std::to_string(CommandParser::getRedisHelper()->lazyfreePending()) + "\n";
+        }
+        else if(section == "stats"){
+            content = "total_commands_processed:" + std::to_string(Stats::getInstance().totalCommands()) + "\n";
+        }
+        else if(section == "replication"){
+            content = replication->info();
+        }
+        else if(section == "commandstats"){
+            content = Stats::getInstance().commandStats();
+        }
+        else if(section == "latencystats"){
+            content = Stats::getInstance().latencyStats();
+        }
+        else if(section == "keyspace"){
+            content = CommandParser::getRedisHelper()->keyspaceInfo();
+        }
+        if(!res.empty()){
+            res += "\n";
+        }
+        std::string title = section;
+        title[0] = toupper(title[0]);
+        res += "# " + title + "\n" + content;
+    }
+    //去掉最后的换行
+    while(!res.empty() && res.back() == '\n'){
+        res.pop_back();
+    }
+    return res;
+}
+
 void RedisServer::signalHandler(int sig){
     if(sig == SIGINT){
         CommandParser::getRedisHelper()->flush();
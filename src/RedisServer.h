@@ -7,31 +7,49 @@
 #include <string>
 #include <vector>
 #include <queue>
+#include <set>
+#include <unordered_set>
 #include <memory>
 #include <atomic>
 #include <unistd.h>
 #include <chrono>
 #include <iomanip>
 #include <signal.h>
+#include <mutex>
 #include "ParserFlyweightFactory.h"
+#include "Replication.h"
+#include "Cluster.h"
+#include "PubSub.h"
+#include "BlockedClients.h"
+#include "Stats.h"
+#include "SlowLog.h"
+#include "Capture.h"
+#include "ReplyBuilder.h"
 
 const std::string MY_PROJECT_DIR_LOGO = "./logo";
+const int DEFAULT_SERVER_PORT = 5555;
 
 /// @brief 懒汉单例模式
 class RedisServer{
 public:
-    static RedisServer* getInstance();
-    std::string handleClient(std::string receiveData); 
-    void start();
+    //只有第一次调用时的参数生效
+    static RedisServer* getInstance(int port=DEFAULT_SERVER_PORT, const std::string& logFilePath = MY_PROJECT_DIR_LOGO);
+    //处理一条客户端请求，阻塞命令在列表都为空时挂起，直到被唤醒或者超时
+    rpc_task<std::string> handleClient(std::string receiveData);
+    //handleClient的同步部分，在dataMutex内执行请求；blocked不为空并且请求需要挂起时把等待者写入*blocked
+    std::string execute(std::string receiveData, std::shared_ptr<BlockedClients::Waiter> *blocked = nullptr);
+    void start();   //启动复制、集群和订阅的后台线程，然后在当前线程处理客户端请求，不会返回
 
 private:
-    RedisServer(int port=5555, const std::string& logFilePath = MY_PROJECT_DIR_LOGO);
+    RedisServer(int port, const std::string& logFilePath);
     static void signalHandler(int sig);
     void printLogo();
     void printStartMessage();
     void replaceText(std::string &text, const std::string &toReplaceText, const std::string &replaceText);
     std::string getDate();
     std::string executeTransaction(std::queue<std::string> &commandsQueue);
+    std::string info(const std::vector<std::string> &tokens);
+    static std::string clientIdentity();
 
 private:
     std::unique_ptr<ParserFlyweightFactory> flyweightFactory; //享元工厂
@@ -42,6 +60,13 @@ private:
     bool startMulti = false;
     bool fallback = false;
     std::queue<std::string> commandsQueue;
+    std::mutex dataMutex; //执行命令时持有，复制线程读写数据时也需要持有
+    std::unique_ptr<Replication> replication;
+    std::unique_ptr<Cluster> cluster;
+    std::unordered_set<std::string> askingClients;  //上一条命令是ASKING的连接，按buttonrpc分配的身份区分
+    std::unique_ptr<PubSub> pubsub;
+    std::unique_ptr<BlockedClients> blockedClients;
+    std::chrono::steady_clock::time_point startTime;
 };
 
 #endif
\ No newline at end of file
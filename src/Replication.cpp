@@ -0,0 +1,327 @@
+#include <sstream>
+#include <random>
+#include <chrono>
+#include "Replication.h"
+#include "ClusterSlots.h"
+
+Replication::Replication(int port, std::mutex &dataMutex)
+: port(port), dataMutex(dataMutex), replicationId(newReplicationId()) {
+}
+
+/// @brief 生成40位十六进制的复制ID
+std::string Replication::newReplicationId(){
+    static const char hex[] = "0123456789abcdef";
+    std::mt19937_64 generator{std::random_device{}()};
+    std::string id;
+    for(int i=0; i<40; i++){
+        id.push_back(hex[generator() & 15]);
+    }
+    return id;
+}
+
+std::string Replication::endpoint(const std::string &host, int port){
+    return "tcp://" + host + ":" + std::to_string(port);
+}
+
+/// @brief 绑定复制流端口和同步端口，同步端口的请求由serveSync处理
+void Replication::start(){
+    publisher.reset(new zmq::socket_t(context, ZMQ_PUB));
+    //限制发送队列和内核缓冲区，从节点跟不上时尽早丢弃，落后的部分不会超出积压缓冲区能补齐的范围
+    publisher->setsockopt(ZMQ_SNDHWM, REPLICATION_STREAM_HWM);
+    publisher->setsockopt(ZMQ_SNDBUF, REPLICATION_STREAM_SNDBUF);
+    publisher->bind(endpoint("*", port + REPLICATION_STREAM_PORT_OFFSET));
+    syncSocket.reset(new zmq::socket_t(context, ZMQ_REP));
+    syncSocket->bind(endpoint("*", port + REPLICATION_SYNC_PORT_OFFSET));
+}
+
+/// @brief 把写命令追加到积压缓冲区并广播
+/// @param tokens 命令和参数
+void Replication::propagate(const std::vector<std::string> &tokens){
+    std::string commandLine;
+    for(size_t i=0; i<tokens.size(); i++){
+        if(i != 0){
+            commandLine += " ";
+        }
+        commandLine += tokens[i];
+    }
+    commandLine += "\n";
+    if(snapshotting){
+        std::vector<std::string> keys = commandKeys(tokens);
+        if(keys.empty()){
+            snapshotRestart = true;
+        }
+        snapshotDirtyKeys.insert(keys.begin(), keys.end());
+    }
+    long long offset = backlog.append(commandLine);
+    if(publisher){
+        //PUB套接字在从节点跟不上时直接丢弃消息，不会阻塞，丢失的部分由从节点通过psync补齐
+        std::string data = replicationId + " " + std::to_string(offset) + " " + commandLine;
+        zmq::message_t message(data.data(), data.size());
+        publisher->send(message);
+    }
+}
+
+/// @brief 处理同步端口的请求，psync分批加锁生成整个快照，交给后台线程执行，等待期间run线程继续处理客户端请求
+rpc_task<void> Replication::serveSync(){
+    while(true){
+        zmq::message_t request;
+        co_await rpc_recv(*syncSocket, request);
+        std::string data(static_cast<char*>(request.data()), request.size());
+        rpc_offload snapshot([this, data](){ return psync(data); });
+        std::string reply = co_await snapshot;
+        zmq::message_t response(reply.data(), reply.size());
+        co_await rpc_send(*syncSocket, response);
+    }
+}
+
+/// @brief 处理从节点的同步请求
+/// 全量同步时按键的顺序分批生成快照，每批之间释放dataMutex，期间被写入的键在最后加锁时删除并重新生成
+/// 回复中的偏移量是最后一次加锁时积压缓冲区的偏移量，快照包含了这之前的全部写命令
+/// @param request psync 复制ID 偏移量，第一次同步时复制ID为?
+/// @return 第一行为 CONTINUE/FULLRESYNC 复制ID 偏移量，之后每行一条命令
+std::string Replication::psync(const std::string &request){
+    std::istringstream iss(request);
+    std::string command;
+    std::string id;
+    long long offset = -1;
+    iss >> command >> id >> offset;
+    std::unique_lock<std::mutex> lock(dataMutex);
+    if(replica){
+        return "ERR this instance is a replica";
+    }
+    std::string data;
+    if(id == replicationId && backlog.read(offset, data)){
+        partialSyncs++;
+        return "CONTINUE " + replicationId + " " + std::to_string(backlog.offset()) + "\n" + data;
+    }
+    fullSyncs++;
+    std::shared_ptr<RedisHelper> helper = CommandParser::getRedisHelper();
+    std::string snapshot;
+    std::string lastKey;
+    bool hasMore = true;
+    snapshotting = true;
+    snapshotRestart = true;
+    while(true){
+        if(replica){
+            snapshotting = false;
+            snapshotDirtyKeys.clear();
+            return "ERR this instance is a replica";
+        }
+        if(snapshotRestart){
+            //执行了不带键的写命令（FLUSHDB、DELRANGE等），从头重新生成
+            snapshot.clear();
+            lastKey.clear();
+            hasMore = true;
+            snapshotRestart = false;
+            snapshotDirtyKeys.clear();
+        }
+        if(!hasMore){
+            break;
+        }
+        std::vector<std::string> keys = helper->scanKeys(lastKey, lastKey.empty(), REPLICATION_SNAPSHOT_BATCH, hasMore);
+        for(const std::string &line : helper->dump(keys)){
+            snapshot += line + "\n";
+        }
+        if(!keys.empty()){
+            lastKey = keys.back();
+        }
+        lock.unlock();
+        std::this_thread::yield();
+        lock.lock();
+    }
+    //生成期间被写入的键可能已经按旧值生成过，先删除再按现在的值重新生成
+    for(const std::string &key : snapshotDirtyKeys){
+        snapshot += "del " + key + "\n";
+        for(const std::string &line : helper->dump({key})){
+            snapshot += line + "\n";
+        }
+    }
+    snapshotting = false;
+    snapshotDirtyKeys.clear();
+    return "FULLRESYNC " + replicationId + " " + std::to_string(backlog.offset()) + "\n" + snapshot;
+}
+
+/// @brief 处理REPLICAOF命令，调用者需要持有dataMutex
+std::string Replication::replicaOf(const std::vector<std::string> &tokens){
+    if(tokens.size() != 3){
+        return "wrong number of arguments for REPLICAOF.";
+    }
+    if(tokens[1] == "no" && tokens[2] == "one"){
+        if(replica){
+            //提升为主节点，使用新的复制流，原来的从节点需要全量同步
+            replica = false;
+            linkUp = false;
+            generation++;
+            replicationId = newReplicationId();
+            backlog.reset(0);
+        }
+        return "OK";
+    }
+    int newPort = 0;
+    try{
+        newPort = std::stoi(tokens[2]);
+    }
+    catch(const std::exception &e){
+        return tokens[2] + " is not a numeric type";
+    }
+    if(replica && masterHost == tokens[1] && masterPort == newPort){
+        return "OK Already connected to specified master";
+    }
+    replica = true;
+    linkUp = false;
+    masterHost = tokens[1];
+    masterPort = newPort;
+    replicaOffset = -1;
+    //旧的复制线程可能正在等锁，不能在这里等它退出，改变generation后它会自己结束
+    unsigned long current = ++generation;
+    std::thread(&Replication::replicaLoop, this, masterHost, masterPort, current).detach();
+    return "OK";
+}
+
+/// @brief ROLE命令，调用者需要持有dataMutex
+std::string Replication::role() const{
+    if(!replica){
+        return "1) \"master\"\n2) (integer) " + std::to_string(backlog.offset());
+    }
+    return "1) \"slave\"\n2) \"" + masterHost + "\"\n3) (integer) " + std::to_string(masterPort) +
+        "\n4) \"" + (linkUp ? "connected" : "connecting") + "\"\n5) (integer) " + std::to_string(replicaOffset);
+}
+
+std::string Replication::info() const{
+    if(!replica){
+        return "role:master\nmaster_replid:" + replicationId + "\nmaster_repl_offset:" + std::to_string(backlog.offset()) +
+            "\nrepl_backlog_first_byte_offset:" + std::to_string(backlog.startOffset()) +
+            "\nsync_full:" + std::to_string(fullSyncs) + "\nsync_partial_ok:" + std::to_string(partialSyncs) + "\n";
+    }
+    return "role:slave\nmaster_host:" + masterHost + "\nmaster_port:" + std::to_string(masterPort) +
+        "\nmaster_link_status:" + (linkUp ? "up" : "down") + "\nmaster_replid:" + replicationId +
+        "\nslave_repl_offset:" + std::to_string(replicaOffset) + "\n";
+}
+
+/// @brief 从节点的复制线程
+/// 先订阅复制流再同步，同步期间到达的消息在SUB套接字中排队，偏移量小于同步结果的直接丢弃
+/// 一段时间没有收到消息时也重新psync，这样最后一条消息丢失时也能补上，并且能发现主节点已经重启
+void Replication::replicaLoop(std::string host, int port, unsigned long current){
+    zmq::socket_t subscriber(context, ZMQ_SUB);
+    subscriber.setsockopt(ZMQ_SUBSCRIBE, "", 0);
+    subscriber.setsockopt(ZMQ_RCVTIMEO, REPLICATION_TIMEOUT_MS);
+    subscriber.setsockopt(ZMQ_LINGER, 0);
+    subscriber.connect(endpoint(host, port + REPLICATION_STREAM_PORT_OFFSET));
+    bool synced = false;
+    while(current == generation){
+        if(!synced){
+            synced = sync(host, port, current);
+            if(!synced){
+                std::this_thread::sleep_for(std::chrono::milliseconds(REPLICATION_RETRY_MS));
+            }
+            continue;
+        }
+        zmq::message_t message;
+        if(!subscriber.recv(message)){
+            synced = false;
+            continue;
+        }
+        //消息格式：复制ID 偏移量 命令
+        std::string data(static_cast<char*>(message.data()), message.size());
+        size_t idEnd = data.find(' ');
+        size_t offsetEnd = idEnd == std::string::npos ? std::string::npos : data.find(' ', idEnd+1);
+        if(offsetEnd == std::string::npos){
+            continue;
+        }
+        long long offset = std::stoll(data.substr(idEnd+1, offsetEnd-idEnd-1));
+        std::lock_guard<std::mutex> lock(dataMutex);
+        if(current != generation){
+            break;
+        }
+        if(data.compare(0, idEnd, replicationId) != 0 || offset > replicaOffset){
+            //主节点换了复制流，或者中间丢了消息
+            synced = false;
+            continue;
+        }
+        if(offset < replicaOffset){
+            continue;
+        }
+        apply(data.substr(offsetEnd+1));
+        replicaOffset += data.size() - offsetEnd - 1;
+    }
+}
+
+/// @brief 向主节点发送psync，执行回复中的命令并更新复制ID和偏移量
+/// 每次新建REQ套接字，超时后旧套接字的状态不能继续使用
+bool Replication::sync(const std::string &host, int port, unsigned long current){
+    zmq::socket_t socket(context, ZMQ_REQ);
+    socket.setsockopt(ZMQ_RCVTIMEO, REPLICATION_TIMEOUT_MS);
+    socket.setsockopt(ZMQ_LINGER, 0);
+    socket.connect(endpoint(host, port + REPLICATION_SYNC_PORT_OFFSET));
+    std::string request;
+    {
+        std::lock_guard<std::mutex> lock(dataMutex);
+        request = "psync " + (replicaOffset < 0 ? std::string("?") : replicationId) + " " + std::to_string(replicaOffset);
+    }
+    zmq::message_t message(request.data(), request.size());
+    socket.send(message);
+    //全量同步的快照分批生成，可能超过REPLICATION_TIMEOUT_MS，每次超时检查一下是否还需要等
+    zmq::message_t reply;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(REPLICATION_SYNC_TIMEOUT_MS);
+    while(!socket.recv(reply)){
+        if(current != generation || std::chrono::steady_clock::now() > deadline){
+            return false;
+        }
+    }
+    std::string data(static_cast<char*>(reply.data()), reply.size());
+    size_t headerEnd = data.find('\n');
+    if(headerEnd == std::string::npos){
+        return false;
+    }
+    std::istringstream header(data.substr(0, headerEnd));
+    std::string type;
+    std::string id;
+    long long offset = -1;
+    header >> type >> id >> offset;
+    if(type != "FULLRESYNC" && type != "CONTINUE"){
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(dataMutex);
+    if(current != generation){
+        return false;
+    }
+    if(type == "FULLRESYNC"){
+        CommandParser::getRedisHelper()->flushall();
+    }
+    size_t pos = headerEnd + 1;
+    while(pos < data.size()){
+        size_t end = data.find('\n', pos);
+        if(end == std::string::npos){
+            end = data.size();
+        }
+        apply(data.substr(pos, end - pos));
+        pos = end + 1;
+    }
+    replicationId = id;
+    replicaOffset = offset;
+    linkUp = true;
+    return true;
+}
+
+/// @brief 执行一条复制来的命令，结果直接丢弃
+void Replication::apply(const std::string &commandLine){
+    std::istringstream iss(commandLine);
+    std::string token;
+    std::vector<std::string> tokens;
+    while(iss >> token){
+        tokens.push_back(token);
+    }
+    if(tokens.empty()){
+        return;
+    }
+    std::shared_ptr<CommandParser> commandParser = factory.getParser(tokens[0]);
+    if(commandParser == nullptr){
+        return;
+    }
+    try{
+        commandParser->parse(tokens);
+    }
+    catch(const std::exception &e){
+        //主节点上同样的命令也执行失败了，忽略
+    }
+}
@@ -0,0 +1,85 @@
+#ifndef REPLICATION_H
+#define REPLICATION_H
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <unordered_set>
+#include <zmq.hpp>
+#include "ParserFlyweightFactory.h"
+#include "RPC/coroutine.hpp"
+#include "dataStructure/ReplicationBacklog.h"
+
+#define REPLICATION_SYNC_PORT_OFFSET 1      //同步端口（REQ/REP）= 服务端口 + 1
+#define REPLICATION_STREAM_PORT_OFFSET 2    //复制流端口（PUB/SUB）= 服务端口 + 2
+#define REPLICATION_TIMEOUT_MS 1000         //从节点等待主节点的超时时间
+#define REPLICATION_RETRY_MS 1000           //同步失败后重试的间隔
+#define REPLICATION_SYNC_TIMEOUT_MS 60000   //从节点等待psync回复的最长时间
+#define REPLICATION_STREAM_HWM 1000         //复制流PUB套接字最多排队的消息数
+#define REPLICATION_STREAM_SNDBUF (64*1024) //复制流PUB套接字的内核发送缓冲区大小
+#define REPLICATION_SNAPSHOT_BATCH 1000     //全量同步时每次加锁生成快照的键数
+
+const std::string READONLY_MESSAGE = "(error) READONLY You can't write against a read only replica.";
+
+/*
+    主从复制
+    主节点：每条写命令执行后追加到复制积压缓冲区，并通过PUB套接字广播 "复制ID 偏移量 命令"
+    同步端口上响应从节点的 "psync 复制ID 偏移量" 请求：
+        复制ID相同并且偏移量还在积压缓冲区内时回复 "CONTINUE 复制ID 偏移量"，后面跟着缺少的命令（部分重同步）
+        否则回复 "FULLRESYNC 复制ID 偏移量"，后面跟着整个数据库的快照命令（全量同步）
+    从节点：先订阅复制流再发psync，同步期间收到的旧命令按偏移量丢弃
+    之后按顺序执行复制流中的命令，发现偏移量不连续（断线期间丢了消息）时重新psync
+    所有数据的读写都在dataMutex内进行；快照分批生成，批之间被写入的键在最后一次加锁时重新生成，
+    偏移量也在这次加锁中取得，保证快照和偏移量一致
+*/
+class Replication{
+public:
+    Replication(int port, std::mutex &dataMutex);
+
+    void start();   //绑定同步端口和复制流端口
+    //在run线程上处理同步端口的请求，psync交给后台线程执行，等待期间run线程继续处理客户端
+    rpc_task<void> serveSync();
+    //把一条已经执行的写命令写入复制流，调用者需要持有dataMutex
+    void propagate(const std::vector<std::string> &tokens);
+    //REPLICAOF host port：成为host:port的从节点；REPLICAOF NO ONE：提升为主节点
+    std::string replicaOf(const std::vector<std::string> &tokens);
+    std::string role() const;
+    std::string info() const;   //INFO replication，调用者需要持有dataMutex
+    bool isReplica() const { return replica; }
+
+private:
+    std::string psync(const std::string &request);
+    //从节点的复制线程，generation改变后退出
+    void replicaLoop(std::string host, int port, unsigned long current);
+    //向主节点发送psync并执行回复中的命令
+    bool sync(const std::string &host, int port, unsigned long current);
+    void apply(const std::string &commandLine);  //执行一条复制来的命令，调用者需要持有dataMutex
+    static std::string newReplicationId();
+    static std::string endpoint(const std::string &host, int port);
+
+private:
+    int port;
+    std::mutex &dataMutex;
+    zmq::context_t context{1};
+    std::unique_ptr<zmq::socket_t> publisher;   //只在执行命令的线程使用
+    std::unique_ptr<zmq::socket_t> syncSocket;  //同步端口，只在run线程使用
+    ParserFlyweightFactory factory;             //从节点执行复制来的命令
+    ReplicationBacklog backlog;
+    std::string replicationId;                  //当前复制流的ID，主节点启动或者提升时重新生成
+    bool replica = false;
+    std::string masterHost;
+    int masterPort = 0;
+    bool linkUp = false;                        //从节点是否已经和主节点完成同步
+    long long replicaOffset = -1;               //从节点已经执行到的复制流偏移量
+    std::atomic<unsigned long> generation{0};   //每次REPLICAOF加一，让旧的复制线程退出
+    size_t fullSyncs = 0;                       //主节点回复FULLRESYNC的次数
+    size_t partialSyncs = 0;                    //主节点回复CONTINUE的次数
+    bool snapshotting = false;                  //正在分批生成全量同步的快照
+    bool snapshotRestart = false;               //生成快照期间执行了不带键的写命令，需要从头生成
+    std::unordered_set<std::string> snapshotDirtyKeys;  //生成快照期间被写入的键
+};
+
+#endif
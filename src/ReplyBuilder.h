@@ -0,0 +1,81 @@
+#ifndef REPLY_BUILDER_H
+#define REPLY_BUILDER_H
+
+#include <string>
+#include <cstring>
+#include <cstddef>
+#include "global.h"
+
+/*
+    多行回复（1) "a"\n2) "b"...）的构造器
+    每一项直接追加到同一个字符串中，不生成 to_string(i) + ") \"" + value + "\"" 这样的临时字符串；
+    调用者知道总大小时先reserve，整个回复只分配一次
+    构造完成后用take()移出，之后经由解析器、handleClient、buttonrpc一路移动，直到序列化进发送缓冲区
+*/
+class ReplyBuilder{
+public:
+    //indent为除第一项外每一项前的空格数，嵌套在外层回复的一项中时与外层的序号对齐
+    explicit ReplyBuilder(size_t reserveBytes=0, size_t indent=0) : indent(indent){
+        reply.reserve(reserveBytes);
+    }
+
+    //一项加引号的字符串所占的字节数，不含序号
+    static size_t bulkSize(size_t valueSize){ return valueSize + 2 + 5; }  //引号，") "和换行，序号估计为2位
+
+    void reserve(size_t bytes){ reply.reserve(bytes); }
+
+    void addBulk(const char *data, size_t size){
+        beginItem();
+        reply.push_back('"');
+        reply.append(data, size);
+        reply.push_back('"');
+    }
+    void addBulk(const std::string &value){ addBulk(value.data(), value.size()); }
+
+    void addNil(){
+        beginItem();
+        reply.append(NIL_MESSAGE);
+    }
+
+    //已经格式化好的一项，例如事务中一条命令的回复
+    void addFormatted(const std::string &formatted){
+        beginItem();
+        reply.append(formatted);
+    }
+
+    size_t count() const { return items; }
+
+    //没有任何项时返回(empty list or set)
+    std::string take(){
+        if(items == 0){
+            return EMPTY_LIST_MESSAGE;
+        }
+        items = 0;
+        return std::move(reply);
+    }
+
+private:
+    //换行和序号，序号直接写入，不经过to_string
+    void beginItem(){
+        if(items != 0){
+            reply.push_back('\n');
+            reply.append(indent, ' ');
+        }
+        char digits[24];
+        size_t pos = sizeof(digits);
+        size_t index = ++items;
+        do{
+            digits[--pos] = static_cast<char>('0' + index % 10);
+            index /= 10;
+        }while(index != 0);
+        reply.append(digits + pos, sizeof(digits) - pos);
+        reply.append(") ", 2);
+    }
+
+private:
+    std::string reply;
+    size_t items = 0;
+    size_t indent;
+};
+
+#endif
@@ -0,0 +1,257 @@
+#include <fstream>
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+#include "SlowLog.h"
+#include "global.h"
+
+static const char *STAGE_NAMES[TRACE_STAGES] = {"recv", "tokenize", "dispatch", "execute", "serialize", "send"};
+
+SlowLog& SlowLog::getInstance(){
+    static SlowLog slowLog;
+    return slowLog;
+}
+
+static bool parseInteger(const std::string &str, long long &value){
+    try{
+        size_t pos = 0;
+        value = std::stoll(str, &pos);
+        return pos == str.size();
+    }
+    catch(const std::exception &e){
+        return false;
+    }
+}
+
+std::string SlowLog::command(const std::vector<std::string> &tokens){
+    if(tokens.size() < 2){
+        return "wrong number of arguments for SLOWLOG.";
+    }
+    const std::string &sub = tokens[1];
+    if(sub == "get" && tokens.size() <= 3){
+        long long count = 10;
+        if(tokens.size() == 3 && (!parseInteger(tokens[2], count) || count < -1)){
+            return "(error) ERR count should be greater than or equal to -1";
+        }
+        //-1表示返回所有记录
+        return format(snapshot(count < 0 ? SLOWLOG_MAX_LEN : count));
+    }
+    if(sub == "len" && tokens.size() == 2){
+        return "(integer) " + std::to_string(snapshot(SLOWLOG_MAX_LEN).size());
+    }
+    if(sub == "reset" && tokens.size() == 2){
+        resetId.store(nextId.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        return "OK";
+    }
+    if(sub == "threshold" && tokens.size() <= 3){
+        if(tokens.size() == 2){
+            return "(integer) " + std::to_string(threshold.load(std::memory_order_relaxed));
+        }
+        long long value = 0;
+        if(!parseInteger(tokens[2], value)){
+            return "(error) ERR value is not an integer or out of range";
+        }
+        threshold.store(value, std::memory_order_relaxed);
+        return "OK";
+    }
+    if(sub == "trace" && tokens.size() == 3 && (tokens[2] == "on" || tokens[2] == "off")){
+        buttonrpc::set_stage_hook(tokens[2] == "on" ? stageHook : nullptr);
+        return "OK";
+    }
+    if(sub == "export" && tokens.size() == 3){
+        return exportTo(tokens[2]);
+    }
+    return "(error) ERR unknown subcommand or wrong number of arguments for SLOWLOG " + sub;
+}
+
+void SlowLog::record(const std::vector<std::string> &tokens, uint64_t usec){
+    Trace &trace = localTrace();
+    if(trace.active){
+        //还不知道整个请求的耗时，先保存命令，回复发出以后再判断
+        fill(trace.entry, tokens, usec);
+        trace.recorded = true;
+        return;
+    }
+    long long limit = threshold.load(std::memory_order_relaxed);
+    if(limit < 0 || usec < static_cast<uint64_t>(limit)){
+        return;
+    }
+    Entry entry;
+    fill(entry, tokens, usec);
+    push(entry);
+}
+
+/// @brief buttonrpc在run线程中调用，只在开启跟踪时设置
+void SlowLog::stageHook(buttonrpc::rpc_stage stage){
+    Trace &trace = localTrace();
+    switch(stage){
+    case buttonrpc::RPC_STAGE_BEGIN:
+        trace.active = true;
+        trace.recorded = false;
+        std::fill(std::begin(trace.stamps), std::end(trace.stamps), 0);
+        trace.stamps[0] = now();
+        break;
+    case buttonrpc::RPC_STAGE_RECEIVED:
+        mark(TRACE_RECV);
+        break;
+    case buttonrpc::RPC_STAGE_CALLED:
+        mark(TRACE_SERIALIZE);
+        //不是普通命令，或者请求被挂起，不会再有SENT
+        if(!trace.recorded){
+            trace.active = false;
+        }
+        break;
+    case buttonrpc::RPC_STAGE_SENT:
+        mark(TRACE_SEND);
+        getInstance().finishTrace(trace);
+        break;
+    }
+}
+
+void SlowLog::finishTrace(Trace &trace){
+    trace.active = false;
+    if(!trace.recorded){
+        return;
+    }
+    long long limit = threshold.load(std::memory_order_relaxed);
+    uint64_t total = (trace.stamps[TRACE_STAGES] - trace.stamps[0]) / 1000;
+    if(limit < 0 || total < static_cast<uint64_t>(limit)){
+        return;
+    }
+    //没有经过的阶段（例如被重定向）耗时为0
+    uint64_t last = trace.stamps[0];
+    for(int i=0; i<TRACE_STAGES; i++){
+        uint64_t end = trace.stamps[i+1] == 0 ? last : trace.stamps[i+1];
+        trace.entry.stages[i] = (end - last) / 1000;
+        last = end;
+    }
+    trace.entry.usec = total;
+    trace.entry.traced = true;
+    push(trace.entry);
+}
+
+/// @brief 把命令拼成一行，超过SLOWLOG_ARGS_LEN时截断
+void SlowLog::fill(Entry &entry, const std::vector<std::string> &tokens, uint64_t usec){
+    entry.timestamp = std::time(nullptr);
+    entry.usec = usec;
+    std::memset(entry.stages, 0, sizeof(entry.stages));
+    entry.traced = false;
+    entry.argc = tokens.size();
+    size_t length = 0;
+    for(size_t i=0; i<tokens.size() && length < SLOWLOG_ARGS_LEN; i++){
+        if(i != 0){
+            entry.args[length++] = ' ';
+        }
+        size_t n = std::min(tokens[i].size(), SLOWLOG_ARGS_LEN - length);
+        std::memcpy(entry.args + length, tokens[i].data(), n);
+        length += n;
+    }
+    entry.length = std::min<size_t>(length, SLOWLOG_ARGS_LEN);
+}
+
+/// @brief 写入id对应的槽位，同一个槽位正在被写或者已经有更新的记录时放弃这条记录
+void SlowLog::push(Entry &entry){
+    uint64_t id = nextId.fetch_add(1, std::memory_order_relaxed);
+    Slot &slot = slots[id % SLOWLOG_MAX_LEN];
+    uint64_t sequence = slot.sequence.load(std::memory_order_relaxed);
+    if((sequence & 1) || sequence > 2 * id ||
+        !slot.sequence.compare_exchange_strong(sequence, sequence | 1, std::memory_order_relaxed)){
+        return;
+    }
+    //序号变成奇数之后才能写入记录
+    std::atomic_thread_fence(std::memory_order_release);
+    entry.id = id;
+    slot.entry = entry;
+    slot.sequence.store(2 * (id + 1), std::memory_order_release);
+}
+
+std::vector<SlowLog::Entry> SlowLog::snapshot(size_t count) const{
+    std::vector<Entry> entries;
+    uint64_t end = nextId.load(std::memory_order_acquire);
+    uint64_t begin = resetId.load(std::memory_order_relaxed);
+    if(end > SLOWLOG_MAX_LEN && end - SLOWLOG_MAX_LEN > begin){
+        begin = end - SLOWLOG_MAX_LEN;
+    }
+    for(uint64_t id=end; id>begin && entries.size()<count; id--){
+        const Slot &slot = slots[(id - 1) % SLOWLOG_MAX_LEN];
+        uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+        if(sequence != 2 * id){
+            continue;   //还没写完，或者已经被覆盖
+        }
+        Entry entry = slot.entry;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if(slot.sequence.load(std::memory_order_relaxed) == sequence){
+            entries.push_back(entry);
+        }
+    }
+    return entries;
+}
+
+/// @brief 每条记录：id、时间、耗时、命令，开启跟踪时还有各阶段的耗时
+std::string SlowLog::format(const std::vector<Entry> &entries) const{
+    if(entries.empty()){
+        return EMPTY_LIST_MESSAGE;
+    }
+    std::string res;
+    for(size_t i=0; i<entries.size(); i++){
+        const Entry &entry = entries[i];
+        std::string prefix = std::to_string(i+1) + ") ";
+        std::string indent(prefix.size(), ' ');
+        std::vector<std::string> items = {
+            "(integer) " + std::to_string(entry.id),
+            "(integer) " + std::to_string(entry.timestamp),
+            "(integer) " + std::to_string(entry.usec),
+            "\"" + std::string(entry.args, entry.length) + "\""
+        };
+        if(entry.traced){
+            std::string stages;
+            for(int stage=0; stage<TRACE_STAGES; stage++){
+                stages += (stage == 0 ? "" : " ") + std::string(STAGE_NAMES[stage]) + "=" + std::to_string(entry.stages[stage]);
+            }
+            items.push_back("\"" + stages + "\"");
+        }
+        for(size_t j=0; j<items.size(); j++){
+            if(i != 0 || j != 0){
+                res += "\n";
+            }
+            res += (j == 0 ? prefix : indent) + std::to_string(j+1) + ") " + items[j];
+        }
+    }
+    return res;
+}
+
+/// @brief 按从旧到新的顺序写成CSV，没有跟踪的记录各阶段耗时为空
+/// @param fileName 输出目录下的文件名，不能带路径
+std::string SlowLog::exportTo(const std::string &fileName) const{
+    if(!isBareFileName(fileName)){
+        return "(error) ERR invalid file name " + fileName + ", only a file name inside the output directory is allowed";
+    }
+    std::string path = directory + "/" + fileName;
+    std::ofstream ofs(path, std::ios::trunc);
+    if(!ofs.is_open()){
+        return "(error) ERR can't open " + path;
+    }
+    ofs << "id,timestamp,usec";
+    for(const char *name : STAGE_NAMES){
+        ofs << "," << name;
+    }
+    ofs << ",argc,command\n";
+    std::vector<Entry> entries = snapshot(SLOWLOG_MAX_LEN);
+    for(auto it=entries.rbegin(); it!=entries.rend(); ++it){
+        ofs << it->id << "," << it->timestamp << "," << it->usec;
+        for(uint64_t stage : it->stages){
+            ofs << ",";
+            if(it->traced){
+                ofs << stage;
+            }
+        }
+        //命令中的引号按CSV的规则转义
+        std::string command(it->args, it->length);
+        std::string escaped;
+        for(char c : command){
+            escaped += c == '"' ? "\"\"" : std::string(1, c);
+        }
+        ofs << "," << it->argc << ",\"" << escaped << "\"\n";
+    }
+    return "(integer) " + std::to_string(entries.size());
+}
@@ -0,0 +1,103 @@
+#ifndef SLOW_LOG_H
+#define SLOW_LOG_H
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include "RPC/buttonrpc.hpp"
+#include "global.h"
+
+#define SLOWLOG_MAX_LEN 128             //环形缓冲区的槽数，只保留最近的慢查询
+#define SLOWLOG_ARGS_LEN 128            //每条记录保存的命令文本长度，超出的部分截断
+#define SLOWLOG_DEFAULT_THRESHOLD 10000 //默认阈值，微秒
+
+//一个请求经过的阶段，按先后顺序排列
+enum TraceStage{
+    TRACE_RECV,         //buttonrpc接收请求
+    TRACE_TOKENIZE,     //handleClient分词
+    TRACE_DISPATCH,     //集群重定向检查，查找解析器
+    TRACE_EXECUTE,      //解析器执行命令（RedisHelper）
+    TRACE_SERIALIZE,    //序列化返回值
+    TRACE_SEND,         //buttonrpc发送回复
+    TRACE_STAGES
+};
+
+/*
+    慢查询日志
+    记录存放在固定大小的环形缓冲区中，写入时用原子自增分配槽位，每个槽位有一个序号（seqlock）：
+    写者把序号改成奇数后写入，写完改成偶数；读者复制记录前后序号一致才算读到，读写都不加锁
+    默认只记录命令的执行耗时，超过阈值时才生成记录，没有慢查询时每条命令只多一次比较
+    开启跟踪（SLOWLOG TRACE ON）后，buttonrpc的run线程和handleClient会记录每个阶段结束的时间，
+    回复发出后按整个请求的耗时判断是否超过阈值，记录中带上各阶段的耗时，用来找出是哪个阶段慢
+*/
+class SlowLog{
+public:
+    static SlowLog& getInstance();
+
+    //SLOWLOG GET [count] / LEN / RESET / THRESHOLD [usec] / TRACE ON|OFF / EXPORT filename
+    std::string command(const std::vector<std::string> &tokens);
+    //EXPORT的文件写在这个目录下，只在启动时设置
+    void setDirectory(const std::string &dir) { directory = dir; }
+    //命令执行完后调用，开启跟踪时留到回复发出以后再判断
+    void record(const std::vector<std::string> &tokens, uint64_t usec);
+    //当前请求的一个阶段结束，没有开启跟踪时直接返回
+    static void mark(TraceStage stage){
+        Trace &trace = localTrace();
+        if(trace.active){
+            trace.stamps[stage + 1] = now();
+        }
+    }
+
+private:
+    //只包含定长字段，可以整体复制
+    struct Entry{
+        uint64_t id;
+        int64_t timestamp;              //unix时间，秒
+        uint64_t usec;                  //执行耗时，开启跟踪时为整个请求的耗时
+        uint64_t stages[TRACE_STAGES];  //各阶段耗时（微秒），没有跟踪时都为0
+        bool traced;
+        uint32_t argc;
+        uint32_t length;
+        char args[SLOWLOG_ARGS_LEN];
+    };
+
+    struct Slot{
+        std::atomic<uint64_t> sequence{0};  //奇数表示正在写入，写完后为2*(id+1)
+        Entry entry;
+    };
+
+    //当前线程正在处理的请求
+    struct Trace{
+        bool active = false;
+        bool recorded = false;                  //请求是一条普通命令，entry已经填好
+        uint64_t stamps[TRACE_STAGES + 1] = {}; //stamps[0]是开始时间，stamps[i+1]是第i个阶段结束的时间，纳秒
+        Entry entry;
+    };
+
+    SlowLog() = default;
+    static Trace& localTrace(){
+        static thread_local Trace trace;
+        return trace;
+    }
+    static uint64_t now(){
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+    static void stageHook(buttonrpc::rpc_stage stage);
+    static void fill(Entry &entry, const std::vector<std::string> &tokens, uint64_t usec);
+    void finishTrace(Trace &trace);
+    void push(Entry &entry);
+    std::vector<Entry> snapshot(size_t count) const;   //从新到旧最多count条
+    std::string format(const std::vector<Entry> &entries) const;
+    std::string exportTo(const std::string &fileName) const;
+
+private:
+    std::atomic<uint64_t> nextId{0};
+    std::atomic<uint64_t> resetId{0};   //比它小的记录已经被RESET清除
+    std::atomic<long long> threshold{SLOWLOG_DEFAULT_THRESHOLD};   //小于0时不记录，等于0时记录所有命令
+    Slot slots[SLOWLOG_MAX_LEN];
+    std::string directory = DEFAULT_OUTPUT_DIR;
+};
+
+#endif
@@ -0,0 +1,207 @@
+#include <cstdio>
+#include <unistd.h>
+#include <sys/resource.h>
+#include "Stats.h"
+
+Stats& Stats::getInstance(){
+    static Stats stats;
+    return stats;
+}
+
+/// @brief 当前线程的计数器，第一次调用时注册
+Stats::Shard& Stats::localShard(){
+    thread_local Shard *shard = nullptr;
+    if(shard == nullptr){
+        std::lock_guard<std::mutex> lock(mutex);
+        shards.emplace_back(new Shard());
+        shard = shards.back().get();
+    }
+    return *shard;
+}
+
+/// @return 命令的下标，命令种类已满时返回-1
+int Stats::commandId(Shard &shard, const std::string &command){
+    auto it = shard.ids.find(command);
+    if(it != shard.ids.end()){
+        return it->second;
+    }
+    int id = -1;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for(size_t i=0; i<names.size(); i++){
+            if(names[i] == command){
+                id = i;
+                break;
+            }
+        }
+        if(id < 0 && names.size() < STATS_MAX_COMMANDS){
+            id = names.size();
+            names.push_back(command);
+        }
+    }
+    shard.ids[command] = id;
+    return id;
+}
+
+/// @brief 小于16的值每个一个桶，之后每个2的幂区间[2^e, 2^(e+1))分成16个桶
+size_t Stats::bucketIndex(uint64_t usec){
+    if(usec < STATS_SUB_BUCKETS){
+        return usec;
+    }
+    int exponent = 63 - __builtin_clzll(usec);
+    if(exponent > STATS_MAX_EXPONENT){
+        return STATS_BUCKETS - 1;
+    }
+    size_t sub = (usec >> (exponent - STATS_SUB_BUCKET_BITS)) & (STATS_SUB_BUCKETS - 1);
+    return (exponent - STATS_SUB_BUCKET_BITS + 1) * STATS_SUB_BUCKETS + sub;
+}
+
+/// @brief 桶内的最大值，百分位数按HDR的习惯报告所在桶的上界
+uint64_t Stats::bucketUpperBound(size_t index){
+    if(index < STATS_SUB_BUCKETS){
+        return index;
+    }
+    int exponent = index / STATS_SUB_BUCKETS + STATS_SUB_BUCKET_BITS - 1;
+    uint64_t sub = index % STATS_SUB_BUCKETS;
+    uint64_t width = uint64_t(1) << (exponent - STATS_SUB_BUCKET_BITS);
+    return ((STATS_SUB_BUCKETS + sub) << (exponent - STATS_SUB_BUCKET_BITS)) + width - 1;
+}
+
+void Stats::record(const std::string &command, uint64_t usec){
+    Shard &shard = localShard();
+    int id = commandId(shard, command);
+    if(id < 0){
+        return;
+    }
+    Counters *counters = shard.commands[id].load(std::memory_order_relaxed);
+    if(counters == nullptr){
+        counters = new Counters();
+        //release保证读线程看到指针时计数器已经初始化
+        shard.commands[id].store(counters, std::memory_order_release);
+    }
+    //只有本线程写，load加store就够了，不需要fetch_add
+    auto increase = [](std::atomic<uint64_t> &counter, uint64_t delta){
+        counter.store(counter.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+    };
+    increase(counters->calls, 1);
+    increase(counters->usec, usec);
+    increase(counters->buckets[bucketIndex(usec)], 1);
+}
+
+/// @brief 合并所有线程中一种命令的计数器，调用者需要持有mutex
+Stats::Merged Stats::merge(int id) const{
+    Merged merged;
+    merged.buckets.assign(STATS_BUCKETS, 0);
+    for(const auto &shard : shards){
+        const Counters *counters = shard->commands[id].load(std::memory_order_acquire);
+        if(counters == nullptr){
+            continue;
+        }
+        merged.calls += counters->calls.load(std::memory_order_relaxed);
+        merged.usec += counters->usec.load(std::memory_order_relaxed);
+        for(size_t i=0; i<STATS_BUCKETS; i++){
+            merged.buckets[i] += counters->buckets[i].load(std::memory_order_relaxed);
+        }
+    }
+    return merged;
+}
+
+uint64_t Stats::percentile(const Merged &merged, double p){
+    uint64_t total = 0;
+    for(uint64_t count : merged.buckets){
+        total += count;
+    }
+    if(total == 0){
+        return 0;
+    }
+    uint64_t rank = static_cast<uint64_t>(p / 100 * total);
+    if(rank == 0){
+        rank = 1;
+    }
+    uint64_t seen = 0;
+    for(size_t i=0; i<merged.buckets.size(); i++){
+        seen += merged.buckets[i];
+        if(seen >= rank){
+            return bucketUpperBound(i);
+        }
+    }
+    return bucketUpperBound(merged.buckets.size() - 1);
+}
+
+uint64_t Stats::totalCommands() const{
+    std::lock_guard<std::mutex> lock(mutex);
+    uint64_t total = 0;
+    for(const auto &shard : shards){
+        for(size_t id=0; id<names.size(); id++){
+            const Counters *counters = shard->commands[id].load(std::memory_order_acquire);
+            if(counters != nullptr){
+                total += counters->calls.load(std::memory_order_relaxed);
+            }
+        }
+    }
+    return total;
+}
+
+std::string Stats::commandStats() const{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::string res;
+    for(size_t id=0; id<names.size(); id++){
+        Merged merged = merge(id);
+        if(merged.calls == 0){
+            continue;
+        }
+        char perCall[32];
+        snprintf(perCall, sizeof(perCall), "%.2f", static_cast<double>(merged.usec) / merged.calls);
+        res += "cmdstat_" + names[id] + ":calls=" + std::to_string(merged.calls) + ",usec=" + std::to_string(merged.usec) +
+            ",usec_per_call=" + perCall + "\n";
+    }
+    return res;
+}
+
+std::string Stats::latencyStats() const{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::string res;
+    for(size_t id=0; id<names.size(); id++){
+        Merged merged = merge(id);
+        if(merged.calls == 0){
+            continue;
+        }
+        res += "latency_percentiles_usec_" + names[id] + ":p50=" + std::to_string(percentile(merged, 50)) +
+            ",p99=" + std::to_string(percentile(merged, 99)) + ",p99.9=" + std::to_string(percentile(merged, 99.9)) + "\n";
+    }
+    return res;
+}
+
+/// @brief 从/proc/self/statm读取常驻内存页数
+size_t Stats::residentMemory(){
+    FILE *file = fopen("/proc/self/statm", "r");
+    if(file == nullptr){
+        return 0;
+    }
+    unsigned long size = 0;
+    unsigned long resident = 0;
+    int matched = fscanf(file, "%lu %lu", &size, &resident);
+    fclose(file);
+    return matched == 2 ? resident * sysconf(_SC_PAGESIZE) : 0;
+}
+
+size_t Stats::peakMemory(){
+    struct rusage usage;
+    if(getrusage(RUSAGE_SELF, &usage) != 0){
+        return 0;
+    }
+    return static_cast<size_t>(usage.ru_maxrss) * 1024;  //Linux上单位为KB
+}
+
+std::string Stats::humanBytes(size_t bytes){
+    const char *units[] = {"B", "K", "M", "G", "T"};
+    double value = bytes;
+    int unit = 0;
+    while(value >= 1024 && unit < 4){
+        value /= 1024;
+        unit++;
+    }
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "%.2f%s", value, units[unit]);
+    return buffer;
+}
@@ -0,0 +1,111 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <memory>
+#include <chrono>
+#include <cstdint>
+#include <unordered_map>
+
+#define STATS_MAX_COMMANDS 256          //最多统计的命令种类
+#define STATS_SUB_BUCKET_BITS 4         //每个2的幂区间再分16个桶，误差不超过1/16
+#define STATS_SUB_BUCKETS (1 << STATS_SUB_BUCKET_BITS)
+#define STATS_MAX_EXPONENT 36           //耗时超过2^36微秒（约19小时）的记在最后一个桶
+#define STATS_BUCKETS ((STATS_MAX_EXPONENT - STATS_SUB_BUCKET_BITS + 2) * STATS_SUB_BUCKETS)
+
+/*
+    命令统计：每种命令的调用次数、总耗时和耗时直方图
+    直方图与HDR Histogram相同，按对数分桶：小于16微秒每微秒一个桶，之后每个2的幂区间分16个桶，
+    固定大小，记录一次只需要计算下标并加一
+    每个线程有自己的计数器，只有本线程写，用relaxed的load/store更新，不需要锁也没有原子的读改写；
+    INFO读取时把所有线程的计数器相加，读到的是近似一致的快照
+*/
+class Stats{
+public:
+    static Stats& getInstance();
+
+    //记录一次命令执行，可以在任意线程调用
+    void record(const std::string &command, uint64_t usec);
+    uint64_t totalCommands() const;
+    //INFO commandstats：cmdstat_命令:calls=,usec=,usec_per_call=
+    std::string commandStats() const;
+    //INFO latencystats：latency_percentiles_usec_命令:p50=,p99=,p99.9=
+    std::string latencyStats() const;
+
+    static size_t residentMemory();     //当前常驻内存，字节
+    static size_t peakMemory();         //常驻内存峰值，字节
+    static std::string humanBytes(size_t bytes);
+    //直方图的分桶，值的单位不限，负载工具用它记录纳秒
+    static size_t bucketIndex(uint64_t usec);
+    static uint64_t bucketUpperBound(size_t index);
+
+    //在作用域结束时记录耗时
+    class Timer{
+    public:
+        explicit Timer(const std::string &command)
+        : command(command), start(std::chrono::steady_clock::now()) {}
+        ~Timer(){
+            if(!command.empty()){
+                auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+                Stats::getInstance().record(command, elapsed.count());
+            }
+        }
+        void cancel(){ command.clear(); }  //不记录这次执行，例如命令不存在
+        uint64_t elapsed() const{           //到目前为止的耗时，微秒
+            return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+        }
+    private:
+        std::string command;
+        std::chrono::steady_clock::time_point start;
+    };
+
+private:
+    struct Counters{
+        std::atomic<uint64_t> calls{0};
+        std::atomic<uint64_t> usec{0};
+        std::atomic<uint64_t> buckets[STATS_BUCKETS];
+        Counters(){
+            for(auto &bucket : buckets){
+                bucket.store(0, std::memory_order_relaxed);
+            }
+        }
+    };
+
+    //一个线程的计数器，命令第一次执行时才分配
+    struct Shard{
+        std::atomic<Counters*> commands[STATS_MAX_COMMANDS];
+        std::unordered_map<std::string, int> ids;   //命令名到下标的缓存，只有本线程访问
+        Shard(){
+            for(auto &command : commands){
+                command.store(nullptr, std::memory_order_relaxed);
+            }
+        }
+        ~Shard(){
+            for(auto &command : commands){
+                delete command.load(std::memory_order_relaxed);
+            }
+        }
+    };
+
+    struct Merged{
+        uint64_t calls = 0;
+        uint64_t usec = 0;
+        std::vector<uint64_t> buckets;
+    };
+
+    Stats() = default;
+    Shard& localShard();
+    int commandId(Shard &shard, const std::string &command);
+    Merged merge(int id) const;
+    static uint64_t percentile(const Merged &merged, double p);
+
+private:
+    mutable std::mutex mutex;                   //保护shards和names，记录时只在命令第一次出现时加锁
+    std::vector<std::unique_ptr<Shard>> shards; //线程退出后计数器仍然保留
+    std::vector<std::string> names;             //下标到命令名
+};
+
+#endif
@@ -0,0 +1,398 @@
+/*
+    微基准测试：跳表、序列化、位图、命令分发和请求执行（execute）端到端
+    编译（和服务端的源文件一起链接）：
+        g++ -std=c++20 -O2 -pthread benchmark/Benchmark.cpp $(ls *.cpp) -lzmq -o benchmark
+    用法：
+        ./benchmark [--filter 名称子串] [--max-keys N] [--repeat N] [--label 版本] [--text]
+    默认每行输出一个JSON对象，方便不同版本的结果直接对比：
+        {"label":"...","name":"skiplist/search","distribution":"zipfian","keys":1000000,"ops":1000000,"ns_per_op":...,...}
+    跳表的规模从1K开始每次乘10，默认到1M，--max-keys 100000000 可以测到100M（需要几十GB内存）
+*/
+#include <iostream>
+#include <string>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <algorithm>
+#include <functional>
+#include "../dataStructure/SkipList.h"
+#include "../dataStructure/Bitmap.h"
+#include "../RPC/Serializer.hpp"
+#include "../ParserFlyweightFactory.h"
+#include "../RedisServer.h"
+#include "Zipfian.h"
+
+#define BENCHMARK_MAX_OPS 1000000           //查找和删除最多执行的次数，规模更大时只抽样
+
+//防止编译器把没有使用的结果优化掉
+template <typename T>
+static inline void doNotOptimize(const T &value){
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+struct Options{
+    std::string filter;
+    uint64_t maxKeys = 1000000;
+    int repeat = 3;
+    std::string label = "dev";
+    bool text = false;
+};
+
+struct Result{
+    std::string name;
+    std::string distribution;   //没有时为空
+    uint64_t keys = 0;          //数据规模，没有时为0
+    uint64_t ops = 0;
+    uint64_t bytes = 0;         //每轮处理的字节数，用来计算吞吐量，没有时为0
+    std::vector<double> nanos{};    //每轮的总耗时
+};
+
+static Options options;
+
+static std::string jsonEscape(const std::string &str){
+    std::string res;
+    for(char c : str){
+        if(c == '"' || c == '\\'){
+            res += '\\';
+        }
+        res += c;
+    }
+    return res;
+}
+
+/// @brief 按最快的一轮计算每次操作的耗时，同时给出中位数，方便判断波动
+static void report(Result &result){
+    std::sort(result.nanos.begin(), result.nanos.end());
+    double best = result.nanos.front() / result.ops;
+    double median = result.nanos[result.nanos.size() / 2] / result.ops;
+    double opsPerSec = 1e9 / best;
+    double mbPerSec = result.bytes == 0 ? 0 : result.bytes / (result.nanos.front() / 1e9) / (1024 * 1024);
+    char line[512];
+    if(options.text){
+        snprintf(line, sizeof(line), "%-32s %-8s %10llu %12.1f ns/op %12.1f median %14.0f ops/s %10.1f MB/s",
+            result.name.c_str(), result.distribution.c_str(), (unsigned long long)result.keys, best, median, opsPerSec, mbPerSec);
+    }
+    else{
+        snprintf(line, sizeof(line), "{\"label\":\"%s\",\"name\":\"%s\",\"distribution\":\"%s\",\"keys\":%llu,\"ops\":%llu,"
+            "\"ns_per_op\":%.2f,\"median_ns_per_op\":%.2f,\"ops_per_sec\":%.0f,\"mb_per_sec\":%.2f}",
+            jsonEscape(options.label).c_str(), result.name.c_str(), result.distribution.c_str(), (unsigned long long)result.keys,
+            (unsigned long long)result.ops, best, median, opsPerSec, mbPerSec);
+    }
+    std::cout << line << std::endl;
+}
+
+static bool selected(const std::string &name){
+    return options.filter.empty() || name.find(options.filter) != std::string::npos;
+}
+
+/// @brief 执行repeat轮，每轮之前调用setup（不计时），body执行ops次操作
+static void run(Result result, const std::function<void()> &setup, const std::function<void()> &body){
+    for(int i=0; i<options.repeat; i++){
+        setup();
+        auto start = std::chrono::steady_clock::now();
+        body();
+        result.nanos.push_back(std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count());
+    }
+    report(result);
+}
+
+static double elapsedNanos(std::chrono::steady_clock::time_point start){
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+//第rank个键，rank经过打散，热点键分散在整个跳表中而不是集中在开头
+static std::string makeKey(uint64_t rank){
+    uint64_t hash = rank * 0x9E3779B97F4A7C15ULL;
+    char buf[32];
+    snprintf(buf, sizeof(buf), "key:%016llx", (unsigned long long)hash);
+    return buf;
+}
+
+/// @brief 按分布生成操作的键下标，uniform是均匀随机，zipfian是Zipf分布
+static std::vector<uint64_t> makeSequence(uint64_t keys, uint64_t ops, const std::string &distribution, std::mt19937_64 &rng){
+    std::vector<uint64_t> sequence(ops);
+    if(distribution == "uniform"){
+        std::uniform_int_distribution<uint64_t> uniform(0, keys - 1);
+        for(auto &index : sequence){
+            index = uniform(rng);
+        }
+    }
+    else{
+        ZipfianGenerator zipf(keys);
+        for(auto &index : sequence){
+            index = zipf.next(rng);
+        }
+    }
+    return sequence;
+}
+
+/*
+    跳表：每种规模先按随机顺序插入所有键，插入的耗时记为insert
+    search和delete按分布选择键，zipfian时热点键被反复访问，delete第一次命中之后都是未命中
+*/
+static void benchSkipList(){
+    std::mt19937_64 rng(42);
+    for(uint64_t keys=1000; keys<=options.maxKeys; keys*=10){
+        std::vector<std::string> names(keys);
+        for(uint64_t i=0; i<keys; i++){
+            names[i] = makeKey(i);
+        }
+        std::vector<uint64_t> order(keys);
+        for(uint64_t i=0; i<keys; i++){
+            order[i] = i;
+        }
+        std::shuffle(order.begin(), order.end(), rng);
+        uint64_t ops = std::min<uint64_t>(keys, BENCHMARK_MAX_OPS);
+
+        if(selected("skiplist/insert")){
+            Result result{"skiplist/insert", "uniform", keys, keys};
+            std::unique_ptr<SkipList<std::string, std::string>> list;
+            run(result, [&](){ list.reset(new SkipList<std::string, std::string>()); }, [&](){
+                for(uint64_t index : order){
+                    list->addItem(names[index], "value");
+                }
+            });
+        }
+        if(!selected("skiplist/search") && !selected("skiplist/delete")){
+            continue;
+        }
+        for(const std::string distribution : {"uniform", "zipfian"}){
+            std::vector<uint64_t> sequence = makeSequence(keys, ops, distribution, rng);
+            if(selected("skiplist/search")){
+                SkipList<std::string, std::string> list;
+                for(uint64_t index : order){
+                    list.addItem(names[index], "value");
+                }
+                Result result{"skiplist/search", distribution, keys, ops};
+                run(result, [](){}, [&](){
+                    for(uint64_t index : sequence){
+                        doNotOptimize(list.searchItem(names[index]));
+                    }
+                });
+            }
+            if(selected("skiplist/delete")){
+                //每轮都要重建跳表，只测一轮里的删除
+                Result result{"skiplist/delete", distribution, keys, ops};
+                std::unique_ptr<SkipList<std::string, std::string>> list;
+                run(result, [&](){
+                    list.reset(new SkipList<std::string, std::string>());
+                    for(uint64_t index : order){
+                        list->addItem(names[index], "value");
+                    }
+                }, [&](){
+                    for(uint64_t index : sequence){
+                        doNotOptimize(list->deleteItem(names[index]));
+                    }
+                });
+            }
+        }
+    }
+}
+
+/// @brief 一种类型的编码和解码，编码每满batch个值清空一次缓冲区
+template <typename T>
+static void benchSerializerType(const std::string &type, const T &value, size_t valueBytes){
+    const size_t batch = 1024;
+    const size_t rounds = 200;
+    uint64_t ops = batch * rounds;
+    if(selected("serializer/encode/" + type)){
+        Result result{"serializer/encode/" + type, "", 0, ops, ops * valueBytes};
+        run(result, [](){}, [&](){
+            Serializer ds;
+            for(size_t r=0; r<rounds; r++){
+                ds.clear();
+                for(size_t i=0; i<batch; i++){
+                    ds << value;
+                }
+                doNotOptimize(ds.size());
+            }
+        });
+    }
+    if(selected("serializer/decode/" + type)){
+        Serializer encoded;
+        for(size_t i=0; i<batch; i++){
+            encoded << value;
+        }
+        StreamBuffer buffer(encoded.data(), encoded.size());
+        Result result{"serializer/decode/" + type, "", 0, ops, ops * valueBytes};
+        run(result, [](){}, [&](){
+            for(size_t r=0; r<rounds; r++){
+                Serializer ds(buffer);
+                for(size_t i=0; i<batch; i++){
+                    T out{};
+                    ds >> out;
+                    doNotOptimize(out);
+                }
+            }
+        });
+    }
+}
+
+static void benchSerializer(){
+    benchSerializerType<int32_t>("int32", 123456789, sizeof(int32_t));
+    benchSerializerType<int64_t>("int64", 1234567890123LL, sizeof(int64_t));
+    benchSerializerType<double>("double", 3.1415926, sizeof(double));
+    benchSerializerType<std::string>("string16", std::string(16, 'x'), 16);
+    benchSerializerType<std::string>("string1k", std::string(1024, 'x'), 1024);
+}
+
+/// @brief 位图的BITCOUNT和BITOP核心循环，每种CPU支持的实现都测一遍，方便对比向量化的收益
+static void benchBitmap(){
+    const size_t bytes = 1024 * 1024;
+    const uint64_t rounds = 200;
+    std::mt19937_64 rng(42);
+    std::vector<uint8_t> a(bytes), b(bytes);
+    for(size_t i=0; i<bytes; i++){
+        a[i] = rng();
+        b[i] = rng();
+    }
+    std::vector<std::pair<std::string, BitmapCountKernel>> counts = {{"portable", bitmapCountPortable}};
+    std::vector<std::pair<std::string, BitmapOpKernel>> ops = {{"portable", bitmapOpPortable}};
+#ifdef BITMAP_X86_DISPATCH
+    if(__builtin_cpu_supports("avx2")){
+        counts.emplace_back("avx2", bitmapCountAvx2);
+        ops.emplace_back("avx2", bitmapOpAvx2);
+    }
+    if(__builtin_cpu_supports("avx512f")){
+        ops.emplace_back("avx512", bitmapOpAvx512);
+    }
+    if(__builtin_cpu_supports("avx512vpopcntdq")){
+        counts.emplace_back("avx512", bitmapCountAvx512);
+    }
+#endif
+    for(const auto &kernel : counts){
+        if(selected("bitmap/count/" + kernel.first)){
+            Result result{"bitmap/count/" + kernel.first, "", bytes, rounds, rounds * bytes};
+            run(result, [](){}, [&](){
+                for(uint64_t r=0; r<rounds; r++){
+                    doNotOptimize(kernel.second(a.data(), bytes));
+                }
+            });
+        }
+    }
+    for(const auto &kernel : ops){
+        if(selected("bitmap/xor/" + kernel.first)){
+            Result result{"bitmap/xor/" + kernel.first, "", bytes, rounds, rounds * bytes};
+            run(result, [](){}, [&](){
+                for(uint64_t r=0; r<rounds; r++){
+                    kernel.second(BITMAP_XOR, a.data(), b.data(), bytes);
+                    doNotOptimize(a[0]);
+                }
+            });
+        }
+    }
+}
+
+/// @brief 按命令表轮流取解析器，第一次取时创建，之后都是查表
+static void benchDispatch(){
+    if(!selected("parser/dispatch")){
+        return;
+    }
+    std::vector<std::string> names;
+    for(const auto &entry : commandMaps){
+        names.push_back(entry.first);
+    }
+    names.push_back("notacommand");
+    ParserFlyweightFactory factory;
+    const uint64_t rounds = 20000;
+    Result result{"parser/dispatch", "", names.size(), rounds * names.size()};
+    run(result, [](){}, [&](){
+        for(uint64_t r=0; r<rounds; r++){
+            for(const std::string &name : names){
+                doNotOptimize(factory.getParser(name));
+            }
+        }
+    });
+}
+
+/*
+    execute端到端（handleClient的同步部分）：分词、分发、执行、统计，不包括网络
+    每条命令在10万个键上循环，键预先写入，读命令都能命中
+*/
+static void benchHandleClient(){
+    const uint64_t keys = 100000;
+    struct Case{
+        std::string name;
+        std::function<std::string(uint64_t)> command;
+    };
+    std::vector<Case> cases = {
+        {"set", [](uint64_t i){ return "set " + makeKey(i) + " value"; }},
+        {"get", [](uint64_t i){ return "get " + makeKey(i); }},
+        {"exists", [](uint64_t i){ return "exists " + makeKey(i); }},
+        {"incr", [](uint64_t i){ return "incr counter:" + std::to_string(i % 1000); }},
+        {"mget", [](uint64_t i){ return "mget " + makeKey(i) + " " + makeKey((i + 1) % keys) + " " + makeKey((i + 2) % keys); }},
+        {"lpush", [](uint64_t i){ return "lpush list:" + std::to_string(i % 1000) + " item"; }},
+        {"lpop", [](uint64_t i){ return "lpop list:" + std::to_string(i % 1000); }},
+        {"hset", [](uint64_t i){ return "hset hash:" + std::to_string(i % 1000) + " field" + std::to_string(i % 100) + " value"; }},
+        {"hget", [](uint64_t i){ return "hget hash:" + std::to_string(i % 1000) + " field" + std::to_string(i % 100); }},
+        {"zadd", [](uint64_t i){ return "zadd zset:" + std::to_string(i % 1000) + " " + std::to_string(i % 100) + " member" + std::to_string(i % 100); }},
+        {"zscore", [](uint64_t i){ return "zscore zset:" + std::to_string(i % 1000) + " member" + std::to_string(i % 100); }},
+        {"del", [](uint64_t i){ return "del " + makeKey(i); }},
+    };
+    RedisServer *server = RedisServer::getInstance();
+    for(const Case &c : cases){
+        if(!selected("server/" + c.name)){
+            continue;
+        }
+        std::vector<std::string> commands(keys);
+        for(uint64_t i=0; i<keys; i++){
+            commands[i] = c.command(i);
+        }
+        Result result{"server/" + c.name, "", keys, keys};
+        run(result, [&](){
+            //del每轮都要有键可删，lpop每轮都要有元素可弹出
+            if(c.name == "del" || c.name == "get" || c.name == "exists" || c.name == "mget"){
+                for(uint64_t i=0; i<keys; i++){
+                    server->execute("set " + makeKey(i) + " value");
+                }
+            }
+            else if(c.name == "lpop"){
+                for(uint64_t i=0; i<keys; i++){
+                    server->execute("lpush list:" + std::to_string(i % 1000) + " item");
+                }
+            }
+        }, [&](){
+            for(const std::string &command : commands){
+                doNotOptimize(server->execute(command));
+            }
+        });
+    }
+}
+
+static void usage(const char *program){
+    std::cerr << "usage: " << program << " [--filter name] [--max-keys N] [--repeat N] [--label version] [--text]" << std::endl;
+}
+
+int main(int argc, char *argv[]){
+    for(int i=1; i<argc; i++){
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if(arg == "--filter" && hasValue){
+            options.filter = argv[++i];
+        }
+        else if(arg == "--max-keys" && hasValue){
+            options.maxKeys = std::stoull(argv[++i]);
+        }
+        else if(arg == "--repeat" && hasValue){
+            options.repeat = std::max(1, std::stoi(argv[++i]));
+        }
+        else if(arg == "--label" && hasValue){
+            options.label = argv[++i];
+        }
+        else if(arg == "--text"){
+            options.text = true;
+        }
+        else{
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    benchSkipList();
+    benchSerializer();
+    benchBitmap();
+    benchDispatch();
+    benchHandleClient();
+    return 0;
+}
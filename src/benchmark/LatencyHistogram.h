@@ -0,0 +1,62 @@
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include "../Stats.h"
+
+//直方图与INFO latencystats使用相同的对数分桶，单位是纳秒
+struct LatencyHistogram{
+    std::vector<uint64_t> counts = std::vector<uint64_t>(STATS_BUCKETS, 0);
+    uint64_t total = 0;
+    uint64_t max = 0;
+
+    void record(uint64_t value, uint64_t count=1){
+        counts[Stats::bucketIndex(value)] += count;
+        total += count;
+        max = std::max(max, value);
+    }
+
+    void merge(const LatencyHistogram &other){
+        for(size_t i=0; i<counts.size(); i++){
+            counts[i] += other.counts[i];
+        }
+        total += other.total;
+        max = std::max(max, other.max);
+    }
+
+    uint64_t percentile(double p) const{
+        uint64_t target = static_cast<uint64_t>(total * p / 100.0);
+        uint64_t seen = 0;
+        for(size_t i=0; i<counts.size(); i++){
+            seen += counts[i];
+            if(seen > target){
+                return std::min(Stats::bucketUpperBound(i), max);
+            }
+        }
+        return max;
+    }
+
+    /// @brief HdrHistogram的copyCorrectedForCoordinatedOmission：超过期望间隔的样本，
+    /// 补上卡顿期间本应发出的请求，它们的延迟依次少一个间隔
+    LatencyHistogram corrected(uint64_t interval) const{
+        LatencyHistogram res;
+        for(size_t i=0; i<counts.size(); i++){
+            if(counts[i] == 0){
+                continue;
+            }
+            uint64_t value = std::min(Stats::bucketUpperBound(i), max);
+            res.record(value, counts[i]);
+            if(interval == 0){
+                continue;
+            }
+            for(uint64_t missing = value > interval ? value - interval : 0; missing >= interval; missing -= interval){
+                res.record(missing, counts[i]);
+            }
+        }
+        return res;
+    }
+};
+
+#endif
@@ -0,0 +1,373 @@
+/*
+    端到端负载工具：用buttonrpc的流水线客户端向本机的服务端发送命令，报告吞吐量和延迟百分位数
+    编译：
+        g++ -std=c++17 -O2 -pthread benchmark/LoadGenerator.cpp Stats.cpp -lzmq -o loadgen
+    用法：
+        ./loadgen [--host 127.0.0.1] [--port 5555] [--connections 4] [--pipeline 1]
+                  [--requests 100000 | --duration 秒] [--rate 每秒总请求数]
+                  [--mix get=9,set=1] [--value-size 100 | 最小-最大] [--keys 100000]
+                  [--distribution uniform|zipfian] [--no-preload] [--label 版本] [--json]
+    支持的命令：get set del exists incr mget lpush lpop hset hget
+    延迟的协调遗漏（coordinated omission）修正：
+        指定--rate时按固定速率计划每个请求的发送时间，修正后的延迟从计划发送时间算起，服务端卡顿期间
+        本应发出却被推迟的请求都计入卡顿的时间（与wrk2相同）
+        不指定--rate时尽快发送，按HdrHistogram的做法用平均请求间隔补上卡顿期间缺失的样本
+*/
+#include <iostream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <cstdio>
+#include <functional>
+#include "../RPC/buttonrpc.hpp"
+#include "../RPC/ClusterClient.hpp"
+#include "Zipfian.h"
+#include "LatencyHistogram.h"
+
+#define LOADGEN_PRELOAD_PIPELINE 64     //预先写入键时的流水线深度
+#define LOADGEN_START_DELAY_MS 100      //所有连接建立后统一开始的延迟
+
+typedef std::chrono::steady_clock Clock;
+
+struct Options{
+    std::string host = "127.0.0.1";
+    int port = 5555;
+    int connections = 4;
+    int pipeline = 1;
+    uint64_t requests = 100000;
+    double duration = 0;        //大于0时按时间运行，忽略requests
+    double rate = 0;            //所有连接合计每秒的请求数，0表示不限速
+    std::string mix = "get=9,set=1";
+    size_t valueMin = 100;
+    size_t valueMax = 100;
+    uint64_t keys = 100000;
+    std::string distribution = "uniform";
+    bool preload = true;
+    std::string label = "dev";
+    bool json = false;
+};
+
+static Options options;
+
+struct Mix{
+    std::string command;
+    int weight;
+};
+
+struct ConnectionResult{
+    LatencyHistogram service;   //从实际发送到收到回复
+    LatencyHistogram intended;  //从计划发送时间到收到回复，只在限速时有意义
+    uint64_t requests = 0;
+    uint64_t errors = 0;
+};
+
+static std::vector<Mix> parseMix(const std::string &str){
+    static const std::vector<std::string> supported = {"get", "set", "del", "exists", "incr", "mget", "lpush", "lpop", "hset", "hget"};
+    std::vector<Mix> mix;
+    size_t start = 0;
+    while(start < str.size()){
+        size_t end = str.find(',', start);
+        std::string item = str.substr(start, end == std::string::npos ? std::string::npos : end - start);
+        size_t eq = item.find('=');
+        std::string command = item.substr(0, eq);
+        int weight = eq == std::string::npos ? 1 : std::stoi(item.substr(eq + 1));
+        if(std::find(supported.begin(), supported.end(), command) == supported.end() || weight < 0){
+            throw std::invalid_argument("unsupported command in --mix: " + item);
+        }
+        if(weight > 0){
+            mix.push_back({command, weight});
+        }
+        if(end == std::string::npos){
+            break;
+        }
+        start = end + 1;
+    }
+    if(mix.empty()){
+        throw std::invalid_argument("--mix is empty");
+    }
+    return mix;
+}
+
+static std::string makeKey(uint64_t index){
+    return "key:" + std::to_string(index);
+}
+
+/*
+    生成一个连接的请求：按权重选择命令，按分布选择键
+    zipfian时把排名打散到整个键空间，热点键不会都挤在一起
+*/
+class RequestGenerator{
+public:
+    RequestGenerator(const std::vector<Mix> &mix, uint64_t seed)
+    : mix(mix), rng(seed), values(options.valueMax, 'x') {
+        for(const Mix &item : mix){
+            totalWeight += item.weight;
+        }
+        if(options.distribution == "zipfian"){
+            zipf.reset(new ZipfianGenerator(options.keys));
+        }
+    }
+
+    std::string next(){
+        int pick = std::uniform_int_distribution<int>(0, totalWeight - 1)(rng);
+        const std::string *command = &mix.back().command;
+        for(const Mix &item : mix){
+            if(pick < item.weight){
+                command = &item.command;
+                break;
+            }
+            pick -= item.weight;
+        }
+        const std::string &name = *command;
+        std::string key = makeKey(nextKey());
+        if(name == "set"){
+            return "set " + key + " " + value();
+        }
+        if(name == "mget"){
+            return "mget " + key + " " + makeKey(nextKey()) + " " + makeKey(nextKey());
+        }
+        if(name == "lpush"){
+            return "lpush list:" + key + " " + value();
+        }
+        if(name == "lpop"){
+            return "lpop list:" + key;
+        }
+        if(name == "hset"){
+            return "hset hash:" + key + " field " + value();
+        }
+        if(name == "hget"){
+            return "hget hash:" + key + " field";
+        }
+        return name + " " + key;
+    }
+
+private:
+    uint64_t nextKey(){
+        if(zipf){
+            return (zipf->next(rng) * 0x9E3779B97F4A7C15ULL) % options.keys;
+        }
+        return std::uniform_int_distribution<uint64_t>(0, options.keys - 1)(rng);
+    }
+
+    std::string value(){
+        size_t size = std::uniform_int_distribution<size_t>(options.valueMin, options.valueMax)(rng);
+        return values.substr(0, size);
+    }
+
+private:
+    const std::vector<Mix> &mix;
+    int totalWeight = 0;
+    std::mt19937_64 rng;
+    std::unique_ptr<ZipfianGenerator> zipf;
+    std::string values;
+};
+
+static bool isError(buttonrpc::value_t<std::string> &reply){
+    if(!reply.valid()){
+        return true;
+    }
+    std::string val = reply.val();
+    return val.compare(0, 7, "(error)") == 0 || val.compare(0, 5, "Error") == 0;
+}
+
+/// @brief 读命令能命中：先写入所有字符串键
+static void preload(){
+    buttonrpc client;
+    client.as_pipelined_client(options.host, options.port);
+    std::string value(options.valueMin, 'x');
+    uint64_t sent = 0;
+    uint64_t received = 0;
+    while(received < options.keys){
+        while(sent < options.keys && sent - received < LOADGEN_PRELOAD_PIPELINE){
+            client.post(REDIS_COMMAND_RPC, "set " + makeKey(sent) + " " + value);
+            sent++;
+        }
+        client.fetch<std::string>();
+        received++;
+    }
+}
+
+/*
+    一个连接：最多保持pipeline个请求在途
+    限速时第i个请求的计划发送时间是start + i*interval，还没到时间就先接收回复或者等待
+*/
+static void runConnection(int id, uint64_t quota, Clock::time_point start, const std::vector<Mix> &mix, ConnectionResult &result){
+    buttonrpc client;
+    client.as_pipelined_client(options.host, options.port);
+    RequestGenerator generator(mix, 1000 + id);
+    std::chrono::nanoseconds interval(0);
+    if(options.rate > 0){
+        interval = std::chrono::nanoseconds(static_cast<int64_t>(1e9 * options.connections / options.rate));
+    }
+    Clock::time_point deadline = start + std::chrono::nanoseconds(static_cast<int64_t>(options.duration * 1e9));
+    std::deque<std::pair<Clock::time_point, Clock::time_point>> inflight;  //实际发送时间，计划发送时间
+    uint64_t sent = 0;
+    std::this_thread::sleep_until(start);
+    while(true){
+        Clock::time_point now = Clock::now();
+        bool finished = options.duration > 0 ? now >= deadline : sent >= quota;
+        while(!finished && inflight.size() < static_cast<size_t>(options.pipeline)){
+            Clock::time_point planned = options.rate > 0 ? start + interval * static_cast<int64_t>(sent) : now;
+            if(planned > now){
+                break;
+            }
+            client.post(REDIS_COMMAND_RPC, generator.next());
+            inflight.emplace_back(now, planned);
+            sent++;
+            finished = options.duration > 0 ? now >= deadline : sent >= quota;
+        }
+        if(inflight.empty()){
+            if(finished){
+                break;
+            }
+            std::this_thread::sleep_until(start + interval * static_cast<int64_t>(sent));
+            continue;
+        }
+        buttonrpc::value_t<std::string> reply = client.fetch<std::string>();
+        Clock::time_point done = Clock::now();
+        result.service.record(std::chrono::duration_cast<std::chrono::nanoseconds>(done - inflight.front().first).count());
+        result.intended.record(std::chrono::duration_cast<std::chrono::nanoseconds>(done - inflight.front().second).count());
+        if(isError(reply)){
+            result.errors++;
+        }
+        result.requests++;
+        inflight.pop_front();
+    }
+}
+
+static void printReport(const LatencyHistogram &service, const LatencyHistogram &corrected, uint64_t requests, uint64_t errors, double seconds){
+    const double percentiles[] = {50, 90, 99, 99.9, 99.99};
+    const char *names[] = {"p50", "p90", "p99", "p99.9", "p99.99"};
+    double throughput = requests / seconds;
+    if(options.json){
+        std::string line = "{\"label\":\"" + options.label + "\",\"connections\":" + std::to_string(options.connections) +
+            ",\"pipeline\":" + std::to_string(options.pipeline) + ",\"rate\":" + std::to_string(options.rate) +
+            ",\"mix\":\"" + options.mix + "\",\"distribution\":\"" + options.distribution +
+            "\",\"requests\":" + std::to_string(requests) + ",\"errors\":" + std::to_string(errors) +
+            ",\"seconds\":" + std::to_string(seconds) + ",\"ops_per_sec\":" + std::to_string(throughput);
+        for(const auto &entry : {std::make_pair("service", &service), std::make_pair("corrected", &corrected)}){
+            for(size_t i=0; i<5; i++){
+                line += ",\"" + std::string(entry.first) + "_" + names[i] + "_us\":" + std::to_string(entry.second->percentile(percentiles[i]) / 1000.0);
+            }
+            line += ",\"" + std::string(entry.first) + "_max_us\":" + std::to_string(entry.second->max / 1000.0);
+        }
+        std::cout << line << "}" << std::endl;
+        return;
+    }
+    printf("%s: %d connections, pipeline %d, %s, mix %s, %s keys\n", options.label.c_str(), options.connections, options.pipeline,
+        options.rate > 0 ? ("rate " + std::to_string(static_cast<uint64_t>(options.rate)) + "/s").c_str() : "unthrottled",
+        options.mix.c_str(), options.distribution.c_str());
+    printf("requests %llu, errors %llu, %.2f s, %.0f ops/s\n", (unsigned long long)requests, (unsigned long long)errors, seconds, throughput);
+    printf("%-12s", "latency(us)");
+    for(const char *name : names){
+        printf("%10s", name);
+    }
+    printf("%10s\n", "max");
+    for(const auto &entry : {std::make_pair("service", &service), std::make_pair("corrected", &corrected)}){
+        printf("%-12s", entry.first);
+        for(double p : percentiles){
+            printf("%10.1f", entry.second->percentile(p) / 1000.0);
+        }
+        printf("%10.1f\n", entry.second->max / 1000.0);
+    }
+}
+
+static void usage(const char *program){
+    std::cerr << "usage: " << program << " [--host h] [--port p] [--connections n] [--pipeline n] [--requests n | --duration s] [--rate ops]"
+        " [--mix get=9,set=1] [--value-size n|min-max] [--keys n] [--distribution uniform|zipfian] [--no-preload] [--label l] [--json]" << std::endl;
+}
+
+static bool parseArgs(int argc, char *argv[]){
+    for(int i=1; i<argc; i++){
+        std::string arg = argv[i];
+        if(arg == "--no-preload"){
+            options.preload = false;
+            continue;
+        }
+        if(arg == "--json"){
+            options.json = true;
+            continue;
+        }
+        if(i + 1 >= argc){
+            return false;
+        }
+        std::string value = argv[++i];
+        if(arg == "--host") options.host = value;
+        else if(arg == "--port") options.port = std::stoi(value);
+        else if(arg == "--connections") options.connections = std::max(1, std::stoi(value));
+        else if(arg == "--pipeline") options.pipeline = std::max(1, std::stoi(value));
+        else if(arg == "--requests") options.requests = std::stoull(value);
+        else if(arg == "--duration") options.duration = std::stod(value);
+        else if(arg == "--rate") options.rate = std::stod(value);
+        else if(arg == "--mix") options.mix = value;
+        else if(arg == "--keys") options.keys = std::max<uint64_t>(1, std::stoull(value));
+        else if(arg == "--distribution" && (value == "uniform" || value == "zipfian")) options.distribution = value;
+        else if(arg == "--label") options.label = value;
+        else if(arg == "--value-size"){
+            size_t dash = value.find('-');
+            options.valueMin = std::stoul(value.substr(0, dash));
+            options.valueMax = dash == std::string::npos ? options.valueMin : std::stoul(value.substr(dash + 1));
+            if(options.valueMin == 0 || options.valueMax < options.valueMin){
+                return false;
+            }
+        }
+        else return false;
+    }
+    return true;
+}
+
+int main(int argc, char *argv[]){
+    std::vector<Mix> mix;
+    try{
+        if(!parseArgs(argc, argv)){
+            usage(argv[0]);
+            return 1;
+        }
+        mix = parseMix(options.mix);
+    }
+    catch(const std::exception &e){
+        std::cerr << e.what() << std::endl;
+        usage(argv[0]);
+        return 1;
+    }
+    if(options.preload){
+        preload();
+    }
+    std::vector<ConnectionResult> results(options.connections);
+    std::vector<std::thread> threads;
+    Clock::time_point start = Clock::now() + std::chrono::milliseconds(LOADGEN_START_DELAY_MS);
+    for(int i=0; i<options.connections; i++){
+        //请求数平均分给每个连接，余数给前面的连接
+        uint64_t quota = options.requests / options.connections + (static_cast<uint64_t>(i) < options.requests % options.connections ? 1 : 0);
+        threads.emplace_back(runConnection, i, quota, start, std::cref(mix), std::ref(results[i]));
+    }
+    for(std::thread &thread : threads){
+        thread.join();
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    LatencyHistogram service;
+    LatencyHistogram intended;
+    uint64_t requests = 0;
+    uint64_t errors = 0;
+    for(const ConnectionResult &result : results){
+        service.merge(result.service);
+        intended.merge(result.intended);
+        requests += result.requests;
+        errors += result.errors;
+    }
+    LatencyHistogram corrected;
+    if(options.rate > 0){
+        corrected = intended;
+    }
+    else if(requests > 0){
+        //不限速时每个连接平均每隔这么久发出一个请求
+        uint64_t interval = static_cast<uint64_t>(seconds * 1e9 * options.connections / requests);
+        corrected = service.corrected(interval);
+    }
+    printReport(service, corrected, requests, errors, seconds);
+    return 0;
+}
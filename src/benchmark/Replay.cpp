@@ -0,0 +1,179 @@
+/*
+    回放CAPTURE录制的流量
+    编译：
+        g++ -std=c++17 -O2 -pthread benchmark/Replay.cpp Capture.cpp Stats.cpp -lzmq -o replay
+    用法：
+        ./replay capture_file [--host 127.0.0.1] [--port 5555] [--speed 1] [--pipeline 16] [--label 版本] [--json]
+    --speed 1 按录制时的节奏发送，2 表示两倍速，0 表示尽快发送
+    每个录制的连接对应一个回放连接，同一个连接的命令可以流水线发送（最多pipeline条在途）；
+    换到另一个连接发送之前先收完其他连接的所有回复，所以服务端执行命令的顺序与录制时完全相同，
+    对同一个初始状态的实例回放的结果是确定的
+*/
+#include <iostream>
+#include <string>
+#include <map>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <chrono>
+#include <cstdio>
+#include "../RPC/buttonrpc.hpp"
+#include "../RPC/ClusterClient.hpp"
+#include "../Capture.h"
+#include "LatencyHistogram.h"
+
+typedef std::chrono::steady_clock Clock;
+
+struct Options{
+    std::string path;
+    std::string host = "127.0.0.1";
+    int port = 5555;
+    double speed = 1;
+    size_t pipeline = 16;
+    std::string label = "dev";
+    bool json = false;
+};
+
+struct Connection{
+    std::unique_ptr<buttonrpc> client;
+    std::deque<Clock::time_point> inflight;     //在途请求的发送时间
+};
+
+static Options options;
+static LatencyHistogram latency;
+static uint64_t errors = 0;
+
+static void receiveOne(Connection &connection){
+    buttonrpc::value_t<std::string> reply = connection.client->fetch<std::string>();
+    latency.record(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - connection.inflight.front()).count());
+    connection.inflight.pop_front();
+    std::string val = reply.valid() ? reply.val() : "";
+    if(!reply.valid() || val.compare(0, 7, "(error)") == 0 || val.compare(0, 5, "Error") == 0){
+        errors++;
+    }
+}
+
+/// @brief 收完除except以外所有连接的回复
+static void drain(std::map<uint32_t, Connection> &connections, const Connection *except){
+    for(auto &entry : connections){
+        if(&entry.second == except){
+            continue;
+        }
+        while(!entry.second.inflight.empty()){
+            receiveOne(entry.second);
+        }
+    }
+}
+
+static void usage(const char *program){
+    std::cerr << "usage: " << program << " capture_file [--host h] [--port p] [--speed x] [--pipeline n] [--label l] [--json]" << std::endl;
+}
+
+static bool parseArgs(int argc, char *argv[]){
+    for(int i=1; i<argc; i++){
+        std::string arg = argv[i];
+        if(arg == "--json"){
+            options.json = true;
+            continue;
+        }
+        if(arg.compare(0, 2, "--") != 0){
+            if(!options.path.empty()){
+                return false;
+            }
+            options.path = arg;
+            continue;
+        }
+        if(i + 1 >= argc){
+            return false;
+        }
+        std::string value = argv[++i];
+        if(arg == "--host") options.host = value;
+        else if(arg == "--port") options.port = std::stoi(value);
+        else if(arg == "--speed") options.speed = std::stod(value);
+        else if(arg == "--pipeline") options.pipeline = std::max(1, std::stoi(value));
+        else if(arg == "--label") options.label = value;
+        else return false;
+    }
+    return !options.path.empty() && options.speed >= 0;
+}
+
+int main(int argc, char *argv[]){
+    try{
+        if(!parseArgs(argc, argv)){
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    catch(const std::exception &e){
+        usage(argv[0]);
+        return 1;
+    }
+    CaptureReader reader;
+    if(!reader.open(options.path)){
+        std::cerr << reader.error() << std::endl;
+        return 1;
+    }
+    std::map<uint32_t, Connection> connections;
+    Connection *current = nullptr;
+    CaptureRecord record;
+    uint64_t requests = 0;
+    uint64_t maxLag = 0;    //落后于录制节奏的最大纳秒数
+    Clock::time_point start = Clock::now();
+    while(reader.next(record)){
+        Connection &connection = connections[record.connection];
+        if(!connection.client){
+            connection.client.reset(new buttonrpc());
+            connection.client->as_pipelined_client(options.host, options.port);
+        }
+        if(options.speed > 0){
+            Clock::time_point planned = start + std::chrono::nanoseconds(static_cast<int64_t>(record.offset / options.speed));
+            if(Clock::now() < planned){
+                //等待期间不会有新的请求，先把回复都收了，延迟不包含等待的时间
+                drain(connections, nullptr);
+                std::this_thread::sleep_until(planned);
+            }
+            else{
+                maxLag = std::max<uint64_t>(maxLag, std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - planned).count());
+            }
+        }
+        if(&connection != current){
+            drain(connections, &connection);
+            current = &connection;
+        }
+        if(connection.inflight.size() >= options.pipeline){
+            receiveOne(connection);
+        }
+        connection.client->post(REDIS_COMMAND_RPC, record.command);
+        connection.inflight.push_back(Clock::now());
+        requests++;
+    }
+    drain(connections, nullptr);
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    if(!reader.error().empty()){
+        std::cerr << "stopped early: " << reader.error() << std::endl;
+    }
+    const double percentiles[] = {50, 90, 99, 99.9};
+    const char *names[] = {"p50", "p90", "p99", "p99.9"};
+    if(options.json){
+        std::string line = "{\"label\":\"" + options.label + "\",\"speed\":" + std::to_string(options.speed) +
+            ",\"connections\":" + std::to_string(connections.size()) + ",\"requests\":" + std::to_string(requests) +
+            ",\"errors\":" + std::to_string(errors) + ",\"seconds\":" + std::to_string(seconds) +
+            ",\"ops_per_sec\":" + std::to_string(requests / seconds) + ",\"max_lag_ms\":" + std::to_string(maxLag / 1e6);
+        for(size_t i=0; i<4; i++){
+            line += ",\"" + std::string(names[i]) + "_us\":" + std::to_string(latency.percentile(percentiles[i]) / 1000.0);
+        }
+        std::cout << line << ",\"max_us\":" << latency.max / 1000.0 << "}" << std::endl;
+        return 0;
+    }
+    printf("%s: %llu requests on %zu connections, errors %llu, %.2f s, %.0f ops/s\n", options.label.c_str(),
+        (unsigned long long)requests, connections.size(), (unsigned long long)errors, seconds, requests / seconds);
+    if(options.speed > 0){
+        printf("max lag behind capture pace: %.1f ms\n", maxLag / 1e6);
+    }
+    printf("latency(us)");
+    for(size_t i=0; i<4; i++){
+        printf("  %s %.1f", names[i], latency.percentile(percentiles[i]) / 1000.0);
+    }
+    printf("  max %.1f\n", latency.max / 1000.0);
+    return 0;
+}
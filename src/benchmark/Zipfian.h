@@ -0,0 +1,53 @@
+#ifndef ZIPFIAN_H
+#define ZIPFIAN_H
+
+#include <random>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+
+#define BENCHMARK_ZIPF_THETA 0.99   //与YCSB相同的倾斜度
+
+/*
+    Zipf分布的随机数，Gray等人的算法（YCSB的ZipfianGenerator），生成[0,n)，0最热
+    构造时计算zeta(n)，之后每次生成是O(1)
+*/
+class ZipfianGenerator{
+public:
+    ZipfianGenerator(uint64_t n, double theta=BENCHMARK_ZIPF_THETA) : n(n), theta(theta){
+        double zeta2 = zeta(2);
+        zetan = zeta(n);
+        alpha = 1.0 / (1.0 - theta);
+        eta = (1 - std::pow(2.0 / n, 1 - theta)) / (1 - zeta2 / zetan);
+    }
+
+    uint64_t next(std::mt19937_64 &rng){
+        double u = std::uniform_real_distribution<double>(0, 1)(rng);
+        double uz = u * zetan;
+        if(uz < 1.0){
+            return 0;
+        }
+        if(uz < 1.0 + std::pow(0.5, theta)){
+            return 1;
+        }
+        return std::min<uint64_t>(n - 1, static_cast<uint64_t>(n * std::pow(eta * u - eta + 1, alpha)));
+    }
+
+private:
+    double zeta(uint64_t count){
+        double sum = 0;
+        for(uint64_t i=1; i<=count; i++){
+            sum += 1.0 / std::pow(static_cast<double>(i), theta);
+        }
+        return sum;
+    }
+
+private:
+    uint64_t n;
+    double theta;
+    double zetan;
+    double alpha;
+    double eta;
+};
+
+#endif
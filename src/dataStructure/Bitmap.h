@@ -0,0 +1,231 @@
+#ifndef BITMAP_H
+#define BITMAP_H
+
+#include <string>
+#include <cstring>
+#include <cstdint>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define BITMAP_X86_DISPATCH
+#include <immintrin.h>
+#endif
+
+#define BITMAP_MAX_BITS (512ULL * 1024 * 1024 * 8)     //位图最长512MB，与字符串的最大长度相同
+
+
+/*
+    位图操作的核心循环，直接在字符串的字节缓冲区上计算
+    位的编号与Redis相同：第0位是第一个字节的最高位
+    BITCOUNT和BITOP的循环按CPU支持的指令集选择实现：AVX-512（VPOPCNTDQ）、AVX2、每次64位的通用实现，
+    第一次调用时用__builtin_cpu_supports检测一次，之后直接调用选中的函数
+    AVX2没有向量popcount，用pshufb查4位的表再用sad_epu8横向求和（Mula的算法）
+*/
+
+enum BitmapOp{
+    BITMAP_AND,BITMAP_OR,BITMAP_XOR,BITMAP_NOT
+};
+
+/// @brief 每次64位的通用实现，也用于处理向量循环剩下的尾部
+inline uint64_t bitmapCountPortable(const uint8_t *data, size_t len){
+    uint64_t count = 0;
+    size_t i = 0;
+    for(; i + 8 <= len; i += 8){
+        uint64_t word;
+        std::memcpy(&word, data + i, 8);
+        count += __builtin_popcountll(word);
+    }
+    for(; i < len; i++){
+        count += __builtin_popcount(data[i]);
+    }
+    return count;
+}
+
+/// @brief dst = dst op src，NOT时dst = ~src
+inline void bitmapOpPortable(BitmapOp op, uint8_t *dst, const uint8_t *src, size_t len){
+    size_t i = 0;
+    for(; i + 8 <= len; i += 8){
+        uint64_t a, b;
+        std::memcpy(&a, dst + i, 8);
+        std::memcpy(&b, src + i, 8);
+        switch(op){
+            case BITMAP_AND: a &= b; break;
+            case BITMAP_OR: a |= b; break;
+            case BITMAP_XOR: a ^= b; break;
+            case BITMAP_NOT: a = ~b; break;
+        }
+        std::memcpy(dst + i, &a, 8);
+    }
+    for(; i < len; i++){
+        switch(op){
+            case BITMAP_AND: dst[i] &= src[i]; break;
+            case BITMAP_OR: dst[i] |= src[i]; break;
+            case BITMAP_XOR: dst[i] ^= src[i]; break;
+            case BITMAP_NOT: dst[i] = ~src[i]; break;
+        }
+    }
+}
+
+#ifdef BITMAP_X86_DISPATCH
+
+__attribute__((target("avx2")))
+inline uint64_t bitmapCountAvx2(const uint8_t *data, size_t len){
+    const __m256i table = _mm256_setr_epi8(0,1,1,2,1,2,2,3,1,2,2,3,2,3,3,4, 0,1,1,2,1,2,2,3,1,2,2,3,2,3,3,4);
+    const __m256i low = _mm256_set1_epi8(0x0f);
+    __m256i total = _mm256_setzero_si256();
+    size_t i = 0;
+    while(i + 32 <= len){
+        //每个字节的计数最多是8，累加31次之前不会溢出
+        __m256i partial = _mm256_setzero_si256();
+        for(int round = 0; round < 31 && i + 32 <= len; round++, i += 32){
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+            __m256i lo = _mm256_shuffle_epi8(table, _mm256_and_si256(v, low));
+            __m256i hi = _mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi16(v, 4), low));
+            partial = _mm256_add_epi8(partial, _mm256_add_epi8(lo, hi));
+        }
+        total = _mm256_add_epi64(total, _mm256_sad_epu8(partial, _mm256_setzero_si256()));
+    }
+    uint64_t lanes[4];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), total);
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3] + bitmapCountPortable(data + i, len - i);
+}
+
+__attribute__((target("avx512f,avx512vpopcntdq")))
+inline uint64_t bitmapCountAvx512(const uint8_t *data, size_t len){
+    __m512i total = _mm512_setzero_si512();
+    size_t i = 0;
+    for(; i + 64 <= len; i += 64){
+        total = _mm512_add_epi64(total, _mm512_popcnt_epi64(_mm512_loadu_si512(data + i)));
+    }
+    uint64_t lanes[8];
+    _mm512_storeu_si512(lanes, total);
+    uint64_t count = bitmapCountPortable(data + i, len - i);
+    for(uint64_t lane : lanes){
+        count += lane;
+    }
+    return count;
+}
+
+__attribute__((target("avx2")))
+inline void bitmapOpAvx2(BitmapOp op, uint8_t *dst, const uint8_t *src, size_t len){
+    size_t i = 0;
+    const __m256i ones = _mm256_set1_epi8(-1);
+    for(; i + 32 <= len; i += 32){
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        switch(op){
+            case BITMAP_AND: a = _mm256_and_si256(a, b); break;
+            case BITMAP_OR: a = _mm256_or_si256(a, b); break;
+            case BITMAP_XOR: a = _mm256_xor_si256(a, b); break;
+            case BITMAP_NOT: a = _mm256_xor_si256(b, ones); break;
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), a);
+    }
+    bitmapOpPortable(op, dst + i, src + i, len - i);
+}
+
+__attribute__((target("avx512f")))
+inline void bitmapOpAvx512(BitmapOp op, uint8_t *dst, const uint8_t *src, size_t len){
+    size_t i = 0;
+    const __m512i ones = _mm512_set1_epi64(-1);
+    for(; i + 64 <= len; i += 64){
+        __m512i a = _mm512_loadu_si512(dst + i);
+        __m512i b = _mm512_loadu_si512(src + i);
+        switch(op){
+            case BITMAP_AND: a = _mm512_and_si512(a, b); break;
+            case BITMAP_OR: a = _mm512_or_si512(a, b); break;
+            case BITMAP_XOR: a = _mm512_xor_si512(a, b); break;
+            case BITMAP_NOT: a = _mm512_xor_si512(b, ones); break;
+        }
+        _mm512_storeu_si512(dst + i, a);
+    }
+    bitmapOpPortable(op, dst + i, src + i, len - i);
+}
+
+#endif
+
+typedef uint64_t (*BitmapCountKernel)(const uint8_t*, size_t);
+typedef void (*BitmapOpKernel)(BitmapOp, uint8_t*, const uint8_t*, size_t);
+
+/// @brief 统计缓冲区中1的个数
+inline uint64_t bitmapCount(const uint8_t *data, size_t len){
+#ifdef BITMAP_X86_DISPATCH
+    static const BitmapCountKernel kernel =
+        __builtin_cpu_supports("avx512vpopcntdq") ? bitmapCountAvx512 :
+        __builtin_cpu_supports("avx2") ? bitmapCountAvx2 : bitmapCountPortable;
+    return kernel(data, len);
+#else
+    return bitmapCountPortable(data, len);
+#endif
+}
+
+/// @brief 按位运算，结果写回dst：dst = dst op src，NOT时dst = ~src
+inline void bitmapOp(BitmapOp op, uint8_t *dst, const uint8_t *src, size_t len){
+#ifdef BITMAP_X86_DISPATCH
+    static const BitmapOpKernel kernel =
+        __builtin_cpu_supports("avx512f") ? bitmapOpAvx512 :
+        __builtin_cpu_supports("avx2") ? bitmapOpAvx2 : bitmapOpPortable;
+    kernel(op, dst, src, len);
+#else
+    bitmapOpPortable(op, dst, src, len);
+#endif
+}
+
+/**
+ * @brief 统计第first位到第last位（都包含）中1的个数
+ * 两端不完整的字节用掩码处理，中间的整字节交给bitmapCount
+*/
+inline uint64_t bitmapCountBits(const uint8_t *data, uint64_t first, uint64_t last){
+    uint64_t firstByte = first / 8, lastByte = last / 8;
+    uint8_t headMask = 0xff >> (first % 8);
+    uint8_t tailMask = 0xff << (7 - last % 8);
+    if(firstByte == lastByte){
+        return __builtin_popcount(data[firstByte] & headMask & tailMask);
+    }
+    return __builtin_popcount(data[firstByte] & headMask) + __builtin_popcount(data[lastByte] & tailMask)
+        + bitmapCount(data + firstByte + 1, lastByte - firstByte - 1);
+}
+
+/**
+ * @brief 查找第first位到第last位（都包含）中第一个值为bit的位
+ * @return 位的编号，没有找到时返回-1
+*/
+inline int64_t bitmapFindBit(const uint8_t *data, uint64_t first, uint64_t last, int bit){
+    //要找0时把字节取反，统一成找1
+    const uint8_t flip = bit ? 0 : 0xff;
+    uint64_t pos = first;
+    //先逐位处理到字节边界
+    while(pos <= last && pos % 8 != 0){
+        if(((data[pos / 8] ^ flip) >> (7 - pos % 8)) & 1){
+            return pos;
+        }
+        pos++;
+    }
+    //中间的整字节每次比较8个字节
+    const uint64_t skip = bit ? 0 : ~0ULL;
+    uint64_t byte = pos / 8;
+    while(pos + 64 <= last + 1){
+        uint64_t word;
+        std::memcpy(&word, data + byte, 8);
+        if(word != skip){
+            break;
+        }
+        byte += 8;
+        pos += 64;
+    }
+    while(pos + 8 <= last + 1){
+        uint8_t value = data[byte] ^ flip;
+        if(value != 0){
+            return pos + __builtin_clz(value) - 24;
+        }
+        byte++;
+        pos += 8;
+    }
+    for(; pos <= last; pos++){
+        if(((data[pos / 8] ^ flip) >> (7 - pos % 8)) & 1){
+            return pos;
+        }
+    }
+    return -1;
+}
+
+#endif
@@ -0,0 +1,118 @@
+#include "Bitmap.h"
+#include <iostream>
+#include <vector>
+#include <random>
+#include <cassert>
+
+static int referenceBit(const uint8_t *data, uint64_t pos){
+    return (data[pos / 8] >> (7 - pos % 8)) & 1;
+}
+
+static uint64_t referenceCount(const uint8_t *data, size_t len){
+    uint64_t count = 0;
+    for(uint64_t pos=0; pos<len*8; pos++){
+        count += referenceBit(data, pos);
+    }
+    return count;
+}
+
+static uint8_t referenceOp(BitmapOp op, uint8_t a, uint8_t b){
+    switch(op){
+        case BITMAP_AND: return a & b;
+        case BITMAP_OR: return a | b;
+        case BITMAP_XOR: return a ^ b;
+        default: return ~b;
+    }
+}
+
+//CPU支持的每一种实现都与逐位计算的结果对照，长度覆盖向量循环的尾部，起始地址不对齐
+static void compareKernels(const std::vector<BitmapCountKernel> &counts, const std::vector<BitmapOpKernel> &ops){
+    std::mt19937 generator(1);
+    std::vector<uint8_t> buffer(1024 + 64);
+    std::vector<uint8_t> other(buffer.size());
+    for(int i=0; i<3000; i++){
+        size_t len = i < 300 ? i : generator() % 1024;
+        size_t offset = generator() % 64;
+        //稀疏、稠密和随机的内容
+        int density = generator() % 3;
+        for(size_t j=0; j<buffer.size(); j++){
+            uint8_t random = generator();
+            buffer[j] = density == 0 ? (random & generator() & generator()) : density == 1 ? (random | generator()) : random;
+            other[j] = generator();
+        }
+        const uint8_t *data = buffer.data() + offset;
+        uint64_t expected = referenceCount(data, len);
+        for(BitmapCountKernel kernel : counts){
+            assert(kernel(data, len) == expected);
+        }
+        BitmapOp op = static_cast<BitmapOp>(generator() % 4);
+        std::vector<uint8_t> expectedOp(len);
+        for(size_t j=0; j<len; j++){
+            expectedOp[j] = referenceOp(op, buffer[offset + j], other[j]);
+        }
+        for(BitmapOpKernel kernel : ops){
+            std::vector<uint8_t> dst(buffer.begin() + offset, buffer.begin() + offset + len);
+            kernel(op, dst.data(), other.data(), len);
+            assert(dst == expectedOp);
+        }
+    }
+    std::cout<<"count kernels="<<counts.size()<<" op kernels="<<ops.size()<<std::endl;
+}
+
+//按位的区间统计和查找，区间两端落在字节中间
+static void compareRanges(){
+    std::mt19937 generator(2);
+    std::vector<uint8_t> data(300);
+    for(int i=0; i<20000; i++){
+        int density = generator() % 4;
+        for(uint8_t &byte : data){
+            byte = density == 0 ? 0 : density == 1 ? 0xff : density == 2 ? (generator() % 16 == 0 ? generator() : 0xff) : generator();
+        }
+        uint64_t first = generator() % (data.size() * 8);
+        uint64_t last = first + generator() % (data.size() * 8 - first);
+        uint64_t count = 0;
+        for(uint64_t pos=first; pos<=last; pos++){
+            count += referenceBit(data.data(), pos);
+        }
+        assert(bitmapCountBits(data.data(), first, last) == count);
+        for(int bit=0; bit<=1; bit++){
+            int64_t expected = -1;
+            for(uint64_t pos=first; pos<=last; pos++){
+                if(referenceBit(data.data(), pos) == bit){
+                    expected = pos;
+                    break;
+                }
+            }
+            assert(bitmapFindBit(data.data(), first, last, bit) == expected);
+        }
+    }
+    std::cout<<"ranges OK"<<std::endl;
+}
+
+int main(){
+    uint8_t bytes[] = {0x80, 0x00, 0x01, 0xff};
+    std::cout<<bitmapCount(bytes, 4)<<" "<<bitmapFindBit(bytes, 0, 31, 1)<<" "<<bitmapFindBit(bytes, 1, 31, 1)<<std::endl;
+    assert(bitmapCount(bytes, 4) == 10);
+    assert(bitmapCountBits(bytes, 0, 0) == 1 && bitmapCountBits(bytes, 1, 22) == 0 && bitmapCountBits(bytes, 23, 31) == 9);
+    assert(bitmapFindBit(bytes, 1, 31, 1) == 23);
+    assert(bitmapFindBit(bytes, 24, 31, 0) == -1);
+
+    std::vector<BitmapCountKernel> counts = {bitmapCountPortable, bitmapCount};
+    std::vector<BitmapOpKernel> ops = {bitmapOpPortable, bitmapOp};
+#ifdef BITMAP_X86_DISPATCH
+    if(__builtin_cpu_supports("avx2")){
+        counts.push_back(bitmapCountAvx2);
+        ops.push_back(bitmapOpAvx2);
+    }
+    if(__builtin_cpu_supports("avx512vpopcntdq")){
+        counts.push_back(bitmapCountAvx512);
+    }
+    if(__builtin_cpu_supports("avx512f")){
+        ops.push_back(bitmapOpAvx512);
+    }
+#endif
+    compareKernels(counts, ops);
+    compareRanges();
+    std::cout<<"Bitmap OK"<<std::endl;
+    return 0;
+}
@@ -0,0 +1,278 @@
+#ifndef BLOOM_FILTER_H
+#define BLOOM_FILTER_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <cmath>
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+#include "MurmurHash.h"
+
+#define BLOOM_BLOCK_BITS 512                //一个块正好是一条64字节的缓存行
+#define BLOOM_DEFAULT_ERROR_RATE 0.01
+#define BLOOM_DEFAULT_CAPACITY 100
+#define BLOOM_EXPANSION 2                   //写满后新建的层是上一层容量的2倍
+#define BLOOM_TIGHTENING 0.5                //新建的层误判率减半，总的误判率不超过第一层的2倍
+#define BLOOM_MAX_HASHES 16
+#define BLOOM_MODEL_MARGIN 0.9              //实际的块负载比泊松模型稍不均匀，按误判率的90%计算大小
+
+
+/*
+    分块布隆过滤器：位数组按64字节的缓存行分块，每个元素先用哈希选一个块，k个位都在这个块内，
+    添加和查询都只访问一条缓存行
+    每个块中的元素个数近似服从泊松分布，元素多的块误判率高，每一层按这个模型选择哈希个数和块数，
+    使写满时的误判率不超过设定值，写满之后新建一层（容量翻倍、误判率减半），
+    查询时检查所有层，添加时已经存在（可能误判）的元素不再写入
+*/
+class BloomFilter{
+public:
+    explicit BloomFilter(double errorRate=BLOOM_DEFAULT_ERROR_RATE, uint64_t capacity=BLOOM_DEFAULT_CAPACITY){
+        addLayer(errorRate, capacity);
+    }
+
+    /// @brief 添加元素
+    /// @return 元素原来不存在时返回true，可能已经存在时返回false
+    bool add(const std::string &item){
+        uint64_t hash = murmurHash64A(item.data(), item.size(), 0);
+        if(contains(hash)){
+            return false;
+        }
+        if(layers.back().count >= layers.back().capacity){
+            addLayer(layers.back().errorRate * BLOOM_TIGHTENING, layers.back().capacity * BLOOM_EXPANSION);
+        }
+        Layer &layer = layers.back();
+        Block &block = layer.blocks[layer.blockIndex(hash, layers.size() - 1)];
+        forEachBit(hash, layer.hashes, [&block](uint32_t bit){
+            block.words[bit / 64] |= 1ULL << (bit % 64);
+            return true;
+        });
+        layer.count++;
+        items++;
+        return true;
+    }
+
+    /// @brief 元素是否可能存在，不存在时一定返回false
+    bool contains(const std::string &item) const{
+        return contains(murmurHash64A(item.data(), item.size(), 0));
+    }
+
+    uint64_t size() const { return items; }
+    uint64_t capacity() const{
+        uint64_t total = 0;
+        for(const Layer &layer : layers){
+            total += layer.capacity;
+        }
+        return total;
+    }
+    size_t bytes() const{
+        size_t total = 0;
+        for(const Layer &layer : layers){
+            total += layer.blockCount * sizeof(Block);
+        }
+        return total;
+    }
+    size_t layerCount() const { return layers.size(); }
+
+    /// @brief 编码：层数，每层的误判率、容量、元素个数、哈希个数、块数和所有块
+    std::string serialize() const{
+        std::string data;
+        appendFixed(data, static_cast<uint32_t>(layers.size()));
+        for(const Layer &layer : layers){
+            appendFixed(data, layer.errorRate);
+            appendFixed(data, layer.capacity);
+            appendFixed(data, layer.count);
+            appendFixed(data, layer.hashes);
+            appendFixed(data, layer.blockCount);
+            data.append(reinterpret_cast<const char*>(layer.blocks.get()), layer.blockCount * sizeof(Block));
+        }
+        return data;
+    }
+
+    /// @brief 从serialize的结果恢复，格式不对时返回false
+    bool deserialize(const std::string &data){
+        size_t offset = 0;
+        uint32_t count = 0;
+        if(!readFixed(data, offset, count) || count == 0){
+            return false;
+        }
+        std::vector<Layer> restored;
+        uint64_t total = 0;
+        for(uint32_t i=0; i<count; i++){
+            Layer layer;
+            if(!readFixed(data, offset, layer.errorRate) || !readFixed(data, offset, layer.capacity)
+                || !readFixed(data, offset, layer.count) || !readFixed(data, offset, layer.hashes)
+                || !readFixed(data, offset, layer.blockCount)){
+                return false;
+            }
+            if(layer.blockCount == 0 || layer.hashes == 0 || layer.hashes > BLOOM_MAX_HASHES
+                || (data.size() - offset) / sizeof(Block) < layer.blockCount){
+                return false;
+            }
+            layer.blocks.reset(new Block[layer.blockCount]);
+            std::memcpy(layer.blocks.get(), data.data() + offset, layer.blockCount * sizeof(Block));
+            offset += layer.blockCount * sizeof(Block);
+            total += layer.count;
+            restored.push_back(std::move(layer));
+        }
+        if(offset != data.size()){
+            return false;
+        }
+        layers.swap(restored);
+        items = total;
+        return true;
+    }
+
+private:
+    struct alignas(64) Block{
+        uint64_t words[BLOOM_BLOCK_BITS / 64];
+    };
+
+    struct Layer{
+        double errorRate = 0;
+        uint64_t capacity = 0;
+        uint64_t count = 0;
+        uint32_t hashes = 0;
+        uint64_t blockCount = 0;
+        std::unique_ptr<Block[]> blocks;    //Block按缓存行对齐，new[]分配的数组也是对齐的
+
+        //每层用不同的方式选块，同一个元素在各层落在不相关的位置
+        uint64_t blockIndex(uint64_t hash, size_t level) const{
+            uint64_t mixed = (hash ^ (level * 0x9E3779B97F4A7C15ULL)) * 0xff51afd7ed558ccdULL;
+            return static_cast<uint64_t>((static_cast<unsigned __int128>(mixed) * blockCount) >> 64);
+        }
+    };
+
+    /// @brief 在块内生成k个位的位置，callback返回false时停止
+    /// 双重哈希(a + i*b)只用到a和b的高几位，同一块中高位相同的两个元素所有位都重合，误判率有下限，
+    /// 这里以哈希值为种子用splitmix64生成64位的随机数，每个随机数提供7个9位的位置
+    template <typename Callback>
+    static bool forEachBit(uint64_t hash, uint32_t hashes, Callback callback){
+        uint64_t state = hash;
+        uint64_t random = 0;
+        for(uint32_t i=0; i<hashes; i++){
+            if(i % 7 == 0){
+                state += 0x9E3779B97F4A7C15ULL;
+                random = state;
+                random = (random ^ (random >> 30)) * 0xbf58476d1ce4e5b9ULL;
+                random = (random ^ (random >> 27)) * 0x94d049bb133111ebULL;
+                random ^= random >> 31;
+            }
+            if(!callback(static_cast<uint32_t>(random & (BLOOM_BLOCK_BITS - 1)))){
+                return false;
+            }
+            random >>= 9;
+        }
+        return true;
+    }
+
+    bool contains(uint64_t hash) const{
+        for(size_t i=0; i<layers.size(); i++){
+            const Layer &layer = layers[i];
+            const Block &block = layer.blocks[layer.blockIndex(hash, i)];
+            bool found = forEachBit(hash, layer.hashes, [&block](uint32_t bit){
+                return (block.words[bit / 64] >> (bit % 64)) & 1;
+            });
+            if(found){
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /// @brief 分块布隆过滤器的误判率：每块的元素个数服从均值为n/blockCount的泊松分布，
+    /// 有j个元素的块中一个位被置1的概率是1-(1-1/BLOOM_BLOCK_BITS)^(kj)，查询命中的概率是它的k次方
+    static double blockedErrorRate(uint64_t capacity, uint64_t blockCount, uint32_t hashes){
+        double lambda = static_cast<double>(capacity) / blockCount;
+        //每块平均几万个元素时所有位都已置1
+        if(lambda > 64 * BLOOM_BLOCK_BITS){
+            return 1.0;
+        }
+        double spread = 12 * std::sqrt(lambda) + 12;
+        uint64_t first = lambda > spread ? static_cast<uint64_t>(lambda - spread) : 0;
+        uint64_t last = static_cast<uint64_t>(lambda + spread);
+        double miss = std::log1p(-1.0 / BLOOM_BLOCK_BITS) * hashes;
+        double rate = 0;
+        for(uint64_t j=first; j<=last; j++){
+            double probability = std::exp(j * std::log(lambda) - lambda - std::lgamma(j + 1.0));
+            rate += probability * std::pow(-std::expm1(miss * j), hashes);
+        }
+        return rate;
+    }
+
+    /// @brief 哈希个数固定时，满足误判率的最少块数，每个元素占一块也达不到时返回0
+    static uint64_t blocksFor(double errorRate, uint64_t capacity, uint32_t hashes){
+        //相同位数下分块的误判率不低于标准布隆过滤器，从标准公式算出的块数开始找
+        double standardBits = -static_cast<double>(hashes) * capacity / std::log1p(-std::pow(errorRate, 1.0 / hashes));
+        double limit = static_cast<double>(capacity) * BLOOM_BLOCK_BITS;
+        if(!(standardBits / BLOOM_BLOCK_BITS < limit)){
+            return 0;
+        }
+        uint64_t low = static_cast<uint64_t>(standardBits / BLOOM_BLOCK_BITS);     //low个块不满足
+        uint64_t high = std::max<uint64_t>(1, low * 2);
+        while(blockedErrorRate(capacity, high, hashes) > errorRate){
+            if(high >= limit || high > UINT64_MAX / 2){
+                return 0;
+            }
+            low = high;
+            high *= 2;
+        }
+        while(low + 1 < high){
+            uint64_t middle = low + (high - low) / 2;
+            if(blockedErrorRate(capacity, middle, hashes) > errorRate){
+                low = middle;
+            }
+            else{
+                high = middle;
+            }
+        }
+        return high;
+    }
+
+    void addLayer(double errorRate, uint64_t capacity){
+        Layer layer;
+        layer.errorRate = errorRate;
+        layer.capacity = capacity;
+        //块内的位分布不均匀，标准布隆过滤器的公式会低估误判率，逐个哈希个数计算需要的块数，
+        //块数先随哈希个数减少再增加，开始增加时停止
+        for(uint32_t hashes=1; hashes<=BLOOM_MAX_HASHES; hashes++){
+            uint64_t blocks = blocksFor(errorRate * BLOOM_MODEL_MARGIN, std::max<uint64_t>(1, capacity), hashes);
+            if(blocks != 0 && (layer.blockCount == 0 || blocks < layer.blockCount)){
+                layer.blockCount = blocks;
+                layer.hashes = hashes;
+            }
+            else if(layer.blockCount != 0 && blocks > layer.blockCount){
+                break;
+            }
+        }
+        //误判率太小，BLOOM_MAX_HASHES个哈希也达不到时按每个元素一个块分配
+        if(layer.blockCount == 0){
+            layer.blockCount = std::max<uint64_t>(1, capacity);
+            layer.hashes = BLOOM_MAX_HASHES;
+        }
+        layer.blocks.reset(new Block[layer.blockCount]());
+        layers.push_back(std::move(layer));
+    }
+
+    template <typename T>
+    static void appendFixed(std::string &data, T value){
+        data.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    template <typename T>
+    static bool readFixed(const std::string &data, size_t &offset, T &value){
+        if(data.size() - offset < sizeof(T)){
+            return false;
+        }
+        std::memcpy(&value, data.data() + offset, sizeof(T));
+        offset += sizeof(T);
+        return true;
+    }
+
+private:
+    std::vector<Layer> layers;
+    uint64_t items = 0;     //所有层的元素个数
+};
+
+#endif
@@ -0,0 +1,66 @@
+#include "BloomFilter.h"
+#include <iostream>
+#include <cassert>
+
+static double measuredErrorRate(const BloomFilter &filter, uint64_t queries){
+    uint64_t positives = 0;
+    for(uint64_t i=0; i<queries; i++){
+        positives += filter.contains("absent:" + std::to_string(i));
+    }
+    return static_cast<double>(positives) / queries;
+}
+
+//写满一层时的误判率不超过设定值，已添加的元素一定能查到
+static void errorRate(double rate, uint64_t capacity){
+    BloomFilter filter(rate, capacity);
+    for(uint64_t i=0; i<capacity; i++){
+        filter.add("member:" + std::to_string(i));
+    }
+    assert(filter.layerCount() == 1 && filter.size() <= capacity);
+    for(uint64_t i=0; i<capacity; i++){
+        assert(filter.contains("member:" + std::to_string(i)));
+    }
+    double measured = measuredErrorRate(filter, 500 / rate);
+    std::cout<<"error rate "<<rate<<" measured "<<measured<<" bits/item "<<filter.bytes() * 8.0 / capacity<<std::endl;
+    assert(measured <= rate);
+}
+
+//写满后扩容，新的层误判率减半，总的误判率不超过第一层的2倍
+static void expansion(){
+    BloomFilter filter(0.01, 1000);
+    for(int i=0; i<20000; i++){
+        filter.add("member:" + std::to_string(i));
+    }
+    assert(filter.layerCount() > 1 && filter.capacity() >= filter.size());
+    for(int i=0; i<20000; i++){
+        assert(filter.contains("member:" + std::to_string(i)));
+    }
+    double measured = measuredErrorRate(filter, 200000);
+    std::cout<<"layers "<<filter.layerCount()<<" measured "<<measured<<std::endl;
+    assert(measured <= 0.02);
+
+    BloomFilter copy;
+    assert(copy.deserialize(filter.serialize()));
+    assert(copy.size() == filter.size() && copy.layerCount() == filter.layerCount() && copy.serialize() == filter.serialize());
+    for(int i=0; i<20000; i+=7){
+        assert(copy.contains("member:" + std::to_string(i)));
+    }
+}
+
+int main(){
+    BloomFilter filter(0.01, 100);
+    assert(filter.add("a") && !filter.add("a") && filter.size() == 1);
+    assert(filter.contains("a") && !filter.contains("b"));
+    //格式错误的数据
+    std::string data = filter.serialize();
+    assert(!filter.deserialize("") && !filter.deserialize(data.substr(0, data.size() - 1)) && !filter.deserialize(data + "x"));
+    assert(filter.deserialize(data) && filter.contains("a"));
+
+    errorRate(0.01, 20000);
+    errorRate(0.001, 20000);
+    errorRate(0.0001, 20000);
+    errorRate(0.05, 1);
+    expansion();
+    std::cout<<"BloomFilter OK"<<std::endl;
+    return 0;
+}
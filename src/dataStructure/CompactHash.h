@@ -0,0 +1,348 @@
+#ifndef COMPACT_HASH_H
+#define COMPACT_HASH_H
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <cstdint>
+
+#define HASH_MAX_PACKED_ENTRIES 128     //紧凑编码最多保存的字段个数的默认值，可以由构造函数指定
+#define HASH_MAX_PACKED_VALUE 64        //紧凑编码中字段或值的最大字节数的默认值，可以由构造函数指定
+#define HASH_INIT_CAPACITY 16           //哈希表初始槽位数，必须是2的幂
+#define HASH_MAX_LOAD_FACTOR 0.75       //哈希表最大负载（包括已删除的槽位）
+
+
+/*
+    双编码哈希
+    小哈希用紧凑编码：所有 field/value 连续存放在一个字符串里，每项编码为 [varint长度][数据]，
+    查找时线性扫描，内存开销几乎只有数据本身，并且对缓存友好
+    字段个数或字段长度超过阈值后转换为开放寻址（线性探测）的哈希表，转换后不再转回
+*/
+class CompactHash{
+public:
+    enum Encoding{
+        PACKED,     //紧凑编码
+        TABLE       //哈希表编码
+    };
+
+    explicit CompactHash(size_t maxPackedEntries=HASH_MAX_PACKED_ENTRIES, size_t maxPackedValue=HASH_MAX_PACKED_VALUE);
+
+    bool set(const std::string &field, const std::string &value);  //设置字段，新增字段返回true
+    bool get(const std::string &field, std::string &value) const;  //获取字段的值
+    bool remove(const std::string &field);                         //删除字段
+    bool exists(const std::string &field) const;
+    //遍历所有字段，回调返回false时停止
+    void forEach(const std::function<bool(const std::string&, const std::string&)> &func) const;
+    //从cursor开始遍历最多count个桶，返回下一次的游标，返回0表示遍历结束
+    size_t scan(size_t cursor, size_t count, const std::function<void(const std::string&, const std::string&)> &func) const;
+
+    size_t size() const { return count; }
+    Encoding encoding() const { return currentEncoding; }
+
+private:
+    struct Slot{
+        enum State : uint8_t { EMPTY, USED, DELETED };
+        std::string field;
+        std::string value;
+        size_t hash = 0;    //缓存字段的哈希值，探测和重建时不必重新计算
+        State state = EMPTY;
+    };
+
+    static void writeLength(std::string &out, size_t len);
+    static size_t reverseBits(size_t v);
+    static size_t readLength(const std::string &in, size_t &pos);
+    //在紧凑编码中查找字段，返回该项的起始位置，valuePos返回值的长度前缀位置
+    size_t packedFind(const std::string &field, size_t &valuePos) const;
+    size_t packedEntryEnd(size_t valuePos) const;
+    void convertToTable();
+    //在哈希表中查找字段所在的槽位，找不到时返回可插入的槽位
+    size_t tableFind(const std::vector<Slot> &slots, const std::string &field, size_t hash, bool &found) const;
+    void tableResize(size_t capacity);
+
+private:
+    Encoding currentEncoding = PACKED;
+    size_t count = 0;
+    size_t maxPackedEntries;
+    size_t maxPackedValue;
+    std::string packed;         //紧凑编码的数据
+    std::vector<Slot> slots;    //哈希表编码的槽位
+    size_t usedSlots = 0;       //已使用的槽位（包括已删除的）
+};
+
+
+inline CompactHash::CompactHash(size_t maxPackedEntries, size_t maxPackedValue)
+: maxPackedEntries(maxPackedEntries), maxPackedValue(maxPackedValue) {
+}
+
+inline void CompactHash::writeLength(std::string &out, size_t len){
+    while(len >= 0x80){
+        out.push_back(static_cast<char>((len & 0x7f) | 0x80));
+        len >>= 7;
+    }
+    out.push_back(static_cast<char>(len));
+}
+
+inline size_t CompactHash::reverseBits(size_t v){
+    size_t r = 0;
+    for(size_t i=0; i<sizeof(size_t)*8; i++){
+        r = (r << 1) | (v & 1);
+        v >>= 1;
+    }
+    return r;
+}
+
+inline size_t CompactHash::readLength(const std::string &in, size_t &pos){
+    size_t len = 0;
+    int shift = 0;
+    uint8_t byte;
+    do{
+        byte = static_cast<uint8_t>(in[pos++]);
+        len |= static_cast<size_t>(byte & 0x7f) << shift;
+        shift += 7;
+    }while(byte & 0x80);
+    return len;
+}
+
+inline size_t CompactHash::packedFind(const std::string &field, size_t &valuePos) const{
+    size_t pos = 0;
+    while(pos < packed.size()){
+        size_t entryStart = pos;
+        size_t fieldLen = readLength(packed, pos);
+        bool match = fieldLen == field.size() && packed.compare(pos, fieldLen, field) == 0;
+        pos += fieldLen;
+        if(match){
+            valuePos = pos;
+            return entryStart;
+        }
+        size_t valueLen = readLength(packed, pos);
+        pos += valueLen;
+    }
+    return std::string::npos;
+}
+
+inline size_t CompactHash::packedEntryEnd(size_t valuePos) const{
+    size_t len = readLength(packed, valuePos);
+    return valuePos + len;
+}
+
+inline size_t CompactHash::tableFind(const std::vector<Slot> &table, const std::string &field, size_t hash, bool &found) const{
+    size_t mask = table.size() - 1;
+    size_t index = hash & mask;
+    size_t firstDeleted = table.size();
+    found = false;
+    while(table[index].state != Slot::EMPTY){
+        if(table[index].state == Slot::USED && table[index].hash == hash && table[index].field == field){
+            found = true;
+            return index;
+        }
+        if(table[index].state == Slot::DELETED && firstDeleted == table.size()){
+            firstDeleted = index;
+        }
+        index = (index + 1) & mask;
+    }
+    //优先复用已删除的槽位
+    return firstDeleted != table.size() ? firstDeleted : index;
+}
+
+inline void CompactHash::tableResize(size_t capacity){
+    std::vector<Slot> newSlots(capacity);
+    for(Slot &slot : slots){
+        if(slot.state != Slot::USED){
+            continue;
+        }
+        bool found;
+        size_t index = tableFind(newSlots, slot.field, slot.hash, found);
+        newSlots[index].field = std::move(slot.field);
+        newSlots[index].value = std::move(slot.value);
+        newSlots[index].hash = slot.hash;
+        newSlots[index].state = Slot::USED;
+    }
+    slots.swap(newSlots);
+    usedSlots = count;
+}
+
+inline void CompactHash::convertToTable(){
+    size_t capacity = HASH_INIT_CAPACITY;
+    while(capacity * HASH_MAX_LOAD_FACTOR <= count + 1){
+        capacity <<= 1;
+    }
+    slots.assign(capacity, Slot());
+    usedSlots = 0;
+    size_t pos = 0;
+    while(pos < packed.size()){
+        size_t fieldLen = readLength(packed, pos);
+        std::string field = packed.substr(pos, fieldLen);
+        pos += fieldLen;
+        size_t valueLen = readLength(packed, pos);
+        bool found;
+        size_t hash = std::hash<std::string>()(field);
+        size_t index = tableFind(slots, field, hash, found);
+        slots[index].field = std::move(field);
+        slots[index].value = packed.substr(pos, valueLen);
+        slots[index].hash = hash;
+        slots[index].state = Slot::USED;
+        usedSlots++;
+        pos += valueLen;
+    }
+    std::string().swap(packed);
+    currentEncoding = TABLE;
+}
+
+inline bool CompactHash::set(const std::string &field, const std::string &value){
+    if(currentEncoding == PACKED){
+        size_t valuePos = 0;
+        size_t entryStart = packedFind(field, valuePos);
+        bool isNew = entryStart == std::string::npos;
+        if(field.size() > maxPackedValue || value.size() > maxPackedValue || (isNew && count + 1 > maxPackedEntries)){
+            convertToTable();
+        }
+        else{
+            std::string entry;
+            if(isNew){
+                writeLength(entry, field.size());
+                entry += field;
+                writeLength(entry, value.size());
+                entry += value;
+                packed += entry;
+                count++;
+            }
+            else{
+                //只替换值部分
+                writeLength(entry, value.size());
+                entry += value;
+                packed.replace(valuePos, packedEntryEnd(valuePos) - valuePos, entry);
+            }
+            return isNew;
+        }
+    }
+    bool found;
+    size_t hash = std::hash<std::string>()(field);
+    size_t index = tableFind(slots, field, hash, found);
+    if(found){
+        slots[index].value = value;
+        return false;
+    }
+    if(slots[index].state == Slot::EMPTY){
+        usedSlots++;
+    }
+    slots[index].field = field;
+    slots[index].value = value;
+    slots[index].hash = hash;
+    slots[index].state = Slot::USED;
+    count++;
+    if(usedSlots > slots.size() * HASH_MAX_LOAD_FACTOR){
+        //删除的槽位较多时原地重建即可，否则扩容
+        tableResize(count * 2 > slots.size() * HASH_MAX_LOAD_FACTOR ? slots.size() * 2 : slots.size());
+    }
+    return true;
+}
+
+inline bool CompactHash::get(const std::string &field, std::string &value) const{
+    if(currentEncoding == PACKED){
+        size_t valuePos = 0;
+        if(packedFind(field, valuePos) == std::string::npos){
+            return false;
+        }
+        size_t len = readLength(packed, valuePos);
+        value.assign(packed, valuePos, len);
+        return true;
+    }
+    bool found;
+    size_t index = tableFind(slots, field, std::hash<std::string>()(field), found);
+    if(found){
+        value = slots[index].value;
+    }
+    return found;
+}
+
+inline bool CompactHash::exists(const std::string &field) const{
+    if(currentEncoding == PACKED){
+        size_t valuePos = 0;
+        return packedFind(field, valuePos) != std::string::npos;
+    }
+    bool found;
+    tableFind(slots, field, std::hash<std::string>()(field), found);
+    return found;
+}
+
+inline bool CompactHash::remove(const std::string &field){
+    if(currentEncoding == PACKED){
+        size_t valuePos = 0;
+        size_t entryStart = packedFind(field, valuePos);
+        if(entryStart == std::string::npos){
+            return false;
+        }
+        packed.erase(entryStart, packedEntryEnd(valuePos) - entryStart);
+        count--;
+        return true;
+    }
+    bool found;
+    size_t index = tableFind(slots, field, std::hash<std::string>()(field), found);
+    if(!found){
+        return false;
+    }
+    std::string().swap(slots[index].field);
+    std::string().swap(slots[index].value);
+    slots[index].state = Slot::DELETED;
+    count--;
+    return true;
+}
+
+inline void CompactHash::forEach(const std::function<bool(const std::string&, const std::string&)> &func) const{
+    if(currentEncoding == PACKED){
+        size_t pos = 0;
+        std::string field;
+        std::string value;
+        while(pos < packed.size()){
+            size_t fieldLen = readLength(packed, pos);
+            field.assign(packed, pos, fieldLen);
+            pos += fieldLen;
+            size_t valueLen = readLength(packed, pos);
+            value.assign(packed, pos, valueLen);
+            pos += valueLen;
+            if(!func(field, value)){
+                return;
+            }
+        }
+        return;
+    }
+    for(const Slot &slot : slots){
+        if(slot.state == Slot::USED && !func(slot.field, slot.value)){
+            return;
+        }
+    }
+}
+
+/// @brief 增量遍历，游标是桶（字段哈希值对应的初始槽位）的编号
+/// 游标按高位加一的顺序递增（与Redis的SCAN相同），扩容后原来桶中的元素只会落到编号更大的桶里，
+/// 所以遍历期间一直存在的字段一定会被访问到，扩容时可能会重复返回少量字段
+/// 紧凑编码的字段很少，一次全部返回
+inline size_t CompactHash::scan(size_t cursor, size_t count, const std::function<void(const std::string&, const std::string&)> &func) const{
+    if(currentEncoding == PACKED){
+        forEach([&func](const std::string &field, const std::string &value){
+            func(field, value);
+            return true;
+        });
+        return 0;
+    }
+    size_t mask = slots.size() - 1;
+    size_t visited = 0;
+    do{
+        //线性探测下，初始槽位为cursor的字段都在从cursor开始的连续非空槽位中
+        size_t bucket = cursor & mask;
+        for(size_t i=bucket; slots[i].state != Slot::EMPTY; i=(i+1)&mask){
+            if(slots[i].state == Slot::USED && (slots[i].hash & mask) == bucket){
+                func(slots[i].field, slots[i].value);
+            }
+        }
+        //反转二进制位后加一，再反转回来
+        cursor |= ~mask;
+        cursor = reverseBits(cursor);
+        cursor++;
+        cursor = reverseBits(cursor);
+        visited++;
+    }while(cursor != 0 && visited < count);
+    return cursor;
+}
+
+#endif
@@ -0,0 +1,118 @@
+#include "CompactHash.h"
+#include <iostream>
+#include <unordered_map>
+#include <unordered_set>
+#include <random>
+#include <cassert>
+
+//随机的set/get/remove与std::unordered_map对照，检查两种编码和转换过程
+static void randomCompare(size_t maxPackedEntries, size_t maxPackedValue){
+    CompactHash hash(maxPackedEntries, maxPackedValue);
+    std::unordered_map<std::string, std::string> expected;
+    std::mt19937 generator(maxPackedEntries * 131 + maxPackedValue);
+    for(int i=0; i<50000; i++){
+        std::string field = "f" + std::to_string(generator() % 2000);
+        int op = generator() % 4;
+        if(op <= 1){
+            //阈值较小时偶尔写入较长的值，触发按长度转换
+            bool tooLong = maxPackedValue < 1000 && generator() % 1000 == 0;
+            std::string value(tooLong ? maxPackedValue + 1 : generator() % 8, 'v');
+            value += std::to_string(i);
+            bool added = hash.set(field, value);
+            assert(added == (expected.count(field) == 0));
+            expected[field] = value;
+        }
+        else if(op == 2){
+            assert(hash.remove(field) == (expected.erase(field) == 1));
+        }
+        else{
+            std::string value;
+            auto it = expected.find(field);
+            assert(hash.get(field, value) == (it != expected.end()));
+            assert(it == expected.end() || value == it->second);
+            assert(hash.exists(field) == (it != expected.end()));
+        }
+        assert(hash.size() == expected.size());
+        if(hash.encoding() == CompactHash::PACKED){
+            assert(hash.size() <= maxPackedEntries);
+        }
+    }
+    size_t visited = 0;
+    hash.forEach([&](const std::string &field, const std::string &value){
+        assert(expected.at(field) == value);
+        visited++;
+        return true;
+    });
+    assert(visited == expected.size());
+    std::cout<<"entries="<<maxPackedEntries<<" value="<<maxPackedValue<<" size="<<hash.size()
+        <<" encoding="<<(hash.encoding() == CompactHash::PACKED ? "packed" : "table")<<std::endl;
+}
+
+//遍历期间不断插入和删除字段，哈希表会扩容，遍历开始前就存在、期间没有删除的字段都必须返回
+static void scanDuringResize(unsigned seed){
+    CompactHash hash(0, 0);
+    std::mt19937 generator(seed);
+    for(int i=0; i<200; i++){
+        hash.set("stable" + std::to_string(i), "v");
+    }
+    std::unordered_set<std::string> returned;
+    size_t cursor = 0;
+    size_t calls = 0;
+    int next = 0;
+    do{
+        cursor = hash.scan(cursor, 1 + generator() % 8, [&returned](const std::string &field, const std::string &){
+            returned.insert(field);
+        });
+        calls++;
+        //每次调用之间写入新字段，并删除一部分新字段
+        for(int i=0; i<3; i++){
+            hash.set("new" + std::to_string(next++), "v");
+        }
+        hash.remove("new" + std::to_string(generator() % next));
+    }while(cursor != 0);
+    for(int i=0; i<200; i++){
+        assert(returned.count("stable" + std::to_string(i)) == 1);
+    }
+    std::cout<<"scan calls="<<calls<<" returned="<<returned.size()<<" final size="<<hash.size()<<std::endl;
+}
+
+int main(){
+    CompactHash hash(4, 8);
+    hash.set("a", "1");
+    hash.set("b", "2");
+    hash.set("c", "3");
+    std::string value;
+    hash.get("b", value);
+    std::cout<<value<<" "<<hash.size()<<" "<<(hash.encoding() == CompactHash::PACKED)<<std::endl;
+    //覆盖已有字段不算新增
+    assert(!hash.set("a", "11") && hash.get("a", value) && value == "11");
+    //字段个数超过阈值后转为哈希表
+    hash.set("d", "4");
+    assert(hash.encoding() == CompactHash::PACKED);
+    hash.set("e", "5");
+    assert(hash.encoding() == CompactHash::TABLE);
+    //转换后不再转回
+    hash.remove("e");
+    hash.remove("d");
+    assert(hash.encoding() == CompactHash::TABLE && hash.size() == 3);
+
+    //值的长度超过阈值也会转换
+    CompactHash small(128, 8);
+    small.set("k", "123456789");
+    assert(small.encoding() == CompactHash::TABLE);
+
+    randomCompare(HASH_MAX_PACKED_ENTRIES, HASH_MAX_PACKED_VALUE);
+    randomCompare(16, 4);
+    randomCompare(100000, 100000);
+
+    //紧凑编码一次返回全部字段，游标为0
+    CompactHash packed;
+    packed.set("x", "1");
+    packed.set("y", "2");
+    size_t scanned = 0;
+    assert(packed.scan(0, 1, [&scanned](const std::string &, const std::string &){ scanned++; }) == 0 && scanned == 2);
+    scanDuringResize(1);
+    scanDuringResize(2);
+    std::cout<<"CompactHash OK"<<std::endl;
+    return 0;
+}
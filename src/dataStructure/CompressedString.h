@@ -0,0 +1,223 @@
+#ifndef COMPRESSED_STRING_H
+#define COMPRESSED_STRING_H
+
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+#include "Lzf.h"
+
+#define STRING_COMPRESS_MIN_BYTES 1024      //字符串达到这个长度才压缩保存，0表示不压缩
+#define STRING_FRAME_BYTES 8192             //每帧原始数据的长度，与LZF的回溯窗口相同
+
+
+/*
+    压缩保存的大字符串：按STRING_FRAME_BYTES分帧，每帧单独用LZF压缩，压缩没有收益的帧原样保存
+    长度单独记录，STRLEN不需要解压
+    APPEND只解压最后一个不满的帧，和新内容拼起来重新分帧，已经写满的帧不再改动；
+    最后不满的帧保持解压，连续追加时不用反复压缩，下一次追加把它填满后才压缩
+    读取整个字符串时解压全部的帧，读取一段时只解压涉及的帧
+*/
+class CompressedString{
+public:
+    explicit CompressedString(const std::string &value = ""){
+        append(value);
+        //构造之后一般不会再追加，最后不满的帧也压缩
+        sealTail();
+    }
+
+    /// @brief 追加内容，只影响最后一个帧
+    void append(const std::string &value){
+        if(!frames.empty() && frames.back().rawSize < STRING_FRAME_BYTES && tail.empty()){
+            Frame last = std::move(frames.back());
+            frames.pop_back();
+            decode(last, tail);
+        }
+        length += value.size();
+        size_t offset = 0;
+        //tail里已有的内容先补满一帧
+        if(!tail.empty()){
+            offset = std::min(value.size(), STRING_FRAME_BYTES - tail.size());
+            tail.append(value, 0, offset);
+            if(tail.size() < STRING_FRAME_BYTES){
+                return;
+            }
+            frames.push_back(encode(tail.data(), tail.size()));
+            tail.clear();
+        }
+        for(; value.size() - offset >= STRING_FRAME_BYTES; offset += STRING_FRAME_BYTES){
+            frames.push_back(encode(value.data() + offset, STRING_FRAME_BYTES));
+        }
+        tail.assign(value, offset, std::string::npos);
+    }
+
+    /// @brief 解压出完整的字符串，每帧直接解压到结果的对应位置
+    std::string str() const{
+        std::string value(length, '\0');
+        char *out = &value[0];
+        for(const Frame &frame : frames){
+            if(frame.compressed){
+                lzfDecompress(frame.data.data(), frame.data.size(), out, frame.rawSize);
+            }
+            else{
+                std::memcpy(out, frame.data.data(), frame.rawSize);
+            }
+            out += frame.rawSize;
+        }
+        std::memcpy(out, tail.data(), tail.size());
+        return value;
+    }
+
+    /// @brief 从pos开始的count个字节，只解压涉及的帧
+    std::string substr(size_t pos, size_t count) const{
+        pos = std::min(pos, length);
+        count = std::min(count, length - pos);
+        std::string value;
+        value.reserve(count);
+        std::string buffer;
+        //除最后一帧外每帧都是STRING_FRAME_BYTES字节，直接算出第一个涉及的帧
+        for(size_t index=pos/STRING_FRAME_BYTES; index<frames.size() && value.size()<count; index++){
+            const Frame &frame = frames[index];
+            size_t from = pos + value.size() - index * STRING_FRAME_BYTES;
+            const std::string *raw = &frame.data;
+            if(frame.compressed){
+                decode(frame, buffer);
+                raw = &buffer;
+            }
+            value.append(*raw, from, std::min<size_t>(frame.rawSize - from, count - value.size()));
+        }
+        if(value.size() < count){
+            value.append(tail, pos + value.size() - frames.size() * STRING_FRAME_BYTES, count - value.size());
+        }
+        return value;
+    }
+
+    size_t size() const { return length; }
+    //实际占用的字节数
+    size_t bytes() const{
+        size_t total = tail.capacity();
+        for(const Frame &frame : frames){
+            total += frame.data.capacity();
+        }
+        return total;
+    }
+    size_t frameCount() const { return frames.size() + (tail.empty() ? 0 : 1); }
+
+    /// @brief 编码：长度、帧数，每帧的原始长度、是否压缩、数据长度和数据，最后是不满的帧
+    /// 帧保持压缩的形式，快照不需要解压再压缩
+    std::string serialize() const{
+        std::string data;
+        appendFixed(data, static_cast<uint64_t>(length));
+        appendFixed(data, static_cast<uint32_t>(frames.size()));
+        for(const Frame &frame : frames){
+            appendFixed(data, frame.rawSize);
+            appendFixed(data, static_cast<uint8_t>(frame.compressed));
+            appendFixed(data, static_cast<uint32_t>(frame.data.size()));
+            data += frame.data;
+        }
+        data += tail;
+        return data;
+    }
+
+    /// @brief 从serialize的结果恢复，每帧都试着解压一次，格式不对时返回false
+    bool deserialize(const std::string &data){
+        size_t offset = 0;
+        uint64_t total = 0;
+        uint32_t count = 0;
+        if(!readFixed(data, offset, total) || !readFixed(data, offset, count)){
+            return false;
+        }
+        std::vector<Frame> restored;
+        uint64_t rawTotal = 0;
+        std::string buffer;
+        for(uint32_t i=0; i<count; i++){
+            Frame frame;
+            uint8_t compressed = 0;
+            uint32_t size = 0;
+            if(!readFixed(data, offset, frame.rawSize) || !readFixed(data, offset, compressed)
+                || !readFixed(data, offset, size) || data.size() - offset < size
+                || frame.rawSize == 0 || frame.rawSize > STRING_FRAME_BYTES){
+                return false;
+            }
+            frame.compressed = compressed != 0;
+            frame.data.assign(data, offset, size);
+            offset += size;
+            if(frame.compressed ? !lzfDecompress(frame.data.data(), size, frame.rawSize, buffer) : size != frame.rawSize){
+                return false;
+            }
+            rawTotal += frame.rawSize;
+            restored.push_back(std::move(frame));
+        }
+        //不满的帧不会超过一帧
+        if(data.size() - offset >= STRING_FRAME_BYTES || rawTotal + data.size() - offset != total){
+            return false;
+        }
+        frames.swap(restored);
+        tail.assign(data, offset, std::string::npos);
+        length = total;
+        return true;
+    }
+
+private:
+    struct Frame{
+        std::string data;
+        uint32_t rawSize = 0;
+        bool compressed = false;
+    };
+
+    //直接压缩到帧的缓冲区，压缩后没有变小时原样保存
+    static Frame encode(const char *data, size_t len){
+        Frame frame;
+        frame.rawSize = len;
+        frame.data.resize(len - 1);
+        size_t compressedLen = len < 4 ? 0 : lzfCompress(data, len, &frame.data[0], frame.data.size());
+        frame.compressed = compressedLen != 0;
+        if(!frame.compressed){
+            frame.data.assign(data, len);
+        }
+        else{
+            frame.data.resize(compressedLen);
+            frame.data.shrink_to_fit();
+        }
+        return frame;
+    }
+
+    static void decode(const Frame &frame, std::string &out){
+        if(frame.compressed){
+            lzfDecompress(frame.data.data(), frame.data.size(), frame.rawSize, out);
+        }
+        else{
+            out = frame.data;
+        }
+    }
+
+    void sealTail(){
+        if(!tail.empty()){
+            frames.push_back(encode(tail.data(), tail.size()));
+            std::string().swap(tail);
+        }
+    }
+
+    template <typename T>
+    static void appendFixed(std::string &data, T value){
+        data.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    template <typename T>
+    static bool readFixed(const std::string &data, size_t &offset, T &value){
+        if(data.size() - offset < sizeof(T)){
+            return false;
+        }
+        std::memcpy(&value, data.data() + offset, sizeof(T));
+        offset += sizeof(T);
+        return true;
+    }
+
+private:
+    std::vector<Frame> frames;  //除最后一帧外都是STRING_FRAME_BYTES字节
+    std::string tail;           //最后不满的帧，追加之后保持解压
+    size_t length = 0;
+};
+
+#endif
@@ -0,0 +1,71 @@
+#include "CompressedString.h"
+#include <iostream>
+#include <random>
+#include <cassert>
+
+static std::string randomText(std::mt19937 &generator, size_t len){
+    static const char *words[] = {"alpha ", "beta ", "gamma ", "delta ", "\x01\x02", "\xff"};
+    std::string text;
+    while(text.size() < len){
+        text += generator() % 8 == 0 ? std::string(1, static_cast<char>(generator())) : words[generator() % 6];
+    }
+    text.resize(len);
+    return text;
+}
+
+//随机追加，与std::string对照内容、长度和任意一段的取值
+static void randomCompare(unsigned seed){
+    std::mt19937 generator(seed);
+    std::string expected = randomText(generator, generator() % 3000);
+    CompressedString value(expected);
+    for(int i=0; i<300; i++){
+        //追加的长度从几个字节到跨越几帧
+        size_t len = generator() % 4 == 0 ? generator() % (3 * STRING_FRAME_BYTES) : generator() % 100;
+        std::string more = randomText(generator, len);
+        value.append(more);
+        expected += more;
+        assert(value.size() == expected.size());
+        assert(value.frameCount() == (expected.size() + STRING_FRAME_BYTES - 1) / STRING_FRAME_BYTES);
+        for(int j=0; j<10; j++){
+            size_t pos = generator() % (expected.size() + 10);
+            size_t count = generator() % 3 == 0 ? std::string::npos : generator() % (2 * STRING_FRAME_BYTES);
+            assert(value.substr(pos, count) == expected.substr(std::min(pos, expected.size()), count));
+        }
+        if(i % 20 == 0){
+            assert(value.str() == expected);
+            CompressedString copy;
+            assert(copy.deserialize(value.serialize()) && copy.str() == expected && copy.size() == expected.size());
+            //恢复后继续追加
+            copy.append("tail");
+            assert(copy.str() == expected + "tail");
+        }
+    }
+    std::cout<<"seed="<<seed<<" size="<<value.size()<<" bytes="<<value.bytes()<<std::endl;
+    assert(value.str() == expected);
+}
+
+int main(){
+    std::string text;
+    for(int i=0; i<5000; i++){
+        text += "hello world ";
+    }
+    CompressedString value(text);
+    std::cout<<text.size()<<" -> "<<value.bytes()<<" frames="<<value.frameCount()<<std::endl;
+    assert(value.str() == text && value.bytes() < text.size() / 4);
+    assert(value.substr(STRING_FRAME_BYTES - 3, 6) == text.substr(STRING_FRAME_BYTES - 3, 6));
+    assert(value.substr(text.size(), 5).empty() && value.substr(text.size() + 5, 5).empty());
+    assert(CompressedString().str().empty() && CompressedString().frameCount() == 0);
+
+    //格式错误的数据
+    std::string data = value.serialize();
+    CompressedString bad;
+    assert(!bad.deserialize("") && !bad.deserialize(data.substr(0, data.size() - 1)));
+    std::string corrupt = data;
+    corrupt[20] ^= 0x55;
+    assert(!bad.deserialize(corrupt) || bad.str().size() == text.size());
+
+    randomCompare(1);
+    randomCompare(2);
+    std::cout<<"CompressedString OK"<<std::endl;
+    return 0;
+}
@@ -0,0 +1,237 @@
+#ifndef CUCKOO_FILTER_H
+#define CUCKOO_FILTER_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+#include "MurmurHash.h"
+
+#define CUCKOO_BUCKET_SIZE 4                //每个桶4个16位指纹，8字节
+#define CUCKOO_DEFAULT_CAPACITY 1024
+#define CUCKOO_MAX_KICKS 500                //插入时最多踢出的次数，超过后认为这一层已满
+#define CUCKOO_LOAD_FACTOR 0.95             //按容量计算桶数时预期的装载率
+
+
+/*
+    布谷鸟过滤器：支持删除的概率成员过滤器，每个元素存一个16位指纹，可以放在两个候选桶之一，
+    另一个桶由当前桶和指纹算出：i2 = i1 ^ hash(fingerprint)，所以踢出指纹时不需要原来的元素
+    桶是8字节并按8字节对齐，不会跨越缓存行，每次探测一个桶只访问一条缓存行
+    一层插不进去时（踢出次数超过上限）撤销这次的所有踢出，新建一层（容量翻倍）再插入
+    误判率约为 2 * 4 / 65535 ≈ 0.012%，删除一个从未添加的元素可能误删其他元素的指纹
+    踢出时选择的位置由指纹和踢出次数决定，同样的命令序列在从节点上得到同样的结果
+*/
+class CuckooFilter{
+public:
+    explicit CuckooFilter(uint64_t capacity=CUCKOO_DEFAULT_CAPACITY){
+        addTable(capacity);
+    }
+
+    /// @brief 添加元素，同一个元素可以添加多次，删除时每次删除一个
+    void add(const std::string &item){
+        uint64_t hash = murmurHash64A(item.data(), item.size(), 0);
+        uint16_t fp = fingerprint(hash);
+        if(!tables.back().insert(hash, fp)){
+            addTable(tables.back().capacity() * 2);
+            tables.back().insert(hash, fp);
+        }
+        items++;
+    }
+
+    /// @brief 元素是否可能存在，不存在时一定返回false
+    bool contains(const std::string &item) const{
+        uint64_t hash = murmurHash64A(item.data(), item.size(), 0);
+        uint16_t fp = fingerprint(hash);
+        for(const Table &table : tables){
+            if(table.contains(hash, fp)){
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /// @brief 删除一次添加的元素，从最新的一层开始找
+    /// @return 是否找到并删除
+    bool remove(const std::string &item){
+        uint64_t hash = murmurHash64A(item.data(), item.size(), 0);
+        uint16_t fp = fingerprint(hash);
+        for(auto it = tables.rbegin(); it != tables.rend(); ++it){
+            if(it->remove(hash, fp)){
+                items--;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    uint64_t size() const { return items; }
+    size_t bytes() const{
+        size_t total = 0;
+        for(const Table &table : tables){
+            total += table.bucketCount * sizeof(Bucket);
+        }
+        return total;
+    }
+    size_t tableCount() const { return tables.size(); }
+
+    /// @brief 编码：元素个数、层数，每层的桶数和所有桶
+    std::string serialize() const{
+        std::string data;
+        appendFixed(data, items);
+        appendFixed(data, static_cast<uint32_t>(tables.size()));
+        for(const Table &table : tables){
+            appendFixed(data, table.bucketCount);
+            data.append(reinterpret_cast<const char*>(table.buckets.get()), table.bucketCount * sizeof(Bucket));
+        }
+        return data;
+    }
+
+    /// @brief 从serialize的结果恢复，格式不对时返回false
+    bool deserialize(const std::string &data){
+        size_t offset = 0;
+        uint64_t count = 0;
+        uint32_t tableNumber = 0;
+        if(!readFixed(data, offset, count) || !readFixed(data, offset, tableNumber) || tableNumber == 0){
+            return false;
+        }
+        std::vector<Table> restored;
+        for(uint32_t i=0; i<tableNumber; i++){
+            Table table;
+            if(!readFixed(data, offset, table.bucketCount)){
+                return false;
+            }
+            //桶数必须是2的幂，候选桶才能用掩码计算
+            if(table.bucketCount == 0 || (table.bucketCount & (table.bucketCount - 1)) != 0
+                || (data.size() - offset) / sizeof(Bucket) < table.bucketCount){
+                return false;
+            }
+            table.buckets.reset(new Bucket[table.bucketCount]);
+            std::memcpy(table.buckets.get(), data.data() + offset, table.bucketCount * sizeof(Bucket));
+            offset += table.bucketCount * sizeof(Bucket);
+            restored.push_back(std::move(table));
+        }
+        if(offset != data.size()){
+            return false;
+        }
+        tables.swap(restored);
+        items = count;
+        return true;
+    }
+
+private:
+    struct alignas(8) Bucket{
+        uint16_t slots[CUCKOO_BUCKET_SIZE];     //0表示空位
+    };
+
+    struct Table{
+        uint64_t bucketCount = 0;   //2的幂
+        std::unique_ptr<Bucket[]> buckets;
+
+        uint64_t capacity() const { return bucketCount * CUCKOO_BUCKET_SIZE; }
+        uint64_t primary(uint64_t hash) const { return hash & (bucketCount - 1); }
+        uint64_t alternate(uint64_t index, uint16_t fp) const{
+            return (index ^ (fp * 0x5bd1e995ULL)) & (bucketCount - 1);
+        }
+
+        bool contains(uint64_t hash, uint16_t fp) const{
+            uint64_t i1 = primary(hash);
+            return find(i1, fp) >= 0 || find(alternate(i1, fp), fp) >= 0;
+        }
+
+        int find(uint64_t index, uint16_t fp) const{
+            for(int slot=0; slot<CUCKOO_BUCKET_SIZE; slot++){
+                if(buckets[index].slots[slot] == fp){
+                    return slot;
+                }
+            }
+            return -1;
+        }
+
+        bool remove(uint64_t hash, uint16_t fp){
+            uint64_t i1 = primary(hash);
+            for(uint64_t index : {i1, alternate(i1, fp)}){
+                int slot = find(index, fp);
+                if(slot >= 0){
+                    buckets[index].slots[slot] = 0;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        /// @brief 放进两个候选桶之一，都满时依次踢出指纹到它的另一个桶
+        /// @return 失败时撤销所有踢出并返回false
+        bool insert(uint64_t hash, uint16_t fp){
+            uint64_t i1 = primary(hash);
+            uint64_t i2 = alternate(i1, fp);
+            if(put(i1, fp) || put(i2, fp)){
+                return true;
+            }
+            //记录每次踢出的位置和被踢出的指纹，用于撤销
+            std::vector<std::pair<uint64_t, int>> path;
+            uint64_t index = (fp & 1) ? i1 : i2;
+            for(int kick=0; kick<CUCKOO_MAX_KICKS; kick++){
+                int slot = (fp + kick) % CUCKOO_BUCKET_SIZE;
+                std::swap(fp, buckets[index].slots[slot]);
+                path.emplace_back(index, slot);
+                index = alternate(index, fp);
+                if(put(index, fp)){
+                    return true;
+                }
+            }
+            //倒序换回来，最后手里的指纹就是最初要插入的指纹
+            for(auto it = path.rbegin(); it != path.rend(); ++it){
+                std::swap(fp, buckets[it->first].slots[it->second]);
+            }
+            return false;
+        }
+
+        bool put(uint64_t index, uint16_t fp){
+            int slot = find(index, 0);
+            if(slot < 0){
+                return false;
+            }
+            buckets[index].slots[slot] = fp;
+            return true;
+        }
+    };
+
+    //指纹不能为0，0表示空位
+    static uint16_t fingerprint(uint64_t hash){
+        return static_cast<uint16_t>((hash >> 48) % 0xffff + 1);
+    }
+
+    void addTable(uint64_t capacity){
+        Table table;
+        uint64_t needed = std::max<uint64_t>(1, capacity / CUCKOO_BUCKET_SIZE / CUCKOO_LOAD_FACTOR);
+        table.bucketCount = 1;
+        while(table.bucketCount < needed){
+            table.bucketCount <<= 1;
+        }
+        table.buckets.reset(new Bucket[table.bucketCount]());
+        tables.push_back(std::move(table));
+    }
+
+    template <typename T>
+    static void appendFixed(std::string &data, T value){
+        data.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    template <typename T>
+    static bool readFixed(const std::string &data, size_t &offset, T &value){
+        if(data.size() - offset < sizeof(T)){
+            return false;
+        }
+        std::memcpy(&value, data.data() + offset, sizeof(T));
+        offset += sizeof(T);
+        return true;
+    }
+
+private:
+    std::vector<Table> tables;
+    uint64_t items = 0;     //所有层的元素个数
+};
+
+#endif
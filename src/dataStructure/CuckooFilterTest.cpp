@@ -0,0 +1,88 @@
+#include "CuckooFilter.h"
+#include <iostream>
+#include <random>
+#include <map>
+#include <cassert>
+
+//随机添加、删除，与std::map记录的次数对照：存在的元素一定能查到、删除一定成功
+static void randomCompare(unsigned seed){
+    std::mt19937 generator(seed);
+    CuckooFilter filter(64);
+    std::map<std::string, int> expected;
+    uint64_t total = 0;
+    for(int i=0; i<100000; i++){
+        std::string item = "item:" + std::to_string(generator() % 20000);
+        if(generator() % 3 != 0){
+            filter.add(item);
+            expected[item]++;
+            total++;
+        }
+        else if(expected.count(item)){
+            assert(filter.remove(item));
+            if(--expected[item] == 0){
+                expected.erase(item);
+            }
+            total--;
+        }
+        if(i % 1000 == 0){
+            for(const auto &entry : expected){
+                assert(filter.contains(entry.first));
+            }
+        }
+        assert(filter.size() == total);
+    }
+    std::cout<<"seed="<<seed<<" items="<<filter.size()<<" tables="<<filter.tableCount()<<std::endl;
+
+    CuckooFilter copy;
+    assert(copy.deserialize(filter.serialize()) && copy.serialize() == filter.serialize());
+    for(const auto &entry : expected){
+        assert(copy.contains(entry.first));
+    }
+    //删掉所有元素后所有桶都是空的，什么都查不到
+    for(const auto &entry : expected){
+        for(int i=0; i<entry.second; i++){
+            assert(copy.remove(entry.first));
+        }
+    }
+    assert(copy.size() == 0);
+    for(const auto &entry : expected){
+        assert(!copy.contains(entry.first));
+    }
+}
+
+//按容量创建时装得下，误判率约为 2 * 4 / 65535
+static void errorRate(){
+    CuckooFilter filter(100000);
+    for(int i=0; i<90000; i++){
+        filter.add("member:" + std::to_string(i));
+    }
+    assert(filter.tableCount() == 1);
+    uint64_t positives = 0, queries = 1000000;
+    for(uint64_t i=0; i<queries; i++){
+        positives += filter.contains("absent:" + std::to_string(i));
+    }
+    double measured = static_cast<double>(positives) / queries;
+    std::cout<<"measured "<<measured<<" bytes "<<filter.bytes()<<std::endl;
+    assert(measured < 2.0 * CUCKOO_BUCKET_SIZE / 65535);
+}
+
+int main(){
+    CuckooFilter filter(4);
+    filter.add("a");
+    filter.add("a");
+    assert(filter.contains("a") && filter.size() == 2);
+    assert(filter.remove("a") && filter.contains("a") && filter.remove("a") && !filter.contains("a"));
+    assert(!filter.remove("a") && filter.size() == 0);
+    //格式错误的数据，桶数必须是2的幂
+    std::string data = filter.serialize();
+    assert(!filter.deserialize("") && !filter.deserialize(data.substr(0, data.size() - 1)) && !filter.deserialize(data + "x"));
+    std::string badCount = data;
+    badCount[sizeof(uint64_t) + sizeof(uint32_t)] = 3;
+    assert(!filter.deserialize(badCount));
+
+    randomCompare(1);
+    randomCompare(2);
+    errorRate();
+    std::cout<<"CuckooFilter OK"<<std::endl;
+    return 0;
+}
@@ -0,0 +1,110 @@
+#include "../GlobPattern.h"
+#include <iostream>
+#include <random>
+#include <cstring>
+#include <algorithm>
+#include <cassert>
+
+//逐字符回溯的参照实现，没有闭合的 [ 按普通字符处理，末尾的 \ 匹配它自己
+static bool referenceMatch(const char *p, const char *pe, const char *s, const char *se){
+    if(p == pe){
+        return s == se;
+    }
+    if(*p == '*'){
+        while(p < pe && *p == '*'){
+            p++;
+        }
+        for(const char *q=s; q<=se; q++){
+            if(referenceMatch(p, pe, q, se)){
+                return true;
+            }
+        }
+        return false;
+    }
+    if(s == se){
+        return false;
+    }
+    if(*p == '?'){
+        return referenceMatch(p+1, pe, s+1, se);
+    }
+    unsigned char ch = *s;
+    if(*p == '[' && std::memchr(p+1, ']', pe-p-1) != nullptr){
+        const char *i = p + 1;
+        bool negate = *i == '^';
+        if(negate){
+            i++;
+        }
+        bool matched = false;
+        while(i < pe && *i != ']'){
+            if(*i == '\\' && i+1 < pe){
+                matched |= static_cast<unsigned char>(i[1]) == ch;
+                i += 2;
+            }
+            else if(i+2 < pe && i[1] == '-' && i[2] != ']'){
+                unsigned char low = std::min(i[0], i[2]);
+                unsigned char high = std::max(i[0], i[2]);
+                matched |= ch >= low && ch <= high;
+                i += 3;
+            }
+            else{
+                matched |= static_cast<unsigned char>(*i) == ch;
+                i++;
+            }
+        }
+        if(i < pe){
+            i++;
+        }
+        return matched != negate && referenceMatch(i, pe, s+1, se);
+    }
+    if(*p == '\\' && p+1 < pe){
+        p++;
+    }
+    return static_cast<unsigned char>(*p) == ch && referenceMatch(p+1, pe, s+1, se);
+}
+
+static bool referenceMatch(const std::string &pattern, const std::string &str){
+    return referenceMatch(pattern.data(), pattern.data() + pattern.size(), str.data(), str.data() + str.size());
+}
+
+int main(){
+    GlobPattern users("user:*:name");
+    std::cout<<users.prefix()<<" "<<users.match("user:1:name")<<" "<<users.match("user:1:age")<<std::endl;
+    assert(users.prefix() == "user:" && !users.isLiteral() && !users.matchAll());
+    assert(users.matchSuffix("user:42:name"));
+    assert(GlobPattern("user:*").matchAll());
+    assert(GlobPattern("a\\*b").isLiteral() && GlobPattern("a\\*b").prefix() == "a*b");
+    assert(GlobPattern("*").match("") && !GlobPattern("?").match(""));
+    assert(GlobPattern("h[^e]llo").match("hallo") && !GlobPattern("h[^e]llo").match("hello"));
+    assert(GlobPattern("[a-c]x").match("bx") && GlobPattern("[c-a]x").match("bx"));
+
+    //随机的短模式和短字符串，字符表中包含所有特殊字符，覆盖转义、未闭合的[和区间边界
+    std::mt19937 generator(1);
+    const char patternChars[] = "ab*?[]^-\\";
+    const char stringChars[] = "ab-]^\\";
+    for(int i=0; i<300000; i++){
+        std::string pattern;
+        std::string str;
+        for(int len=generator()%8; len>0; len--){
+            pattern += patternChars[generator() % (sizeof(patternChars) - 1)];
+        }
+        for(int len=generator()%8; len>0; len--){
+            str += stringChars[generator() % (sizeof(stringChars) - 1)];
+        }
+        GlobPattern matcher(pattern);
+        bool expected = referenceMatch(pattern, str);
+        if(matcher.match(str) != expected){
+            std::cout<<"mismatch pattern="<<pattern<<" str="<<str<<" expected="<<expected<<std::endl;
+            return 1;
+        }
+        //以前缀开头的字符串，matchSuffix与match一致
+        if(str.compare(0, matcher.prefix().size(), matcher.prefix()) == 0){
+            assert(matcher.matchSuffix(str) == expected);
+        }
+    }
+    //较长的字符串，多个*需要回溯
+    std::string longStr(2000, 'a');
+    longStr += "b";
+    assert(GlobPattern("*a*a*a*b").match(longStr) && !GlobPattern("*a*a*a*c").match(longStr));
+    std::cout<<"GlobPattern OK"<<std::endl;
+    return 0;
+}
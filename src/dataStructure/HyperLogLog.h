@@ -0,0 +1,313 @@
+#ifndef HYPER_LOG_LOG_H
+#define HYPER_LOG_LOG_H
+
+#include <string>
+#include <vector>
+#include <cmath>
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+#include "MurmurHash.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define HLL_X86_DISPATCH
+#include <immintrin.h>
+#endif
+
+#define HLL_P 14                                //用哈希值的低14位选择寄存器
+#define HLL_Q (64 - HLL_P)                      //剩下的位用来计算寄存器的值
+#define HLL_REGISTERS (1 << HLL_P)              //16384个寄存器，标准误差0.81%
+#define HLL_BITS 6                              //寄存器的最大值是HLL_Q+1，6位就够
+#define HLL_DENSE_BYTES ((HLL_REGISTERS * HLL_BITS + 7) / 8)
+#define HLL_SPARSE_MAX_BYTES 3000               //稀疏编码超过这个大小时转换成密集编码
+#define HLL_ALPHA_INF 0.721347520444481703680
+
+
+/*
+    HyperLogLog基数估计，与Redis的参数和估计算法相同（Ertl的改进估计，不需要小基数修正）
+    稀疏编码：非零寄存器按下标排序存放，每个4字节（下标<<8 | 值），适合只有少量元素的键
+    密集编码：16384个6位寄存器紧密排列，共12KB
+    基数的估计值缓存起来，只有寄存器改变时才重新计算
+    合并时先把寄存器展开成每个一字节，再按CPU支持的指令集（AVX-512BW、AVX2、通用）逐字节取最大值
+*/
+
+inline void hllMaxPortable(uint8_t *dst, const uint8_t *src, size_t len){
+    for(size_t i=0; i<len; i++){
+        dst[i] = std::max(dst[i], src[i]);
+    }
+}
+
+#ifdef HLL_X86_DISPATCH
+
+__attribute__((target("avx2")))
+inline void hllMaxAvx2(uint8_t *dst, const uint8_t *src, size_t len){
+    size_t i = 0;
+    for(; i + 32 <= len; i += 32){
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_max_epu8(a, b));
+    }
+    hllMaxPortable(dst + i, src + i, len - i);
+}
+
+__attribute__((target("avx512f,avx512bw")))
+inline void hllMaxAvx512(uint8_t *dst, const uint8_t *src, size_t len){
+    size_t i = 0;
+    for(; i + 64 <= len; i += 64){
+        __m512i a = _mm512_loadu_si512(dst + i);
+        __m512i b = _mm512_loadu_si512(src + i);
+        _mm512_storeu_si512(dst + i, _mm512_max_epu8(a, b));
+    }
+    hllMaxPortable(dst + i, src + i, len - i);
+}
+
+#endif
+
+/// @brief 逐字节取最大值：dst[i] = max(dst[i], src[i])
+inline void hllMax(uint8_t *dst, const uint8_t *src, size_t len){
+#ifdef HLL_X86_DISPATCH
+    static void (*const kernel)(uint8_t*, const uint8_t*, size_t) =
+        __builtin_cpu_supports("avx512bw") ? hllMaxAvx512 :
+        __builtin_cpu_supports("avx2") ? hllMaxAvx2 : hllMaxPortable;
+    kernel(dst, src, len);
+#else
+    hllMaxPortable(dst, src, len);
+#endif
+}
+
+class HyperLogLog{
+public:
+    enum Encoding{
+        SPARSE,DENSE
+    };
+
+    /// @brief 添加一个元素
+    /// @return 是否有寄存器改变
+    bool add(const std::string &element){
+        uint64_t hash = murmurHash64A(element.data(), element.size(), 0xadc83b19ULL);
+        uint32_t index = hash & (HLL_REGISTERS - 1);
+        hash >>= HLL_P;
+        hash |= 1ULL << HLL_Q;  //保证最多数HLL_Q个0
+        uint8_t rank = __builtin_ctzll(hash) + 1;
+        return set(index, rank);
+    }
+
+    /// @brief 估计的基数，寄存器没有改变时直接返回缓存的值
+    uint64_t count(){
+        if(!cacheValid){
+            int histogram[HLL_Q + 2] = {0};
+            if(encoding == SPARSE){
+                histogram[0] = HLL_REGISTERS - sparse.size();
+                for(uint32_t entry : sparse){
+                    histogram[entry & 0xff]++;
+                }
+            }
+            else{
+                for(uint32_t i=0; i<HLL_REGISTERS; i++){
+                    histogram[getDense(i)]++;
+                }
+            }
+            cached = estimate(histogram);
+            cacheValid = true;
+        }
+        return cached;
+    }
+
+    /// @brief 把寄存器合并到展开的数组中，每个寄存器一字节，共HLL_REGISTERS字节
+    void mergeInto(uint8_t *registers) const{
+        if(encoding == SPARSE){
+            for(uint32_t entry : sparse){
+                uint8_t &reg = registers[entry >> 8];
+                reg = std::max<uint8_t>(reg, entry & 0xff);
+            }
+            return;
+        }
+        uint8_t expanded[HLL_REGISTERS];
+        for(uint32_t i=0; i<HLL_REGISTERS; i++){
+            expanded[i] = getDense(i);
+        }
+        hllMax(registers, expanded, HLL_REGISTERS);
+    }
+
+    /// @brief 用展开的寄存器替换当前的寄存器，结果使用密集编码
+    void setRegisters(const uint8_t *registers){
+        encoding = DENSE;
+        std::vector<uint32_t>().swap(sparse);
+        dense.assign(HLL_DENSE_BYTES + 1, 0);
+        for(uint32_t i=0; i<HLL_REGISTERS; i++){
+            setDense(i, registers[i]);
+        }
+        cacheValid = false;
+    }
+
+    /// @brief 用寄存器的直方图估计基数，histogram[i]是值为i的寄存器个数
+    static uint64_t estimate(const int *histogram){
+        double m = HLL_REGISTERS;
+        double z = m * tau((m - histogram[HLL_Q + 1]) / m);
+        for(int j=HLL_Q; j>=1; j--){
+            z += histogram[j];
+            z *= 0.5;
+        }
+        z += m * sigma(histogram[0] / m);
+        return std::llround(HLL_ALPHA_INF * m * m / z);
+    }
+
+    /// @brief 用展开的寄存器估计基数
+    static uint64_t estimate(const uint8_t *registers){
+        int histogram[HLL_Q + 2] = {0};
+        for(uint32_t i=0; i<HLL_REGISTERS; i++){
+            histogram[registers[i]]++;
+        }
+        return estimate(histogram);
+    }
+
+    Encoding getEncoding() const { return encoding; }
+    size_t bytes() const { return encoding == SPARSE ? sparse.size() * sizeof(uint32_t) : dense.size(); }
+
+    /// @brief 编码：第一个字节是'S'或'D'，稀疏编码后面是小端的4字节项，密集编码后面是紧密排列的寄存器
+    std::string serialize() const{
+        std::string data(1, encoding == SPARSE ? 'S' : 'D');
+        if(encoding == SPARSE){
+            for(uint32_t entry : sparse){
+                for(int i=0; i<4; i++){
+                    data += static_cast<char>((entry >> (i * 8)) & 0xff);
+                }
+            }
+        }
+        else{
+            data.append(reinterpret_cast<const char*>(dense.data()), HLL_DENSE_BYTES);
+        }
+        return data;
+    }
+
+    /// @brief 从serialize的结果恢复，格式不对时返回false
+    bool deserialize(const std::string &data){
+        if(data.empty()){
+            return false;
+        }
+        const uint8_t *p = reinterpret_cast<const uint8_t*>(data.data()) + 1;
+        size_t len = data.size() - 1;
+        if(data[0] == 'S' && len % 4 == 0){
+            std::vector<uint32_t> entries;
+            for(size_t i=0; i<len; i+=4){
+                uint32_t entry = p[i] | (p[i+1] << 8) | (p[i+2] << 16) | (uint32_t(p[i+3]) << 24);
+                uint32_t rank = entry & 0xff;
+                if(rank == 0 || rank > HLL_Q + 1 || (entry >> 8) >= HLL_REGISTERS
+                    || (!entries.empty() && (entries.back() >> 8) >= (entry >> 8))){
+                    return false;
+                }
+                entries.push_back(entry);
+            }
+            encoding = SPARSE;
+            sparse.swap(entries);
+            std::vector<uint8_t>().swap(dense);
+        }
+        else if(data[0] == 'D' && len == HLL_DENSE_BYTES){
+            encoding = DENSE;
+            std::vector<uint32_t>().swap(sparse);
+            dense.assign(p, p + len);
+            dense.push_back(0);
+            for(uint32_t i=0; i<HLL_REGISTERS; i++){
+                if(getDense(i) > HLL_Q + 1){
+                    return false;
+                }
+            }
+        }
+        else{
+            return false;
+        }
+        cacheValid = false;
+        return true;
+    }
+
+private:
+    /// @brief 寄存器取max(原值, rank)
+    /// @return 寄存器是否改变
+    bool set(uint32_t index, uint8_t rank){
+        if(encoding == DENSE){
+            if(getDense(index) >= rank){
+                return false;
+            }
+            setDense(index, rank);
+            cacheValid = false;
+            return true;
+        }
+        uint32_t entry = (index << 8) | rank;
+        auto it = std::lower_bound(sparse.begin(), sparse.end(), index << 8);
+        if(it != sparse.end() && (*it >> 8) == index){
+            if((*it & 0xff) >= rank){
+                return false;
+            }
+            *it = entry;
+        }
+        else{
+            sparse.insert(it, entry);
+        }
+        cacheValid = false;
+        if(sparse.size() * sizeof(uint32_t) > HLL_SPARSE_MAX_BYTES){
+            toDense();
+        }
+        return true;
+    }
+
+    //寄存器可能跨越两个字节，dense末尾多留一个字节，读写时不用判断边界
+    uint8_t getDense(uint32_t index) const{
+        size_t byte = index * HLL_BITS / 8;
+        unsigned shift = index * HLL_BITS & 7;
+        return ((dense[byte] >> shift) | (dense[byte + 1] << (8 - shift))) & ((1 << HLL_BITS) - 1);
+    }
+
+    void setDense(uint32_t index, uint8_t value){
+        size_t byte = index * HLL_BITS / 8;
+        unsigned shift = index * HLL_BITS & 7;
+        const unsigned mask = (1 << HLL_BITS) - 1;
+        dense[byte] = (dense[byte] & ~(mask << shift)) | (value << shift);
+        dense[byte + 1] = (dense[byte + 1] & ~(mask >> (8 - shift))) | (value >> (8 - shift));
+    }
+
+    void toDense(){
+        dense.assign(HLL_DENSE_BYTES + 1, 0);
+        for(uint32_t entry : sparse){
+            setDense(entry >> 8, entry & 0xff);
+        }
+        std::vector<uint32_t>().swap(sparse);
+        encoding = DENSE;
+    }
+
+    static double sigma(double x){
+        if(x == 1.0){
+            return INFINITY;
+        }
+        double y = 1, z = x, last;
+        do{
+            x *= x;
+            last = z;
+            z += x * y;
+            y += y;
+        }while(last != z);
+        return z;
+    }
+
+    static double tau(double x){
+        if(x == 0.0 || x == 1.0){
+            return 0.0;
+        }
+        double y = 1.0, z = 1 - x, last;
+        do{
+            x = std::sqrt(x);
+            last = z;
+            y *= 0.5;
+            z -= std::pow(1 - x, 2) * y;
+        }while(last != z);
+        return z / 3;
+    }
+
+private:
+    Encoding encoding = SPARSE;
+    std::vector<uint32_t> sparse;   //非零寄存器，(下标<<8 | 值)，按下标排序
+    std::vector<uint8_t> dense;     //HLL_DENSE_BYTES+1字节
+    uint64_t cached = 0;            //上一次估计的基数
+    bool cacheValid = true;         //空的HyperLogLog基数为0
+};
+
+#endif
@@ -0,0 +1,130 @@
+#include "HyperLogLog.h"
+#include <iostream>
+#include <random>
+#include <cassert>
+
+static double relativeError(uint64_t estimate, uint64_t actual){
+    return std::fabs(static_cast<double>(estimate) - actual) / actual;
+}
+
+//逐字节取最大值的各个实现与通用实现对照，长度覆盖向量循环的尾部
+static void compareMaxKernels(){
+    std::vector<void (*)(uint8_t*, const uint8_t*, size_t)> kernels = {hllMax};
+#ifdef HLL_X86_DISPATCH
+    if(__builtin_cpu_supports("avx2")){
+        kernels.push_back(hllMaxAvx2);
+    }
+    if(__builtin_cpu_supports("avx512bw")){
+        kernels.push_back(hllMaxAvx512);
+    }
+#endif
+    std::mt19937 generator(1);
+    for(int i=0; i<2000; i++){
+        size_t len = i < 200 ? i : generator() % 1000;
+        std::vector<uint8_t> dst(len), src(len);
+        for(size_t j=0; j<len; j++){
+            dst[j] = generator() % 52;
+            src[j] = generator() % 52;
+        }
+        std::vector<uint8_t> expected = dst;
+        hllMaxPortable(expected.data(), src.data(), len);
+        for(auto kernel : kernels){
+            std::vector<uint8_t> result = dst;
+            kernel(result.data(), src.data(), len);
+            assert(result == expected);
+        }
+    }
+    std::cout<<"max kernels="<<kernels.size()<<std::endl;
+}
+
+//稀疏编码转换成密集编码前后，以及序列化恢复后，估计值不变
+static void compareEncodings(){
+    HyperLogLog hll;
+    uint64_t lastCount = 0;
+    for(int i=0; i<20000; i++){
+        std::string element = "e" + std::to_string(i);
+        assert(hll.add(element) || hll.count() == lastCount);
+        assert(!hll.add(element));
+        lastCount = hll.count();
+
+        if(i % 97 == 0){
+            HyperLogLog copy;
+            assert(copy.deserialize(hll.serialize()) && copy.getEncoding() == hll.getEncoding());
+            assert(copy.count() == lastCount && copy.serialize() == hll.serialize());
+            //展开后改用密集编码，寄存器相同所以估计值相同
+            std::vector<uint8_t> registers(HLL_REGISTERS, 0);
+            hll.mergeInto(registers.data());
+            HyperLogLog dense;
+            dense.setRegisters(registers.data());
+            assert(dense.getEncoding() == HyperLogLog::DENSE && dense.count() == lastCount);
+            assert(HyperLogLog::estimate(registers.data()) == lastCount);
+        }
+    }
+    assert(hll.getEncoding() == HyperLogLog::DENSE && hll.bytes() == HLL_DENSE_BYTES + 1);
+    std::cout<<"encodings OK, 20000 -> "<<hll.count()<<std::endl;
+}
+
+//不同基数下的误差，标准误差0.81%，允许4倍
+static void accuracy(){
+    HyperLogLog hll;
+    uint64_t checkpoints[] = {1, 10, 100, 1000, 10000, 100000, 1000000};
+    uint64_t added = 0;
+    for(uint64_t target : checkpoints){
+        for(; added < target; added++){
+            hll.add("member:" + std::to_string(added));
+        }
+        uint64_t estimate = hll.count();
+        std::cout<<target<<" -> "<<estimate<<" ("<<relativeError(estimate, target) * 100<<"%)"<<std::endl;
+        if(target <= 100){
+            assert(estimate + 2 >= target && estimate <= target + 2);
+        }
+        else{
+            assert(relativeError(estimate, target) < 0.0324);
+        }
+    }
+}
+
+//合并的结果与直接添加所有元素的寄存器相同
+static void merge(){
+    HyperLogLog a, b, both;
+    for(int i=0; i<30000; i++){
+        std::string element = std::to_string(i);
+        (i < 20000 ? a : b).add(element);
+        both.add(element);
+    }
+    //重叠的部分
+    for(int i=15000; i<20000; i++){
+        b.add(std::to_string(i));
+    }
+    std::vector<uint8_t> registers(HLL_REGISTERS, 0);
+    a.mergeInto(registers.data());
+    b.mergeInto(registers.data());
+    assert(HyperLogLog::estimate(registers.data()) == both.count());
+    HyperLogLog merged;
+    merged.setRegisters(registers.data());
+    assert(merged.serialize() == both.serialize() || both.getEncoding() == HyperLogLog::SPARSE);
+    assert(merged.count() == both.count());
+    std::cout<<"merge OK, "<<merged.count()<<std::endl;
+}
+
+int main(){
+    HyperLogLog empty;
+    assert(empty.count() == 0 && empty.getEncoding() == HyperLogLog::SPARSE);
+    assert(empty.add("a") && !empty.add("a") && empty.count() == 1);
+
+    //格式错误的数据
+    HyperLogLog bad;
+    assert(!bad.deserialize("") && !bad.deserialize("X") && !bad.deserialize("Sabc"));
+    assert(!bad.deserialize(std::string("S\x00\x00\x00\x00", 5)) && !bad.deserialize(std::string("S\x40\x00\x00\x00", 5)));     //寄存器的值在1到HLL_Q+1之间
+    assert(!bad.deserialize(std::string("S\x01\x01\x00\x00\x01\x01\x00\x00", 9)));    //下标必须递增
+    assert(!bad.deserialize("D" + std::string(HLL_DENSE_BYTES - 1, '\0')));
+    assert(!bad.deserialize("D" + std::string(HLL_DENSE_BYTES, '\xff')));
+    assert(bad.deserialize("S") && bad.count() == 0);
+
+    compareMaxKernels();
+    compareEncodings();
+    accuracy();
+    merge();
+    std::cout<<"HyperLogLog OK"<<std::endl;
+    return 0;
+}
@@ -0,0 +1,213 @@
+#ifndef LZF_H
+#define LZF_H
+
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+
+#define LZF_HASH_LOG 13
+#define LZF_MAX_LITERAL 32     //一段字面量的最大长度
+#define LZF_MAX_OFFSET 8192    //回溯引用的最大距离
+#define LZF_MAX_MATCH 264      //一次匹配的最大长度 (7+255+2)
+
+
+/*
+    LZF风格的轻量压缩算法，不依赖第三方库
+    控制字节 ctrl < 32: 后面跟着 ctrl+1 个原样字节(字面量)
+    控制字节 ctrl >= 32: 回溯引用，长度为 (ctrl>>5)+2 (等于7时再读一个字节累加)，
+                         距离为 ((ctrl&0x1f)<<8) + 下一个字节 + 1
+    压缩和解压都是单遍扫描，速度优先于压缩率
+*/
+
+/**
+ * @brief 压缩数据
+ * @param in 输入数据
+ * @param inLen 输入数据长度
+ * @param out 输出缓冲区
+ * @param outLen 输出缓冲区大小
+ * @return 压缩后的长度，输出缓冲区放不下时返回0
+*/
+inline size_t lzfCompress(const char *in, size_t inLen, char *out, size_t outLen){
+    if(inLen == 0 || outLen == 0 || inLen > UINT32_MAX){
+        return 0;
+    }
+    //哈希表每个线程一份，记录三字节前缀上一次出现的位置，不在每次压缩时分配和清零；
+    //上一次调用留下的位置不小于当前位置时直接忽略，小于时指向本次输入中已经扫描过的字节，比较内容后仍然可以使用
+    thread_local uint32_t hashTable[1 << LZF_HASH_LOG];
+    const uint8_t *inStart = reinterpret_cast<const uint8_t*>(in);
+    const uint8_t *ip = inStart;
+    const uint8_t *inEnd = ip + inLen;
+    uint8_t *op = reinterpret_cast<uint8_t*>(out);
+    uint8_t *outStart = op;
+    uint8_t *outEnd = op + outLen;
+    int lit = 0;
+    op++; //为第一段字面量预留控制字节
+
+    while(ip + 2 < inEnd){
+        uint32_t v = (ip[0] << 16) | (ip[1] << 8) | ip[2];
+        uint32_t h = (v * 2654435761u) >> (32 - LZF_HASH_LOG);
+        uint32_t pos = ip - inStart;
+        uint32_t refPos = hashTable[h];
+        hashTable[h] = pos;
+        const uint8_t *ref = refPos < pos ? inStart + refPos : ip;
+        size_t off = refPos < pos ? pos - refPos - 1 : LZF_MAX_OFFSET;
+        if(off < LZF_MAX_OFFSET && ref[0] == ip[0] && ref[1] == ip[1] && ref[2] == ip[2]){
+            size_t maxLen = std::min<size_t>(inEnd - ip, LZF_MAX_MATCH);
+            size_t len = 3;
+            while(len < maxLen && ref[len] == ip[len]){
+                len++;
+            }
+            //回溯引用最多占3个字节，再加上下一段字面量的控制字节
+            if(op + 4 > outEnd){
+                return 0;
+            }
+            //结束当前字面量段
+            if(lit){
+                op[-lit - 1] = lit - 1;
+            }
+            else{
+                op--;
+            }
+            size_t l = len - 2;
+            if(l < 7){
+                *op++ = (l << 5) | (off >> 8);
+            }
+            else{
+                *op++ = (7 << 5) | (off >> 8);
+                *op++ = l - 7;
+            }
+            *op++ = off & 0xff;
+            ip += len;
+            lit = 0;
+            op++;
+            continue;
+        }
+        if(op >= outEnd){
+            return 0;
+        }
+        *op++ = *ip++;
+        if(++lit == LZF_MAX_LITERAL){
+            op[-lit - 1] = lit - 1;
+            lit = 0;
+            op++;
+        }
+    }
+    while(ip < inEnd){
+        if(op >= outEnd){
+            return 0;
+        }
+        *op++ = *ip++;
+        if(++lit == LZF_MAX_LITERAL){
+            op[-lit - 1] = lit - 1;
+            lit = 0;
+            op++;
+        }
+    }
+    if(op > outEnd){
+        return 0;
+    }
+    if(lit){
+        op[-lit - 1] = lit - 1;
+    }
+    else{
+        op--;
+    }
+    return op - outStart;
+}
+
+/**
+ * @brief 解压数据
+ * @param in 压缩后的数据
+ * @param inLen 压缩数据长度
+ * @param out 输出缓冲区
+ * @param outLen 输出缓冲区大小，即原始数据长度
+ * @return 解压后的长度，数据损坏或缓冲区不足时返回0
+*/
+inline size_t lzfDecompress(const char *in, size_t inLen, char *out, size_t outLen){
+    const uint8_t *ip = reinterpret_cast<const uint8_t*>(in);
+    const uint8_t *inEnd = ip + inLen;
+    uint8_t *op = reinterpret_cast<uint8_t*>(out);
+    uint8_t *outStart = op;
+    uint8_t *outEnd = op + outLen;
+
+    while(ip < inEnd){
+        size_t ctrl = *ip++;
+        if(ctrl < LZF_MAX_LITERAL){
+            ctrl++;
+            if(op + ctrl > outEnd || ip + ctrl > inEnd){
+                return 0;
+            }
+            memcpy(op, ip, ctrl);
+            op += ctrl;
+            ip += ctrl;
+        }
+        else{
+            size_t len = ctrl >> 5;
+            if(len == 7){
+                if(ip >= inEnd){
+                    return 0;
+                }
+                len += *ip++;
+            }
+            if(ip >= inEnd){
+                return 0;
+            }
+            const uint8_t *ref = op - ((ctrl & 0x1f) << 8) - 1 - *ip++;
+            len += 2;
+            if(op + len > outEnd || ref < outStart){
+                return 0;
+            }
+            //引用区域和输出区域不重叠时整段拷贝，重叠时（重复的短模式）只能逐字节拷贝
+            if(static_cast<size_t>(op - ref) >= len){
+                memcpy(op, ref, len);
+                op += len;
+            }
+            else{
+                while(len--){
+                    *op++ = *ref++;
+                }
+            }
+        }
+    }
+    return op - outStart;
+}
+
+/**
+ * @brief 压缩字符串，只有压缩后确实变小才算成功
+ * @param in 原始数据
+ * @param out 压缩结果
+ * @return 是否压缩成功
+*/
+inline bool lzfCompress(const std::string &in, std::string &out){
+    if(in.size() < 4){
+        return false;
+    }
+    out.resize(in.size() - 1);
+    size_t len = lzfCompress(in.data(), in.size(), &out[0], out.size());
+    if(len == 0){
+        out.clear();
+        return false;
+    }
+    out.resize(len);
+    return true;
+}
+
+/**
+ * @brief 解压字符串
+ * @param in 压缩数据
+ * @param inLen 压缩数据长度
+ * @param rawLen 原始数据长度
+ * @param out 解压结果
+ * @return 是否解压成功
+*/
+inline bool lzfDecompress(const char *in, size_t inLen, size_t rawLen, std::string &out){
+    out.resize(rawLen);
+    if(rawLen == 0){
+        return true;
+    }
+    return lzfDecompress(in, inLen, &out[0], rawLen) == rawLen;
+}
+
+#endif
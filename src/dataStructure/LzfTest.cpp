@@ -0,0 +1,99 @@
+#include "Lzf.h"
+#include <iostream>
+#include <random>
+#include <thread>
+#include <cassert>
+
+//不同重复程度的数据：全部相同、少量字符、带重复片段的文本、完全随机
+static std::string randomData(std::mt19937 &generator, size_t len){
+    std::string data;
+    int kind = generator() % 4;
+    while(data.size() < len){
+        if(kind == 0){
+            data += 'a';
+        }
+        else if(kind == 1){
+            data += "ab"[generator() % 2];
+        }
+        else if(kind == 2 && data.size() > 16 && generator() % 4 == 0){
+            size_t from = generator() % (data.size() - 8);
+            data.append(data, from, 3 + generator() % std::min<size_t>(300, data.size() - from - 3));
+        }
+        else{
+            data += static_cast<char>(generator());
+        }
+    }
+    data.resize(len);
+    return data;
+}
+
+//压缩后能解压出原始数据，压缩结果一定比原始数据短
+static void roundTrip(unsigned seed, int rounds){
+    std::mt19937 generator(seed);
+    size_t compressedCount = 0;
+    for(int i=0; i<rounds; i++){
+        size_t len = i < 100 ? i : generator() % 20000;
+        std::string data = randomData(generator, len);
+        std::string compressed;
+        if(!lzfCompress(data, compressed)){
+            continue;
+        }
+        compressedCount++;
+        assert(compressed.size() < data.size());
+        std::string restored;
+        assert(lzfDecompress(compressed.data(), compressed.size(), data.size(), restored) && restored == data);
+        //输出缓冲区小于原始长度时解压失败
+        if(!data.empty()){
+            std::string small(data.size() - 1, '\0');
+            assert(lzfDecompress(compressed.data(), compressed.size(), &small[0], small.size()) == 0);
+        }
+    }
+    std::cout<<"seed="<<seed<<" compressed "<<compressedCount<<"/"<<rounds<<std::endl;
+}
+
+//随机修改或截断压缩数据，解压不会越界（用-fsanitize=address检查）
+static void corrupted(){
+    std::mt19937 generator(7);
+    for(int i=0; i<2000; i++){
+        std::string data = randomData(generator, 100 + generator() % 5000);
+        std::string compressed;
+        if(!lzfCompress(data, compressed)){
+            continue;
+        }
+        for(int j=0; j<4; j++){
+            compressed[generator() % compressed.size()] = generator();
+        }
+        std::string restored;
+        lzfDecompress(compressed.data(), generator() % (compressed.size() + 1), data.size(), restored);
+    }
+    std::cout<<"corrupted input OK"<<std::endl;
+}
+
+int main(){
+    std::string text;
+    for(int i=0; i<200; i++){
+        text += "hello world ";
+    }
+    std::string compressed;
+    assert(lzfCompress(text, compressed));
+    std::cout<<text.size()<<" -> "<<compressed.size()<<std::endl;
+    std::string restored;
+    assert(lzfDecompress(compressed.data(), compressed.size(), text.size(), restored) && restored == text);
+    //太短或者不能压缩的数据
+    assert(!lzfCompress(std::string("abc"), compressed));
+    assert(!lzfCompress(std::string("abcdefgh"), compressed));
+    assert(lzfDecompress(nullptr, 0, 0, restored) && restored.empty());
+
+    roundTrip(1, 3000);
+    //哈希表是线程局部的，多个线程同时压缩互不影响
+    std::vector<std::thread> threads;
+    for(unsigned seed=2; seed<6; seed++){
+        threads.emplace_back(roundTrip, seed, 500);
+    }
+    for(std::thread &thread : threads){
+        thread.join();
+    }
+    corrupted();
+    std::cout<<"Lzf OK"<<std::endl;
+    return 0;
+}
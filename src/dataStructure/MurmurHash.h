@@ -0,0 +1,39 @@
+#ifndef MURMUR_HASH_H
+#define MURMUR_HASH_H
+
+#include <cstring>
+#include <cstdint>
+
+/// @brief MurmurHash64A，与Redis计算HyperLogLog时使用的哈希相同，布隆过滤器和布谷鸟过滤器也使用它
+inline uint64_t murmurHash64A(const void *key, size_t len, uint64_t seed){
+    const uint64_t m = 0xc6a4a7935bd1e995ULL;
+    const int r = 47;
+    uint64_t h = seed ^ (len * m);
+    const uint8_t *data = static_cast<const uint8_t*>(key);
+    const uint8_t *end = data + (len - (len & 7));
+    for(; data != end; data += 8){
+        uint64_t k;
+        std::memcpy(&k, data, 8);
+        k *= m;
+        k ^= k >> r;
+        k *= m;
+        h ^= k;
+        h *= m;
+    }
+    switch(len & 7){
+        case 7: h ^= uint64_t(data[6]) << 48; [[fallthrough]];
+        case 6: h ^= uint64_t(data[5]) << 40; [[fallthrough]];
+        case 5: h ^= uint64_t(data[4]) << 32; [[fallthrough]];
+        case 4: h ^= uint64_t(data[3]) << 24; [[fallthrough]];
+        case 3: h ^= uint64_t(data[2]) << 16; [[fallthrough]];
+        case 2: h ^= uint64_t(data[1]) << 8; [[fallthrough]];
+        case 1: h ^= uint64_t(data[0]);
+                h *= m;
+    }
+    h ^= h >> r;
+    h *= m;
+    h ^= h >> r;
+    return h;
+}
+
+#endif
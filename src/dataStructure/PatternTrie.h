@@ -0,0 +1,293 @@
+#ifndef PATTERN_TRIE_H
+#define PATTERN_TRIE_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <memory>
+#include <bitset>
+#include <algorithm>
+
+/*
+    glob模式的前缀树，支持 * ? [abc] [^a-z] 和 \ 转义，语义与GlobPattern相同
+    每个模式拆成单字符的段插入树中，前缀相同的模式共用节点
+    匹配时把树当作NFA，用一组活跃节点同时推进：每读一个字符，活跃节点沿字面量、?、字符集合的边前进，
+    * 节点可以吸收任意字符所以保持活跃
+    代价取决于字符串长度和被字符串走到的节点数，与模式总数无关，不会为了每个模式重新扫描字符串
+*/
+template<typename Value>
+class PatternTrie{
+public:
+    /// @brief 添加模式的一个订阅者
+    /// @return 该订阅者之前没有订阅这个模式时返回true
+    bool insert(const std::string &pattern, const Value &value){
+        Node *node = &root;
+        for(const Segment &segment : parse(pattern)){
+            std::unique_ptr<Node> &child = node->child(segment);
+            if(child == nullptr){
+                child.reset(new Node());
+                child->isStar = segment.type == Segment::ANY_SEQ;
+                child->charset = segment.charset;
+            }
+            node = child.get();
+        }
+        std::set<Value> &values = node->patterns[pattern];
+        if(values.empty()){
+            patternCount++;
+        }
+        return values.insert(value).second;
+    }
+
+    /// @brief 删除模式的一个订阅者，模式没有订阅者后删除不再使用的节点
+    bool erase(const std::string &pattern, const Value &value){
+        std::vector<Segment> segments = parse(pattern);
+        bool erased = false;
+        eraseFrom(&root, pattern, segments, 0, value, erased);
+        return erased;
+    }
+
+    /// @brief 对每个与str匹配的模式的每个订阅者调用callback(pattern, value)
+    template<typename Callback>
+    void match(const std::string &str, Callback callback) const{
+        std::vector<const Node*> active;
+        std::vector<const Node*> next;
+        clock++;
+        addState(active, &root);
+        for(unsigned char c : str){
+            next.clear();
+            clock++;
+            for(const Node *node : active){
+                if(node->isStar){
+                    addState(next, node);
+                }
+                auto it = node->literals.find(c);
+                if(it != node->literals.end()){
+                    addState(next, it->second.get());
+                }
+                if(node->anyChar != nullptr){
+                    addState(next, node->anyChar.get());
+                }
+                for(const auto &charClass : node->classes){
+                    if(charClass.second->charset.test(c)){
+                        addState(next, charClass.second.get());
+                    }
+                }
+            }
+            active.swap(next);
+            if(active.empty()){
+                return;
+            }
+        }
+        for(const Node *node : active){
+            for(const auto &entry : node->patterns){
+                for(const Value &value : entry.second){
+                    callback(entry.first, value);
+                }
+            }
+        }
+    }
+
+    /// @brief 模式的订阅者个数
+    size_t count(const std::string &pattern) const{
+        const Node *node = &root;
+        for(const Segment &segment : parse(pattern)){
+            const std::unique_ptr<Node> *child = node->find(segment);
+            if(child == nullptr || *child == nullptr){
+                return 0;
+            }
+            node = child->get();
+        }
+        auto it = node->patterns.find(pattern);
+        return it == node->patterns.end() ? 0 : it->second.size();
+    }
+
+    size_t size() const { return patternCount; }   //至少有一个订阅者的模式个数
+
+private:
+    struct Segment{
+        enum Type{
+            LITERAL,    //单个字符
+            ANY_CHAR,   // ?
+            ANY_SEQ,    // *
+            CHAR_CLASS  // [...]
+        };
+        Type type;
+        unsigned char c;
+        std::string text;           //字符集合在模式中的原文，相同的原文共用节点
+        std::bitset<256> charset;
+    };
+
+    struct Node{
+        std::map<unsigned char, std::unique_ptr<Node>> literals;
+        std::unique_ptr<Node> anyChar;
+        std::unique_ptr<Node> anySeq;
+        std::vector<std::pair<std::string, std::unique_ptr<Node>>> classes;
+        bool isStar = false;            //由 * 到达的节点，可以吸收任意字符
+        std::bitset<256> charset;       //由字符集合到达的节点使用
+        //在此结束的模式和它们的订阅者，"a*"和"a**"拆分后相同，但仍然是不同的模式
+        std::map<std::string, std::set<Value>> patterns;
+        mutable unsigned long stamp = 0;    //最近一次加入活跃集合时的clock，用于去重
+
+        std::unique_ptr<Node>* find(const Segment &segment){
+            switch(segment.type){
+                case Segment::LITERAL:{
+                    auto it = literals.find(segment.c);
+                    return it == literals.end() ? nullptr : &it->second;
+                }
+                case Segment::ANY_CHAR:
+                    return &anyChar;
+                case Segment::ANY_SEQ:
+                    return &anySeq;
+                default:
+                    for(auto &charClass : classes){
+                        if(charClass.first == segment.text){
+                            return &charClass.second;
+                        }
+                    }
+                    return nullptr;
+            }
+        }
+
+        const std::unique_ptr<Node>* find(const Segment &segment) const{
+            return const_cast<Node*>(this)->find(segment);
+        }
+
+        std::unique_ptr<Node>& child(const Segment &segment){
+            std::unique_ptr<Node> *found = find(segment);
+            if(found != nullptr){
+                return *found;
+            }
+            if(segment.type == Segment::LITERAL){
+                return literals[segment.c];
+            }
+            classes.emplace_back(segment.text, nullptr);
+            return classes.back().second;
+        }
+
+        void remove(const Segment &segment){
+            switch(segment.type){
+                case Segment::LITERAL:
+                    literals.erase(segment.c);
+                    break;
+                case Segment::ANY_CHAR:
+                    anyChar.reset();
+                    break;
+                case Segment::ANY_SEQ:
+                    anySeq.reset();
+                    break;
+                default:
+                    classes.erase(std::remove_if(classes.begin(), classes.end(),
+                        [&](const std::pair<std::string, std::unique_ptr<Node>> &charClass){ return charClass.first == segment.text; }), classes.end());
+                    break;
+            }
+        }
+
+        bool empty() const{
+            return patterns.empty() && literals.empty() && anyChar == nullptr && anySeq == nullptr && classes.empty();
+        }
+    };
+
+    /// @brief 加入活跃节点，并加入经过 * 不消耗字符就能到达的节点
+    void addState(std::vector<const Node*> &states, const Node *node) const{
+        if(node->stamp == clock){
+            return;
+        }
+        node->stamp = clock;
+        states.push_back(node);
+        if(node->anySeq != nullptr){
+            addState(states, node->anySeq.get());
+        }
+    }
+
+    static std::vector<Segment> parse(const std::string &pattern){
+        std::vector<Segment> segments;
+        size_t i = 0;
+        while(i < pattern.size()){
+            char c = pattern[i];
+            if(c == '*'){
+                //连续的*等价于一个
+                if(segments.empty() || segments.back().type != Segment::ANY_SEQ){
+                    segments.push_back(Segment{Segment::ANY_SEQ, 0, "", {}});
+                }
+                i++;
+            }
+            else if(c == '?'){
+                segments.push_back(Segment{Segment::ANY_CHAR, 0, "", {}});
+                i++;
+            }
+            else if(c == '[' && pattern.find(']', i+1) != std::string::npos){
+                size_t begin = i;
+                Segment segment{Segment::CHAR_CLASS, 0, "", {}};
+                i++;
+                bool negate = i < pattern.size() && pattern[i] == '^';
+                if(negate){
+                    i++;
+                }
+                while(i < pattern.size() && pattern[i] != ']'){
+                    if(pattern[i] == '\\' && i+1 < pattern.size()){
+                        segment.charset.set(static_cast<unsigned char>(pattern[i+1]));
+                        i += 2;
+                    }
+                    else if(i+2 < pattern.size() && pattern[i+1] == '-' && pattern[i+2] != ']'){
+                        unsigned char low = std::min(pattern[i], pattern[i+2]);
+                        unsigned char high = std::max(pattern[i], pattern[i+2]);
+                        for(int ch=low; ch<=high; ch++){
+                            segment.charset.set(ch);
+                        }
+                        i += 3;
+                    }
+                    else{
+                        segment.charset.set(static_cast<unsigned char>(pattern[i]));
+                        i++;
+                    }
+                }
+                i++; //跳过 ]
+                if(negate){
+                    segment.charset.flip();
+                }
+                segment.text = pattern.substr(begin, i - begin);
+                segments.push_back(segment);
+            }
+            else{
+                if(c == '\\' && i+1 < pattern.size()){
+                    i++;
+                    c = pattern[i];
+                }
+                segments.push_back(Segment{Segment::LITERAL, static_cast<unsigned char>(c), "", {}});
+                i++;
+            }
+        }
+        return segments;
+    }
+
+    /// @return node是否已经可以删除
+    bool eraseFrom(Node *node, const std::string &pattern, const std::vector<Segment> &segments, size_t index, const Value &value, bool &erased){
+        if(index == segments.size()){
+            auto it = node->patterns.find(pattern);
+            if(it != node->patterns.end() && it->second.erase(value) > 0){
+                erased = true;
+                if(it->second.empty()){
+                    node->patterns.erase(it);
+                    patternCount--;
+                }
+            }
+            return node->empty();
+        }
+        std::unique_ptr<Node> *child = node->find(segments[index]);
+        if(child == nullptr || *child == nullptr){
+            return false;
+        }
+        if(eraseFrom(child->get(), pattern, segments, index+1, value, erased)){
+            node->remove(segments[index]);
+        }
+        return node != &root && node->empty();
+    }
+
+private:
+    Node root;
+    size_t patternCount = 0;
+    mutable unsigned long clock = 0;    //每推进一个字符加一
+};
+
+#endif
@@ -0,0 +1,103 @@
+#include "PatternTrie.h"
+#include "../GlobPattern.h"
+#include <iostream>
+#include <random>
+#include <set>
+#include <cassert>
+
+typedef std::set<std::pair<std::string, int>> Matches;
+
+static Matches trieMatches(const PatternTrie<int> &trie, const std::string &str){
+    Matches matches;
+    trie.match(str, [&matches](const std::string &pattern, int value){
+        //同一个模式的同一个订阅者只回调一次
+        assert(matches.insert({pattern, value}).second);
+    });
+    return matches;
+}
+
+//随机插入、删除多个模式，与逐个用GlobPattern匹配的结果对照
+static void randomCompare(unsigned seed){
+    std::mt19937 generator(seed);
+    const char patternChars[] = "ab*?[]^-\\";
+    const char stringChars[] = "ab-]^";
+    PatternTrie<int> trie;
+    std::set<std::pair<std::string, int>> expected;
+    for(int i=0; i<20000; i++){
+        std::string pattern;
+        for(int len=generator()%6; len>0; len--){
+            pattern += patternChars[generator() % (sizeof(patternChars) - 1)];
+        }
+        int value = generator() % 3;
+        //订阅总数保持在几百个以内，参照实现逐个匹配
+        int op = expected.size() > 300 ? 2 : generator() % 4;
+        if(op <= 1){
+            assert(trie.insert(pattern, value) == expected.insert({pattern, value}).second);
+        }
+        else if(op == 2){
+            //删除已有的订阅时从已有集合中选，否则大部分删除都落空
+            if(!expected.empty() && (expected.size() > 300 || generator() % 2 == 0)){
+                auto it = expected.begin();
+                std::advance(it, generator() % expected.size());
+                pattern = it->first;
+                value = it->second;
+            }
+            assert(trie.erase(pattern, value) == (expected.erase({pattern, value}) == 1));
+        }
+        else{
+            std::string str;
+            for(int len=generator()%7; len>0; len--){
+                str += stringChars[generator() % (sizeof(stringChars) - 1)];
+            }
+            Matches reference;
+            for(const auto &entry : expected){
+                if(GlobPattern(entry.first).match(str)){
+                    reference.insert(entry);
+                }
+            }
+            if(trieMatches(trie, str) != reference){
+                std::cout<<"mismatch str="<<str<<" expected="<<reference.size()<<std::endl;
+                assert(false);
+            }
+        }
+        if(i % 100 == 0){
+            std::set<std::string> patterns;
+            for(const auto &entry : expected){
+                patterns.insert(entry.first);
+            }
+            assert(trie.size() == patterns.size());
+        }
+    }
+    std::cout<<"seed="<<seed<<" patterns="<<trie.size()<<std::endl;
+}
+
+int main(){
+    PatternTrie<int> trie;
+    trie.insert("news.*", 1);
+    trie.insert("news.*", 2);
+    trie.insert("news.[st]*", 1);
+    trie.insert("*", 3);
+    for(const auto &match : trieMatches(trie, "news.sport")){
+        std::cout<<match.first<<":"<<match.second<<" ";
+    }
+    std::cout<<std::endl;
+    assert(trieMatches(trie, "news.sport").size() == 4);
+    assert(trieMatches(trie, "weather").size() == 1);
+    assert(trie.size() == 3 && trie.count("news.*") == 2);
+    //重复订阅不增加订阅者
+    assert(!trie.insert("news.*", 1));
+    //"a*"和"a**"拆分后相同，但仍然是两个模式
+    trie.insert("a*", 4);
+    trie.insert("a**", 4);
+    assert(trieMatches(trie, "abc").size() == 3);
+    assert(trie.erase("a**", 4) && !trie.erase("a**", 4));
+    assert(trieMatches(trie, "abc").size() == 2);
+    //删除最后一个订阅者后模式消失
+    assert(trie.erase("news.*", 1) && trie.erase("news.*", 2));
+    assert(trie.count("news.*") == 0 && trieMatches(trie, "news.weather").size() == 1);
+
+    randomCompare(1);
+    randomCompare(2);
+    std::cout<<"PatternTrie OK"<<std::endl;
+    return 0;
+}
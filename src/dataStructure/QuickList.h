@@ -0,0 +1,379 @@
+#ifndef QUICKLIST_H
+#define QUICKLIST_H
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <cstring>
+#include <cstdint>
+#include "Lzf.h"
+
+#define QUICKLIST_CHUNK_SIZE 8192           //每个节点打包数据的字节上限
+#define QUICKLIST_COMPRESS_DEPTH 0          //两端各保留多少个不压缩的节点，0表示不压缩
+#define QUICKLIST_MIN_COMPRESS_BYTES 48     //小于该字节数的节点不值得压缩
+#define QUICKLIST_ENTRY_OVERHEAD (2*sizeof(uint32_t))
+
+
+/*
+    快速列表节点
+    每个节点把若干元素打包在一块连续内存中，元素编码为 [len][data][len]，
+    头尾都记录长度，所以从两端都可以O(1)定位第一个/最后一个元素
+*/
+struct QuickListNode{
+    QuickListNode *prev = nullptr;
+    QuickListNode *next = nullptr;
+    std::string entries;        //打包后的元素，压缩后存放的是压缩数据
+    uint32_t count = 0;         //节点内元素个数
+    uint32_t rawSize = 0;       //压缩前的字节数
+    bool compressed = false;    //是否已经压缩
+    bool incompressible = false; //压缩过但没有收益，内容不变就不再尝试
+};
+
+/*
+    快速列表：由定长字节块组成的双向链表
+    两端push/pop只操作头尾节点，时间复杂度O(1)
+    按下标查找先按节点的元素个数跳过整个节点，复杂度O(n/chunk)
+    中间节点可以选择压缩，两端compressDepth个节点始终保持不压缩
+*/
+class QuickList{
+public:
+    explicit QuickList(size_t chunkSize=QUICKLIST_CHUNK_SIZE, int compressDepth=QUICKLIST_COMPRESS_DEPTH);
+    ~QuickList();
+    QuickList(const QuickList&) = delete;
+    QuickList& operator=(const QuickList&) = delete;
+
+    void pushFront(const std::string &value);   //从头部插入
+    void pushBack(const std::string &value);    //从尾部插入
+    bool popFront(std::string &value);          //从头部弹出
+    bool popBack(std::string &value);           //从尾部弹出
+    bool index(long idx, std::string &value);   //按下标获取，支持负数下标
+    std::vector<std::string> range(long start, long end); //获取[start,end]区间的元素，支持负数下标
+    //按顺序访问[start,end]区间的元素，不复制元素，data只在回调期间有效
+    void forEachInRange(long start, long end, const std::function<void(const char *data, size_t size)> &func);
+    void clear();
+
+    size_t size() const { return length; }
+    size_t nodeSize() const { return nodeNumber; }
+    size_t bytes() const { return totalBytes; } //占用的打包字节数（压缩节点按压缩后计算）
+
+private:
+    QuickListNode* createNode();
+    void unlinkNode(QuickListNode *node);
+    bool canInsert(QuickListNode *node, const std::string &value) const;
+    void encodeEntry(const std::string &value, std::string &out) const;
+    //获取节点的原始字节，压缩节点会解压到scratch中
+    const std::string& rawEntries(QuickListNode *node, std::string &scratch) const;
+    void compressNode(QuickListNode *node);
+    void decompressNode(QuickListNode *node);
+    void updateCompression();
+    //定位下标所在的节点，offset返回在该节点内的偏移
+    QuickListNode* seek(size_t idx, size_t &offset) const;
+
+private:
+    QuickListNode *head = nullptr;
+    QuickListNode *tail = nullptr;
+    size_t length = 0;      //元素总数
+    size_t nodeNumber = 0;  //节点个数
+    size_t totalBytes = 0;
+    size_t chunkSize;
+    int compressDepth;
+};
+
+
+inline QuickList::QuickList(size_t chunkSize, int compressDepth)
+: chunkSize(chunkSize), compressDepth(compressDepth) {
+}
+
+inline QuickList::~QuickList(){
+    clear();
+}
+
+inline void QuickList::clear(){
+    //逐个释放节点，避免长链表递归析构
+    QuickListNode *node = head;
+    while(node){
+        QuickListNode *next = node->next;
+        delete node;
+        node = next;
+    }
+    head = tail = nullptr;
+    length = nodeNumber = totalBytes = 0;
+}
+
+inline QuickListNode* QuickList::createNode(){
+    nodeNumber++;
+    return new QuickListNode();
+}
+
+inline void QuickList::unlinkNode(QuickListNode *node){
+    if(node->prev){
+        node->prev->next = node->next;
+    }
+    else{
+        head = node->next;
+    }
+    if(node->next){
+        node->next->prev = node->prev;
+    }
+    else{
+        tail = node->prev;
+    }
+    totalBytes -= node->entries.size();
+    nodeNumber--;
+    delete node;
+}
+
+inline bool QuickList::canInsert(QuickListNode *node, const std::string &value) const{
+    if(node == nullptr || node->compressed){
+        return false;
+    }
+    //超过块大小的元素单独占一个节点
+    return node->count == 0 || node->entries.size() + value.size() + QUICKLIST_ENTRY_OVERHEAD <= chunkSize;
+}
+
+inline void QuickList::encodeEntry(const std::string &value, std::string &out) const{
+    uint32_t len = value.size();
+    out.resize(value.size() + QUICKLIST_ENTRY_OVERHEAD);
+    memcpy(&out[0], &len, sizeof(uint32_t));
+    memcpy(&out[sizeof(uint32_t)], value.data(), value.size());
+    memcpy(&out[sizeof(uint32_t) + value.size()], &len, sizeof(uint32_t));
+}
+
+inline void QuickList::pushFront(const std::string &value){
+    if(!canInsert(head, value)){
+        QuickListNode *node = createNode();
+        node->next = head;
+        if(head){
+            head->prev = node;
+        }
+        else{
+            tail = node;
+        }
+        head = node;
+    }
+    std::string entry;
+    encodeEntry(value, entry);
+    head->entries.insert(0, entry);
+    head->count++;
+    head->rawSize = head->entries.size();
+    head->incompressible = false;
+    totalBytes += entry.size();
+    length++;
+    updateCompression();
+}
+
+inline void QuickList::pushBack(const std::string &value){
+    if(!canInsert(tail, value)){
+        QuickListNode *node = createNode();
+        node->prev = tail;
+        if(tail){
+            tail->next = node;
+        }
+        else{
+            head = node;
+        }
+        tail = node;
+    }
+    std::string entry;
+    encodeEntry(value, entry);
+    tail->entries.append(entry);
+    tail->count++;
+    tail->rawSize = tail->entries.size();
+    tail->incompressible = false;
+    totalBytes += entry.size();
+    length++;
+    updateCompression();
+}
+
+inline bool QuickList::popFront(std::string &value){
+    if(head == nullptr){
+        return false;
+    }
+    decompressNode(head);
+    uint32_t len;
+    memcpy(&len, head->entries.data(), sizeof(uint32_t));
+    value.assign(head->entries.data() + sizeof(uint32_t), len);
+    head->entries.erase(0, len + QUICKLIST_ENTRY_OVERHEAD);
+    head->count--;
+    head->rawSize = head->entries.size();
+    totalBytes -= len + QUICKLIST_ENTRY_OVERHEAD;
+    length--;
+    if(head->count == 0){
+        unlinkNode(head);
+    }
+    updateCompression();
+    return true;
+}
+
+inline bool QuickList::popBack(std::string &value){
+    if(tail == nullptr){
+        return false;
+    }
+    decompressNode(tail);
+    uint32_t len;
+    size_t end = tail->entries.size();
+    memcpy(&len, tail->entries.data() + end - sizeof(uint32_t), sizeof(uint32_t));
+    size_t begin = end - len - QUICKLIST_ENTRY_OVERHEAD;
+    value.assign(tail->entries.data() + begin + sizeof(uint32_t), len);
+    tail->entries.resize(begin);
+    tail->count--;
+    tail->rawSize = tail->entries.size();
+    totalBytes -= len + QUICKLIST_ENTRY_OVERHEAD;
+    length--;
+    if(tail->count == 0){
+        unlinkNode(tail);
+    }
+    updateCompression();
+    return true;
+}
+
+inline const std::string& QuickList::rawEntries(QuickListNode *node, std::string &scratch) const{
+    if(!node->compressed){
+        return node->entries;
+    }
+    lzfDecompress(node->entries.data(), node->entries.size(), node->rawSize, scratch);
+    return scratch;
+}
+
+inline void QuickList::compressNode(QuickListNode *node){
+    if(node->compressed || node->incompressible || node->rawSize < QUICKLIST_MIN_COMPRESS_BYTES){
+        return;
+    }
+    std::string out;
+    if(!lzfCompress(node->entries, out)){
+        node->incompressible = true;
+        return;
+    }
+    totalBytes -= node->entries.size();
+    totalBytes += out.size();
+    node->entries.swap(out);
+    node->compressed = true;
+}
+
+inline void QuickList::decompressNode(QuickListNode *node){
+    if(!node->compressed){
+        return;
+    }
+    std::string out;
+    lzfDecompress(node->entries.data(), node->entries.size(), node->rawSize, out);
+    totalBytes -= node->entries.size();
+    totalBytes += out.size();
+    node->entries.swap(out);
+    node->compressed = false;
+    //内容没变，之前压缩有收益，下次移到中间时还会再压缩
+    node->incompressible = false;
+}
+
+/// @brief 两端各compressDepth个节点保持解压，刚好越过边界的节点压缩
+/// 每次push/pop最多只有边界上的节点发生变化，所以只需检查两端，复杂度O(compressDepth)
+inline void QuickList::updateCompression(){
+    if(compressDepth <= 0){
+        return;
+    }
+    size_t depth = compressDepth;
+    QuickListNode *forward = head;
+    QuickListNode *backward = tail;
+    for(size_t i=0; i<=depth && forward && backward; i++){
+        if(i < depth){
+            decompressNode(forward);
+            decompressNode(backward);
+        }
+        else if(nodeNumber > 2*depth){
+            compressNode(forward);
+            compressNode(backward);
+        }
+        forward = forward->next;
+        backward = backward->prev;
+    }
+}
+
+inline QuickListNode* QuickList::seek(size_t idx, size_t &offset) const{
+    //从离下标更近的一端开始，整个节点整个节点地跳过
+    if(idx < length/2){
+        QuickListNode *node = head;
+        while(node && idx >= node->count){
+            idx -= node->count;
+            node = node->next;
+        }
+        offset = idx;
+        return node;
+    }
+    size_t fromTail = length - 1 - idx;
+    QuickListNode *node = tail;
+    while(node && fromTail >= node->count){
+        fromTail -= node->count;
+        node = node->prev;
+    }
+    offset = node ? node->count - 1 - fromTail : 0;
+    return node;
+}
+
+inline bool QuickList::index(long idx, std::string &value){
+    if(idx < 0){
+        idx += length;
+    }
+    if(idx < 0 || idx >= (long)length){
+        return false;
+    }
+    size_t offset = 0;
+    QuickListNode *node = seek(idx, offset);
+    std::string scratch;
+    const std::string &raw = rawEntries(node, scratch);
+    size_t pos = 0;
+    uint32_t len;
+    for(size_t i=0; i<offset; i++){
+        memcpy(&len, raw.data() + pos, sizeof(uint32_t));
+        pos += len + QUICKLIST_ENTRY_OVERHEAD;
+    }
+    memcpy(&len, raw.data() + pos, sizeof(uint32_t));
+    value.assign(raw.data() + pos + sizeof(uint32_t), len);
+    return true;
+}
+
+inline std::vector<std::string> QuickList::range(long start, long end){
+    std::vector<std::string> result;
+    forEachInRange(start, end, [&result](const char *data, size_t size){
+        result.emplace_back(data, size);
+    });
+    return result;
+}
+
+inline void QuickList::forEachInRange(long start, long end, const std::function<void(const char *data, size_t size)> &func){
+    long len = length;
+    if(start < 0){
+        start += len;
+    }
+    if(end < 0){
+        end += len;
+    }
+    if(start < 0){
+        start = 0;
+    }
+    if(end >= len){
+        end = len - 1;
+    }
+    if(start > end || start >= len){
+        return;
+    }
+    size_t offset = 0;
+    QuickListNode *node = seek(start, offset);
+    long remain = end - start + 1;
+    std::string scratch;
+    while(node && remain > 0){
+        const std::string &raw = rawEntries(node, scratch);
+        size_t pos = 0;
+        uint32_t entryLen;
+        for(uint32_t i=0; i<node->count && remain > 0; i++){
+            memcpy(&entryLen, raw.data() + pos, sizeof(uint32_t));
+            if(i >= offset){
+                func(raw.data() + pos + sizeof(uint32_t), entryLen);
+                remain--;
+            }
+            pos += entryLen + QUICKLIST_ENTRY_OVERHEAD;
+        }
+        offset = 0;
+        node = node->next;
+    }
+}
+
+#endif
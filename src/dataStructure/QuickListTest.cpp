@@ -0,0 +1,90 @@
+#include "QuickList.h"
+#include <iostream>
+#include <deque>
+#include <random>
+#include <cassert>
+
+//随机的push/pop/index/range与std::deque对照，chunkSize取得很小，让元素跨越多个节点
+static void randomCompare(size_t chunkSize, int compressDepth){
+    QuickList list(chunkSize, compressDepth);
+    std::deque<std::string> expected;
+    std::mt19937 generator(chunkSize * 31 + compressDepth);
+    for(int i=0; i<20000; i++){
+        //push多于pop，列表会逐渐变长
+        int op = generator() % 7;
+        if(op == 6){
+            op = i % 2;
+        }
+        if(op <= 1){
+            //较长的重复内容让中间节点可以压缩
+            std::string value(generator() % 100, static_cast<char>('a' + i % 26));
+            value += std::to_string(i);
+            if(op == 0){
+                list.pushFront(value);
+                expected.push_front(value);
+            }
+            else{
+                list.pushBack(value);
+                expected.push_back(value);
+            }
+        }
+        else if(op == 2 || op == 3){
+            std::string value;
+            bool popped = op == 2 ? list.popFront(value) : list.popBack(value);
+            assert(popped == !expected.empty());
+            if(popped){
+                assert(value == (op == 2 ? expected.front() : expected.back()));
+                op == 2 ? expected.pop_front() : expected.pop_back();
+            }
+        }
+        else if(op == 4 && !expected.empty()){
+            long idx = static_cast<long>(generator() % (2 * expected.size())) - static_cast<long>(expected.size());
+            std::string value;
+            assert(list.index(idx, value));
+            assert(value == expected[idx < 0 ? idx + expected.size() : idx]);
+        }
+        else if(op == 5 && i % 50 == 0){
+            long start = static_cast<long>(generator() % (expected.size() + 2)) - 1;
+            long end = static_cast<long>(generator() % (expected.size() + 2)) - 1;
+            std::vector<std::string> range = list.range(start, end);
+            std::vector<std::string> visited;
+            list.forEachInRange(start, end, [&visited](const char *data, size_t size){
+                visited.emplace_back(data, size);
+            });
+            assert(range == visited);
+        }
+        assert(list.size() == expected.size());
+    }
+    std::vector<std::string> all = list.range(0, -1);
+    assert(all == std::vector<std::string>(expected.begin(), expected.end()));
+    std::cout<<"chunk="<<chunkSize<<" depth="<<compressDepth<<" size="<<list.size()<<" nodes="<<list.nodeSize()<<" bytes="<<list.bytes()<<std::endl;
+}
+
+int main(){
+    QuickList list(64);
+    for(int i=0; i<10; i++){
+        list.pushBack(std::to_string(i));
+    }
+    list.pushFront("head");
+    for(const std::string &item : list.range(0, -1)){
+        std::cout<<item<<" ";
+    }
+    std::cout<<std::endl;
+    std::string value;
+    list.index(-1, value);
+    std::cout<<value<<" "<<list.size()<<" "<<list.nodeSize()<<std::endl;
+    //越界的下标和空区间
+    assert(!list.index(11, value));
+    assert(!list.index(-12, value));
+    assert(list.range(5, 2).empty());
+    assert(list.range(-100, 0).size() == 1);
+    list.clear();
+    assert(list.size() == 0 && !list.popFront(value) && !list.popBack(value));
+
+    randomCompare(64, 0);
+    randomCompare(64, 1);
+    randomCompare(256, 2);
+    randomCompare(QUICKLIST_CHUNK_SIZE, 1);
+    std::cout<<"QuickList OK"<<std::endl;
+    return 0;
+}
@@ -0,0 +1,87 @@
+#ifndef REPLICATION_BACKLOG_H
+#define REPLICATION_BACKLOG_H
+
+#include <string>
+#include <vector>
+#include <cstring>
+#include <algorithm>
+
+#define REPL_BACKLOG_SIZE (1024*1024)   //复制积压缓冲区默认大小
+
+
+/*
+    复制积压缓冲区：保存最近写入复制流的capacity个字节
+    复制流中每个字节都有一个递增的偏移量，从节点断开重连后带着自己的偏移量来同步，
+    偏移量还在缓冲区范围内时只需要补发缺少的部分（部分重同步），否则需要全量同步
+    环形缓冲区，写入时覆盖最旧的数据，不会为每条命令分配内存
+*/
+class ReplicationBacklog{
+public:
+    explicit ReplicationBacklog(size_t capacity=REPL_BACKLOG_SIZE);
+
+    long long append(const std::string &data);  //追加数据，返回追加前的偏移量
+    bool read(long long offset, std::string &data) const; //读取从offset到末尾的数据，offset已被覆盖时返回false
+    void reset(long long offset);               //清空缓冲区，之后的数据从offset开始
+
+    long long offset() const { return endOffset; }              //下一个字节的偏移量
+    long long startOffset() const { return endOffset - length; } //缓冲区中最旧字节的偏移量
+
+private:
+    std::vector<char> buffer;
+    size_t writePos = 0;    //下一个字节在buffer中的位置
+    size_t length = 0;      //有效数据的长度
+    long long endOffset = 0;
+};
+
+
+inline ReplicationBacklog::ReplicationBacklog(size_t capacity) : buffer(capacity) {
+}
+
+inline long long ReplicationBacklog::append(const std::string &data){
+    long long start = endOffset;
+    size_t capacity = buffer.size();
+    const char *src = data.data();
+    size_t len = data.size();
+    endOffset += len;
+    //超过容量的部分只保留最后capacity个字节
+    if(len > capacity){
+        src += len - capacity;
+        len = capacity;
+    }
+    while(len > 0){
+        size_t n = std::min(len, capacity - writePos);
+        memcpy(buffer.data() + writePos, src, n);
+        writePos = (writePos + n) % capacity;
+        src += n;
+        len -= n;
+    }
+    length = std::min(capacity, length + data.size());
+    return start;
+}
+
+inline bool ReplicationBacklog::read(long long offset, std::string &data) const{
+    if(offset < startOffset() || offset > endOffset){
+        return false;
+    }
+    size_t len = endOffset - offset;
+    size_t capacity = buffer.size();
+    //writePos往前len个字节就是offset所在的位置
+    size_t pos = (writePos + capacity - len) % capacity;
+    data.clear();
+    data.reserve(len);
+    while(len > 0){
+        size_t n = std::min(len, capacity - pos);
+        data.append(buffer.data() + pos, n);
+        pos = (pos + n) % capacity;
+        len -= n;
+    }
+    return true;
+}
+
+inline void ReplicationBacklog::reset(long long offset){
+    writePos = 0;
+    length = 0;
+    endOffset = offset;
+}
+
+#endif
@@ -9,32 +9,118 @@
 #include <string>
 #include <mutex>
 #include <cstring>
+#include <functional>
+#include <algorithm>
+#include <cstdint>
 
 #define MAX_SKIP_LIST_LEVEL 32
 #define PROBABILITY_FACTOR 0.25
 #define DELIMITER ":"
 #define  SAVE_PATH "data_file"
 
+#if defined(__GNUC__)
+#define SKIPLIST_PREFETCH(addr) __builtin_prefetch(addr)
+#else
+#define SKIPLIST_PREFETCH(addr)
+#endif
+
+
+/*
+    键的定长前缀，比较时先比较前缀，前缀相同才比较完整的键
+    前缀必须保序：prefix(a)<prefix(b) 时一定有 a<b
+    默认没有前缀（总是0），每次都比较完整的键
+*/
+template <typename Key>
+struct SkipListKeyPrefix{
+    static uint64_t get(const Key &key){ return 0; }
+};
+
+//字符串取前8个字节按大端序拼成整数，不足8个字节补0，整数大小关系与字典序一致
+template <>
+struct SkipListKeyPrefix<std::string>{
+    static uint64_t get(const std::string &key){
+        uint64_t prefix = 0;
+        size_t len = std::min<size_t>(key.size(), 8);
+        for(size_t i=0; i<len; i++){
+            prefix |= static_cast<uint64_t>(static_cast<unsigned char>(key[i])) << (56 - 8*i);
+        }
+        return prefix;
+    }
+};
+
+
+template <typename Key, typename Value>
+struct SkipListNode;
+
+/*
+    前进指针，同时保存指向节点的键前缀
+    查找时用当前节点里保存的前缀就能判断要不要前进，不前进时不用访问后继节点，
+    只有前缀相同时才需要访问后继节点比较完整的键
+    除了前缀以外和shared_ptr用法相同，前缀在指针赋值时自动更新
+*/
+template <typename Key, typename Value>
+struct SkipListLink : std::shared_ptr<SkipListNode<Key,Value>>{
+    uint64_t prefix = 0;
+    SkipListLink(std::nullptr_t = nullptr){}
+    SkipListLink(const std::shared_ptr<SkipListNode<Key,Value>> &node) :
+        std::shared_ptr<SkipListNode<Key,Value>>(node), prefix(node ? node->prefix : 0){}
+};
 
 //跳表节点
 template <typename Key, typename Value>
 struct SkipListNode{
+    uint64_t prefix;    //键的前缀，见SkipListKeyPrefix
     Key key;
     Value value;
-    std::vector<std::shared_ptr<SkipListNode<Key,Value>>> forward;
+    std::vector<SkipListLink<Key,Value>> forward;
+    SkipListNode<Key,Value> *backward = nullptr;    //最底层的前一个节点，不持有所有权，用于逆序遍历
     SkipListNode(Key k, Value v, int maxLevel=MAX_SKIP_LIST_LEVEL) : 
-        key(k),value(v),forward(maxLevel, nullptr){}; 
+        prefix(SkipListKeyPrefix<Key>::get(k)),key(k),value(v),forward(maxLevel, nullptr){}; 
 }; 
 
 template <typename Key, typename Value>
 class SkipList{
 public:
+    /// @brief 双向迭代器，沿最底层移动
+    /// 迭代器本身不加锁，使用期间不能有其他线程修改跳表
+    class Iterator{
+    public:
+        Iterator(SkipList *list=nullptr, SkipListNode<Key,Value> *node=nullptr) : list(list), node(node){}
+        bool valid() const { return node != nullptr; }
+        const Key& key() const { return node->key; }
+        Value& value() const { return node->value; }
+        Iterator& operator++(){ node = node->forward[0].get(); return *this; }
+        //end()向前移动得到最后一个节点
+        Iterator& operator--(){ node = node ? node->backward : list->tail; return *this; }
+        bool operator==(const Iterator &other) const { return node == other.node; }
+        bool operator!=(const Iterator &other) const { return node != other.node; }
+    private:
+        SkipList *list;
+        SkipListNode<Key,Value> *node;
+    };
+
     SkipList();
     ~SkipList();
     bool addItem(const Key &key, const Value &value);   //增添节点
     bool modifyItem(const Key &key, const Value &value);    //修改节点
     std::shared_ptr<SkipListNode<Key,Value>> searchItem(const Key &key); //查找节点
+    std::vector<std::shared_ptr<SkipListNode<Key,Value>>> searchItems(const std::vector<Key> &keys); //批量查找节点
     bool deleteItem(const Key &key); //删除节点
+    //批量删除节点，detached不为空时摘下的节点放到detached中，由调用者决定在哪里释放
+    int deleteItems(const std::vector<Key> &keys, std::vector<std::shared_ptr<SkipListNode<Key,Value>>> *detached=nullptr);
+    std::vector<Key> scanKeys(const Key &key, int count, bool fromStart=false); //从key之后顺序读取最多count个键
+    void seekKeys(const Key &begin, const std::function<bool(const Key&)> &func); //从第一个不小于begin的键开始顺序访问
+    Iterator begin(){ return Iterator(this, head->forward[0].get()); }
+    Iterator end(){ return Iterator(this, nullptr); }
+    Iterator lowerBound(const Key &key);    //第一个不小于key的节点
+    Iterator upperBound(const Key &key);    //第一个大于key的节点
+    //从begin开始（includeBegin为false时不含begin）统计连续满足inRange的键个数
+    int countRange(const Key &begin, bool includeBegin, const std::function<bool(const Key&)> &inRange);
+    int countRange(const Key &begin, const Key &end); //统计[begin,end)内的键个数
+    //从begin开始删除连续满足inRange的一段键，每层只修改一次指针，整段一次摘除，detached的含义与deleteItems相同
+    int deleteRange(const Key &begin, bool includeBegin, const std::function<bool(const Key&)> &inRange,
+        std::vector<std::shared_ptr<SkipListNode<Key,Value>>> *detached=nullptr);
+    int deleteRange(const Key &begin, const Key &end); //删除[begin,end)内的键
     void printList();   //打印跳表
     // void dumpFile(std::string save_path); //保存跳表到文件中;
     // void loadFile(std::string load_path); //从文件中加载到跳表中
@@ -47,12 +133,27 @@ public:
 private:
     //随机生成需要插入节点的层数
     int randomLevel();
+    //查找每层最后一个小于key（inclusive为true时为不大于key）的节点，不加锁
+    SkipListNode<Key,Value>* findPredecessors(const Key &key, bool inclusive, std::vector<SkipListNode<Key,Value>*> &update);
+    //link指向的键是否小于key，prefix为key的前缀；inclusive为true时判断不大于
+    static bool keyBefore(const SkipListLink<Key,Value> &link, const Key &key, uint64_t prefix, bool inclusive=false){
+        if(link.prefix != prefix){
+            return link.prefix < prefix;
+        }
+        return inclusive ? !(key<link->key) : link->key<key;
+    }
+    //摘除节点，不加锁
+    void unlinkNode(SkipListNode<Key,Value> *node, std::vector<SkipListNode<Key,Value>*> &update);
     // bool parseString(const std::string &line, std::string &key, std::string &value);
     // bool isVaildString(const std::string &line);
 
 private:
     int currentLevel; //当前跳表的最大层数
     std::shared_ptr<SkipListNode<Key, Value>> head; //头节点
+    SkipListNode<Key, Value> *tail = nullptr; //尾节点
+    std::vector<SkipListNode<Key, Value>*> finger; //上一次查找的搜索路径
+    Key fingerKey;              //上一次查找的键
+    bool fingerValid = false;   //搜索路径是否可用
     std::mt19937 generator{std::random_device{}()}; //随机数生成器
     std::uniform_real_distribution<double> distribution; //随机数分布，限定随机数生成器生成的数字范围
     int elementNumber=0;
@@ -65,13 +166,21 @@ private:
 
 template <typename Key, typename Value>
 SkipList<Key,Value>::SkipList() : currentLevel(0), distribution(0,1) {
-    Key key;
-    Value value;
+    Key key{};
+    Value value{};
     head = std::make_shared<SkipListNode<Key, Value>>(key,value);
 }
 
 template <typename Key, typename Value>
 SkipList<Key, Value>::~SkipList(){
+    //逐个断开节点，避免长链递归析构
+    std::shared_ptr<SkipListNode<Key,Value>> node = head->forward[0];
+    head->forward.clear();
+    while(node){
+        std::shared_ptr<SkipListNode<Key,Value>> next = node->forward[0];
+        node->forward.clear();
+        node = next;
+    }
     if(readFile)
         readFile.close();
     if(writeFile)
@@ -99,16 +208,9 @@ int SkipList<Key, Value>::size(){
 template<typename Key, typename Value>
 bool SkipList<Key, Value>::addItem(const Key& key, const Value &value){
     mutex.lock();
-    auto currentNode = head;
-    //记录每层需要更新的节点
-    std::vector<std::shared_ptr<SkipListNode<Key, Value>>>update(MAX_SKIP_LIST_LEVEL,head);
     //寻找需要添加的节点位置，同时记录每层需要更新的节点
-    for(int lv=currentLevel-1; lv>=0; lv--){
-        while(currentNode->forward[lv] && currentNode->forward[lv]->key<key){
-            currentNode = currentNode->forward[lv];
-        }
-        update[lv]=currentNode;
-    }
+    std::vector<SkipListNode<Key,Value>*> update;
+    findPredecessors(key, false, update);
     // 生成新节点的层数
     int newLevel = randomLevel();
     // 更新当前跳表的最大层数
@@ -119,6 +221,13 @@ bool SkipList<Key, Value>::addItem(const Key& key, const Value &value){
         newNode->forward[i] = update[i]->forward[i];
         update[i]->forward[i] = newNode;
     }
+    newNode->backward = update[0] == head.get() ? nullptr : update[0];
+    if(newNode->forward[0]){
+        newNode->forward[0]->backward = newNode.get();
+    }
+    else{
+        tail = newNode.get();
+    }
     elementNumber++;
     mutex.unlock();
     return true;
@@ -127,25 +236,41 @@ bool SkipList<Key, Value>::addItem(const Key& key, const Value &value){
 template <typename Key, typename Value>
 std::shared_ptr<SkipListNode<Key,Value>> SkipList<Key,Value>::searchItem(const Key &key){
     mutex.lock();
-    auto currentNode = head;
-    if(!currentNode){
-        mutex.unlock();
-        return nullptr;
-    }
-    for(int i=currentLevel-1; i>=0; i++){
-        while(currentNode->forward[i] && currentNode->forward[i]->key<key){
-            currentNode = currentNode->forward[i];
-        }
-    }
-    if(currentNode->forward[0]->key==key){
+    std::vector<SkipListNode<Key,Value>*> update;
+    SkipListNode<Key,Value> *currentNode = findPredecessors(key, false, update);
+    if(currentNode->forward[0] && currentNode->forward[0]->key==key){
         //可以优化，不然先解锁后返回的是指针，怕指针内容被修改删除
+        std::shared_ptr<SkipListNode<Key,Value>> target = currentNode->forward[0];
         mutex.unlock();
-        return currentNode->forward[0];
+        return target;
     }
     mutex.unlock();
     return nullptr;
 }
 
+/// @brief 批量查找，按键排序后依次查找，每次查找都从上一个键的搜索路径继续，整批只相当于一次遍历
+/// @param keys 需要查找的键，不要求有序
+/// @return 与keys一一对应的节点，不存在的为nullptr
+template <typename Key, typename Value>
+std::vector<std::shared_ptr<SkipListNode<Key,Value>>> SkipList<Key,Value>::searchItems(const std::vector<Key> &keys){
+    std::vector<std::shared_ptr<SkipListNode<Key,Value>>> result(keys.size());
+    std::vector<size_t> order(keys.size());
+    for(size_t i=0; i<keys.size(); i++){
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&keys](size_t a, size_t b){ return keys[a]<keys[b]; });
+    std::vector<SkipListNode<Key,Value>*> update;
+    mutex.lock();
+    for(size_t index : order){
+        SkipListNode<Key,Value> *currentNode = findPredecessors(keys[index], false, update);
+        if(currentNode->forward[0] && currentNode->forward[0]->key==keys[index]){
+            result[index] = currentNode->forward[0];
+        }
+    }
+    mutex.unlock();
+    return result;
+}
+
 
 template<typename Key, typename Value>
 bool SkipList<Key, Value>::modifyItem(const Key &key, const Value &value){
@@ -164,35 +289,251 @@ bool SkipList<Key, Value>::modifyItem(const Key &key, const Value &value){
 template <typename Key, typename Value>
 bool SkipList<Key,Value>::deleteItem(const Key &key){
     mutex.lock();
-    std::shared_ptr<SkipListNode<Key,Value>> currentNode = head;
-    std::vector<std::shared_ptr<SkipListNode<Key,Value>>> update(MAX_SKIP_LIST_LEVEL,nullptr);
-    for(int i=currentLevel-1; i>=0; i--){
-        while(currentNode->forward[i] && currentNode->forward[i]->key<key){
-            currentNode = currentNode->forward[i];
-        }
-        update[i] = currentNode;
-    }
-    currentNode=currentNode->forward[0];
+    std::vector<SkipListNode<Key,Value>*> update;
+    std::shared_ptr<SkipListNode<Key,Value>> currentNode = findPredecessors(key, false, update)->forward[0];
     //找不到当前需要删除的键,如果找不到，则直接退出
     if(!currentNode || currentNode->key!=key){
         mutex.unlock();
         return false;
     }
-    
+    unlinkNode(currentNode.get(), update);
+    mutex.unlock();
+    return true;
+}
+
+/// @brief 批量删除，和searchItems一样按顺序共用一次遍历
+/// @param keys 需要删除的键，不要求有序，重复的键只删除一次
+/// @param detached 不为空时返回摘下的节点，节点不再指向跳表中的其他节点，可以在其他线程释放
+/// @return 删除的键个数
+template <typename Key, typename Value>
+int SkipList<Key,Value>::deleteItems(const std::vector<Key> &keys, std::vector<std::shared_ptr<SkipListNode<Key,Value>>> *detached){
+    std::vector<Key> sortedKeys(keys);
+    std::sort(sortedKeys.begin(), sortedKeys.end());
+    sortedKeys.erase(std::unique(sortedKeys.begin(), sortedKeys.end()), sortedKeys.end());
+    std::vector<SkipListNode<Key,Value>*> update;
+    int count = 0;
+    mutex.lock();
+    for(const Key &key : sortedKeys){
+        std::shared_ptr<SkipListNode<Key,Value>> currentNode = findPredecessors(key, false, update)->forward[0];
+        if(currentNode && currentNode->key==key){
+            unlinkNode(currentNode.get(), update);
+            count++;
+            if(detached){
+                currentNode->forward.clear();
+                currentNode->backward = nullptr;
+                detached->push_back(currentNode);
+            }
+        }
+    }
+    mutex.unlock();
+    return count;
+}
+
+/// @brief 把节点从各层摘除，调用者需要持有锁，update为该节点每层的前驱
+template <typename Key, typename Value>
+void SkipList<Key,Value>::unlinkNode(SkipListNode<Key,Value> *node, std::vector<SkipListNode<Key,Value>*> &update){
     for(int i=0; i<currentLevel; i++){
         //找到需要删除的键，删除它
-        if(update[i]->forward[i]!=currentNode){
+        if(update[i]->forward[i].get()!=node){
            break;
         }
-        update[i]->forward[i] = currentNode->forward[i];
+        update[i]->forward[i] = node->forward[i];
+    }
+    if(node->forward[0]){
+        node->forward[0]->backward = node->backward;
+    }
+    else{
+        tail = node->backward;
     }
-    currentNode.reset();
     while(currentLevel>0 && head->forward[currentLevel-1]==nullptr){
         currentLevel--;
     }
     elementNumber--;
+}
+
+
+/// @brief 从key之后(不含key)开始，沿最底层顺序读取最多count个键，每次调用只做有限的工作
+/// @param key 上一次读取到的最后一个键
+/// @param count 最多读取的键个数
+/// @param fromStart 为true时忽略key，从第一个键开始读取
+/// @return 按顺序排列的键
+template <typename Key, typename Value>
+std::vector<Key> SkipList<Key,Value>::scanKeys(const Key &key, int count, bool fromStart){
+    std::vector<Key> keys;
+    std::vector<SkipListNode<Key,Value>*> update;
+    size_t limit = count > 0 ? count : 0;
+    mutex.lock();
+    SkipListNode<Key,Value> *currentNode = fromStart ? head.get() : findPredecessors(key, true, update);
+    currentNode = currentNode->forward[0].get();
+    while(currentNode && keys.size()<limit){
+        keys.push_back(currentNode->key);
+        currentNode = currentNode->forward[0].get();
+    }
     mutex.unlock();
-    return true;
+    return keys;
+}
+
+/// @brief 定位到第一个不小于begin的键，然后沿最底层顺序访问，回调返回false时停止
+/// 用于前缀查询：定位到前缀开始的位置，遇到第一个不带前缀的键就停止
+/// @param begin 开始的键
+/// @param func 访问每个键的回调
+template <typename Key, typename Value>
+void SkipList<Key,Value>::seekKeys(const Key &begin, const std::function<bool(const Key&)> &func){
+    std::vector<SkipListNode<Key,Value>*> update;
+    mutex.lock();
+    SkipListNode<Key,Value> *currentNode = findPredecessors(begin, false, update)->forward[0].get();
+    while(currentNode && func(currentNode->key)){
+        currentNode = currentNode->forward[0].get();
+    }
+    mutex.unlock();
+}
+
+/// @brief 查找每层的前驱节点，调用者需要持有锁
+/// 严格小于的查找会缓存搜索路径（finger），下一次查找的键不小于上次的键时，
+/// 从底层往上找到第一层缓存前驱仍然有效的层，只从这一层往下继续查找，
+/// 顺序写入、按时间排序的键等相邻访问的代价接近O(1)
+/// @param key 查找的键
+/// @param inclusive 为false时查找小于key的节点，为true时查找不大于key的节点
+/// @param update 返回每层的前驱节点
+/// @return 最底层的前驱节点
+template <typename Key, typename Value>
+SkipListNode<Key,Value>* SkipList<Key,Value>::findPredecessors(const Key &key, bool inclusive, std::vector<SkipListNode<Key,Value>*> &update){
+    SkipListNode<Key,Value> *currentNode = head.get();
+    uint64_t prefix = SkipListKeyPrefix<Key>::get(key);
+    int startLevel = currentLevel;
+    if(!inclusive && fingerValid && !(key<fingerKey)){
+        //上次的前驱都小于key，某层前驱的后继不小于key时，这一层及以上的前驱仍然是key的前驱
+        int validLevel = 0;
+        while(validLevel < currentLevel && finger[validLevel]->forward[validLevel] &&
+            keyBefore(finger[validLevel]->forward[validLevel], key, prefix)){
+            validLevel++;
+        }
+        update = finger;
+        startLevel = validLevel;
+        if(validLevel < currentLevel){
+            currentNode = finger[validLevel];
+        }
+    }
+    else{
+        update.assign(MAX_SKIP_LIST_LEVEL, head.get());
+    }
+    for(int i=startLevel-1; i>=0; i--){
+        //缓存的前驱更靠后时直接从它开始
+        if(update[i] != head.get() && (currentNode == head.get() || currentNode->key<update[i]->key)){
+            currentNode = update[i];
+        }
+        while(currentNode->forward[i]){
+            const SkipListLink<Key,Value> &link = currentNode->forward[i];
+            //读到指针就开始预取后继节点，和前缀比较重叠
+            SKIPLIST_PREFETCH(link.get());
+            if(!keyBefore(link, key, prefix, inclusive)){
+                break;
+            }
+            currentNode = link.get();
+        }
+        //下一层的后继是下一次要比较的节点
+        if(i > 0){
+            SKIPLIST_PREFETCH(currentNode->forward[i-1].get());
+        }
+        update[i] = currentNode;
+    }
+    if(!inclusive){
+        finger = update;
+        fingerKey = key;
+        fingerValid = true;
+    }
+    return currentNode;
+}
+
+template <typename Key, typename Value>
+typename SkipList<Key,Value>::Iterator SkipList<Key,Value>::lowerBound(const Key &key){
+    std::vector<SkipListNode<Key,Value>*> update;
+    mutex.lock();
+    SkipListNode<Key,Value> *node = findPredecessors(key, false, update)->forward[0].get();
+    mutex.unlock();
+    return Iterator(this, node);
+}
+
+template <typename Key, typename Value>
+typename SkipList<Key,Value>::Iterator SkipList<Key,Value>::upperBound(const Key &key){
+    std::vector<SkipListNode<Key,Value>*> update;
+    mutex.lock();
+    SkipListNode<Key,Value> *node = findPredecessors(key, true, update)->forward[0].get();
+    mutex.unlock();
+    return Iterator(this, node);
+}
+
+template <typename Key, typename Value>
+int SkipList<Key,Value>::countRange(const Key &begin, bool includeBegin, const std::function<bool(const Key&)> &inRange){
+    std::vector<SkipListNode<Key,Value>*> update;
+    int count = 0;
+    mutex.lock();
+    SkipListNode<Key,Value> *node = findPredecessors(begin, !includeBegin, update)->forward[0].get();
+    while(node && inRange(node->key)){
+        count++;
+        node = node->forward[0].get();
+    }
+    mutex.unlock();
+    return count;
+}
+
+template <typename Key, typename Value>
+int SkipList<Key,Value>::countRange(const Key &begin, const Key &end){
+    return countRange(begin, true, [&end](const Key &key){ return key<end; });
+}
+
+/// @brief 删除连续的一段键
+/// 先找到起点在每层的前驱，然后每层从前驱往后跳过区间内的节点，把前驱直接接到区间后的第一个节点上，
+/// 每个被删除的节点在它所在的每一层只访问一次，复杂度O(log n + m)
+/// @return 删除的键个数
+template <typename Key, typename Value>
+int SkipList<Key,Value>::deleteRange(const Key &begin, bool includeBegin, const std::function<bool(const Key&)> &inRange,
+    std::vector<std::shared_ptr<SkipListNode<Key,Value>>> *detached){
+    std::vector<SkipListNode<Key,Value>*> update;
+    mutex.lock();
+    findPredecessors(begin, !includeBegin, update);
+    std::shared_ptr<SkipListNode<Key,Value>> first = update[0]->forward[0];
+    //被删除的节点可能在缓存的搜索路径上
+    fingerValid = false;
+    int count = 0;
+    for(int i=currentLevel-1; i>=0; i--){
+        std::shared_ptr<SkipListNode<Key,Value>> node = update[i]->forward[i];
+        while(node && inRange(node->key)){
+            if(i == 0){
+                count++;
+            }
+            node = node->forward[i];
+        }
+        update[i]->forward[i] = node;
+        if(i == 0){
+            if(node){
+                node->backward = update[0] == head.get() ? nullptr : update[0];
+            }
+            else{
+                tail = update[0] == head.get() ? nullptr : update[0];
+            }
+        }
+    }
+    while(currentLevel>0 && head->forward[currentLevel-1]==nullptr){
+        currentLevel--;
+    }
+    elementNumber -= count;
+    //摘下来的节点之间还互相持有，逐个断开，避免长链递归析构
+    for(int i=0; i<count && first; i++){
+        std::shared_ptr<SkipListNode<Key,Value>> next = first->forward[0];
+        first->forward.clear();
+        if(detached != nullptr){
+            detached->push_back(std::move(first));
+        }
+        first = next;
+    }
+    mutex.unlock();
+    return count;
+}
+
+template <typename Key, typename Value>
+int SkipList<Key,Value>::deleteRange(const Key &begin, const Key &end){
+    return deleteRange(begin, true, [&end](const Key &key){ return key<end; });
 }
 
 
@@ -12,5 +12,13 @@ int main(){
     sl.printList();
     std::cout<<sl.size()<<std::endl;
     std::cout<<sl.getCurrentLevel()<<std::endl;
+    //区间遍历和区间删除
+    for(auto it=sl.lowerBound("c"); it!=sl.end(); ++it){
+        std::cout<<it.key()<<DELIMITER<<it.value()<<" ";
+    }
+    std::cout<<std::endl;
+    std::cout<<sl.countRange("b","d")<<std::endl;
+    std::cout<<sl.deleteRange("b","d")<<std::endl;
+    sl.printList();
     return 0;
 }
\ No newline at end of file
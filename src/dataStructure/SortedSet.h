@@ -0,0 +1,374 @@
+#ifndef SORTED_SET_H
+#define SORTED_SET_H
+
+#include <string>
+#include <vector>
+#include <random>
+#include <cmath>
+#include <unordered_map>
+
+#define ZSKIPLIST_MAX_LEVEL 32
+#define ZSKIPLIST_PROBABILITY 0.25
+
+
+//有序集合跳表节点，每一层除了前进指针还记录跨度，用于计算排名
+struct ZSkipListNode{
+    struct Level{
+        ZSkipListNode *forward;
+        size_t span;    //到forward节点之间跨过的元素个数
+    };
+    std::string member;
+    double score;
+    ZSkipListNode *backward;    //后退指针，用于逆序遍历
+    std::vector<Level> level;
+    ZSkipListNode(const std::string &member, double score, int maxLevel) :
+        member(member), score(score), backward(nullptr), level(maxLevel, Level{nullptr, 0}){};
+};
+
+//分数区间，min/max是否为开区间
+struct ZRangeSpec{
+    double min;
+    double max;
+    bool minExclusive = false;
+    bool maxExclusive = false;
+    bool gteMin(double value) const { return minExclusive ? value > min : value >= min; }
+    bool lteMax(double value) const { return maxExclusive ? value < max : value <= max; }
+};
+
+/*
+    带排名的跳表，按 (score, member) 排序
+    每层记录跨度，查找过程中累加跨度即可得到排名，ZRANK和按下标取区间都是O(log n)
+    第0层有后退指针，支持从尾部逆序遍历
+*/
+class ZSkipList{
+public:
+    ZSkipList();
+    ~ZSkipList();
+    ZSkipList(const ZSkipList&) = delete;
+    ZSkipList& operator=(const ZSkipList&) = delete;
+
+    ZSkipListNode* insert(double score, const std::string &member);  //插入节点，调用者保证不重复
+    bool remove(double score, const std::string &member);            //删除节点
+    size_t getRank(double score, const std::string &member) const;   //获取排名，从1开始，不存在返回0
+    ZSkipListNode* getByRank(size_t rank) const;                     //按排名获取节点，从1开始
+    ZSkipListNode* firstInRange(const ZRangeSpec &range) const;      //分数区间内的第一个节点
+    ZSkipListNode* lastInRange(const ZRangeSpec &range) const;       //分数区间内的最后一个节点
+
+    ZSkipListNode* first() const { return header->level[0].forward; }
+    ZSkipListNode* last() const { return tail; }
+    size_t size() const { return length; }
+
+private:
+    static bool lessThan(const ZSkipListNode *node, double score, const std::string &member){
+        return node->score < score || (node->score == score && node->member < member);
+    }
+    int randomLevel();
+    bool isInRange(const ZRangeSpec &range) const;
+
+private:
+    ZSkipListNode *header;
+    ZSkipListNode *tail = nullptr;
+    size_t length = 0;
+    int level = 1;
+    std::mt19937 generator{std::random_device{}()};
+    std::uniform_real_distribution<double> distribution{0, 1};
+};
+
+
+inline ZSkipList::ZSkipList(){
+    header = new ZSkipListNode("", 0, ZSKIPLIST_MAX_LEVEL);
+}
+
+inline ZSkipList::~ZSkipList(){
+    ZSkipListNode *node = header;
+    while(node){
+        ZSkipListNode *next = node->level[0].forward;
+        delete node;
+        node = next;
+    }
+}
+
+inline int ZSkipList::randomLevel(){
+    int lv = 1;
+    while(distribution(generator) < ZSKIPLIST_PROBABILITY && lv < ZSKIPLIST_MAX_LEVEL){
+        ++lv;
+    }
+    return lv;
+}
+
+inline ZSkipListNode* ZSkipList::insert(double score, const std::string &member){
+    ZSkipListNode *update[ZSKIPLIST_MAX_LEVEL];
+    size_t rank[ZSKIPLIST_MAX_LEVEL];
+    ZSkipListNode *x = header;
+    //记录每层需要更新的节点，以及该节点的排名
+    for(int i=level-1; i>=0; i--){
+        rank[i] = i == level-1 ? 0 : rank[i+1];
+        while(x->level[i].forward && lessThan(x->level[i].forward, score, member)){
+            rank[i] += x->level[i].span;
+            x = x->level[i].forward;
+        }
+        update[i] = x;
+    }
+    int newLevel = randomLevel();
+    if(newLevel > level){
+        for(int i=level; i<newLevel; i++){
+            rank[i] = 0;
+            update[i] = header;
+            update[i]->level[i].span = length;
+        }
+        level = newLevel;
+    }
+    x = new ZSkipListNode(member, score, newLevel);
+    for(int i=0; i<newLevel; i++){
+        x->level[i].forward = update[i]->level[i].forward;
+        update[i]->level[i].forward = x;
+        //rank[0]-rank[i] 是update[i]到新节点前一个节点之间的距离
+        x->level[i].span = update[i]->level[i].span - (rank[0] - rank[i]);
+        update[i]->level[i].span = (rank[0] - rank[i]) + 1;
+    }
+    //更高的层没有指向新节点，但跨度要加一
+    for(int i=newLevel; i<level; i++){
+        update[i]->level[i].span++;
+    }
+    x->backward = update[0] == header ? nullptr : update[0];
+    if(x->level[0].forward){
+        x->level[0].forward->backward = x;
+    }
+    else{
+        tail = x;
+    }
+    length++;
+    return x;
+}
+
+inline bool ZSkipList::remove(double score, const std::string &member){
+    ZSkipListNode *update[ZSKIPLIST_MAX_LEVEL];
+    ZSkipListNode *x = header;
+    for(int i=level-1; i>=0; i--){
+        while(x->level[i].forward && lessThan(x->level[i].forward, score, member)){
+            x = x->level[i].forward;
+        }
+        update[i] = x;
+    }
+    x = x->level[0].forward;
+    if(!x || x->score != score || x->member != member){
+        return false;
+    }
+    for(int i=0; i<level; i++){
+        if(update[i]->level[i].forward == x){
+            update[i]->level[i].span += x->level[i].span - 1;
+            update[i]->level[i].forward = x->level[i].forward;
+        }
+        else{
+            update[i]->level[i].span -= 1;
+        }
+    }
+    if(x->level[0].forward){
+        x->level[0].forward->backward = x->backward;
+    }
+    else{
+        tail = x->backward;
+    }
+    while(level > 1 && header->level[level-1].forward == nullptr){
+        level--;
+    }
+    length--;
+    delete x;
+    return true;
+}
+
+inline size_t ZSkipList::getRank(double score, const std::string &member) const{
+    size_t rank = 0;
+    ZSkipListNode *x = header;
+    for(int i=level-1; i>=0; i--){
+        while(x->level[i].forward &&
+            (x->level[i].forward->score < score ||
+            (x->level[i].forward->score == score && x->level[i].forward->member <= member))){
+            rank += x->level[i].span;
+            x = x->level[i].forward;
+        }
+        if(x != header && x->score == score && x->member == member){
+            return rank;
+        }
+    }
+    return 0;
+}
+
+inline ZSkipListNode* ZSkipList::getByRank(size_t rank) const{
+    size_t traversed = 0;
+    ZSkipListNode *x = header;
+    for(int i=level-1; i>=0; i--){
+        while(x->level[i].forward && traversed + x->level[i].span <= rank){
+            traversed += x->level[i].span;
+            x = x->level[i].forward;
+        }
+        if(traversed == rank){
+            return x == header ? nullptr : x;
+        }
+    }
+    return nullptr;
+}
+
+inline bool ZSkipList::isInRange(const ZRangeSpec &range) const{
+    if(range.min > range.max || (range.min == range.max && (range.minExclusive || range.maxExclusive))){
+        return false;
+    }
+    if(tail == nullptr || !range.gteMin(tail->score)){
+        return false;
+    }
+    return range.lteMax(header->level[0].forward->score);
+}
+
+inline ZSkipListNode* ZSkipList::firstInRange(const ZRangeSpec &range) const{
+    if(!isInRange(range)){
+        return nullptr;
+    }
+    ZSkipListNode *x = header;
+    for(int i=level-1; i>=0; i--){
+        while(x->level[i].forward && !range.gteMin(x->level[i].forward->score)){
+            x = x->level[i].forward;
+        }
+    }
+    x = x->level[0].forward;
+    return x && range.lteMax(x->score) ? x : nullptr;
+}
+
+inline ZSkipListNode* ZSkipList::lastInRange(const ZRangeSpec &range) const{
+    if(!isInRange(range)){
+        return nullptr;
+    }
+    ZSkipListNode *x = header;
+    for(int i=level-1; i>=0; i--){
+        while(x->level[i].forward && range.lteMax(x->level[i].forward->score)){
+            x = x->level[i].forward;
+        }
+    }
+    return x != header && range.gteMin(x->score) ? x : nullptr;
+}
+
+
+/*
+    有序集合：带排名的跳表 + member到score的哈希表
+    ZSCORE通过哈希表O(1)得到，排名和区间查询走跳表
+*/
+class SortedSet{
+public:
+    typedef std::vector<std::pair<std::string, double>> Items;
+
+    bool add(const std::string &member, double score);                  //添加或更新分数，新增返回true
+    bool incrBy(const std::string &member, double increment, double &newScore); //分数加上增量，结果为NaN时返回false
+    bool remove(const std::string &member);
+    bool score(const std::string &member, double &score) const;
+    long rank(const std::string &member, bool reverse=false) const;     //排名从0开始，不存在返回-1
+    Items rangeByIndex(long start, long end, bool reverse=false) const; //按排名取区间，支持负数下标
+    Items rangeByScore(const ZRangeSpec &range, long offset=0, long count=-1, bool reverse=false) const;
+    size_t size() const { return dict.size(); }
+
+private:
+    ZSkipList skipList;
+    std::unordered_map<std::string, double> dict;
+};
+
+
+inline bool SortedSet::add(const std::string &member, double score){
+    auto it = dict.find(member);
+    if(it == dict.end()){
+        skipList.insert(score, member);
+        dict.emplace(member, score);
+        return true;
+    }
+    if(it->second != score){
+        skipList.remove(it->second, member);
+        skipList.insert(score, member);
+        it->second = score;
+    }
+    return false;
+}
+
+inline bool SortedSet::incrBy(const std::string &member, double increment, double &newScore){
+    auto it = dict.find(member);
+    newScore = (it == dict.end() ? 0 : it->second) + increment;
+    if(std::isnan(newScore)){
+        return false;
+    }
+    add(member, newScore);
+    return true;
+}
+
+inline bool SortedSet::remove(const std::string &member){
+    auto it = dict.find(member);
+    if(it == dict.end()){
+        return false;
+    }
+    skipList.remove(it->second, member);
+    dict.erase(it);
+    return true;
+}
+
+inline bool SortedSet::score(const std::string &member, double &score) const{
+    auto it = dict.find(member);
+    if(it == dict.end()){
+        return false;
+    }
+    score = it->second;
+    return true;
+}
+
+inline long SortedSet::rank(const std::string &member, bool reverse) const{
+    auto it = dict.find(member);
+    if(it == dict.end()){
+        return -1;
+    }
+    long r = skipList.getRank(it->second, member);
+    return reverse ? skipList.size() - r : r - 1;
+}
+
+inline SortedSet::Items SortedSet::rangeByIndex(long start, long end, bool reverse) const{
+    Items items;
+    long len = skipList.size();
+    if(start < 0){
+        start += len;
+    }
+    if(end < 0){
+        end += len;
+    }
+    if(start < 0){
+        start = 0;
+    }
+    if(end >= len){
+        end = len - 1;
+    }
+    if(start > end || start >= len){
+        return items;
+    }
+    items.reserve(end - start + 1);
+    //先O(log n)定位到起始排名，再沿第0层顺序或逆序遍历
+    ZSkipListNode *node = skipList.getByRank(reverse ? len - start : start + 1);
+    for(long i=start; i<=end && node; i++){
+        items.emplace_back(node->member, node->score);
+        node = reverse ? node->backward : node->level[0].forward;
+    }
+    return items;
+}
+
+inline SortedSet::Items SortedSet::rangeByScore(const ZRangeSpec &range, long offset, long count, bool reverse) const{
+    Items items;
+    ZSkipListNode *node = reverse ? skipList.lastInRange(range) : skipList.firstInRange(range);
+    while(node && offset > 0){
+        node = reverse ? node->backward : node->level[0].forward;
+        offset--;
+    }
+    while(node && count != 0){
+        if(reverse ? !range.gteMin(node->score) : !range.lteMax(node->score)){
+            break;
+        }
+        items.emplace_back(node->member, node->score);
+        node = reverse ? node->backward : node->level[0].forward;
+        if(count > 0){
+            count--;
+        }
+    }
+    return items;
+}
+
+#endif
@@ -0,0 +1,126 @@
+#include "SortedSet.h"
+#include <iostream>
+#include <set>
+#include <map>
+#include <cmath>
+#include <algorithm>
+#include <random>
+#include <cassert>
+
+typedef std::set<std::pair<double, std::string>> Reference;
+
+//按排名区间从参照集合中取出成员，下标的处理与ZRANGE相同
+static SortedSet::Items referenceRange(const Reference &reference, long start, long end, bool reverse){
+    SortedSet::Items items;
+    std::vector<std::pair<double, std::string>> ordered(reference.begin(), reference.end());
+    if(reverse){
+        std::reverse(ordered.begin(), ordered.end());
+    }
+    long len = ordered.size();
+    start = start < 0 ? std::max(start + len, 0L) : start;
+    end = end < 0 ? end + len : std::min(end, len - 1);
+    for(long i=start; i<=end; i++){
+        items.emplace_back(ordered[i].second, ordered[i].first);
+    }
+    return items;
+}
+
+//随机的add/incrBy/remove与std::set对照，检查排名和两种区间查询
+static void randomCompare(unsigned seed){
+    SortedSet zset;
+    Reference reference;
+    std::map<std::string, double> scores;
+    std::mt19937 generator(seed);
+    for(int i=0; i<20000; i++){
+        std::string member = "m" + std::to_string(generator() % 500);
+        //分数取值范围很小，大量成员同分，按成员排序
+        double score = static_cast<int>(generator() % 50) - 25;
+        int op = generator() % 5;
+        auto it = scores.find(member);
+        if(op <= 1){
+            assert(zset.add(member, score) == (it == scores.end()));
+            if(it != scores.end()){
+                reference.erase({it->second, member});
+            }
+            reference.insert({score, member});
+            scores[member] = score;
+        }
+        else if(op == 2){
+            double newScore = 0;
+            assert(zset.incrBy(member, 0.5, newScore));
+            assert(newScore == (it == scores.end() ? 0 : it->second) + 0.5);
+            if(it != scores.end()){
+                reference.erase({it->second, member});
+            }
+            reference.insert({newScore, member});
+            scores[member] = newScore;
+        }
+        else if(op == 3){
+            assert(zset.remove(member) == (it != scores.end()));
+            if(it != scores.end()){
+                reference.erase({it->second, member});
+                scores.erase(it);
+            }
+        }
+        else if(it != scores.end()){
+            double found = 0;
+            assert(zset.score(member, found) && found == it->second);
+            long rank = std::distance(reference.begin(), reference.find({it->second, member}));
+            assert(zset.rank(member) == rank);
+            assert(zset.rank(member, true) == static_cast<long>(reference.size()) - 1 - rank);
+        }
+        assert(zset.size() == reference.size());
+        if(i % 200 == 0){
+            long len = reference.size();
+            long start = static_cast<long>(generator() % (2 * len + 2)) - len - 1;
+            long end = static_cast<long>(generator() % (2 * len + 2)) - len - 1;
+            assert(zset.rangeByIndex(start, end) == referenceRange(reference, start, end, false));
+            assert(zset.rangeByIndex(start, end, true) == referenceRange(reference, start, end, true));
+
+            ZRangeSpec range;
+            range.min = static_cast<int>(generator() % 60) - 30;
+            range.max = range.min + generator() % 20;
+            range.minExclusive = generator() % 2;
+            range.maxExclusive = generator() % 2;
+            long offset = generator() % 5;
+            long count = static_cast<long>(generator() % 20) - 1;
+            SortedSet::Items expected;
+            long skipped = 0;
+            for(const auto &item : reference){
+                if(range.gteMin(item.first) && range.lteMax(item.first) && skipped++ >= offset
+                    && (count < 0 || static_cast<long>(expected.size()) < count)){
+                    expected.emplace_back(item.second, item.first);
+                }
+            }
+            assert(zset.rangeByScore(range, offset, count) == expected);
+        }
+    }
+    std::cout<<"seed="<<seed<<" size="<<zset.size()<<std::endl;
+}
+
+int main(){
+    SortedSet zset;
+    zset.add("a", 3);
+    zset.add("b", 1);
+    zset.add("c", 2);
+    for(const auto &item : zset.rangeByIndex(0, -1)){
+        std::cout<<item.first<<":"<<item.second<<" ";
+    }
+    std::cout<<std::endl;
+    std::cout<<zset.rank("a")<<" "<<zset.rank("a", true)<<std::endl;
+    //更新分数后重新排序，NaN不写入
+    assert(!zset.add("b", 5));
+    assert(zset.rank("b") == 2);
+    double score = 0;
+    assert(zset.incrBy("c", 10, score) && score == 12);
+    zset.add("inf", INFINITY);
+    assert(!zset.incrBy("inf", -INFINITY, score));
+    assert(zset.score("inf", score) && std::isinf(score));
+    assert(zset.rank("missing") == -1);
+    assert(zset.rangeByIndex(5, 10).empty());
+
+    randomCompare(1);
+    randomCompare(2);
+    std::cout<<"SortedSet OK"<<std::endl;
+    return 0;
+}
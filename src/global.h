@@ -2,11 +2,29 @@
 #define GLOBAL
 #include<iostream>
 #include<unordered_map>
+#include<unordered_set>
 #include<sstream>
+const std::string WRONG_TYPE_MESSAGE = "(error) WRONGTYPE Operation against a key holding the wrong kind of value";
+const std::string NIL_MESSAGE = "(nil)";
+const std::string EMPTY_LIST_MESSAGE = "(empty list or set)";
+const int SCAN_DEFAULT_COUNT = 10; //SCAN每次默认访问的键个数
+const int DATABASE_COUNT = 16; //SELECT可以选择的数据库个数，内存中只保存当前数据库，其他的在文件中
+const int LIST_COMPRESS_DEPTH = 1; //列表两端各保留几个不压缩的节点，中间的节点压缩保存，0表示不压缩
+const std::string DEFAULT_OUTPUT_DIR = "."; //SLOWLOG EXPORT等命令写出的文件所在的目录，启动时可以指定
+
+/// @brief 客户端给出的文件名是否可以放在输出目录下，只接受不带路径的文件名，不能借此写到目录以外
+inline bool isBareFileName(const std::string &name){
+    return !name.empty() && name != "." && name != ".." && name.find('/') == std::string::npos && name.find('\0') == std::string::npos;
+}
+
 enum SET_MODEL{ //set命令的模式
     NONE,NX,XX
 };
 
+enum VALUE_TYPE{ //键对应的值类型
+    TYPE_NONE,TYPE_STRING,TYPE_LIST,TYPE_HASH,TYPE_ZSET,TYPE_HLL,TYPE_BLOOM,TYPE_CUCKOO
+};
+
 enum Command{ //命令枚举
     SET,
     SETNX,
@@ -37,6 +55,54 @@ enum Command{ //命令枚举
     HDEL,
     HKEYS,
     HVALS,
+    HGETALL,
+    HMGET,
+    HINCRBY,
+    HLEN,
+    ZADD,
+    ZREM,
+    ZSCORE,
+    ZINCRBY,
+    ZCARD,
+    ZRANK,
+    ZREVRANK,
+    ZRANGE,
+    ZREVRANGE,
+    ZRANGEBYSCORE,
+    SCAN,
+    HSCAN,
+    KEYRANGE,
+    KEYCOUNT,
+    DELRANGE,
+    DELPREFIX,
+    UNLINK,
+    FLUSHDB,
+    FLUSHALL,
+    LMOVE,
+    BLPOP,
+    BRPOP,
+    BLMOVE,
+    SETBIT,
+    GETBIT,
+    BITCOUNT,
+    BITPOS,
+    BITOP,
+    PFADD,
+    PFCOUNT,
+    PFMERGE,
+    RESTORE,
+    BF_RESERVE,
+    BF_ADD,
+    BF_MADD,
+    BF_EXISTS,
+    BF_MEXISTS,
+    CF_RESERVE,
+    CF_ADD,
+    CF_ADDNX,
+    CF_EXISTS,
+    CF_DEL,
+    FCALL,
+    FCALL_RO,
     INVALID_COMMAND
 };
 
@@ -69,7 +135,65 @@ static std::unordered_map<std::string,enum Command>commandMaps={ //命令映射
     {"hget",HGET},
     {"hdel",HDEL},
     {"hkeys",HKEYS},
-    {"hvals",HVALS}
+    {"hvals",HVALS},
+    {"hgetall",HGETALL},
+    {"hmget",HMGET},
+    {"hincrby",HINCRBY},
+    {"hlen",HLEN},
+    {"zadd",ZADD},
+    {"zrem",ZREM},
+    {"zscore",ZSCORE},
+    {"zincrby",ZINCRBY},
+    {"zcard",ZCARD},
+    {"zrank",ZRANK},
+    {"zrevrank",ZREVRANK},
+    {"zrange",ZRANGE},
+    {"zrevrange",ZREVRANGE},
+    {"zrangebyscore",ZRANGEBYSCORE},
+    {"scan",SCAN},
+    {"hscan",HSCAN},
+    {"keyrange",KEYRANGE},
+    {"keycount",KEYCOUNT},
+    {"delrange",DELRANGE},
+    {"delprefix",DELPREFIX},
+    {"unlink",UNLINK},
+    {"flushdb",FLUSHDB},
+    {"flushall",FLUSHALL},
+    {"lmove",LMOVE},
+    {"blpop",BLPOP},
+    {"brpop",BRPOP},
+    {"blmove",BLMOVE},
+    {"setbit",SETBIT},
+    {"getbit",GETBIT},
+    {"bitcount",BITCOUNT},
+    {"bitpos",BITPOS},
+    {"bitop",BITOP},
+    {"pfadd",PFADD},
+    {"pfcount",PFCOUNT},
+    {"pfmerge",PFMERGE},
+    {"restore",RESTORE},
+    {"bf.reserve",BF_RESERVE},
+    {"bf.add",BF_ADD},
+    {"bf.madd",BF_MADD},
+    {"bf.exists",BF_EXISTS},
+    {"bf.mexists",BF_MEXISTS},
+    {"cf.reserve",CF_RESERVE},
+    {"cf.add",CF_ADD},
+    {"cf.addnx",CF_ADDNX},
+    {"cf.exists",CF_EXISTS},
+    {"cf.del",CF_DEL},
+    {"fcall",FCALL},
+    {"fcall_ro",FCALL_RO}
+};
+
+static std::unordered_set<Command> writeCommands={ //会修改数据的命令，主节点执行后传播给从节点，从节点拒绝客户端执行
+    SET,SETNX,SETEX,SELECT,DEL,RENAME,INCR,INCRBY,INCRBYFLOAT,DECR,DECRBY,MSET,APPEND,SETBIT,BITOP,
+    LPUSH,RPUSH,LPOP,RPOP,LMOVE,BLPOP,BRPOP,BLMOVE,
+    HSET,HDEL,HINCRBY,
+    ZADD,ZREM,ZINCRBY,
+    PFADD,PFMERGE,RESTORE,
+    BF_RESERVE,BF_ADD,BF_MADD,CF_RESERVE,CF_ADD,CF_ADDNX,CF_DEL,FCALL,
+    DELRANGE,DELPREFIX,UNLINK,FLUSHDB,FLUSHALL
 };
 
 
@@ -0,0 +1,68 @@
+/*
+    服务端入口
+    编译（在src目录下）：
+        g++ -std=c++20 -O2 -pthread server/Main.cpp $(ls *.cpp) -lzmq -o redis-server
+    用法：
+        ./redis-server [--port 5555] [--logo ./logo] [--hash-max-packed-entries N] [--hash-max-packed-value N] [--dir .]
+    一个节点占用以下端口，同一台机器上的多个节点的端口至少相隔4，并且不能和其他节点的集群总线端口重叠：
+        P           客户端请求（buttonrpc，函数名redis_command）
+        P+1         复制的同步端口，从节点在这里psync
+        P+2         复制流，主节点在这里广播写命令
+        P+3         SUBSCRIBE/PSUBSCRIBE的订阅端口
+        P+10000     集群总线，迁移槽时节点之间发送数据
+    --dir 指定SLOWLOG EXPORT和CAPTURE START写出文件的目录，客户端只能给出这个目录下的文件名
+*/
+#include <iostream>
+#include <string>
+#include <cstring>
+#include "../RedisServer.h"
+
+static void usage(const char *name){
+    std::cout<<"usage: "<<name<<" [--port 5555] [--logo ./logo] [--hash-max-packed-entries N] [--hash-max-packed-value N] [--dir .]"<<std::endl;
+}
+
+int main(int argc, char *argv[]){
+    int port = DEFAULT_SERVER_PORT;
+    std::string logo = MY_PROJECT_DIR_LOGO;
+    size_t hashMaxPackedEntries = HASH_MAX_PACKED_ENTRIES;
+    size_t hashMaxPackedValue = HASH_MAX_PACKED_VALUE;
+    std::string dir = DEFAULT_OUTPUT_DIR;
+    for(int i=1; i<argc; i++){
+        bool hasValue = i + 1 < argc;
+        try{
+            if(std::strcmp(argv[i], "--port") == 0 && hasValue){
+                port = std::stoi(argv[++i]);
+            }
+            else if(std::strcmp(argv[i], "--logo") == 0 && hasValue){
+                logo = argv[++i];
+            }
+            else if(std::strcmp(argv[i], "--hash-max-packed-entries") == 0 && hasValue){
+                hashMaxPackedEntries = std::stoul(argv[++i]);
+            }
+            else if(std::strcmp(argv[i], "--hash-max-packed-value") == 0 && hasValue){
+                hashMaxPackedValue = std::stoul(argv[++i]);
+            }
+            else if(std::strcmp(argv[i], "--dir") == 0 && hasValue){
+                dir = argv[++i];
+            }
+            else{
+                usage(argv[0]);
+                return 1;
+            }
+        }
+        catch(const std::exception &e){
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    //集群总线端口是P+10000，P再大就超出端口范围
+    if(port <= 0 || port + CLUSTER_BUS_PORT_OFFSET > 65535){
+        std::cout<<"invalid port "<<port<<std::endl;
+        return 1;
+    }
+    CommandParser::getRedisHelper()->setHashPacking(hashMaxPackedEntries, hashMaxPackedValue);
+    SlowLog::getInstance().setDirectory(dir);
+    Capture::getInstance().setDirectory(dir);
+    RedisServer::getInstance(port, logo)->start();
+    return 0;
+}
@@ -0,0 +1,206 @@
+/*
+    多进程测试：启动几个redis-server进程，检查全量同步、部分重同步和槽迁移
+    编译（在src目录下，先按Main.cpp中的说明编译出redis-server）：
+        g++ -std=c++20 -O2 -pthread server/MultiNodeTest.cpp -lzmq -o multinode_test
+    用法：
+        ./multinode_test [./redis-server] [起始端口7000]
+    每个节点的端口相隔10，占用 P..P+3 和 P+10000，见Main.cpp
+*/
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <chrono>
+#include <cstdlib>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "../RPC/ClusterClient.hpp"
+
+#define NODE_PORT_STEP 10       //相邻两个节点的端口间隔
+#define WAIT_TIMEOUT_MS 20000   //等待复制或迁移完成的最长时间
+#define TEST_KEYS 2000
+
+static std::vector<pid_t> children;
+
+static void killChildren(){
+    for(pid_t pid : children){
+        kill(pid, SIGKILL);
+        waitpid(pid, nullptr, 0);
+    }
+    children.clear();
+}
+
+static void fail(const std::string &message){
+    std::cout<<"FAILED: "<<message<<std::endl;
+    killChildren();
+    exit(1);
+}
+
+/// @brief 启动一个节点，标准输出丢弃
+struct Node{
+    int port;
+    pid_t pid;
+    std::unique_ptr<buttonrpc> client;
+
+    Node(const std::string &binary, int port) : port(port) {
+        pid = fork();
+        if(pid == 0){
+            int devNull = open("/dev/null", O_WRONLY);
+            dup2(devNull, STDOUT_FILENO);
+            std::string portArg = std::to_string(port);
+            execl(binary.c_str(), binary.c_str(), "--port", portArg.c_str(), static_cast<char*>(nullptr));
+            _exit(127);
+        }
+        children.push_back(pid);
+        client.reset(new buttonrpc());
+        client->as_client("127.0.0.1", port);
+    }
+
+    std::string address() const { return "127.0.0.1:" + std::to_string(port); }
+
+    std::string call(const std::string &commandLine){
+        return client->call<std::string>(REDIS_COMMAND_RPC, commandLine).val();
+    }
+
+    /// @brief INFO中某一项的值，没有时返回空字符串
+    std::string infoField(const std::string &section, const std::string &field){
+        std::string info = call("info " + section);
+        size_t pos = info.find(field + ":");
+        if(pos == std::string::npos){
+            return "";
+        }
+        size_t begin = pos + field.size() + 1;
+        return info.substr(begin, info.find_first_of("\r\n", begin) - begin);
+    }
+};
+
+/// @brief 每隔一段时间检查一次条件，超时后失败
+static void waitFor(const std::string &what, const std::function<bool()> &condition){
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(WAIT_TIMEOUT_MS);
+    while(!condition()){
+        if(std::chrono::steady_clock::now() > deadline){
+            fail("timed out waiting for " + what);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+}
+
+static void expect(bool condition, const std::string &message){
+    if(!condition){
+        fail(message);
+    }
+}
+
+static std::string quoted(const std::string &value){
+    return "\"" + value + "\"";
+}
+
+/// @brief 从节点第一次连接时全量同步；暂停从节点期间主节点写入的数据通过部分重同步补上
+static void replication(Node &master, Node &replica){
+    for(int i=0; i<TEST_KEYS; i++){
+        master.call("set key:" + std::to_string(i) + " v" + std::to_string(i));
+    }
+    master.call("rpush list a b c");
+    expect(replica.call("replicaof 127.0.0.1 " + std::to_string(master.port)) == "OK", "replicaof");
+    waitFor("full sync", [&replica](){ return replica.infoField("replication", "master_link_status") == "up"; });
+    expect(master.infoField("replication", "sync_full") == "1", "one full sync");
+    expect(replica.call("get key:" + std::to_string(TEST_KEYS-1)) == quoted("v" + std::to_string(TEST_KEYS-1)), "snapshot data");
+    expect(replica.call("lrange list 0 -1") == master.call("lrange list 0 -1"), "snapshot list");
+    expect(replica.call("set key:0 x").find("READONLY") != std::string::npos, "replica is read only");
+
+    //复制流中的写命令
+    master.call("set streamed 1");
+    waitFor("streamed write", [&replica](){ return replica.call("get streamed") == quoted("1"); });
+
+    //暂停从节点，主节点写入的命令超过PUB套接字的缓冲后被丢弃，从节点恢复后发现偏移量不连续，从积压缓冲区补上
+    kill(replica.pid, SIGSTOP);
+    for(int i=0; i<TEST_KEYS*5; i++){
+        master.call("set paused:" + std::to_string(i) + " " + std::to_string(i));
+    }
+    kill(replica.pid, SIGCONT);
+    std::string last = "get paused:" + std::to_string(TEST_KEYS*5-1);
+    waitFor("partial resync", [&](){ return replica.call(last) == master.call(last); });
+    for(int i=0; i<TEST_KEYS*5; i+=97){
+        std::string get = "get paused:" + std::to_string(i);
+        expect(replica.call(get) == master.call(get), get);
+    }
+    expect(master.infoField("replication", "sync_full") == "1", "no second full sync");
+    expect(std::stoul(master.infoField("replication", "sync_partial_ok")) >= 1, "partial resync");
+    std::cout<<"replication OK, sync_partial_ok="<<master.infoField("replication", "sync_partial_ok")<<std::endl;
+
+    //重新全量同步，快照分批生成期间的写入不能丢失，也不能执行两次
+    expect(replica.call("replicaof no one") == "OK", "replicaof no one");
+    expect(replica.call("replicaof 127.0.0.1 " + std::to_string(master.port)) == "OK", "replicaof again");
+    for(int i=0; i<TEST_KEYS/4; i++){
+        master.call("incr counter");
+        master.call("rpush during " + std::to_string(i));
+        master.call("set key:" + std::to_string(i * 7 % TEST_KEYS) + " w" + std::to_string(i));
+    }
+    waitFor("writes during full sync", [&](){
+        return replica.infoField("replication", "master_link_status") == "up" &&
+            replica.call("get counter") == master.call("get counter") &&
+            replica.call("lrange during 0 -1") == master.call("lrange during 0 -1");
+    });
+    for(int i=0; i<TEST_KEYS; i+=13){
+        std::string get = "get key:" + std::to_string(i);
+        expect(replica.call(get) == master.call(get), get);
+    }
+    expect(master.infoField("replication", "sync_full") == "2", "second full sync");
+    std::cout<<"full sync with concurrent writes OK"<<std::endl;
+}
+
+/// @brief 把一个槽从source迁移到target，迁移期间通过集群客户端继续读写该槽的键
+static void slotMigration(Node &source, Node &target){
+    for(Node *node : {&source, &target}){
+        expect(node->call("cluster addslotsrange 0 16383 " + source.address()) == "OK", "addslotsrange");
+    }
+    std::string slot = source.call("cluster keyslot {user}");
+    slot = slot.substr(slot.find(' ') + 1);
+    for(int i=0; i<TEST_KEYS; i++){
+        source.call("set {user}:" + std::to_string(i) + " " + std::to_string(i));
+    }
+    source.call("set other 1");
+    expect(target.call("get {user}:0").find("MOVED " + slot + " " + source.address()) != std::string::npos, "moved before migration");
+
+    expect(target.call("cluster setslot " + slot + " importing " + source.address()) == "OK", "importing");
+    expect(source.call("cluster setslot " + slot + " migrating " + target.address()) == "OK", "migrating");
+    expect(source.call("cluster migrate " + slot) == "OK", "migrate");
+
+    //迁移期间的读写跟随ASK/MOVED
+    ClusterClient client("127.0.0.1", source.port);
+    for(int i=0; i<TEST_KEYS; i+=7){
+        std::string key = "{user}:" + std::to_string(i);
+        expect(client.execute("get " + key) == quoted(std::to_string(i)), "read during migration " + key);
+        client.execute("set " + key + " w" + std::to_string(i));
+    }
+    waitFor("migration", [&](){ return source.call("get {user}:0").find("MOVED " + slot + " " + target.address()) != std::string::npos; });
+    for(int i=0; i<TEST_KEYS; i++){
+        std::string expected = i % 7 == 0 ? "w" + std::to_string(i) : std::to_string(i);
+        expect(target.call("get {user}:" + std::to_string(i)) == quoted(expected), "migrated value {user}:" + std::to_string(i));
+    }
+    expect(source.call("get other") == quoted("1"), "other slots stay");
+    expect(target.call("cluster slots").find(target.address()) != std::string::npos, "target owns the slot");
+    std::cout<<"slot migration OK, slot="<<slot<<std::endl;
+}
+
+int main(int argc, char *argv[]){
+    std::string binary = argc > 1 ? argv[1] : "./redis-server";
+    int port = argc > 2 ? std::atoi(argv[2]) : 7000;
+    signal(SIGPIPE, SIG_IGN);
+
+    Node master(binary, port);
+    Node replica(binary, port + NODE_PORT_STEP);
+    replication(master, replica);
+
+    Node source(binary, port + 2*NODE_PORT_STEP);
+    Node target(binary, port + 3*NODE_PORT_STEP);
+    slotMigration(source, target);
+
+    killChildren();
+    std::cout<<"MultiNode OK"<<std::endl;
+    return 0;
+}